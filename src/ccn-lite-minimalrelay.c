@@ -25,6 +25,7 @@
 #include <errno.h>
 #include <getopt.h>
 #include <stdarg.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -77,9 +78,10 @@ int inet_aton(const char *cp, struct in_addr *inp);
 #define free_2ptr_list(a,b)     ccnl_free(a), ccnl_free(b)
 #define free_3ptr_list(a,b,c)   ccnl_free(a), ccnl_free(b), ccnl_free(c)
 #define free_4ptr_list(a,b,c,d) ccnl_free(a), ccnl_free(b), ccnl_free(c), ccnl_free(d);
+#define free_5ptr_list(a,b,c,d,e) ccnl_free(a), ccnl_free(b), ccnl_free(c), ccnl_free(d), ccnl_free(e);
 
 #define free_prefix(p)  do{ if(p) \
-                free_4ptr_list(p->bytes,p->comp,p->complen,p); } while(0)
+                free_5ptr_list(p->bytes,p->comp,p->complen,p->chunknum,p); } while(0)
 #define free_content(c) do{ free_prefix(c->name); \
                         free_2ptr_list(c->pkt, c); } while(0)
 
@@ -92,6 +94,16 @@ int inet_aton(const char *cp, struct in_addr *inp);
 
 #define ccnl_nfn_monitor(a,b,c,d,e)     do{}while(0)
 
+#define ccnl_cs_count(r,p,c)            do{}while(0)
+#define ccnl_cs_admit(r,c)              1
+#define ccnl_cs_cleanup(r)              do{}while(0)
+#define ccnl_prefetch_RX(r,p,c,i)       do{}while(0)
+#define ccnl_prefetch_wanted(r,c)       0
+#define ccnl_prefetch_cleanup(r)        do{}while(0)
+#define ccnl_disk_demote(r,c)           do{}while(0)
+#define ccnl_disk_RX(r,f,p)             0
+#define ccnl_disk_close(r)              do{}while(0)
+
 #define ccnl_print_stats(x,y)           do{}while(0)
 #define ccnl_app_RX(x,y)                do{}while(0)
 
@@ -126,6 +138,7 @@ ccnl_buf_new(void *data, int len)
         return NULL;
     b->next = NULL;
     b->datalen = len;
+    b->tclass = 0;
     if (data)
         memcpy(b->data, data, len);
     return b;
@@ -28,9 +28,11 @@
 
 #define CCNL_UNIX
 
+#define USE_CACHEPOLICY
 #define USE_CCNxDIGEST
 #define USE_DEBUG                      // must select this for USE_MGMT
 #define USE_DEBUG_MALLOC
+#define USE_DISKCACHE
 // #define USE_FRAG
 #define USE_ETHERNET
 #define USE_HTTP_STATUS
@@ -39,7 +41,10 @@
 // #define USE_NFN
 #define USE_NFN_NSTRANS
 // #define USE_NFN_MONITOR
+#define USE_PREFETCH
+#define USE_PRELOAD
 // #define USE_SCHEDULER
+#define USE_SNAPSHOT
 #define USE_SUITE_CCNB                 // must select this for USE_MGMT
 #define USE_SUITE_CCNTLV
 #define USE_SUITE_IOTTLV
@@ -69,12 +74,18 @@
 #include "ccnl-ext-nfn.c"
 #include "ccnl-ext-nfnmonitor.c"
 #include "ccnl-ext-sched.c"
+#include "ccnl-ext-cache.c"
+#include "ccnl-ext-prefetch.c"
+#include "ccnl-ext-preload.c"
+#include "ccnl-ext-diskcache.c"
+#include "ccnl-ext-snapshot.c"
 #include "ccnl-ext-frag.c"
 #include "ccnl-ext-crypto.c"
 
 // ----------------------------------------------------------------------
 
 struct ccnl_relay_s theRelay;
+int halt_pipe[2] = {-1, -1};    // wakes up select(), see ccnl_relay_halt()
 char suite = CCNL_SUITE_DEFAULT; 
 
 struct timeval*
@@ -267,6 +278,51 @@ ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
     rc = 0; // just to silence a compiler warning (if USE_DEBUG is not set)
 }
 
+#ifdef USE_FRAG
+// gather variant of ccnl_ll_TX, used for sending fragments
+void
+ccnl_ll_TXv(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+            sockunion *dest, struct iovec *iov, int iovcnt)
+{
+    struct msghdr msg;
+    int rc;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+    switch(dest->sa.sa_family) {
+    case AF_INET:
+        msg.msg_name = &dest->ip4;
+        msg.msg_namelen = sizeof(struct sockaddr_in);
+        break;
+#ifdef USE_UNIXSOCKET
+    case AF_UNIX:
+        msg.msg_name = &dest->ux;
+        msg.msg_namelen = sizeof(struct sockaddr_un);
+        break;
+#endif
+    default: { // gather into one buffer (e.g. Ethernet framing)
+        struct ccnl_buf_s *buf;
+        int i, len = 0;
+
+        for (i = 0; i < iovcnt; i++)
+            len += iov[i].iov_len;
+        buf = ccnl_buf_new(NULL, len);
+        if (!buf)
+            return;
+        for (i = 0, len = 0; i < iovcnt; len += iov[i++].iov_len)
+            memcpy(buf->data + len, iov[i].iov_base, iov[i].iov_len);
+        ccnl_ll_TX(ccnl, ifc, dest, buf);
+        ccnl_free(buf);
+        return;
+    }
+    }
+    rc = sendmsg(ifc->sock, &msg, 0);
+    DEBUGMSG(DEBUG, "sendmsg (%d parts) returned %d\n", iovcnt, rc);
+    rc = 0; // just to silence a compiler warning (if USE_DEBUG is not set)
+}
+#endif // USE_FRAG
+
 void
 ccnl_close_socket(int s)
 {
@@ -460,6 +516,8 @@ ccnl_io_loop(struct ccnl_relay_s *ccnl)
     for (i = 0; i < ccnl->ifcount; i++)
         if (ccnl->ifs[i].sock > maxfd)
             maxfd = ccnl->ifs[i].sock;
+    if (halt_pipe[0] > maxfd)
+        maxfd = halt_pipe[0];
     maxfd++;
 
     DEBUGMSG(INFO, "starting main event and IO loop\n");
@@ -468,13 +526,16 @@ ccnl_io_loop(struct ccnl_relay_s *ccnl)
 
         FD_ZERO(&readfs);
         FD_ZERO(&writefs);
+        if (halt_pipe[0] >= 0)
+            FD_SET(halt_pipe[0], &readfs);
 
 #ifdef USE_HTTP_STATUS
         ccnl_http_anteselect(ccnl, ccnl->http, &readfs, &writefs, &maxfd);
 #endif
         for (i = 0; i < ccnl->ifcount; i++) {
             FD_SET(ccnl->ifs[i].sock, &readfs);
-            if (ccnl->ifs[i].qlen > 0)
+            // a scheduler gives its interface the CTS itself
+            if (ccnl->ifs[i].qlen > 0 && !ccnl->ifs[i].sched)
                 FD_SET(ccnl->ifs[i].sock, &writefs);
         }
 
@@ -482,6 +543,8 @@ ccnl_io_loop(struct ccnl_relay_s *ccnl)
         rc = select(maxfd, &readfs, &writefs, NULL, timeout);
 
         if (rc < 0) {
+            if (errno == EINTR) // see ccnl_relay_halt()
+                continue;
             perror("select(): ");
             exit(EXIT_FAILURE);
         }
@@ -526,154 +589,30 @@ ccnl_io_loop(struct ccnl_relay_s *ccnl)
 }
 
 
+// ----------------------------------------------------------------------
+
+// SIGTERM, SIGINT: leave the loop, and clean up (snapshot, disk tier).
+// The byte in halt_pipe also ends a select() which started before the
+// flag was set, instead of waiting for its timeout.
 void
-ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
+ccnl_relay_halt(int sig)
 {
-    DIR *dir;
-    struct dirent *de;
-
-    dir = opendir(path);
-    if (!dir) {
-        DEBUGMSG(ERROR, "could not open directory %s\n", path);
-        return;
-    }
-
-    DEBUGMSG(INFO, "populating cache from directory %s\n", path);
-
-    while ((de = readdir(dir))) {
-        char fname[1000];
-        struct stat s;
-        struct ccnl_buf_s *buf = 0, *nonce=0, *ppkd=0, *pkt = 0;
-        struct ccnl_prefix_s *prefix = 0;
-        struct ccnl_content_s *c = 0;
-        unsigned char *content, *data;
-        int fd, contlen, datalen, typ, len, suite, skip;
-
-        if (de->d_name[0] == '.')
-            continue;
-
-        strcpy(fname, path);
-        strcat(fname, "/");
-        strcat(fname, de->d_name);
-
-        if (stat(fname, &s)) { 
-            perror("stat"); 
-            continue; 
-        }
-
-        DEBUGMSG(INFO, "loading file %s, %d bytes\n", de->d_name,
-                 (int) s.st_size);
-
-        fd = open(fname, O_RDONLY);
-        if (!fd) { 
-            perror("open"); 
-            continue; 
-        }
-
-        buf = (struct ccnl_buf_s *) ccnl_malloc(sizeof(*buf) + s.st_size);
-        if (buf)
-            datalen = read(fd, buf->data, s.st_size);
-        else
-            datalen = -1;
-        close(fd);
-
-        if (!buf || datalen != s.st_size || datalen < 2) {
-            DEBUGMSG(WARNING, "size mismatch for file %s, %d/%d bytes\n",
-                     de->d_name, datalen, (int) s.st_size);
-            continue;
-        }
-        buf->datalen = datalen;
-        suite = ccnl_pkt2suite(buf->data, datalen, &skip);
-
-        switch (suite) {
-#ifdef USE_SUITE_CCNB
-        case CCNL_SUITE_CCNB:
-            if (buf->data[0+skip] != 0x04 || buf->data[1+skip] != 0x82)
-                goto notacontent;
-            data = buf->data + 2 + skip;
-            datalen -= 2 + skip;
-            pkt = ccnl_ccnb_extract(&data, &datalen, 0, 0, 0, 0,
-                                    &prefix, &nonce, &ppkd, &content, &contlen);
-            break;
-#endif
-#ifdef USE_SUITE_CCNTLV
-        case CCNL_SUITE_CCNTLV:
-            // ccntlv_extract expects the data pointer 
-            // at the start of the message. Move past the fixed header.
-            data = buf->data + skip;
-            datalen -= 8 + skip;
-            data += 8;
-            pkt = ccnl_ccntlv_extract(8, // hdrlen
-                                      &data, &datalen, &prefix, 0, 0, 0,
-                                      &content, &contlen);
-            break;
-#endif 
-#ifdef USE_SUITE_IOTTLV
-        case CCNL_SUITE_IOTTLV:
-            data = buf->data + skip;
-            datalen -= skip;
-            if (ccnl_iottlv_dehead(&data, &datalen, &typ, &len) ||
-                                                       typ != IOT_TLV_Reply)
-                goto notacontent;
-            pkt = ccnl_iottlv_extract(buf->data + skip, &data, &datalen,
-                                      &prefix, NULL, &content, &contlen);
-            break;
-#endif
-#ifdef USE_SUITE_NDNTLV
-        case CCNL_SUITE_NDNTLV:
-            data = buf->data + skip;
-            datalen -= skip;
-            if (ccnl_ndntlv_dehead(&data, &datalen, &typ, &len) ||
-                                                       typ != NDN_TLV_Data)
-                goto notacontent;
-            pkt = ccnl_ndntlv_extract(data - buf->data, &data, &datalen,
-                                      0, 0, 0, 0, NULL, &prefix, NULL,
-                                      &nonce, &ppkd, &content, &contlen);
-            break;
-#endif
-        default:
-            DEBUGMSG(WARNING, "unknown packet format (%s)\n", de->d_name);
-            goto Done;
-        }
-        if (!pkt) {
-            DEBUGMSG(WARNING, "parsing error (%s)\n", de->d_name);
-            goto Done;
-        }
-        if (!prefix) {
-            DEBUGMSG(WARNING, "missing prefix (%s)\n", de->d_name);
-            goto Done;
-        }
+    int err = errno;
 
-        c = ccnl_content_new(ccnl, suite, &pkt, &prefix,
-                             &ppkd, content, contlen);
-        if (!c) {
-            DEBUGMSG(WARNING, "could not create content (%s)\n", de->d_name);
-            goto Done;
-        }
-        ccnl_content_add2cache(ccnl, c);
-        c->flags |= CCNL_CONTENT_FLAGS_STATIC;
-Done:
-        free_prefix(prefix);
-        ccnl_free(buf);
-        ccnl_free(pkt);
-        ccnl_free(nonce);
-        ccnl_free(ppkd);
-        continue;
-notacontent:
-        DEBUGMSG(WARNING, "not a content object (%s)\n", de->d_name);
-        ccnl_free(buf);
-    }
-
-    closedir(dir);
+    theRelay.halt_flag = 1;
+    if (halt_pipe[1] >= 0 && write(halt_pipe[1], "", 1) < 0)
+        ; // pipe full: select() returns anyway
+    errno = err;
 }
 
-// ----------------------------------------------------------------------
-
 int
 main(int argc, char **argv)
 {
     int opt, max_cache_entries = -1, udpport = -1, httpport = -1;
     char *datadir = NULL, *ethdev = NULL, *crypto_sock_path = NULL;
+    char *diskdir = NULL;
+    struct sigaction sa;
+    long disk_mbytes = CCNL_DISK_MAX_MBYTES;
 #ifdef USE_UNIXSOCKET
     char *uxpath = CCNL_DEFAULT_UNIXSOCKNAME;
 #else
@@ -682,15 +621,24 @@ main(int argc, char **argv)
 
     time(&theRelay.startup_time);
     srandom(time(NULL));
+    theRelay.coalesce_linger = CCNL_FACE_COALESCE_LINGER;
 
-    while ((opt = getopt(argc, argv, "hc:d:e:g:i:s:t:u:v:x:p:")) != -1) {
+    while ((opt = getopt(argc, argv, "hB:c:d:D:e:g:i:l:s:S:t:u:v:x:p:")) != -1) {
         switch (opt) {
+        case 'B':
+            disk_mbytes = atol(optarg);
+            if (disk_mbytes <= 0)
+                goto usage;
+            break;
         case 'c':
             max_cache_entries = atoi(optarg);
             break;
         case 'd':
             datadir = optarg;
             break;
+        case 'D':
+            diskdir = optarg;
+            break;
         case 'e':
             ethdev = optarg;
             break;
@@ -700,11 +648,17 @@ main(int argc, char **argv)
         case 'i':
             inter_ccn_interval = atoi(optarg);
             break;
+        case 'l':
+            theRelay.coalesce_linger = atoi(optarg);
+            break;
         case 's':
             suite = ccnl_str2suite(optarg);
             if (suite < 0 || suite >= CCNL_SUITE_LAST)
                 goto usage;
             break;
+        case 'S':
+            theRelay.snapshot = optarg;
+            break;
         case 't':
             httpport = atoi(optarg);
             break;
@@ -730,14 +684,24 @@ main(int argc, char **argv)
 usage:
             fprintf(stderr,
                     "usage: %s [options]\n"
+#ifdef USE_DISKCACHE
+                    "  -B DISK_MBYTES (of the -D tier, default 1024)\n"
+#endif
                     "  -c MAX_CONTENT_ENTRIES\n"
-                    "  -d databasedir\n"
+                    "  -d databasedir (or packed repository file)\n"
+#ifdef USE_DISKCACHE
+                    "  -D diskdir (content evicted from RAM is kept there)\n"
+#endif
                     "  -e ethdev\n"
                     "  -g MIN_INTER_PACKET_INTERVAL\n"
                     "  -h\n"
                     "  -i MIN_INTER_CCNMSG_INTERVAL\n"
+                    "  -l LINGER (usec, for faces with the coalesce flag 0x10)\n"
                     "  -p crypto_face_ux_socket\n"
                     "  -s SUITE (ccnb, ccnx2014, iot2014, ndn2013)\n"
+#ifdef USE_SNAPSHOT
+                    "  -S snapshotfile (content store, restored and saved)\n"
+#endif
                     "  -t tcpport (for HTML status page)\n"
                     "  -u udpport\n"
 
@@ -785,13 +749,35 @@ usage:
 
     ccnl_relay_config(&theRelay, ethdev, udpport, httpport,
                       uxpath, suite, max_cache_entries, crypto_sock_path);
+#ifdef USE_DISKCACHE
+    if (diskdir && ccnl_disk_open(&theRelay, diskdir, disk_mbytes << 20) < 0)
+        exit(EXIT_FAILURE);
+#endif
+#ifdef USE_SNAPSHOT
+    if (theRelay.snapshot)
+        ccnl_snapshot_load(&theRelay, theRelay.snapshot);
+#endif
     if (datadir)
         ccnl_populate_cache(&theRelay, datadir);
+
+    if (!pipe(halt_pipe)) {
+        fcntl(halt_pipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(halt_pipe[1], F_SETFL, O_NONBLOCK);
+    }
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = ccnl_relay_halt;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
     
     ccnl_io_loop(&theRelay);
 
+    ccnl_preload_cleanup(&theRelay);
     while (eventqueue)
         ccnl_rem_timer(eventqueue);
+#ifdef USE_SNAPSHOT
+    if (theRelay.snapshot)
+        ccnl_snapshot_save(&theRelay, theRelay.snapshot);
+#endif
     
     ccnl_core_cleanup(&theRelay);
 #ifdef USE_HTTP_STATUS
@@ -22,15 +22,19 @@
  * 2013-03-19 updated (ms): replacement code after renaming the field
  *              ccnl_relay_s.client to ccnl_relay_s.aux
  * 2014-12-18 removed log generation (cft)
+ * 2026-10-19 lossy ethernet (-l), fragmentation and ARQ per link (-f)
+ * 2026-10-19 interface scheduler options (-r), e.g. a token bucket
  */
 
 
 #define CCNL_SIMULATION
 
+#define USE_CACHEPOLICY
 #define USE_DEBUG
 #define USE_DEBUG_MALLOC
 #define USE_ETHERNET
-//#define USE_FRAG
+#define USE_FRAG
+#define USE_PREFETCH
 #define USE_SCHEDULER
 #define USE_SUITE_CCNB
 #define USE_SUITE_CCNTLV
@@ -62,6 +66,8 @@ int ccnl_pkt_prependComponent(int suite, char *src, int *offset, unsigned char *
 #include "ccnl-ext-nfn.c"
 #include "ccnl-ext-nfnmonitor.c"
 #include "ccnl-ext-sched.c"
+#include "ccnl-ext-cache.c"
+#include "ccnl-ext-prefetch.c"
 
 #include "ccnl-ext-frag.c"
 
@@ -197,6 +203,9 @@ struct ccnl_ethernet_s {
 };
 struct ccnl_ethernet_s *etherqueue;
 
+static int ether_loss; // percent of the frames which get lost
+static int ether_lost;
+
 void
 ccnl_simu_ethernet(void *dummy, void *dummy2)
 {
@@ -215,7 +224,11 @@ ccnl_simu_ethernet(void *dummy, void *dummy2)
                 break;
             }
         }
-        if (i < 5) {
+        if (i < 5 && ether_loss > 0 && random() % 100 < ether_loss) {
+            DEBUGMSG(DEBUG, "simu_ethernet: losing %d Bytes to %s\n",
+                     p->len, eth2ascii(p->dst));
+            ether_lost++;
+        } else if (i < 5) {
             sockunion sun;
 
             sun.sa.sa_family = AF_PACKET;
@@ -319,6 +332,8 @@ void ccnl_simu_cleanup(void *dummy, void *dummy2);
 
 static int inter_ccn_interval = 0; // in usec
 static int inter_packet_interval = 0; // in usec
+static char *frag_spec = "none"; // fragmentation of the links
+static char *sched_spec; // options of the interface schedulers
 
 #ifdef USE_SCHEDULER
 struct ccnl_sched_s*
@@ -360,6 +375,8 @@ ccnl_simu_init_node(char node, const char *addr,
 #ifdef USE_SCHEDULER
     i->sched = ccnl_sched_pktrate_new(ccnl_interface_CTS, relay,
                                       inter_packet_interval);
+    if (sched_spec)
+        ccnl_sched_setopts(i->sched, sched_spec);
     relay->defaultFaceScheduler = ccnl_simu_defaultFaceScheduler;
 #endif
 
@@ -378,30 +395,44 @@ ccnl_simu_init_node(char node, const char *addr,
 }
 
 
+// the face of node towards peer, with the link's fragmentation
+static struct ccnl_face_s*
+ccnl_simu_link_face(struct ccnl_relay_s *relay, struct ccnl_relay_s *peer)
+{
+    struct ccnl_face_s *f;
+    sockunion sun;
+
+    sun.eth.sll_family = AF_PACKET;
+    memcpy(sun.eth.sll_addr, peer->ifs[0].addr.eth.sll_addr, ETH_ALEN);
+    f = ccnl_get_face_or_create(relay, 0, &sun.sa, sizeof(sun.eth));
+#ifdef USE_FRAG
+    if (f && !f->frag) {
+        f->frag = ccnl_frag_new(ccnl_frag_str2proto(frag_spec), 1200);
+        ccnl_frag_setopts(f->frag, frag_spec);
+    }
+#endif
+    return f;
+}
+
 void
 ccnl_simu_add_fwd(char node, const char *name, char dstnode)
 {
     struct ccnl_relay_s *relay = char2relay(node), *dst = char2relay(dstnode);
     struct ccnl_forward_s *fwd;
-    sockunion sun;
     char *cp;
 
     DEBUGMSG(TRACE, "ccnl_simu_add_fwd\n");
 
-    sun.eth.sll_family = AF_PACKET;
-    memcpy(sun.eth.sll_addr, dst->ifs[0].addr.eth.sll_addr, ETH_ALEN);
     fwd = (struct ccnl_forward_s *) ccnl_calloc(1, sizeof(*fwd));
     //    fwd->prefix = ccnl_path_to_prefix(name);
     cp = ccnl_strdup(name);
     fwd->prefix = ccnl_URItoPrefix(cp, theSuite, NULL, NULL);
     ccnl_free(cp);
     fwd->suite = theSuite;
-    fwd->face = ccnl_get_face_or_create(relay, 0, &sun.sa, sizeof(sun.eth));
-#ifdef USE_FRAG
-    //    fwd->face->frag = ccnl_frag_new(CCNL_FRAG_SEQUENCED2012, 1500);
-    fwd->face->frag = ccnl_frag_new(CCNL_FRAG_CCNx2013, 1200);
-#endif
+    fwd->face = ccnl_simu_link_face(relay, dst);
     fwd->face->flags |= CCNL_FACE_FLAGS_STATIC;
+    // the way back, for the content
+    ccnl_simu_link_face(dst, relay)->flags |= CCNL_FACE_FLAGS_STATIC;
     fwd->next = relay->fib;
     relay->fib = fwd;
 }
@@ -461,6 +492,7 @@ ccnl_simu_init(int max_cache_entries)
     // start clients:
     ccnl_set_timer( 500000, ccnl_simu_client_start, char2relay('A'), 0);
     ccnl_set_timer(1000000, ccnl_simu_client_start, char2relay('B'), 0);
+    pending_client_tasks = 2;
     phaseOne = 1;
 
     printf("Press ENTER to start the simulation\n");
@@ -475,6 +507,7 @@ ccnl_simu_phase_two(void *ptr, void *dummy)
     phaseOne = 0;
     ccnl_set_timer(0, ccnl_simu_client_start, char2relay('A'), 0);
     ccnl_set_timer(500000, ccnl_simu_client_start, char2relay('B'), 0);
+    pending_client_tasks = 2;
 }
 
 
@@ -546,6 +579,9 @@ ccnl_simu_cleanup(void *dummy, void *dummy2)
 #ifdef USE_SCHEDULER
     ccnl_sched_cleanup();
 #endif
+    if (ether_loss > 0)
+        printf("%d frames lost on the ethernet (%d%%)\n",
+               ether_lost, ether_loss);
 #ifdef USE_DEBUG_MALLOC
     debug_memdump();
 #endif
@@ -562,17 +598,31 @@ main(int argc, char **argv)
     //    srand(time(NULL));
     srandom(time(NULL));
 
-    while ((opt = getopt(argc, argv, "hc:g:i:s:v:")) != -1) {
+    while ((opt = getopt(argc, argv, "hc:f:g:i:l:r:s:v:")) != -1) {
         switch (opt) {
         case 'c':
             max_cache_entries = atoi(optarg);
             break;
+        case 'f':
+            frag_spec = optarg;
+            if (ccnl_frag_str2proto(frag_spec) < 0 ||
+                ccnl_frag_setopts(NULL, frag_spec) < 0)
+                goto usage;
+            break;
         case 'g':
             inter_packet_interval = atoi(optarg);
             break;
         case 'i':
             inter_ccn_interval = atoi(optarg);
             break;
+        case 'l':
+            ether_loss = atoi(optarg);
+            break;
+        case 'r':
+            sched_spec = optarg;
+            if (ccnl_sched_setopts(NULL, sched_spec) < 0)
+                goto usage;
+            break;
         case 'v':
             if (isdigit(optarg[0]))
                 debug_level = atoi(optarg);
@@ -585,9 +635,13 @@ main(int argc, char **argv)
                 break;
         case 'h':
         default:
+usage:
             fprintf(stderr, "Xusage: %s [-h] [-c MAX_CONTENT_ENTRIES] "
+                    "[-f FRAG (none, seqd2012, ccnx2013)[,arq][,fec=N/K]] "
                     "[-g MIN_INTER_PACKET_INTERVAL] "
                     "[-i MIN_INTER_CCNMSG_INTERVAL] "
+                    "[-l LOSS_PERCENT] "
+                    "[-r SCHED (rate=BYTES_PER_SEC[,burst=BYTES][,quantum=BYTES])] "
                     "[-s SUITE (ccnb, ccnx2014, iot2014, ndn2013)] "
                     "[-v DEBUG_LEVEL]\n",
                     argv[0]);
@@ -18,6 +18,13 @@
  *
  * File history:
  * 2014-11-05 collected from the various fwd-XXX.c files
+ * 2026-10-19 content sizes for the interest shaping of the incoming face
+ * 2026-10-19 RTT samples and NACK failover for the forwarding strategy
+ * 2026-10-19 NDN InterestLifetime, MustBeFresh and FreshnessPeriod
+ * 2026-10-19 negative cache of received NACKs
+ * 2026-10-19 cache admission and content store hit counters
+ * 2026-10-19 sequential chunk prefetching
+ * 2026-10-19 content store misses looked up in the disk tier
  */
 
 // ----------------------------------------------------------------------
@@ -27,6 +34,8 @@ void
 ccnl_fwd_handleContent(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                        struct ccnl_content_s *c)
 {
+    int admit;
+
     if (!c)
         return;
      // CONFORM: Step 2 (and 3)
@@ -37,13 +46,37 @@ ccnl_fwd_handleContent(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         DEBUGMSG(VERBOSE, "no running computation found \n");
     }
 #endif
+#ifdef USE_NACK
+    if (ccnl_nfnprefix_contentIsNACK(c)) {
+        if (ccnl_fwd_NACK(relay, from, c))
+            DEBUGMSG(DEBUG, "  NACK, trying another next hop\n");
+        else if (ccnl_content_serve_pending(relay, c)) {
+            // no other next hop: passed on, and remembered for a moment
+            DEBUGMSG(DEBUG, "  NACK, negative cache entry for <%s>\n",
+                     ccnl_prefix_to_path(c->name));
+            ccnl_nack_cache(relay, c->name);
+        }
+        free_content(c); // NACKs are not cached as content
+        return;
+    }
+    ccnl_nack_forget(relay, c->name);
+#endif
+    if (from)
+        ccnl_fwd_RX(relay, from, c);
+    // admission looks at the PIT entries, decide before they are served
+    admit = relay->max_cache_entries != 0 &&
+            (ccnl_prefetch_wanted(relay, c) || ccnl_cs_admit(relay, c));
     if (!ccnl_content_serve_pending(relay, c)) { // unsolicited content
         // CONFORM: "A node MUST NOT forward unsolicited data [...]"
         DEBUGMSG(DEBUG, "  removed because no matching interest\n");
         free_content(c);
         return;
     }
-    if (relay->max_cache_entries != 0) { // it's set to -1 or a limit
+#ifdef USE_SCHEDULER
+    if (from)
+        ccnl_sched_shape_RX(from, c->pkt->datalen);
+#endif
+    if (admit) { // max_cache_entries is set to -1 or a limit
         DEBUGMSG(DEBUG, "  adding content to cache\n");
         ccnl_content_add2cache(relay, c);
     } else {
@@ -75,7 +108,8 @@ ccnl_ccnb_fwd(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
         DEBUGMSG(DEBUG, "  parsing error or no prefix\n");
         goto Done;
     }
-    if (nonce && ccnl_nonce_find_or_append(ccnl, nonce)) {
+    if (nonce &&
+        ccnl_nonce_find_or_append(ccnl, nonce->data, nonce->datalen)) {
         DEBUGMSG(DEBUG, "  dropped because of duplicate nonce\n");
         goto Skip;
     }
@@ -96,15 +130,20 @@ ccnl_ccnb_fwd(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
                 // FIXME: should check stale bit in aok here
                 DEBUGMSG(DEBUG, "  matching content for interest, content %p\n",
                          (void *) c);
+                ccnl_content_used(ccnl, c);
+                ccnl_cs_count(ccnl, p, c);
                 if (from->ifndx >= 0) {
                     ccnl_nfn_monitor(ccnl, from, c->name, c->content,
                                      c->contentlen);
-                    ccnl_face_enqueue(ccnl, from, buf_dup(c->pkt));
+                    ccnl_face_send_shared(ccnl, from, c->pkt, -1, 0);
                 } else {
                     ccnl_app_RX(ccnl, c);
                 }
                 goto Skip;
             }
+            ccnl_cs_count(ccnl, p, NULL);
+            if (ccnl_disk_RX(ccnl, from, p))
+                goto Skip;
         }
         // CONFORM: Step 2: check whether interest is already known
         for (i = ccnl->pit; i; i = i->next) {
@@ -133,13 +172,14 @@ ccnl_ccnb_fwd(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
                 i->details.ccnb.ppkd = ppkd, ppkd = NULL;
             if (i) { // CONFORM: Step 3 (and 4)
                 DEBUGMSG(DEBUG, "  created new interest entry %p\n", (void *)i);
-                if (scope > 2)
-                    ccnl_interest_propagate(ccnl, i);
+                if (scope > 2 && !ccnl_interest_propagate(ccnl, i))
+                    i = NULL; // answered with a NACK
             }
         } else if (scope > 2 && (from->flags & CCNL_FACE_FLAGS_FWDALLI)) {
             DEBUGMSG(DEBUG, "  old interest, nevertheless propagated %p\n",
                      (void *) i);
-            ccnl_interest_propagate(ccnl, i);
+            if (!ccnl_interest_propagate(ccnl, i))
+                i = NULL; // answered with a NACK
         }
         if (i) { // store the I request, for the incoming face (Step 3)
             DEBUGMSG(DEBUG, "  appending interest entry %p\n", (void *) i);
@@ -193,10 +233,10 @@ ccnl_ccnb_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
             continue;
 #ifdef USE_FRAG
         case CCNL_DTAG_FRAGMENT2012:
-            rc = ccnl_frag_RX_frag2012(ccnl_RX_ccnb, relay, from, data, datalen);
+            rc = ccnl_frag_RX_frag2012(ccnl_frag_deliver, relay, from, data, datalen);
             continue;
         case CCNL_DTAG_FRAGMENT2013:
-            rc = ccnl_frag_RX_CCNx2013(ccnl_RX_ccnb, relay, from, data, datalen);
+            rc = ccnl_frag_RX_CCNx2013(ccnl_frag_deliver, relay, from, data, datalen);
             continue;
 #endif
         default:
@@ -251,16 +291,23 @@ ccnl_ccntlv_fwd(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                 continue;
             DEBUGMSG(DEBUG, "  matching content for interest, content %p\n",
                      (void *) c);
+            ccnl_content_used(relay, c);
+            ccnl_cs_count(relay, p, c);
             if (from->ifndx >= 0){
                 ccnl_nfn_monitor(relay, from, c->name, c->content,
                                  c->contentlen);
-                ccnl_face_enqueue(relay, from, buf_dup(c->pkt));
+                // we are the copy it comes from (see ccnl-ext-cache.c)
+                ccnl_face_send_shared(relay, from, c->pkt, c->hoppos, 255);
             } else {
                 ccnl_app_RX(relay, c);
             }
+            ccnl_prefetch_RX(relay, p, c, NULL);
             goto Skip;
         }
         DEBUGMSG(DEBUG, "  no matching content for interest\n");
+        ccnl_cs_count(relay, p, NULL);
+        if (ccnl_disk_RX(relay, from, p))
+            goto Skip;
         // CONFORM: Step 2: check whether interest is already known
         for (i = relay->pit; i; i = i->next) {
             if (i->suite != CCNL_SUITE_CCNTLV)
@@ -279,21 +326,28 @@ ccnl_ccntlv_fwd(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 #endif
         if (!i) {
             i = ccnl_interest_new(relay, from, CCNL_SUITE_CCNTLV,
-                                  &buf, &p, 0, hdrptr->hoplimit - 1);
+                                  &buf, &p, 0, 0);
             if (i) { // CONFORM: Step 3 (and 4)
+                // the stored packet keeps the received hop limit, the
+                // decremented one is patched in when forwarding
+                i->hoppos = &hdrptr->hoplimit - (unsigned char*) hdrptr;
+                i->hopval = hdrptr->hoplimit - 1;
                 // TODO keyID restriction
                 DEBUGMSG(DEBUG, "  created new interest entry %p\n",
                          (void *) i);
-                ccnl_interest_propagate(relay, i);
+                if (!ccnl_interest_propagate(relay, i))
+                    i = NULL; // answered with a NACK
             }
         } else if ((from->flags & CCNL_FACE_FLAGS_FWDALLI)) {
             DEBUGMSG(DEBUG, "  old interest, nevertheless propagated %p\n",
                      (void *) i);
-            ccnl_interest_propagate(relay, i);
+            if (!ccnl_interest_propagate(relay, i))
+                i = NULL; // answered with a NACK
         }
         if (i) { // store the I request, for the incoming face (Step 3)
             DEBUGMSG(DEBUG, "  appending interest entry %p\n", (void *) i);
             ccnl_interest_append_pending(i, from);
+            ccnl_prefetch_RX(relay, i->prefix, NULL, i);
         }
     } else if (typ == CCNX_PT_NACK) {
         DEBUGMSG(DEBUG, "  NACK=<%s>\n", ccnl_prefix_to_path(p));
@@ -306,6 +360,13 @@ ccnl_ccntlv_fwd(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                 goto Skip; // content is dup
         c = ccnl_content_new(relay, CCNL_SUITE_CCNTLV,
                              &buf, &p, NULL, content, contlen);
+#ifdef USE_CACHEPOLICY
+        if (c) { // NON-CONFORM: the hop limit counts the hops from the copy
+            c->hoppos = &hdrptr->hoplimit - (unsigned char*) hdrptr;
+            c->hops = 256 - hdrptr->hoplimit;
+            c->hopval = hdrptr->hoplimit > 1 ? hdrptr->hoplimit - 1 : 1;
+        }
+#endif
         ccnl_fwd_handleContent(relay, from, c);
     }
 
@@ -356,8 +417,7 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         *data = end;
         *datalen = endlen;
         return 0;
-    } else
-        hp->hoplimit = hoplimit;
+    }
 
     return ccnl_ccntlv_fwd(relay, from, hp, data, datalen);
 }
@@ -381,12 +441,14 @@ ccnl_iottlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     unsigned char *start = *data, *content = 0;
     DEBUGMSG(TRACE, "ccnl_iottlv_forwarder (%d bytes left)\n", *datalen);
 
-    if (ccnl_iottlv_dehead(data, datalen, &typ, &len))
+    if (ccnl_iottlv_dehead(data, datalen, &typ, &len) || len > *datalen)
         return -1;
+    // extract this packet only, a datagram may carry several (coalescing)
+    *datalen -= len;
 
     // typ must be Request or Reply
 
-    buf = ccnl_iottlv_extract(start, data, datalen, &p, NULL,
+    buf = ccnl_iottlv_extract(start, data, &len, &p, NULL,
                               &content, &contlen);
     if (!buf) {
         DEBUGMSG(WARNING, "  parsing error or no prefix\n");
@@ -401,15 +463,20 @@ ccnl_iottlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
             if (ccnl_prefix_cmp(c->name, NULL, p, CMP_EXACT))
                 continue;
             DEBUGMSG(DEBUG, "  matching content for interest, content %p\n", (void *) c);
+            ccnl_content_used(relay, c);
+            ccnl_cs_count(relay, p, c);
             if (from->ifndx >= 0) {
                 ccnl_nfn_monitor(relay, from, c->name, c->content, c->contentlen);
-                ccnl_face_enqueue(relay, from, buf_dup(c->pkt));
+                ccnl_face_send_shared(relay, from, c->pkt, -1, 0);
             } else {
                 ccnl_app_RX(relay, c);
             }
             goto Skip;
         }
         DEBUGMSG(DEBUG, "  no matching content for interest\n");
+        ccnl_cs_count(relay, p, NULL);
+        if (ccnl_disk_RX(relay, from, p))
+            goto Skip;
         // CONFORM: Step 2: check whether interest is already known
         for (i = relay->pit; i; i = i->next) {
             if (i->suite == CCNL_SUITE_IOTTLV &&
@@ -432,11 +499,13 @@ ccnl_iottlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                                   &buf, &p, 0, 0);
             if (i) { // CONFORM: Step 3 (and 4)
                 DEBUGMSG(DEBUG, "  created new interest entry %p\n", (void *) i);
-                ccnl_interest_propagate(relay, i);
+                if (!ccnl_interest_propagate(relay, i))
+                    i = NULL; // answered with a NACK
             }
         } else if (from->flags & CCNL_FACE_FLAGS_FWDALLI) {
             DEBUGMSG(DEBUG, "  old interest, nevertheless propagated %p\n", (void *) i);
-            ccnl_interest_propagate(relay, i);
+            if (!ccnl_interest_propagate(relay, i))
+                i = NULL; // answered with a NACK
         }
         if (i) { // store the I request, for the incoming face (Step 3)
             DEBUGMSG(DEBUG, "  appending interest entry %p\n", (void *) i);
@@ -479,36 +548,47 @@ Done:
 #ifdef USE_SUITE_NDNTLV
 
 // process one NDNTLV packet, return <0 if no bytes consumed or error
+// The packet is only scanned in place; a copy of it (and of its name) is
+// made when a new PIT or CS entry is created.
 int
 ccnl_ndntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                       unsigned char **data, int *datalen)
 {
     int len, rc=-1, typ;
-    int mbf=0, minsfx=0, maxsfx=CCNL_MAX_NAME_COMP, scope=3, contlen;
-    struct ccnl_buf_s *buf = 0, *nonce=0, *ppkl=0;
+    int minsfx, maxsfx, scope, fwdscope = -1, contlen;
+    struct ccnl_ndntlv_view_s v;
+    struct ccnl_prefix_s shadow, *p = 0;
+    struct ccnl_buf_s *buf = 0;
     struct ccnl_interest_s *i = 0;
     struct ccnl_content_s *c = 0;
-    struct ccnl_prefix_s *p = 0, *tracing = 0;
     unsigned char *content = 0, *cp = *data;
     DEBUGMSG(DEBUG, "ccnl_ndntlv_forwarder (%d bytes left)\n", *datalen);
 
-    if (ccnl_ndntlv_dehead(data, datalen, &typ, &len))
+    if (ccnl_ndntlv_dehead(data, datalen, &typ, &len) || len > *datalen)
         return -1;
-    buf = ccnl_ndntlv_extract(*data - cp,
-                              data, datalen,
-                              &scope, &mbf, &minsfx, &maxsfx, 0, 
-                              &p, &tracing, &nonce, &ppkl, &content, &contlen);
-    if (!buf) {
+    // scan this packet only, a datagram may carry several (coalescing)
+    *datalen -= len;
+    if (ccnl_ndntlv_scan(*data - cp, data, &len, &v)) {
         DEBUGMSG(DEBUG, "  parsing error or no prefix\n");
         goto Done;
     }
+    ccnl_ndntlv_view2shadow(&v, &shadow);
+    scope = v.scope < 0 ? 3 : v.scope;
+    // scope 2 (next node only) from a local client: forward it, rewritten
+    // to scope 1 so that the next node keeps it on its host
+    if (scope == 2 && v.scopepos >= 0 && from &&
+                                        from->peer.sa.sa_family == AF_UNIX)
+        fwdscope = 1;
+    minsfx = v.minsuffix < 0 ? 0 : v.minsuffix;
+    maxsfx = v.maxsuffix < 0 ? CCNL_MAX_NAME_COMP : v.maxsuffix;
 
     if (typ == NDN_TLV_Interest) {
-        if (nonce && ccnl_nonce_find_or_append(relay, nonce)) {
+        if (v.nonce &&
+            ccnl_nonce_find_or_append(relay, v.nonce, v.noncelen)) {
             DEBUGMSG(DEBUG, "  dropped because of duplicate nonce\n");
             goto Skip;
         }
-        DEBUGMSG(DEBUG, "  interest=<%s>\n", ccnl_prefix_to_path(p));
+        DEBUGMSG(DEBUG, "  interest=<%s>\n", ccnl_prefix_to_path(&shadow));
     /*
         filter here for link level management messages ...
         if (p->compcnt == 4 && !memcmp(p->comp[0], "ccnx", 4)) {
@@ -518,40 +598,41 @@ ccnl_ndntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         // CONFORM: Step 1: search for matching local content
         for (c = relay->contents; c; c = c->next) {
             if (c->suite != CCNL_SUITE_NDNTLV) continue;
-            if (!ccnl_i_prefixof_c(p, minsfx, maxsfx, c)) continue;
-            if (ppkl && !buf_equal(ppkl, c->details.ndntlv.ppkl)) continue;
-            // FIXME: should check freshness (mbf) here
-            // if (mbf) // honor "answer-from-existing-content-store" flag
+            if (!ccnl_i_prefixof_c(&shadow, minsfx, maxsfx, c)) continue;
+            if (v.mbf && ccnl_content_isStale(c)) continue; // MustBeFresh
             DEBUGMSG(DEBUG, "  matching content for interest, content %p\n",
                      (void *) c);
+            ccnl_content_used(relay, c);
+            ccnl_cs_count(relay, &shadow, c);
             if (from->ifndx >= 0) {
                 ccnl_nfn_monitor(relay, from, c->name, c->content,
                                  c->contentlen);
-                ccnl_face_enqueue(relay, from, buf_dup(c->pkt));
+                ccnl_face_send_shared(relay, from, c->pkt, -1, 0);
             } else {
                 ccnl_app_RX(relay, c);
             }
+            ccnl_prefetch_RX(relay, &shadow, c, NULL);
             goto Skip;
         }
+        ccnl_cs_count(relay, &shadow, NULL);
+        if (!v.mbf && ccnl_disk_RX(relay, from, &shadow))
+            goto Skip;
         // CONFORM: Step 2: check whether interest is already known
-#ifdef USE_KITE
-        if (tracing) { // is a tracing interest
-            for (i = relay->pit; i; i = i->next) {
-            }
-        }
-#endif
+        // (the publisher key locator selector is not parsed for NDN)
         for (i = relay->pit; i; i = i->next) {
             if (i->suite == CCNL_SUITE_NDNTLV &&
-                !ccnl_prefix_cmp(i->prefix, NULL, p, CMP_EXACT) &&
+                !ccnl_prefix_cmp(i->prefix, NULL, &shadow, CMP_EXACT) &&
                 i->details.ndntlv.minsuffix == minsfx &&
                 i->details.ndntlv.maxsuffix == maxsfx &&
-                ((!ppkl && !i->details.ndntlv.ppkl) ||
-                 buf_equal(ppkl, i->details.ndntlv.ppkl)) )
+                !i->details.ndntlv.ppkl)
                 break;
         }
         // this is a new/unknown I request: create and propagate
 #ifdef USE_NFN
-        if (!i && ccnl_nfnprefix_isNFN(p)) { // NFN PLUGIN CALL
+        if (!i && ccnl_nfnprefix_isNFN(&shadow)) { // NFN PLUGIN CALL
+            buf = ccnl_ndntlv_view2pkt(&v, &p, NULL);
+            if (!buf)
+                goto Done;
             if (ccnl_nfn_RX_request(relay, from, CCNL_SUITE_NDNTLV,
                                     &buf, &p, minsfx, maxsfx))
                 // Since the interest msg may be required in future it is
@@ -561,27 +642,56 @@ ccnl_ndntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         }
 #endif
         if (!i) {
+            if (!buf && !(buf = ccnl_ndntlv_view2pkt(&v, &p, NULL)))
+                goto Done;
             i = ccnl_interest_new(relay, from, CCNL_SUITE_NDNTLV,
                       &buf, &p, minsfx, maxsfx);
-            if (ppkl)
-                i->details.ndntlv.ppkl = ppkl, ppkl = NULL;
             if (i) { // CONFORM: Step 3 (and 4)
                 DEBUGMSG(DEBUG,
                          "  created new interest entry %p\n", (void *) i);
-                if (scope > 2)
-                    ccnl_interest_propagate(relay, i);
+                if (fwdscope >= 0) {
+                    i->hoppos = v.scopepos;
+                    i->hopval = fwdscope;
+                }
+                ccnl_interest_lifetime(i, v.lifetime >= 0 ? v.lifetime :
+                                       CCNL_INTEREST_TIMEOUT * 1000);
+                if ((scope > 2 || fwdscope >= 0) &&
+                                        !ccnl_interest_propagate(relay, i))
+                    i = NULL; // answered with a NACK
             }
         } else if (scope > 2 && (from->flags & CCNL_FACE_FLAGS_FWDALLI)) {
             DEBUGMSG(DEBUG, "  old interest, nevertheless propagated %p\n",
                      (void *) i);
-            ccnl_interest_propagate(relay, i);
+            if (!ccnl_interest_propagate(relay, i))
+                i = NULL; // answered with a NACK
+        } else if (scope > 2 && ccnl_interest_overdue(i)) {
+            // the consumer retransmitted: forward its interest now, ours
+            // would be dropped upstream because of its known nonce
+            if (!(buf = ccnl_ndntlv_view2pkt(&v, NULL, NULL)))
+                goto Done;
+            DEBUGMSG(DEBUG, "  overdue interest, propagated again %p\n",
+                     (void *) i);
+            buf->tclass = i->pkt->tclass;
+            ccnl_free(i->pkt);
+            i->pkt = buf;
+            buf = NULL;
+            i->hoppos = fwdscope >= 0 ? v.scopepos : -1;
+            i->hopval = fwdscope;
+            i->retries = 1; // backs off, and gives no ambiguous RTT sample
+            if (!ccnl_interest_propagate(relay, i))
+                i = NULL; // answered with a NACK
         }
         if (i) { // store the I request, for the incoming face (Step 3)
             DEBUGMSG(DEBUG, "  appending interest entry %p\n", (void *) i);
+            if (i->pending)
+                ccnl_interest_lifetime(i, v.lifetime >= 0 ? v.lifetime :
+                                       CCNL_INTEREST_TIMEOUT * 1000);
             ccnl_interest_append_pending(i, from);
+            if (scope > 2)
+                ccnl_prefetch_RX(relay, i->prefix, NULL, i);
         }
     } else { // data packet with content -------------------------------------
-        DEBUGMSG(DEBUG, "  data=<%s>\n", ccnl_prefix_to_path(p));
+        DEBUGMSG(DEBUG, "  data=<%s>\n", ccnl_prefix_to_path(&shadow));
 
 /*  mgmt messages for NDN?
 #ifdef USE_SIGNATURES
@@ -595,10 +705,26 @@ ccnl_ndntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 
         // CONFORM: Step 1:
         for (c = relay->contents; c; c = c->next)
-            if (buf_equal(c->pkt, buf))
+            if (c->pkt->datalen == v.len &&
+                                !memcmp(c->pkt->data, v.start, v.len)) {
+                if (c->suite == CCNL_SUITE_NDNTLV && ccnl_content_isStale(c)) {
+                    // a new copy of stale content: fresh again, and it
+                    // serves the interests which must have fresh data
+                    ccnl_content_freshness(c, v.freshness);
+                    if (from)
+                        ccnl_fwd_RX(relay, from, c);
+                    ccnl_content_serve_pending(relay, c);
+                }
                 goto Skip; // content is dup
+            }
+        buf = ccnl_ndntlv_view2pkt(&v, &p, &content);
+        if (!buf)
+            goto Done;
+        contlen = v.contlen;
         c = ccnl_content_new(relay, CCNL_SUITE_NDNTLV,
                              &buf, &p, NULL /* ppkd */ , content, contlen);
+        if (c)
+            ccnl_content_freshness(c, v.freshness);
         ccnl_fwd_handleContent(relay, from, c);
     }
 
@@ -606,7 +732,7 @@ Skip:
     rc = 0;
 Done:
     free_prefix(p);
-    free_3ptr_list(buf, nonce, ppkl);
+    ccnl_free(buf);
 
     return rc;
 }
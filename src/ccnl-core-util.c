@@ -18,6 +18,8 @@
  *
  * File history:
  * 2014-06-18 created
+ * 2026-10-19 pre-encoded packet templates
+ * 2026-10-19 name hash of the disk tier and packed repository files
  */
 
 #ifndef CCNL_CORE_UTIL_H
@@ -32,6 +34,9 @@ const char*
 compile_string(void)
 {
     static const char *cp = ""
+#ifdef USE_CACHEPOLICY
+        "CACHEPOLICY, "
+#endif
 #ifdef USE_CCNxDIGEST
         "CCNxDIGEST, "
 #endif
@@ -41,6 +46,9 @@ compile_string(void)
 #ifdef USE_DEBUG_MALLOC
         "DEBUG_MALLOC, "
 #endif
+#ifdef USE_DISKCACHE
+        "DISKCACHE, "
+#endif
 #ifdef USE_ETHERNET
         "ETHERNET, "
 #endif
@@ -71,12 +79,21 @@ compile_string(void)
 #ifdef USE_NFN_NSTRANS
         "NFN_NSTRANS, "
 #endif
+#ifdef USE_PREFETCH
+        "PREFETCH, "
+#endif
+#ifdef USE_PRELOAD
+        "PRELOAD, "
+#endif
 #ifdef USE_SCHEDULER
         "SCHEDULER, "
 #endif
 #ifdef USE_SIGNATURES
         "SIGNATURES, "
 #endif
+#ifdef USE_SNAPSHOT
+        "SNAPSHOT, "
+#endif
 #ifdef USE_SUITE_CCNB
         "SUITE_CCNB, "
 #endif
@@ -389,7 +406,6 @@ ccnl_prefix_dup(struct ccnl_prefix_s *prefix)
         return p;
 
     p->compcnt = prefix->compcnt;
-    p->chunknum = prefix->chunknum;
 #ifdef USE_NFN
     p->nfnflags = prefix->nfnflags;
 #endif
@@ -411,12 +427,34 @@ ccnl_prefix_dup(struct ccnl_prefix_s *prefix)
 
     if (prefix->chunknum) {
         p->chunknum = ccnl_malloc(sizeof(int));
+        if (!p->chunknum) {
+            free_prefix(p);
+            return NULL;
+        }
         *p->chunknum = *prefix->chunknum;
     }
 
     return p;
 }
 
+// hash of a name as it was decoded, of its components only: where the
+// chunk number is kept differs between the name of an interest and of its
+// content (for the disk tier and the index of packed repository files)
+unsigned int
+ccnl_prefix_hash(struct ccnl_prefix_s *p)
+{
+    unsigned int h = 2166136261u; // FNV-1a
+    unsigned char *cp;
+    int k;
+
+    for (k = 0; k < p->compcnt; k++) {
+        for (cp = p->comp[k]; cp < p->comp[k] + p->complen[k]; cp++)
+            h = (h ^ *cp) * 16777619u;
+        h = (h ^ '/') * 16777619u;
+    }
+    return (h ^ p->suite) * 16777619u;
+}
+
 
 int
 ccnl_prefix_appendCmp(struct ccnl_prefix_s *prefix, unsigned char *cmp,
@@ -540,6 +578,10 @@ ccnl_pkt2suite(unsigned char *data, int len, int *skip)
 #ifdef USE_SUITE_CCNB
     if (*data == 0x01 || *data == 0x04)
         return CCNL_SUITE_CCNB;
+# ifdef USE_FRAG
+    if (ccnl_is_fragment(data, len))
+        return CCNL_SUITE_CCNB;
+# endif
 #endif
 
 #ifdef USE_SUITE_CCNTLV
@@ -818,6 +860,193 @@ ccnl_mkSimpleContent(struct ccnl_prefix_s *name,
     return buf;
 }
 
+// ----------------------------------------------------------------------
+// packet templates: for streams of packets under one name (chunked
+// fetch/produce) the name is encoded only once. As long as the encoded
+// chunk number keeps its width, successive packets are patched in place
+// (chunk number, nonce, payload) instead of being rebuilt.
+
+#if defined(USE_SUITE_CCNTLV) || defined(USE_SUITE_NDNTLV)
+
+void
+ccnl_pkt_tmpl_free(struct ccnl_pkt_tmpl_s *t)
+{
+    if (!t)
+        return;
+    ccnl_free(t->name);
+    ccnl_free(t->buf);
+    ccnl_free(t);
+}
+
+struct ccnl_pkt_tmpl_s*
+ccnl_pkt_tmpl_new(struct ccnl_prefix_s *name)
+{
+    struct ccnl_pkt_tmpl_s *t;
+    struct ccnl_prefix_s p = *name;
+    unsigned char *cp;
+    int offs, len = -1;
+
+    t = (struct ccnl_pkt_tmpl_s *) ccnl_calloc(1, sizeof(*t));
+    if (!t)
+        return NULL;
+    t->suite = name->suite;
+    t->size = CCNL_MAX_PACKET_SIZE;
+    t->buf = (unsigned char *) ccnl_malloc(t->size);
+    if (!t->buf)
+        goto Bail;
+    p.chunknum = NULL;
+    offs = t->size;
+
+    // encode the name once, keep the components without the Name TL
+    switch (t->suite) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        if (ccnl_ccntlv_prependName(&p, &offs, t->buf))
+            goto Bail;
+        cp = t->buf + offs + 4;
+        len = t->size - offs - 4;
+        break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV: {
+        int typ, len2;
+        if (ccnl_ndntlv_prependName(&p, &offs, t->buf))
+            goto Bail;
+        cp = t->buf + offs;
+        len2 = t->size - offs;
+        if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &len) || len != len2)
+            goto Bail;
+        break;
+    }
+#endif
+    default:
+        DEBUGMSG(WARNING, "no packet templates for suite %d\n", t->suite);
+        goto Bail;
+    }
+
+    t->name = (unsigned char *) ccnl_malloc(len > 0 ? len : 1);
+    if (!t->name)
+        goto Bail;
+    memcpy(t->name, cp, len);
+    t->namelen = len;
+
+    return t;
+Bail:
+    ccnl_pkt_tmpl_free(t);
+    return NULL;
+}
+
+// overwrite the chunk number of the last packet, returns 0 if the new
+// number does not have the same encoded length
+static int
+ccnl_pkt_tmpl_patchChunk(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum)
+{
+    unsigned char tmp[16];
+    int offs = sizeof(tmp);
+
+    if (!chunknum)
+        return t->chunkpos < 0;
+    if (t->chunkpos < 0)
+        return 0;
+
+    switch (t->suite) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        ccnl_ccntlv_prependNetworkVarInt(CCNX_TLV_N_Chunk, *chunknum,
+                                         &offs, tmp);
+        break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        ccnl_ndntlv_prependIncludedNonNegInt(NDN_TLV_NameComponent, *chunknum,
+                                             NDN_Marker_SegmentNumber,
+                                             &offs, tmp);
+        break;
+#endif
+    default:
+        return 0;
+    }
+    if ((int) sizeof(tmp) - offs != t->chunklen)
+        return 0;
+    memcpy(t->buf + t->chunkpos, tmp + offs, t->chunklen);
+
+    return 1;
+}
+
+// returns the length of the interest packet, *pkt points into the template
+int
+ccnl_pkt_tmpl_interest(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum,
+                       int *nonce, unsigned char **pkt)
+{
+    int len = -1;
+
+    if (t->kind == 'i' && (nonce != NULL) == (t->noncepos >= 0) &&
+                                        ccnl_pkt_tmpl_patchChunk(t, chunknum)) {
+        if (nonce)
+            memcpy(t->buf + t->noncepos, nonce, 4);
+        len = t->len;
+    } else switch (t->suite) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        len = ccnl_ccntlv_tmplInterest(t, chunknum);
+        break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        len = ccnl_ndntlv_tmplInterest(t, chunknum, nonce);
+        break;
+#endif
+    default:
+        break;
+    }
+    if (len > 0 && pkt)
+        *pkt = t->buf + t->offs;
+
+    return len;
+}
+
+// returns the length of the content packet, *pkt points into the template
+// and *contentpos is the payload's offset in the packet
+int
+ccnl_pkt_tmpl_content(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum,
+                      unsigned char *payload, int paylen,
+                      unsigned int *lastchunknum, int *contentpos,
+                      unsigned char **pkt)
+{
+    int len = -1;
+
+    if (t->kind == 'c' && !t->final && !lastchunknum && paylen == t->paylen &&
+                                        ccnl_pkt_tmpl_patchChunk(t, chunknum)) {
+        memcpy(t->buf + t->paypos, payload, paylen);
+        len = t->len;
+    } else switch (t->suite) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        len = ccnl_ccntlv_tmplContent(t, chunknum, payload, paylen,
+                                      lastchunknum);
+        break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        len = ccnl_ndntlv_tmplContent(t, chunknum, payload, paylen,
+                                      lastchunknum);
+        break;
+#endif
+    default:
+        break;
+    }
+    if (len > 0) {
+        if (contentpos)
+            *contentpos = t->paypos - t->offs;
+        if (pkt)
+            *pkt = t->buf + t->offs;
+    }
+
+    return len;
+}
+
+#endif // USE_SUITE_CCNTLV || USE_SUITE_NDNTLV
+
 #endif // NEEDS_PACKET_CRAFTING
 
 #endif // CCNL_LINUXKERNEL
@@ -28,6 +28,10 @@
 
 // forward reference:
 void ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
+void ccnl_interest_retx_start(struct ccnl_relay_s *ccnl,
+                              struct ccnl_interest_s *i);
+long ccnl_interest_lifeleft(struct ccnl_interest_s *i);
+struct ccnl_prefix_s* ccnl_prefix_dup(struct ccnl_prefix_s *prefix);
 
 // ----------------------------------------------------------------------
 // datastructure support functions
@@ -168,13 +172,20 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
     DEBUGMSG(DEBUG, "face_remove relay=%p face=%p\n",
              (void*)ccnl, (void*)f);
 
+#ifdef USE_SCHEDULER
+    ccnl_sched_fq_remove(ccnl, f);
+#endif
     ccnl_sched_destroy(f->sched);
     ccnl_frag_destroy(f->frag);
+    if (f->linger)
+        ccnl_rem_timer(f->linger);
 
     for (pit = ccnl->pit; pit; ) {
         struct ccnl_pendint_s **ppend, *pend;
         if (pit->from == f)
             pit->from = NULL;
+        if (pit->upface == f)
+            pit->upface = NULL;
         for (ppend = &pit->pending; *ppend;) {
             if ((*ppend)->face == f) {
                 pend = *ppend;
@@ -183,7 +194,7 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
             } else
                 ppend = &(*ppend)->next;
         }
-        if (pit->pending)
+        if (pit->pending || (pit->flags & CCNL_PIT_PREFETCH))
             pit = pit->next;
         else
             pit = ccnl_nfn_interest_remove(ccnl, pit);
@@ -241,6 +252,7 @@ ccnl_interface_CTS(void *aux1, void *aux2)
     memcpy(&req, r, sizeof(req));
     ifc->qfront = (ifc->qfront + 1) % CCNL_MAX_IF_QLEN;
     ifc->qlen--;
+    ifc->qcnt[req.buf->tclass]--;
 
     ccnl_ll_TX(ccnl, ifc, &req.dst, req.buf);
 #ifdef USE_SCHEDULER
@@ -249,6 +261,9 @@ ccnl_interface_CTS(void *aux1, void *aux2)
         req.txdone(req.txdone_face, 1, req.buf->datalen);
 #endif
     ccnl_free(req.buf);
+#ifdef USE_SCHEDULER
+    ccnl_sched_fq_pull(ccnl, ifc);
+#endif
 }
 
 void
@@ -256,21 +271,38 @@ ccnl_interface_enqueue(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
                        struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
                        struct ccnl_buf_s *buf, sockunion *dest)
 {
-    struct ccnl_txrequest_s *r;
+    static const int qlimits[CCNL_TCLASS_CNT] = CCNL_TCLASS_QLIMITS;
+    struct ccnl_txrequest_s *r, *r2;
+    int i;
     DEBUGMSG(TRACE, "enqueue interface=%p buf=%p len=%d (qlen=%d)\n",
              (void*)ifc, (void*)buf, buf->datalen, ifc->qlen);
 
-    if (ifc->qlen >= CCNL_MAX_IF_QLEN) {
-        DEBUGMSG(WARNING, "  DROPPING buf=%p\n", (void*)buf);
+    if (buf->tclass >= CCNL_TCLASS_CNT)
+        buf->tclass = CCNL_TCLASS_CNT - 1;
+    if (ifc->qlen >= CCNL_MAX_IF_QLEN ||
+                        ifc->qcnt[buf->tclass] >= qlimits[buf->tclass]) {
+        DEBUGMSG(WARNING, "  DROPPING buf=%p (class %d)\n",
+                 (void*)buf, buf->tclass);
         ccnl_free(buf);
         return;
     }
-    r = ifc->queue + ((ifc->qfront + ifc->qlen) % CCNL_MAX_IF_QLEN);
+    // strict priority: ahead of all packets of lower classes
+    for (i = ifc->qlen; i > 0; i--) {
+        r = ifc->queue + ((ifc->qfront + i) % CCNL_MAX_IF_QLEN);
+        r2 = ifc->queue + ((ifc->qfront + i - 1) % CCNL_MAX_IF_QLEN);
+        if (r2->buf->tclass >= buf->tclass)
+            break;
+        memcpy(r, r2, sizeof(*r));
+    }
+    r = ifc->queue + ((ifc->qfront + i) % CCNL_MAX_IF_QLEN);
     r->buf = buf;
     memcpy(&r->dst, dest, sizeof(sockunion));
     r->txdone = tx_done; 
     r->txdone_face = f; 
     ifc->qlen++;
+    ifc->qcnt[buf->tclass]++;
+    ifc->qbytes += buf->datalen;
+    ifc->qpkts++;
 
 #ifdef USE_SCHEDULER
     ccnl_sched_RTS(ifc->sched, 1, buf->datalen, ccnl, ifc);
@@ -296,6 +328,78 @@ ccnl_face_dequeue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
     return pkt;
 }
 
+// coalescing faces: pack as many queued packets as fit into the MTU
+// into one datagram (ccnl_core_RX() takes them apart again)
+struct ccnl_buf_s*
+ccnl_face_dequeue_coalesced(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    struct ccnl_buf_s *pkt, *buf;
+    int cnt = 1, len, mtu = 1500;
+
+    if (!f->outq)
+        return NULL;
+    if (f->ifndx >= 0 && ccnl->ifs[f->ifndx].mtu > 0)
+        mtu = ccnl->ifs[f->ifndx].mtu;
+    len = f->outq->datalen;
+    for (pkt = f->outq->next; pkt && len + pkt->datalen <= mtu;
+                                                        pkt = pkt->next) {
+        len += pkt->datalen;
+        cnt++;
+    }
+    f->txdgrams++;
+    f->txpkts += cnt;
+    if (cnt == 1 || !(buf = ccnl_buf_new(NULL, len)))
+        return ccnl_face_dequeue(ccnl, f);
+
+    DEBUGMSG(TRACE, "  coalescing %d packets (%d bytes) face=%p\n",
+             cnt, len, (void*) f);
+    buf->tclass = f->outq->tclass; // the highest one, see face_enqueue()
+    for (len = 0; cnt > 0; cnt--) {
+        pkt = ccnl_face_dequeue(ccnl, f);
+        memcpy(buf->data + len, pkt->data, pkt->datalen);
+        len += pkt->datalen;
+        ccnl_free(pkt);
+    }
+    return buf;
+}
+
+void
+ccnl_face_linger_done(void *ptr, void *aux)
+{
+    struct ccnl_relay_s *ccnl = (struct ccnl_relay_s *) ptr;
+    struct ccnl_face_s *f = (struct ccnl_face_s *) aux;
+
+    f->linger = NULL;
+    while (f->outq)
+        ccnl_face_CTS(ccnl, f);
+}
+
+// hold back the packets of a coalescing face for at most coalesce_linger
+// usec, unless a full datagram is ready
+void
+ccnl_face_linger(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    struct ccnl_buf_s *pkt;
+    int len, mtu = 1500;
+
+    if (ccnl->coalesce_linger <= 0) {
+        ccnl_face_CTS(ccnl, f);
+        return;
+    }
+    if (f->ifndx >= 0 && ccnl->ifs[f->ifndx].mtu > 0)
+        mtu = ccnl->ifs[f->ifndx].mtu;
+    for (;;) {
+        for (len = 0, pkt = f->outq; pkt; pkt = pkt->next)
+            len += pkt->datalen;
+        if (!f->outq || len < mtu)
+            break;
+        ccnl_face_CTS(ccnl, f);
+    }
+    if (f->outq && !f->linger)
+        f->linger = ccnl_set_timer(ccnl->coalesce_linger,
+                                   ccnl_face_linger_done, ccnl, f);
+}
+
 void
 ccnl_face_CTS_done(void *ptr, int cnt, int len)
 {
@@ -314,7 +418,10 @@ ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
     DEBUGMSG(TRACE, "CTS face=%p sched=%p\n", (void*)f, (void*)f->sched);
 
     if (!f->frag || f->frag->protocol == CCNL_FRAG_NONE) {
-        buf = ccnl_face_dequeue(ccnl, f);
+        if (f->flags & CCNL_FACE_FLAGS_COALESCE)
+            buf = ccnl_face_dequeue_coalesced(ccnl, f);
+        else
+            buf = ccnl_face_dequeue(ccnl, f);
         if (buf)
             ccnl_interface_enqueue(ccnl_face_CTS_done, f,
                                    ccnl, ccnl->ifs + f->ifndx, buf, &f->peer);
@@ -323,6 +430,21 @@ ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
     else {
         sockunion dst;
         int ifndx = f->ifndx;
+        if (f->frag->flags & CCNL_FRAG_FLAGS_ARQ) {
+            ccnl_frag_arq_CTS(ccnl, f);
+            return;
+        }
+#if defined(CCNL_UNIX) && !defined(USE_SCHEDULER)
+        // idle interface: send the fragments straight out of the packets
+        if (!f->frag->bigpkt && ifndx >= 0 && !ccnl->ifs[ifndx].qlen) {
+            while ((buf = ccnl_face_dequeue(ccnl, f)) != NULL) {
+                ccnl_frag_reset(f->frag, buf, ifndx, &f->peer);
+                ccnl_frag_TXv(ccnl, f->frag);
+                ccnl_frag_fec_CTS(ccnl, f);
+            }
+            return;
+        }
+#endif
         buf = ccnl_frag_getnext(f->frag, &ifndx, &dst);
         if (!buf) {
             buf = ccnl_face_dequeue(ccnl, f);
@@ -332,6 +454,7 @@ ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
         if (buf) {
             ccnl_interface_enqueue(ccnl_face_CTS_done, f,
                                    ccnl, ccnl->ifs + ifndx, buf, &dst);
+            ccnl_frag_fec_CTS(ccnl, f);
 #ifndef USE_SCHEDULER
             ccnl_face_CTS(ccnl, f); // loop to push more fragments
 #endif
@@ -344,24 +467,48 @@ int
 ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
                  struct ccnl_buf_s *buf)
 {
-    struct ccnl_buf_s *msg;
+    struct ccnl_buf_s *msg, **pp;
+    int qlen = 0;
+#ifdef USE_SCHEDULER
+    int fq;
+#endif
     DEBUGMSG(TRACE, "enqueue face=%p (id=%d.%d) buf=%p len=%d\n",
              (void*) to, ccnl->id, to->faceid, (void*) buf, buf->datalen);
 
-    for (msg = to->outq; msg; msg = msg->next) // already in the queue?
+    if ((to->flags & CCNL_FACE_FLAGS_CTRL) && buf->tclass < CCNL_TCLASS_CTRL)
+        buf->tclass = CCNL_TCLASS_CTRL;
+#ifdef USE_SIGNATURES
+    if (to == ccnl->crypto_face && buf->tclass < CCNL_TCLASS_CRYPTO)
+        buf->tclass = CCNL_TCLASS_CRYPTO;
+#endif
+
+    for (msg = to->outq; msg; msg = msg->next, qlen++) // already in the queue?
         if (buf_equal(msg, buf)) {
             DEBUGMSG(VERBOSE, "    not enqueued because already there\n");
             ccnl_free(buf);
             return -1;
         }
-    buf->next = NULL;
-    if (to->outqend)
-        to->outqend->next = buf;
-    else
-        to->outq = buf;
-    to->outqend = buf;
 #ifdef USE_SCHEDULER
-    if (to->sched) {
+    // a fair queueing interface serves the face queues in turn
+    fq = ccnl_sched_fq_enqueue(ccnl, to, qlen);
+    if (fq < 0) {
+        DEBUGMSG(WARNING, "  DROPPING buf=%p, face %d has %d queued\n",
+                 (void*)buf, to->faceid, qlen);
+        ccnl_free(buf);
+        return -1;
+    }
+#endif
+    // strict priority: ahead of all packets of lower classes
+    for (pp = &to->outq; *pp && (*pp)->tclass >= buf->tclass;
+                                                        pp = &(*pp)->next);
+    buf->next = *pp;
+    *pp = buf;
+    if (!buf->next)
+        to->outqend = buf;
+#ifdef USE_SCHEDULER
+    if (fq)
+        ccnl_sched_fq_pull(ccnl, ccnl->ifs + to->ifndx);
+    else if (to->sched) {
 #ifdef USE_FRAG
         int len, cnt = ccnl_frag_getfragcount(to->frag, buf->datalen, &len);
 #else
@@ -371,12 +518,75 @@ ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
     } else
         ccnl_face_CTS(ccnl, to);
 #else
-    ccnl_face_CTS(ccnl, to);
+    if ((to->flags & CCNL_FACE_FLAGS_COALESCE) &&
+                        (!to->frag || to->frag->protocol == CCNL_FRAG_NONE))
+        ccnl_face_linger(ccnl, to);
+    else
+        ccnl_face_CTS(ccnl, to);
 #endif
 
     return 0;
 }
 
+// send a packet which stays with the caller (PIT or CS entry), with the
+// byte at pos (hop limit, scope; -1 for none) set to val. If the face can
+// transmit right away, the shared packet is patched and sent in place,
+// otherwise a patched copy is queued.
+int
+ccnl_face_send_shared(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
+                      struct ccnl_buf_s *pkt, int pos, unsigned char val)
+{
+    struct ccnl_buf_s *buf;
+
+    if (pos >= (int) pkt->datalen)
+        pos = -1;
+#ifndef USE_SCHEDULER
+    if (!to->outq && to->ifndx >= 0 && !ccnl->ifs[to->ifndx].qlen &&
+                        !(to->flags & CCNL_FACE_FLAGS_COALESCE) &&
+                        (!to->frag || to->frag->protocol == CCNL_FRAG_NONE)) {
+        unsigned char old = 0;
+
+        DEBUGMSG(TRACE, "send shared face=%p (id=%d.%d) buf=%p len=%d\n",
+                 (void*) to, ccnl->id, to->faceid, (void*) pkt, pkt->datalen);
+        if (pos >= 0) {
+            old = pkt->data[pos];
+            pkt->data[pos] = val;
+        }
+        ccnl_ll_TX(ccnl, (ccnl->ifs + to->ifndx), &to->peer, pkt);
+        if (pos >= 0)
+            pkt->data[pos] = old;
+        return 0;
+    }
+#endif
+    buf = buf_dup(pkt);
+    if (!buf)
+        return -1;
+    buf->tclass = pkt->tclass;
+    if (pos >= 0)
+        buf->data[pos] = val;
+    return ccnl_face_enqueue(ccnl, to, buf);
+}
+
+// ----------------------------------------------------------------------
+// traffic class of a name: relay management (/ccnx/...), crypto server
+// requests (/ccnx/crypto) and NFN computations are served before data
+
+int
+ccnl_prefix_tclass(struct ccnl_prefix_s *p)
+{
+    if (!p)
+        return CCNL_TCLASS_DATA;
+#ifdef USE_NFN
+    if (ccnl_nfnprefix_isNFN(p))
+        return CCNL_TCLASS_CTRL;
+#endif
+    if (p->compcnt < 2 || p->complen[0] != 4 || memcmp(p->comp[0], "ccnx", 4))
+        return CCNL_TCLASS_DATA;
+    if (p->complen[1] == 6 && !memcmp(p->comp[1], "crypto", 6))
+        return CCNL_TCLASS_CRYPTO;
+    return CCNL_TCLASS_CTRL;
+}
+
 // ----------------------------------------------------------------------
 // handling of interest messages
 
@@ -398,6 +608,8 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
     i->from = from;
     i->prefix = *prefix;        *prefix = 0;
     i->pkt  = *pkt;             *pkt = 0;
+    i->pkt->tclass = ccnl_prefix_tclass(i->prefix);
+    i->hoppos = -1;
     switch (suite) {
 #ifdef USE_SUITE_CCNB
     case CCNL_SUITE_CCNB:
@@ -445,55 +657,511 @@ ccnl_interest_append_pending(struct ccnl_interest_s *i,
     return 0;
 }
 
+#ifdef USE_NACK
+// ----------------------------------------------------------------------
+// negative cache: a name NACKed upstream (with no other next hop left) is
+// answered locally for CCNL_NACK_CACHE_TIME, instead of asking again
+
+// the live entry for prefix, expired ones are dropped on the way
+struct ccnl_nack_s*
+ccnl_nack_find(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix)
+{
+    struct ccnl_nack_s **pp = &ccnl->nacks, *n;
+    struct timeval now;
+
+    ccnl_get_timeval(&now);
+    while ((n = *pp)) {
+        if (timevaldelta(&n->expires, &now) <= 0) {
+            *pp = n->next;
+            free_prefix(n->prefix);
+            ccnl_free(n);
+            ccnl->nackcnt--;
+            continue;
+        }
+        if (prefix && n->prefix->suite == prefix->suite &&
+            !ccnl_prefix_cmp(n->prefix, NULL, prefix, CMP_EXACT) &&
+            (n->prefix->chunknum ? prefix->chunknum &&
+                   *n->prefix->chunknum == *prefix->chunknum :
+                   !prefix->chunknum))
+            return n;
+        pp = &n->next;
+    }
+    return NULL;
+}
+
 void
-ccnl_interest_propagate(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
+ccnl_nack_cache(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix)
 {
-    struct ccnl_forward_s *fwd;
-    int rc = 0;
-#ifdef USE_NACK
-    int matching_face = 0;
+    struct ccnl_nack_s *n = ccnl_nack_find(ccnl, prefix), **pp;
+
+    if (!n) {
+        if (ccnl->nackcnt >= CCNL_MAX_NACK_ENTRIES) { // drop the oldest
+            for (pp = &ccnl->nacks; (*pp)->next; pp = &(*pp)->next);
+            free_prefix((*pp)->prefix);
+            ccnl_free(*pp);
+            *pp = NULL;
+            ccnl->nackcnt--;
+        }
+        n = (struct ccnl_nack_s *) ccnl_calloc(1, sizeof(struct ccnl_nack_s));
+        if (!n)
+            return;
+        n->prefix = ccnl_prefix_dup(prefix);
+        if (!n->prefix) {
+            ccnl_free(n);
+            return;
+        }
+        n->next = ccnl->nacks;
+        ccnl->nacks = n;
+        ccnl->nackcnt++;
+    }
+    ccnl_get_timeval(&n->expires);
+    n->expires.tv_usec += CCNL_NACK_CACHE_TIME * 1000L;
+    n->expires.tv_sec += n->expires.tv_usec / 1000000;
+    n->expires.tv_usec %= 1000000;
+}
+
+// content for prefix has come after all
+void
+ccnl_nack_forget(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix)
+{
+    struct ccnl_nack_s *n = ccnl_nack_find(ccnl, prefix);
+
+    if (n)
+        n->expires.tv_sec = 0;
+}
+
+// NACKs i on all faces which want it, then removes it
+void
+ccnl_interest_nack(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
+{
+    struct ccnl_pendint_s *pi;
+
+    ccnl_nack_reply(ccnl, i->prefix, i->from, i->suite);
+    for (pi = i->pending; pi; pi = pi->next)
+        if (pi->face != i->from)
+            ccnl_nack_reply(ccnl, i->prefix, pi->face, i->suite);
+    ccnl_interest_remove(ccnl, i);
+}
+#endif // USE_NACK
+
+// ----------------------------------------------------------------------
+// forwarding strategy: per (prefix, face) smoothed RTT and success ratio,
+// learned from the content which comes back for PIT entries
+
+int
+ccnl_fwd_matches(struct ccnl_forward_s *fwd, struct ccnl_interest_s *i)
+{
+    int rc;
+
+    //Only for matching suite
+    if (fwd->suite != i->suite)
+        return 0;
+    rc = ccnl_prefix_cmp(fwd->prefix, NULL, i->prefix, CMP_LONGEST);
+    DEBUGMSG(DEBUG, "  ccnl_fwd_matches, rc=%d/%d\n", rc, fwd->prefix->compcnt);
+    return rc >= fwd->prefix->compcnt;
+}
+
+// expected cost of a next hop: its retransmission timeout, stretched by
+// the share of interests which were not answered
+long
+ccnl_fwd_cost(struct ccnl_forward_s *fwd)
+{
+    long rto = fwd->srtt ? fwd->srtt + 4 * fwd->rttvar : CCNL_STRATEGY_RTT0;
+
+    return rto * (fwd->sent + 1) / (fwd->ok + 1);
+}
+
+// how long to wait for an answer from that next hop
+long
+ccnl_fwd_rto(struct ccnl_forward_s *fwd)
+{
+    long rto = fwd->srtt ? fwd->srtt + 4 * fwd->rttvar : CCNL_INTEREST_RETX_INIT;
+
+    return rto < CCNL_INTEREST_RETX_MIN ? CCNL_INTEREST_RETX_MIN : rto;
+}
+
+// the FIB entry of face f with the longest match for interest i
+struct ccnl_forward_s*
+ccnl_fwd_lookup(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f,
+                struct ccnl_interest_s *i)
+{
+    struct ccnl_forward_s *fwd, *best = NULL;
+
+    for (fwd = ccnl->fib; fwd; fwd = fwd->next)
+        if (fwd->face == f && ccnl_fwd_matches(fwd, i) &&
+                (!best || fwd->prefix->compcnt > best->prefix->compcnt))
+            best = fwd;
+    return best;
+}
+
+// returns 0 if the face refused the interest
+int
+ccnl_fwd_send(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd,
+              struct ccnl_interest_s *i)
+{
+#ifdef USE_SCHEDULER
+    int shaped;
 #endif
-    DEBUGMSG(DEBUG, "ccnl_interest_propagate\n");
 
-    // CONFORM: "A node MUST implement some strategy rule, even if it is only to
-    // transmit an Interest Message on all listed dest faces in sequence."
-    // CCNL strategy: we forward on all FWD entries with a prefix match
+    ccnl_nfn_monitor(ccnl, fwd->face, i->prefix, NULL, 0);
+#ifdef USE_SCHEDULER
+    // interest shaping may hold it back, or refuse it
+    shaped = ccnl_sched_shape_interest(ccnl, fwd->face, i);
+    if (shaped == -2)
+        return 0;
+    if (!shaped)
+#endif
+    ccnl_face_send_shared(ccnl, fwd->face, i->pkt, i->hoppos, i->hopval);
+    if (++fwd->sent >= CCNL_STRATEGY_WINDOW) {
+        fwd->sent /= 2;
+        fwd->ok /= 2;
+    }
+    return 1;
+}
 
-    for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
+// CCNL_STRATEGY_WEIGHTED: the share of a next hop, as configured or by
+// its measured cost (CCNL_STRATEGY_WEIGHT0 for CCNL_STRATEGY_RTT0). The
+// measured one is rounded down to a power of two: it only changes when
+// the cost halves or doubles, not with each RTT sample
+int
+ccnl_fwd_weight(struct ccnl_forward_s *fwd)
+{
+    long w, q = 1;
+
+    if (fwd->weight > 0)
+        return fwd->weight;
+    w = CCNL_STRATEGY_WEIGHT0 * CCNL_STRATEGY_RTT0 / ccnl_fwd_cost(fwd);
+    while (q * 2 <= w)
+        q *= 2;
+    return q;
+}
+
+// the same for all interests for an object
+unsigned int
+ccnl_fwd_namehash(struct ccnl_prefix_s *p)
+{
+    unsigned int h = 2166136261u; // FNV-1a
+    unsigned char *cp;
+    int k;
+
+    for (k = 0; k < p->compcnt; k++) {
+        for (cp = p->comp[k]; cp < p->comp[k] + p->complen[k]; cp++)
+            h = (h ^ *cp) * 16777619u;
+        h = (h ^ '/') * 16777619u;
+    }
+    if (p->chunknum)
+        h = (h ^ *p->chunknum) * 16777619u;
+    h ^= h >> 15;
+    return h;
+}
 
-        //Only for matching suite
-        if (fwd->suite != i->suite) {
-            DEBUGMSG(DEBUG, "  not same suite (%d/%d)\n", fwd->suite, i->suite);
+// whether fwd is one of the next hops ccnl_fwd_pick() chooses from
+static int
+ccnl_fwd_pickable(struct ccnl_forward_s *fwd, struct ccnl_interest_s *i,
+                  int len, struct ccnl_face_s *avoid, struct ccnl_face_s *avoid2)
+{
+    if (fwd->prefix->compcnt != len || !ccnl_fwd_matches(fwd, i))
+        return 0;
+    if (fwd->face == avoid || fwd->face == avoid2)
+        return 0;
+    return !i->from || fwd->face != i->from ||
+                                (i->from->flags & CCNL_FACE_FLAGS_REFLECT);
+}
+
+// -log2(h / 2^32) in 1/65536, for 0 < h (no floating point in the core)
+static unsigned long
+ccnl_fwd_neglog2(unsigned int h)
+{
+    unsigned long long m;
+    unsigned long r;
+    int b = 31, k;
+
+    while (!(h >> b))
+        b--;
+    r = (unsigned long) b << 16;
+    m = b >= 16 ? h >> (b - 16) : (unsigned long long) h << (16 - b); // [1, 2)
+    for (k = 15; k >= 0; k--) {
+        m = m * m >> 16;
+        if (m >= 2UL << 16) {
+            m >>= 1;
+            r |= 1UL << k;
+        }
+    }
+    r = (32UL << 16) - r;
+    return r ? r : 1;
+}
+
+// CCNL_STRATEGY_WEIGHTED: among the FIB entries with the longest match
+// (len components) for i, the one with the highest weighted rendezvous
+// score w / -ln(u) for the hash u of the name and its face. The same
+// object is asked for at the same upstream cache, and a changed weight or
+// next hop only moves the names which it wins or loses
+struct ccnl_forward_s*
+ccnl_fwd_pick(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i, int len,
+              struct ccnl_face_s *avoid, struct ccnl_face_s *avoid2)
+{
+    struct ccnl_forward_s *fwd, *best = NULL;
+    unsigned long long w, bestw = 0;
+    unsigned long l, bestl = 1;
+    unsigned int name = ccnl_fwd_namehash(i->prefix), h;
+
+    for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
+        if (!ccnl_fwd_pickable(fwd, i, len, avoid, avoid2))
             continue;
+        h = name ^ (fwd->face->faceid * 2654435761u);
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        l = ccnl_fwd_neglog2(h ? h : 1);
+        w = ccnl_fwd_weight(fwd);
+        if (!best || w * bestl > bestw * l) { // w/l > bestw/bestl
+            best = fwd;
+            bestw = w;
+            bestl = l;
         }
+    }
+    return best;
+}
 
-        rc = ccnl_prefix_cmp(fwd->prefix, NULL, i->prefix, CMP_LONGEST);
+// forwards i according to the strategy of its longest FIB match, but not
+// to the face avoid (which failed) unless strict is 0 and there is no
+// other choice; returns the number of faces which took the interest
+int
+ccnl_fwd_strategy(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i,
+                  struct ccnl_face_s *avoid, int strict)
+{
+    struct ccnl_forward_s *fwd, *best = NULL, *second = NULL, *probe = NULL;
+    struct ccnl_forward_s *fallback = NULL;
+    int cnt = 0, len = -1, strategy = CCNL_STRATEGY_BEST;
 
-        DEBUGMSG(DEBUG, "  ccnl_interest_propagate, rc=%d/%d\n",
-                 rc, fwd->prefix->compcnt);
-        if (rc < fwd->prefix->compcnt)
+    ccnl_get_timeval(&i->upsent);
+    i->upface = NULL;
+    i->rto = 0;
+    for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
+        if (!ccnl_fwd_matches(fwd, i))
             continue;
-        DEBUGMSG(DEBUG, "  ccnl_interest_propagate, fwd==%p\n", (void*)fwd);
+        if (fwd->prefix->compcnt > len) {
+            len = fwd->prefix->compcnt;
+            strategy = fwd->strategy;
+        }
         // suppress forwarding to origin of interest, except wireless
-        if (!i->from || fwd->face != i->from ||
-                                (i->from->flags & CCNL_FACE_FLAGS_REFLECT)) {
-            ccnl_nfn_monitor(ccnl, fwd->face, i->prefix, NULL, 0);
-            ccnl_face_enqueue(ccnl, fwd->face, buf_dup(i->pkt));
-#ifdef USE_NACK
-            matching_face = 1;
-#endif
+        if (i->from && fwd->face == i->from &&
+                                !(i->from->flags & CCNL_FACE_FLAGS_REFLECT))
+            continue;
+        if (fwd->face == avoid) {
+            fallback = fwd;
+            continue;
+        }
+        if (!best || ccnl_fwd_cost(fwd) < ccnl_fwd_cost(best)) {
+            second = best;
+            best = fwd;
+        } else if (!second || ccnl_fwd_cost(fwd) < ccnl_fwd_cost(second))
+            second = fwd;
+        // the least known alternative is probed
+        if (!probe || fwd->sent < probe->sent)
+            probe = fwd;
+    }
+
+    if (strategy == CCNL_STRATEGY_MULTICAST) {
+        for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
+            if (!ccnl_fwd_matches(fwd, i) || fwd->face == avoid ||
+                    (i->from && fwd->face == i->from &&
+                     !(i->from->flags & CCNL_FACE_FLAGS_REFLECT)))
+                continue;
+            if (ccnl_fwd_send(ccnl, fwd, i)) {
+                cnt++;
+                // the first answer counts
+                if (!i->rto || ccnl_fwd_rto(fwd) < i->rto)
+                    i->rto = ccnl_fwd_rto(fwd);
+            }
+        }
+        if (!cnt && fallback && !strict && ccnl_fwd_send(ccnl, fallback, i)) {
+            cnt++;
+            i->rto = ccnl_fwd_rto(fallback);
+        }
+        return cnt;
+    }
+
+    if (strategy == CCNL_STRATEGY_WEIGHTED) {
+        best = ccnl_fwd_pick(ccnl, i, len, avoid, NULL);
+        if (!best && !strict)
+            best = fallback;
+        if (best && !ccnl_fwd_send(ccnl, best, i)) { // refused, another one
+            best = ccnl_fwd_pick(ccnl, i, len, avoid, best->face);
+            if (best && !ccnl_fwd_send(ccnl, best, i))
+                best = NULL;
         }
+        if (!best)
+            return 0;
+        DEBUGMSG(DEBUG, "  strategy: weighted next hop is face %d (%d)\n",
+                 best->face->faceid, ccnl_fwd_weight(best));
+        i->upface = best->face;
+        i->rto = ccnl_fwd_rto(best);
+        return 1;
+    }
+
+    if (!best && !strict)
+        best = fallback;
+    if (!best)
+        return 0;
+    if (!ccnl_fwd_send(ccnl, best, i)) { // refused, next one
+        best = second;
+        if (!best || !ccnl_fwd_send(ccnl, best, i))
+            return 0;
+    }
+    DEBUGMSG(DEBUG, "  strategy: best next hop is face %d (cost %ld)\n",
+             best->face->faceid, ccnl_fwd_cost(best));
+    i->upface = best->face;
+    i->rto = ccnl_fwd_rto(best);
+    cnt = 1;
+    if (probe == best)
+        probe = second;
+    if (probe && probe != best && ++best->probecnt >= CCNL_STRATEGY_PROBE) {
+        best->probecnt = 0;
+        DEBUGMSG(DEBUG, "  strategy: probing face %d\n", probe->face->faceid);
+        cnt += ccnl_fwd_send(ccnl, probe, i);
+    }
+    return cnt;
+}
+
+// returns 0 if i was answered with a NACK (and is gone)
+int
+ccnl_interest_propagate(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
+{
+    int cnt;
+    DEBUGMSG(DEBUG, "ccnl_interest_propagate\n");
 
+#ifdef USE_NACK
+    if (ccnl_nack_find(ccnl, i->prefix)) {
+        DEBUGMSG(DEBUG, "  negative cache hit for <%s>\n",
+                 ccnl_prefix_to_path(i->prefix));
+        ccnl_interest_nack(ccnl, i);
+        return 0;
     }
+#endif
+
+    // CONFORM: "A node MUST implement some strategy rule, even if it is only to
+    // transmit an Interest Message on all listed dest faces in sequence."
+    // CCNL strategy: per prefix, either to the best next hop (probing an
+    // alternative now and then), or on all FWD entries with a prefix match
+
+    // a retransmission: the last choice did not answer in time, fail over
+    cnt = ccnl_fwd_strategy(ccnl, i, i->upface, 0);
 
 #ifdef USE_NACK
-    if(!matching_face){
-        ccnl_nack_reply(ccnl, i->prefix, i->from, i->suite);
-        ccnl_interest_remove(ccnl, i);
+    if (!cnt) { // with no face, a NACK goes back
+        ccnl_interest_nack(ccnl, i);
+        return 0;
+    }
+#else
+    (void) cnt;
+#endif
+    ccnl_interest_retx_start(ccnl, i);
+
+    return 1;
+}
+
+// CONFORM: "A node MUST retransmit Interest Messages periodically for
+// pending PIT entries." CCNL: after the RTO of the next hops the entry
+// went to, doubled with each retransmission and with some jitter, so that
+// the retransmissions of many entries do not come in bursts
+void
+ccnl_interest_retx(void *relay, void *ptr)
+{
+    struct ccnl_relay_s *ccnl = (struct ccnl_relay_s*) relay;
+    struct ccnl_interest_s *i = (struct ccnl_interest_s*) ptr;
+    long left = ccnl_interest_lifeleft(i);
+
+    i->retxTimer = NULL;
+    if (left >= 0 && left < 1000) {
+        DEBUGMSG(DEBUG, " lifetime of <%s> is over\n",
+                 ccnl_prefix_to_path(i->prefix));
+        ccnl_nfn_interest_remove(ccnl, i);
+        return;
+    }
+    if (i->retries >= CCNL_MAX_INTEREST_RETRANSMIT + 1) {
+        // no more retransmissions: a longer lifetime does not keep the
+        // entry, the consumer's next interest creates a new one
+        ccnl_nfn_interest_remove(ccnl, i);
+        return;
     }
+#ifdef USE_NFN
+    if (!(i->flags & CCNL_PIT_COREPROPAGATES))
+        return; // up to the NFN engine, the ageing counts its retries
 #endif
+    DEBUGMSG(DEBUG, " retransmit %d <%s> rto=%ld\n", i->retries,
+             ccnl_prefix_to_path(i->prefix), i->rto);
+    i->retries++;
+    ccnl_interest_propagate(ccnl, i);
+}
 
-    return;
+void
+ccnl_interest_retx_start(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
+{
+    static unsigned int seed = 1;
+    long rto = i->rto ? i->rto : CCNL_INTEREST_RETX_INIT;
+    long left = ccnl_interest_lifeleft(i);
+
+    if (i->retxTimer)
+        ccnl_rem_timer(i->retxTimer);
+    rto <<= i->retries;
+    seed = seed * 1103515245 + 12345;
+    rto += rto * ((seed >> 16) % 32) / 128; // up to a quarter more
+    if (left >= 0 && rto > left)
+        rto = left;
+    else if (rto > CCNL_INTEREST_TIMEOUT * 1000000L)
+        rto = CCNL_INTEREST_TIMEOUT * 1000000L;
+    i->retxTimer = ccnl_set_timer(rto, ccnl_interest_retx, ccnl, i);
+}
+
+// InterestLifetime of msec: exact for a new entry, for one with pending
+// faces it is only extended
+void
+ccnl_interest_lifetime(struct ccnl_interest_s *i, int msec)
+{
+    struct timeval t;
+
+    ccnl_get_timeval(&t);
+    t.tv_sec += msec / 1000;
+    t.tv_usec += (msec % 1000) * 1000;
+    if (t.tv_usec >= 1000000) {
+        t.tv_sec++;
+        t.tv_usec -= 1000000;
+    }
+    if (!i->pending || !i->expires.tv_sec || timevaldelta(&t, &i->expires) > 0)
+        i->expires = t;
+}
+
+// usec until the lifetime of i is over (0 if it is), -1 without lifetime
+long
+ccnl_interest_lifeleft(struct ccnl_interest_s *i)
+{
+    struct timeval now;
+    long left;
+
+    if (!i->expires.tv_sec)
+        return -1;
+    ccnl_get_timeval(&now);
+    left = timevaldelta(&i->expires, &now);
+    return left > 0 ? left : 0;
+}
+
+// whether the answer to i, forwarded by the core, is overdue: the RTO of
+// its next hops has passed, or its retransmissions are used up
+int
+ccnl_interest_overdue(struct ccnl_interest_s *i)
+{
+    struct timeval now;
+
+    if (!(i->flags & CCNL_PIT_COREPROPAGATES) || !i->upsent.tv_sec)
+        return 0;
+    if (i->retries > CCNL_MAX_INTEREST_RETRANSMIT)
+        return 1;
+    ccnl_get_timeval(&now);
+    return timevaldelta(&now, &i->upsent) >=
+                                (i->rto ? i->rto : CCNL_INTEREST_RETX_INIT);
 }
 
 struct ccnl_interest_s*
@@ -502,6 +1170,8 @@ ccnl_interest_remove(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
     struct ccnl_interest_s *i2;
 
     DEBUGMSG(TRACE, "ccnl_interest_remove %p\n", (void *) i);
+    if (i->retxTimer)
+        ccnl_rem_timer(i->retxTimer);
 /*
 #ifdef USE_NFN
     if (!(i->flags & CCNL_PIT_COREPROPAGATES))
@@ -575,8 +1245,11 @@ ccnl_content_new(struct ccnl_relay_s *ccnl, char suite, struct ccnl_buf_s **pkt,
     c->last_used = CCNL_NOW();
     c->content = content;
     c->contentlen = contlen;
+    c->hoppos = -1;
     c->pkt = *pkt;        *pkt = NULL;
     c->name = *prefix;    *prefix = NULL;
+    if (c->pkt)
+        c->pkt->tclass = ccnl_prefix_tclass(c->name);
     if (ppk) {
         switch (suite) {
 #ifdef USE_SUITE_CCNB
@@ -594,6 +1267,37 @@ ccnl_content_new(struct ccnl_relay_s *ccnl, char suite, struct ccnl_buf_s **pkt,
     return c;
 }
 
+// FreshnessPeriod of msec, content without one (msec <= 0) is stale at once
+void
+ccnl_content_freshness(struct ccnl_content_s *c, int msec)
+{
+    if (msec <= 0) {
+        c->flags |= CCNL_CONTENT_FLAGS_STALE;
+        return;
+    }
+    c->flags &= ~CCNL_CONTENT_FLAGS_STALE;
+    ccnl_get_timeval(&c->fresh);
+    c->fresh.tv_sec += msec / 1000;
+    c->fresh.tv_usec += (msec % 1000) * 1000;
+    if (c->fresh.tv_usec >= 1000000) {
+        c->fresh.tv_sec++;
+        c->fresh.tv_usec -= 1000000;
+    }
+}
+
+int
+ccnl_content_isStale(struct ccnl_content_s *c)
+{
+    struct timeval now;
+
+    if (!(c->flags & CCNL_CONTENT_FLAGS_STALE) && c->fresh.tv_sec) {
+        ccnl_get_timeval(&now);
+        if (timevaldelta(&c->fresh, &now) <= 0)
+            c->flags |= CCNL_CONTENT_FLAGS_STALE;
+    }
+    return (c->flags & CCNL_CONTENT_FLAGS_STALE) != 0;
+}
+
 struct ccnl_content_s*
 ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 {
@@ -607,17 +1311,40 @@ ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
     return c2;
 }
 
+// content c answered an interest: the list is kept in the order of use
+void
+ccnl_content_used(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    c->last_used = CCNL_NOW();
+    if (ccnl->contents == c)
+        return;
+    DBL_LINKED_LIST_REMOVE(ccnl->contents, c);
+    c->prev = NULL;
+    DBL_LINKED_LIST_ADD(ccnl->contents, c);
+}
+
+// the least recently used content which is not static
+struct ccnl_content_s*
+ccnl_content_victim(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_content_s *c, *oldest = NULL;
+
+    for (c = ccnl->contents; c; c = c->next) // on a tie, the later one
+        if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC) &&
+                                (!oldest || c->last_used <= oldest->last_used))
+            oldest = c;
+    return oldest;
+}
+
 struct ccnl_content_s*
 ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 {
-    struct ccnl_content_s *cit;
     DEBUGMSG(DEBUG, "ccnl_content_add2cache (%d/%d) --> %p\n",
              ccnl->contentcnt, ccnl->max_cache_entries, (void*)c);
-    for (cit = ccnl->contents; cit; cit = cit->next) {
-        if (c == cit) {
-            DEBUGMSG(DEBUG, "--- Already in cache ---\n");
-            return NULL;
-        }
+    // in the list, all but its head have a predecessor
+    if (c == ccnl->contents || c->prev) {
+        DEBUGMSG(DEBUG, "--- Already in cache ---\n");
+        return NULL;
     }
 #ifdef USE_NACK
     if (ccnl_nfnprefix_contentIsNACK(c))
@@ -625,20 +1352,62 @@ ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 #endif
     if (ccnl->max_cache_entries > 0 &&
         ccnl->contentcnt >= ccnl->max_cache_entries) { // remove oldest content
-        struct ccnl_content_s *c2;
-        int age = 0;
-        for (c2 = ccnl->contents; c2; c2 = c2->next)
-            if (!(c2->flags & CCNL_CONTENT_FLAGS_STATIC) &&
-                                        ((age == 0) || c2->last_used < age))
-                age = c2->last_used;
-        if (c2)
+        struct ccnl_content_s *c2 = ccnl_content_victim(ccnl);
+        if (c2) {
+            ccnl_disk_demote(ccnl, c2);
             ccnl_content_remove(ccnl, c2);
+        }
     }
     DBL_LINKED_LIST_ADD(ccnl->contents, c);
     ccnl->contentcnt++;
     return c;
 }
 
+// does content c satisfy the PIT entry i
+int
+ccnl_i_matches_c(struct ccnl_interest_s *i, struct ccnl_content_s *c)
+{
+    switch (i->suite) {
+#ifdef USE_SUITE_CCNB
+    case CCNL_SUITE_CCNB:
+        if (!ccnl_i_prefixof_c(i->prefix, i->details.ccnb.minsuffix,
+                   i->details.ccnb.maxsuffix, c)) {
+            // XX must also check i->ppkd
+            return 0;
+        }
+        break;
+#endif
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        if (ccnl_prefix_cmp(c->name, NULL, i->prefix, CMP_EXACT)) {
+            // XX must also check keyid
+            return 0;
+        }
+        break;
+#endif
+#ifdef USE_SUITE_IOTTLV
+    case CCNL_SUITE_IOTTLV:
+        if (ccnl_prefix_cmp(c->name, NULL, i->prefix, CMP_EXACT)) {
+            // XX must also check keyid
+            return 0;
+        }
+        break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        if (!ccnl_i_prefixof_c(i->prefix, i->details.ndntlv.minsuffix,
+                   i->details.ndntlv.maxsuffix, c)) {
+            // XX must also check i->ppkl,
+            return 0;
+        }
+        break;
+#endif
+    default:
+        return 0;
+    }
+    return 1;
+}
+
 // deliver new content c to all clients with (loosely) matching interest,
 // but only one copy per face
 // returns: number of forwards
@@ -656,50 +1425,17 @@ ccnl_content_serve_pending(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
     for (i = ccnl->pit; i;) {
         struct ccnl_pendint_s *pi;
 
-        switch (i->suite) {
-#ifdef USE_SUITE_CCNB
-        case CCNL_SUITE_CCNB:
-            if (!ccnl_i_prefixof_c(i->prefix, i->details.ccnb.minsuffix,
-                       i->details.ccnb.maxsuffix, c)) {
-                // XX must also check i->ppkd
-                i = i->next;
-                continue;
-            }
-            break;
-#endif
-#ifdef USE_SUITE_CCNTLV
-        case CCNL_SUITE_CCNTLV:
-            if (ccnl_prefix_cmp(c->name, NULL, i->prefix, CMP_EXACT)) {
-                // XX must also check keyid
-                i = i->next;
-                continue;
-            }
-            break;
-#endif
-#ifdef USE_SUITE_IOTTLV
-        case CCNL_SUITE_IOTTLV:
-            if (ccnl_prefix_cmp(c->name, NULL, i->prefix, CMP_EXACT)) {
-                // XX must also check keyid
-                i = i->next;
-                continue;
-            }
-            break;
-#endif
-#ifdef USE_SUITE_NDNTLV
-        case CCNL_SUITE_NDNTLV:
-            if (!ccnl_i_prefixof_c(i->prefix, i->details.ndntlv.minsuffix,
-                       i->details.ndntlv.maxsuffix, c)) {
-                // XX must also check i->ppkl,
-                i = i->next;
-                continue;
-            }
-            break;
-#endif
-        default:
+        if (!ccnl_i_matches_c(i, c)) {
             i = i->next;
             continue;
         }
 
+        if (i->flags & CCNL_PIT_PREFETCH) { // for the content store only
+            c->flags |= CCNL_CONTENT_FLAGS_PREFETCHED;
+            i = ccnl_interest_remove(ccnl, i);
+            cnt++;
+            continue;
+        }
         //Hook for add content to cache by callback:
         if(i && ! i->pending){
             c->flags |= CCNL_CONTENT_FLAGS_STATIC;
@@ -721,7 +1457,8 @@ ccnl_content_serve_pending(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
                          pi->face->faceid, (void*) c->pkt);
                 ccnl_nfn_monitor(ccnl, pi->face, c->name,
                                  c->content, c->contentlen);
-                ccnl_face_enqueue(ccnl, pi->face, buf_dup(c->pkt));
+                ccnl_face_send_shared(ccnl, pi->face, c->pkt, c->hoppos,
+                                      c->hopval);
             } else {// upcall to deliver content to local client
                 ccnl_app_RX(ccnl, c);
             }
@@ -733,6 +1470,74 @@ ccnl_content_serve_pending(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
     return cnt;
 }
 
+// content c from face f answers PIT entries: update the RTT and success
+// ratio of the next hop, before serve_pending() removes the entries
+void
+ccnl_fwd_RX(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f,
+            struct ccnl_content_s *c)
+{
+    struct ccnl_interest_s *i;
+    struct ccnl_forward_s *fwd;
+    struct timeval now;
+    long rtt, delta;
+
+    ccnl_get_timeval(&now);
+    for (i = ccnl->pit; i; i = i->next) {
+        if (!i->upsent.tv_sec || !ccnl_i_matches_c(i, c))
+            continue;
+        fwd = ccnl_fwd_lookup(ccnl, f, i);
+        if (!fwd)
+            continue;
+        if (fwd->ok < fwd->sent)
+            fwd->ok++;
+        if (i->retries) // ambiguous after a retransmission, no sample
+            continue;
+        rtt = timevaldelta(&now, &i->upsent);
+        if (rtt <= 0)
+            rtt = 1;
+        if (!fwd->srtt) {
+            fwd->srtt = rtt;
+            fwd->rttvar = rtt / 2;
+        } else {
+            delta = rtt - fwd->srtt;
+            fwd->srtt += delta / 8;
+            if (fwd->srtt <= 0)
+                fwd->srtt = 1;
+            fwd->rttvar += ((delta < 0 ? -delta : delta) - fwd->rttvar) / 4;
+        }
+        DEBUGMSG(DEBUG, "  strategy: face %d rtt=%ld srtt=%ld rttvar=%ld\n",
+                 f->faceid, rtt, fwd->srtt, fwd->rttvar);
+    }
+}
+
+#ifdef USE_NACK
+// NACK c from face f: PIT entries which went to f try another next hop,
+// until all of them NACKed; returns 1 if any did (the NACK goes no further)
+int
+ccnl_fwd_NACK(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f,
+              struct ccnl_content_s *c)
+{
+    struct ccnl_interest_s *i;
+    struct ccnl_forward_s *fwd;
+    int cnt = 0, hops;
+
+    for (i = ccnl->pit; i; i = i->next) {
+        if (!f || i->upface != f || !ccnl_i_matches_c(i, c))
+            continue;
+        DEBUGMSG(DEBUG, "  strategy: NACK from face %d for <%s>\n",
+                 f->faceid, ccnl_prefix_to_path(i->prefix));
+        for (fwd = ccnl->fib, hops = 0; fwd; fwd = fwd->next)
+            if (ccnl_fwd_matches(fwd, i) && fwd->face != i->from)
+                hops++;
+        if (++i->nacked < hops && ccnl_fwd_strategy(ccnl, i, f, 1)) {
+            ccnl_interest_retx_start(ccnl, i);
+            cnt++;
+        }
+    }
+    return cnt > 0;
+}
+#endif
+
 void
 ccnl_do_ageing(void *ptr, void *dummy)
 {
@@ -743,29 +1548,33 @@ ccnl_do_ageing(void *ptr, void *dummy)
     time_t t = CCNL_NOW();
     DEBUGMSG(TRACE, "ageing t=%d\n", (int)t);
 
-    while (c) {
+#ifdef USE_NACK
+    ccnl_nack_find(relay, NULL); // drops the expired negative cache entries
+#endif
+
+    while (c) { // content stays while it is fresh
         if ((c->last_used + CCNL_CONTENT_TIMEOUT) <= t &&
-                                !(c->flags & CCNL_CONTENT_FLAGS_STATIC))
+                                !(c->flags & CCNL_CONTENT_FLAGS_STATIC) &&
+                                (!c->fresh.tv_sec || ccnl_content_isStale(c))) {
+            ccnl_disk_demote(relay, c);
             c = ccnl_content_remove(relay, c);
-        else
+        } else
             c = c->next;
     }
     while (i) { // CONFORM: "Entries in the PIT MUST timeout rather
                 // than being held indefinitely."
-        if ((i->last_used + CCNL_INTEREST_TIMEOUT) <= t ||
+        // with an InterestLifetime this is its end, otherwise the default;
+        // and in any case when the retransmissions are used up
+        if ((i->expires.tv_sec ? !ccnl_interest_lifeleft(i) :
+                (i->last_used + CCNL_INTEREST_TIMEOUT) <= t) ||
                                 i->retries > CCNL_MAX_INTEREST_RETRANSMIT) {
             i = ccnl_nfn_interest_remove(relay, i);
         } else {
-            // CONFORM: "A node MUST retransmit Interest Messages
-            // periodically for pending PIT entries."
-            DEBUGMSG(DEBUG, " retransmit %d <%s>\n", i->retries,
-                     ccnl_prefix_to_path(i->prefix));
+            // retransmissions: see ccnl_interest_retx()
 #ifdef USE_NFN
-            if (i->flags & CCNL_PIT_COREPROPAGATES)
+            if (!(i->flags & CCNL_PIT_COREPROPAGATES))
+                i->retries++;
 #endif
-                ccnl_interest_propagate(relay, i);
-
-            i->retries++;
             i = i->next;
         }
     }
@@ -780,19 +1589,20 @@ ccnl_do_ageing(void *ptr, void *dummy)
 }
 
 int
-ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *nonce)
+ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl,
+                          unsigned char *nonce, int len)
 {
     struct ccnl_buf_s *n, *n2 = 0;
     int i;
     DEBUGMSG(TRACE, "ccnl_nonce_find_or_append\n");
 
     for (n = ccnl->nonces, i = 0; n; n = n->next, i++) {
-        if (buf_equal(n, nonce))
+        if (n->datalen == len && !memcmp(n->data, nonce, len))
             return -1;
         if (n->next)
             n2 = n;
     }
-    n = ccnl_buf_new(nonce->data, nonce->datalen);
+    n = ccnl_buf_new(nonce, len);
     if (n) {
         n->next = ccnl->nonces;
         ccnl->nonces = n;
@@ -908,6 +1718,7 @@ ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
         ccnl_interest_remove(ccnl, ccnl->pit);
     while (ccnl->faces)
         ccnl_face_remove(ccnl, ccnl->faces); // also removes all FWD entries
+    ccnl_disk_close(ccnl); // after demoting what is only in RAM
     while (ccnl->contents)
         ccnl_content_remove(ccnl, ccnl->contents);
     while (ccnl->nonces) {
@@ -915,6 +1726,14 @@ ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
         ccnl_free(ccnl->nonces);
         ccnl->nonces = tmp;
     }
+    while (ccnl->nacks) {
+        struct ccnl_nack_s *tmp = ccnl->nacks->next;
+        free_prefix(ccnl->nacks->prefix);
+        ccnl_free(ccnl->nacks);
+        ccnl->nacks = tmp;
+    }
+    ccnl_cs_cleanup(ccnl);
+    ccnl_prefetch_cleanup(ccnl);
     for (k = 0; k < ccnl->ifcount; k++)
         ccnl_interface_cleanup(ccnl->ifs + k);
 
@@ -19,6 +19,18 @@
  * File history:
  * 2011-04-09 created
  * 2013-03-19 updated (ms): modified struct ccnl_relay_s for 'aux' field
+ * 2026-10-19 traffic class of buffers, per-class interface queue counters
+ * 2026-10-19 forwarding strategy state in FIB and PIT entries
+ * 2026-10-19 retransmission timer of PIT entries
+ * 2026-10-19 per entry InterestLifetime and FreshnessPeriod
+ * 2026-10-19 negative cache
+ * 2026-10-19 cache admission policies
+ * 2026-10-19 sequential chunk prefetching
+ * 2026-10-19 weighted multipath strategy
+ * 2026-10-19 background loading of the content store
+ * 2026-10-19 content store tier on disk
+ * 2026-10-19 packed repository files
+ * 2026-10-19 content store snapshot file
  */
 
 #ifndef CCNL_CORE
@@ -35,13 +47,21 @@
 #define CCNL_FACE_FLAGS_REFLECT 2
 #define CCNL_FACE_FLAGS_SERVED  4
 #define CCNL_FACE_FLAGS_FWDALLI 8 // forward all interests, also known ones
+#define CCNL_FACE_FLAGS_COALESCE 16 // pack queued packets into one datagram
+#define CCNL_FACE_FLAGS_CTRL    32 // all its packets are control traffic
 
 #define CCNL_FRAG_NONE          0
 #define CCNL_FRAG_SEQUENCED2012 1
 #define CCNL_FRAG_CCNx2013      2
 
+#define CCNL_FRAG_FLAGS_ARQ     0x01 // retransmit lost fragments (ack'd)
+#define CCNL_FRAG_FLAGS_FEC     0x02 // send repair fragments (fecn/feck)
+#define CCNL_FRAG_FLAGS_PMTU    0x04 // mtu from path MTU discovery
+
 #define CCNL_CONTENT_FLAGS_STATIC  0x01
 #define CCNL_CONTENT_FLAGS_STALE   0x02
+#define CCNL_CONTENT_FLAGS_PREFETCHED 0x04 // not yet asked for
+#define CCNL_CONTENT_FLAGS_ONDISK  0x08 // in the disk tier, see -D
 
 // ----------------------------------------------------------------------
 
@@ -82,6 +102,8 @@ struct ccnl_if_s { // interface for packet IO
     int qfront; // index of next packet to send
     struct ccnl_txrequest_s queue[CCNL_MAX_IF_QLEN];
     struct ccnl_sched_s *sched;
+    unsigned int qbytes, qpkts; // enqueued so far (fair queueing)
+    int qcnt[CCNL_TCLASS_CNT]; // pending sends per traffic class
 };
 
 struct ccnl_relay_s {
@@ -92,11 +114,29 @@ struct ccnl_relay_s {
     struct ccnl_interest_s *pit;
     struct ccnl_content_s *contents; //, *contentsend;
     struct ccnl_buf_s *nonces;
+    struct ccnl_nack_s *nacks;  // negative cache, names NACKed upstream
+    int nackcnt;
     int contentcnt;             // number of cached items
     int max_cache_entries;      // -1: unlimited
+    struct ccnl_cachepolicy_s *cachepolicies; // admission, per prefix
+    unsigned char *cs_sketch;   // TinyLFU request counts, see ccnl-ext-cache.c
+    int cs_sketchcnt;           // counted since they were last halved
+    long cs_lookups, cs_hits;   // interests looked up in the content store
+    long cs_admitted, cs_rejected;
+    struct ccnl_prefetch_s *prefetchers; // sequential chunks, per prefix
+    struct ccnl_prefetch_stream_s *prefetchstreams;
+    long pf_issued, pf_hits;    // chunks prefetched, and then asked for
+    struct ccnl_preload_s *preload; // files still being loaded, see -d
+    struct ccnl_disk_s *disk;   // content store tier on disk, see -D
+    char *snapshot;             // file of the content store, see -S
+    int coalesce_linger;        // usec a coalescing face waits for more pkts
     struct ccnl_if_s ifs[CCNL_MAX_INTERFACES];
     int ifcount;                // number of active interfaces
+#ifdef CCNL_LINUXKERNEL
     char halt_flag;
+#else
+    volatile sig_atomic_t halt_flag; // also set by a signal handler
+#endif
     struct ccnl_sched_s* (*defaultFaceScheduler)(struct ccnl_relay_s*,
                                                  void(*cts_done)(void*,void*));
     struct ccnl_sched_s* (*defaultInterfaceScheduler)(struct ccnl_relay_s*,
@@ -114,6 +154,7 @@ struct ccnl_relay_s {
 struct ccnl_buf_s {
     struct ccnl_buf_s *next;
     unsigned int datalen;
+    unsigned char tclass; // traffic class, CCNL_TCLASS_*
     unsigned char data[1];
 };
 
@@ -144,7 +185,56 @@ struct ccnl_frag_s {
     // transport state, if present:
     int ifndx;
 
-    struct ccnl_buf_s *defrag;
+    // reassembly: the packet being collected from in-order fragments,
+    // and a window for those which are ahead of a gap. Sequence number
+    // rxbase+i uses slot (rxbase+i) % CCNL_FRAG_RXWINDOW, a bit set in
+    // rxmap with an empty slot is a fragment of an already delivered packet
+    struct ccnl_buf_s *defrag;  // buffer size is the capacity
+    int defraglen;
+    unsigned int rxbase;
+    unsigned int rxmap[CCNL_FRAG_RXWINDOW / 32];
+    struct ccnl_buf_s *rxslot[CCNL_FRAG_RXWINDOW];
+    unsigned char rxflags[CCNL_FRAG_RXWINDOW];
+    int rxbytes;                // held in defrag and the window
+    void *rxtimer;
+    unsigned int rxtimerbase;   // rxbase when the timer was set
+    int rxunacked;              // fragments received since our last ack
+
+    // selective repeat ARQ (CCNL_FRAG_FLAGS_ARQ): the sent fragments from
+    // txbase on are kept until the peer acknowledges them
+    int flags;
+    unsigned int txbase;
+    struct ccnl_buf_s *txslot[CCNL_FRAG_TXWINDOW];
+    struct timeval txtime[CCNL_FRAG_TXWINDOW]; // last (re)transmission
+    unsigned int txstamp[CCNL_FRAG_TXWINDOW];  // order of the last send
+    unsigned char txcnt[CCNL_FRAG_TXWINDOW];   // times sent
+    unsigned int txclock;
+    int srtt, rttvar, rto;      // usec, srtt is 0 before the first sample
+    void *txtimer;
+    unsigned int retransmits;
+
+    // forward error correction (CCNL_FRAG_FLAGS_FEC): feck repair
+    // fragments for each block of up to fecn data fragments. The sender
+    // sums the block up in fecrep, the receiver keeps the data in fecsym
+    // (slot as in rxslot) and the repairs of the latest block in fecrxrep
+    int fecn, feck;
+    unsigned int fecbase;       // seq no of the block's first fragment
+    int feccnt, feclen;         // fragments in the block, longest symbol
+    struct ccnl_buf_s *fecrep[CCNL_FRAG_FECMAXK];
+    struct ccnl_buf_s *fecout;  // repair fragments ready to be sent
+    struct ccnl_buf_s *fecsym[CCNL_FRAG_RXWINDOW];
+    unsigned int fecsymseq[CCNL_FRAG_RXWINDOW];
+    unsigned int fecrxbase;
+    int fecrxcnt, fecrxdone;
+    struct ccnl_buf_s *fecrxrep[CCNL_FRAG_FECMAXK];
+    unsigned int fecsent, fecrecovered;
+
+    // path MTU discovery (CCNL_FRAG_FLAGS_PMTU): mtu is the largest probe
+    // the peer acked, the search runs between pmtulo (acked) and pmtuhi
+    // (too big, or above the bound which the kernel knows)
+    int pmtulo, pmtuhi, pmtumax;
+    int pmtuprobe, pmtutries;   // size in flight (0: idle), times sent
+    void *pmtutimer;
 
     unsigned int sendseq;
     unsigned int losscount;
@@ -165,6 +255,8 @@ struct ccnl_face_s {
     struct ccnl_buf_s *outq, *outqend; // queue of packets to send
     struct ccnl_frag_s *frag;  // which special datagram armoring
     struct ccnl_sched_s *sched;
+    void *linger;              // coalescing: timer for the next datagram
+    int txdgrams, txpkts;      // coalescing: datagrams and packets sent
 };
 
 struct ccnl_forward_s {
@@ -172,6 +264,63 @@ struct ccnl_forward_s {
     struct ccnl_prefix_s *prefix;
     struct ccnl_face_s *face;
     char suite;
+    char strategy;          // CCNL_STRATEGY_*, the longest match decides
+    long srtt, rttvar;      // smoothed RTT and its variation (usec), 0: none
+    int sent, ok;           // interests forwarded and answered
+    int probecnt;           // interests since an alternative was probed
+    int weight;             // CCNL_STRATEGY_WEIGHTED share, 0: measured
+};
+
+struct ccnl_cachepolicy_s { // cache admission of a prefix
+    struct ccnl_cachepolicy_s *next;
+    struct ccnl_prefix_s *prefix;
+    char policy;            // CCNL_CACHEPOLICY_*, the longest match decides
+    int prob;               // percent, for CCNL_CACHEPOLICY_PROB
+};
+
+struct ccnl_prefetch_s { // sequential chunk prefetching of a prefix
+    struct ccnl_prefetch_s *next;
+    struct ccnl_prefix_s *prefix;
+    int window;             // most chunks ahead of a consumer, 0: none
+};
+
+struct ccnl_prefetch_stream_s { // chunks of one name, as they are asked for
+    struct ccnl_prefetch_stream_s *next;
+    struct ccnl_prefix_s *name; // without the chunk component
+    struct ccnl_pkt_tmpl_s *tmpl;
+    unsigned int expected;  // chunk after the last one asked for
+    unsigned int ahead;     // last chunk prefetched
+    int window;             // chunks ahead, adapted to the hits
+    int issued, hits;
+    int last_used;
+};
+
+// A packed repository file holds many packets: this header, the packets
+// one after the other, then the index (an entry per packet). The integers
+// are in network byte order, offsets are from the start of the file.
+struct ccnl_repo_hdr_s {
+    char magic[8];          // CCNL_REPO_MAGIC
+    unsigned int version;   // CCNL_REPO_VERSION
+    unsigned int cnt;       // of index entries
+    unsigned int idxhi, idxlo; // offset of the index
+};
+
+struct ccnl_repo_ent_s {
+    unsigned int hash;      // of the packet's name, see ccnl_prefix_hash()
+    unsigned int len;       // of the packet
+    unsigned int offhi, offlo;
+};
+
+struct ccnl_disk_s { // content store tier on disk (ccnl-ext-diskcache.c)
+    char *dir;
+    long maxbytes, bytes;   // of all segments
+    long segsize;           // at which a segment is full
+    int fd;                 // of the segment appended to
+    struct ccnl_disk_seg_s *segs; // oldest first
+    struct ccnl_disk_ent_s *ents; // the index, oldest first
+    int entcnt, entmax;
+    int *buckets, nbuckets; // of the index, chains of ents
+    long hits, misses, demoted, promoted, collected;
 };
 
 struct ccnl_ccnb_id_s { // interest details
@@ -190,6 +339,7 @@ struct ccnl_ndntlv_id_s { // interest details
 
 #define CCNL_PIT_COREPROPAGATES    0x01
 #define CCNL_PIT_TRACED            0x02
+#define CCNL_PIT_PREFETCH          0x04 // ours, no consumer asked yet
 
 struct ccnl_interest_s {
     struct ccnl_buf_s *pkt; // full datagram
@@ -200,6 +350,14 @@ struct ccnl_interest_s {
     int flags;
     int last_used;
     int retries;
+    int hoppos;             // offset of the hop limit/scope byte in pkt, or -1
+    unsigned char hopval;   // value of that byte when forwarding
+    struct ccnl_face_s *upface; // next hop chosen by the strategy, or NULL
+    struct timeval upsent;  // when it was last forwarded
+    long rto;               // retransmission timeout of its next hops (usec)
+    void *retxTimer;
+    struct timeval expires; // end of its InterestLifetime, 0 if none
+    int nacked;             // number of next hops which NACKed it
     union {
         struct ccnl_ccnb_id_s ccnb;
         struct ccnl_ccntlv_id_s ccntlv;
@@ -208,6 +366,12 @@ struct ccnl_interest_s {
     char suite;
 };
 
+struct ccnl_nack_s { // negative cache entry
+    struct ccnl_nack_s *next;
+    struct ccnl_prefix_s *prefix;
+    struct timeval expires;
+};
+
 struct ccnl_pendint_s { // pending interest
     struct ccnl_pendint_s *next; // , *prev;
     struct ccnl_face_s *face;
@@ -234,10 +398,14 @@ struct ccnl_content_s {
     int flags;
     unsigned char *content; // pointer into the data buffer
     int contentlen;
-    // NON-CONFORM: "The [ContentSTore] MUST also implement the Staleness Bit."
-    // >> CCNL: currently no stale bit, old content is fully removed <<
+    // CONFORM: "The [ContentSTore] MUST also implement the Staleness Bit."
+    // CCNL: CCNL_CONTENT_FLAGS_STALE, set once fresh has passed
+    struct timeval fresh;   // end of its FreshnessPeriod, 0 if none
     int last_used;
     int served_cnt;
+    int hoppos;             // offset of the hop count byte in pkt, or -1
+    unsigned char hopval;   // value of that byte when forwarding
+    unsigned char hops;     // from the copy it came from, 0 if unknown
     union {
         struct ccnl_ccnb_cd_s ccnb;
         struct ccnl_ccntlv_cd_s ccntlv;
@@ -246,6 +414,22 @@ struct ccnl_content_s {
     char suite;
 };
 
+// pre-encoded packet, see ccnl_pkt_tmpl_new(): the name is encoded once,
+// per packet only chunk number, nonce and payload change
+struct ccnl_pkt_tmpl_s {
+    char suite;
+    char kind;                  // last packet built: 0, 'i'nterest, 'c'ontent
+    char final;                 // last packet carried the final chunk number
+    unsigned char *name;        // encoded name components, without chunk
+    int namelen;
+    unsigned char *buf;         // packets are built backwards from buf+size
+    int size;
+    int offs, len;              // last packet: buf+offs, len bytes
+    int chunkpos, chunklen;     // chunk TLV in the last packet (or -1)
+    int noncepos;               // nonce value in the last packet (or -1)
+    int paypos, paylen;         // payload in the last packet (or -1)
+};
+
 struct ccnl_lambdaTerm_s {
     char *v;
     struct ccnl_lambdaTerm_s *m, *n;
@@ -39,15 +39,67 @@
 #define CCNL_CONTENT_TIMEOUT            30 // sec
 #define CCNL_INTEREST_TIMEOUT           4  // sec
 #define CCNL_MAX_INTEREST_RETRANSMIT    2
+#define CCNL_INTEREST_RETX_INIT   1000000 // usec, timeout without RTT samples
+#define CCNL_INTEREST_RETX_MIN    20000   // usec, lower bound of the timeout
 
 // #define CCNL_FACE_TIMEOUT    60 // sec
 #define CCNL_FACE_TIMEOUT       15 // sec
+#define CCNL_FACE_COALESCE_LINGER 200 // usec, default for coalescing faces
 
 #define CCNL_MAX_NAME_COMP      64
 #define CCNL_MAX_IF_QLEN        64
+#define CCNL_SCHED_FQ_IFQLEN    4  // fair queueing: packets handed to the interface
+#define CCNL_SCHED_SHAPE_QLEN   32   // interest shaping: default queue limit
+#define CCNL_SCHED_SHAPE_SIZE   1500 // and content size expected at first
+
+// traffic classes, higher ones are sent first; each may hold at most
+// its CCNL_TCLASS_QLIMITS slots of an interface queue
+#define CCNL_TCLASS_DATA        0
+#define CCNL_TCLASS_CRYPTO      1
+#define CCNL_TCLASS_CTRL        2  // management, NFN computations
+#define CCNL_TCLASS_CNT         3
+#define CCNL_TCLASS_QLIMITS     {48, 8, 8}
+
+// forwarding strategies, chosen per prefix
+#define CCNL_STRATEGY_BEST      0  // best next hop by RTT and success ratio
+#define CCNL_STRATEGY_MULTICAST 1  // all next hops
+#define CCNL_STRATEGY_WEIGHTED  2  // one next hop per name, shares by weight
+#define CCNL_STRATEGY_PROBE     16 // every Nth interest also tries an alternative
+#define CCNL_STRATEGY_RTT0      100000 // usec, assumed for unmeasured next hops
+#define CCNL_STRATEGY_WINDOW    64 // success ratio: counters are halved then
+#define CCNL_STRATEGY_WEIGHT0   10 // measured weight of a next hop at RTT0
+#define CCNL_STRATEGY_MAX_WEIGHT 10000
 
 #define CCNL_DEFAULT_MAX_CACHE_ENTRIES  0   // means: no content caching
+
+// cache admission policies, chosen per prefix
+#define CCNL_CACHEPOLICY_LCE       0 // leave a copy everywhere (the default)
+#define CCNL_CACHEPOLICY_LCD       1 // leave a copy one hop below the copy
+#define CCNL_CACHEPOLICY_PROB      2 // with a fixed probability
+#define CCNL_CACHEPOLICY_PROBCACHE 3 // the further from the copy, the likelier
+#define CCNL_CACHEPOLICY_TINYLFU   4 // asked for more often than the victim
+#define CCNL_CS_SKETCH_WIDTH       1024  // TinyLFU: counters per row (of 4)
+#define CCNL_CS_SKETCH_SAMPLE      10240 // counts until all are halved
+
+// sequential chunk prefetching (ccnl-ext-prefetch.c)
+#define CCNL_PREFETCH_MAX_WINDOW   64 // chunks ahead of a consumer, at most
+#define CCNL_PREFETCH_MAX_STREAMS  16 // names followed at a time
+
+#define CCNL_PRELOAD_THREADS        4 // reading files into the cache at startup
+#define CCNL_PRELOAD_QUEUE       1024 // files mapped and not yet decoded
+#define CCNL_PRELOAD_BATCH         64 // decoded between two select()s
+
+// packed repository files (ccn-lite-produce -r, ccn-lite-relay -d FILE)
+#define CCNL_REPO_MAGIC     "ccnlrepo" // 8 bytes, no '\0'
+#define CCNL_REPO_VERSION          1
+
+// content store tier on disk (ccnl-ext-diskcache.c)
+#define CCNL_DISK_SEGMENT    (64*1024*1024) // bytes of a segment file, at most
+#define CCNL_DISK_MAX_MBYTES      1024 // of all segments, default of -B
+
 #define CCNL_MAX_NONCES                 256 // for detected dups
+#define CCNL_NACK_CACHE_TIME            500 // msec a received NACK is answered locally
+#define CCNL_MAX_NACK_ENTRIES           64  // in the negative cache
 
 
 enum {
@@ -86,6 +138,10 @@ enum {
 #define CCNL_DTAG_DEVNAME       99007 // name of interface (eth0, wlan0)
 #define CCNL_DTAG_DEVFLAGS      99008 //
 #define CCNL_DTAG_MTU           99009 //
+#define CCNL_DTAG_SCHED         99010 // setsched: scheduler options
+#define CCNL_DTAG_STRATEGY      99011 // prefixreg: forwarding strategy
+#define CCNL_DTAG_CACHEPOLICY   99012 // setcache: admission policy
+#define CCNL_DTAG_WEIGHT        99013 // setweight: share of a next hop
 
 #define CCNL_DTAG_DEBUGREQUEST  99100 //
 #define CCNL_DTAG_DEBUGACTION   99101 // dump, halt, dump+halt
@@ -131,6 +187,12 @@ enum {
 
 #define CCNL_DTAG_FRAG2012_OLOSS        (CCNL_DTAG_FRAGMENT2012+5)  // our loss count
 #define CCNL_DTAG_FRAG2012_YSEQN        (CCNL_DTAG_FRAGMENT2012+6)  // your (highest) seq no
+#define CCNL_DTAG_FRAG2012_YBITS        (CCNL_DTAG_FRAGMENT2012+7)  // your seq nos after YSEQN we have
+#define CCNL_DTAG_FRAG2012_FECSEQ       (CCNL_DTAG_FRAGMENT2012+8)  // first seq no of a FEC block
+#define CCNL_DTAG_FRAG2012_FECINFO      (CCNL_DTAG_FRAGMENT2012+9)  // block size << 8 | repair index
+#define CCNL_DTAG_FRAG2012_PMTUPROBE    (CCNL_DTAG_FRAGMENT2012+10) // size of this MTU probe
+#define CCNL_DTAG_FRAG2012_PMTUACK      (CCNL_DTAG_FRAGMENT2012+11) // size of a probe we got
+#define CCNL_DTAG_FRAG2012_PAD          (CCNL_DTAG_FRAGMENT2012+12) // filler, ignored
 
 // fragmentation protocol: (ccnl-ext-frag.c, FRAG_CCNx2013)
 #define CCNL_DTAG_FRAGMENT2013          CCN_DTAG_FragP // requested 2013-07-24, assigned 2013-08-12
@@ -141,6 +203,12 @@ enum {
 
 #define CCNL_DTAG_FRAG2013_OLOSS        CCNL_DTAG_FRAG2012_OLOSS  // our loss count
 #define CCNL_DTAG_FRAG2013_YSEQN        CCNL_DTAG_FRAG2012_YSEQN  // your (highest) seq no
+#define CCNL_DTAG_FRAG2013_YBITS        CCNL_DTAG_FRAG2012_YBITS
+#define CCNL_DTAG_FRAG2013_FECSEQ       CCNL_DTAG_FRAG2012_FECSEQ
+#define CCNL_DTAG_FRAG2013_FECINFO      CCNL_DTAG_FRAG2012_FECINFO
+#define CCNL_DTAG_FRAG2013_PMTUPROBE    CCNL_DTAG_FRAG2012_PMTUPROBE
+#define CCNL_DTAG_FRAG2013_PMTUACK      CCNL_DTAG_FRAG2012_PMTUACK
+#define CCNL_DTAG_FRAG2013_PAD          CCNL_DTAG_FRAG2012_PAD
 
 
 #define CCNL_DTAG_FRAG_FLAG_MASK        0x03
@@ -151,10 +219,41 @@ enum {
 
 // echo "FHBH" | base64 -d | hexdump -v -e '/1 "@x%02x"'| tr @ '\\'; echo
 #define CCNL_FRAG_TYPE_CCNx2013_VAL     "\x14\x70\x47"
+// echo "FMTE" | base64 -d | hexdump -v -e '/1 "@x%02x"'| tr @ '\\'; echo
+#define CCNL_FRAG_TYPE_MIDTOEND_VAL     "\x14\xc4\xc4"
+
+// reassembly of fragments which arrive out of order, per face:
+#define CCNL_FRAG_RXWINDOW              64     // fragments, multiple of 32
+#define CCNL_FRAG_RXMAXBYTES            65536  // held fragment bytes
+#define CCNL_FRAG_RXTIMEOUT             500000 // usec, wait for a gap
+
+// hop-by-hop ARQ: an ack carries the next expected seq no (YSEQN) and
+// a bitmap of the ones received beyond it (YBITS)
+#define CCNL_FRAG_TXWINDOW              CCNL_FRAG_RXWINDOW // unacked fragments
+#define CCNL_FRAG_ACKEVERY              8       // fragments, at the latest
+#define CCNL_FRAG_RTOINIT               200000  // usec
+#define CCNL_FRAG_RTOMIN                5000
+#define CCNL_FRAG_RTOMAX                2000000
+#define CCNL_FRAG_MAXTX                 8       // sends before giving up
+
+// forward error correction: K repair fragments per block of N
+#define CCNL_FRAG_FECMAXN               32      // data fragments per block
+#define CCNL_FRAG_FECMAXK               8       // repair fragments per block
+
+// path MTU discovery: probes with the DF bit, which the peer acks. The
+// sizes are those of the UDP payload (fragment datagrams)
+#define CCNL_PMTU_MIN                   548     // of a 576 byte IPv4 packet
+#define CCNL_PMTU_BASE                  1200    // used until a probe is acked
+#define CCNL_PMTU_STEP                  32      // search precision, bytes
+#define CCNL_PMTU_PROBETIMEOUT          1000000 // usec
+#define CCNL_PMTU_MAXPROBES             3       // per size, then it is too big
+#define CCNL_PMTU_RAISETIMEOUT          600     // sec, until the next search
 
 // ----------------------------------------------------------------------
 // face mgmt protocol:
 #define CCNL_DTAG_FRAG_FLAG_STATUSREQ   0x04
+#define CCNL_DTAG_FRAG_FLAG_ACKREQ      0x08 // kept by the sender until ack'd
+#define CCNL_DTAG_FRAG_FLAG_FEC         0x10 // covered by repair fragments
 
 //#define USE_SIGNATURES
 
@@ -0,0 +1,282 @@
+/*
+ * @f ccnl-ext-cache.c
+ * @b CCN lite extension: content store admission policies
+ *
+ * Copyright (C) 2026, Christian Tschudin, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2026-10-19 created
+ */
+
+#ifdef USE_CACHEPOLICY
+
+// Content returning for pending interests is admitted to the content
+// store by the policy of its longest matching prefix, see the "setcache"
+// management command; without one, a copy is left everywhere (LCE).
+//
+// Leave-copy-down and ProbCache need the distance to the copy the content
+// came from, i.e. the producer or the node which answered from its content
+// store. CCNx 2015 data carries it in its hop limit, which no node uses
+// otherwise (NON-CONFORM): that copy sends 255, the others count it down.
+// For the other suites it is unknown, and both policies then admit.
+
+int
+ccnl_cs_str2policy(char *spec, int *prob)
+{
+    if (!strcmp(spec, "lce"))
+        return CCNL_CACHEPOLICY_LCE;
+    if (!strcmp(spec, "lcd"))
+        return CCNL_CACHEPOLICY_LCD;
+    if (!strcmp(spec, "probcache"))
+        return CCNL_CACHEPOLICY_PROBCACHE;
+    if (!strcmp(spec, "tinylfu"))
+        return CCNL_CACHEPOLICY_TINYLFU;
+    if (!strncmp(spec, "prob=", 5)) {
+        *prob = atoi(spec + 5);
+        if (*prob < 0 || *prob > 100)
+            return -1;
+        return CCNL_CACHEPOLICY_PROB;
+    }
+    return -1;
+}
+
+char*
+ccnl_cs_policy2str(struct ccnl_cachepolicy_s *cp)
+{
+    static char buf[16];
+
+    switch (cp ? cp->policy : CCNL_CACHEPOLICY_LCE) {
+    case CCNL_CACHEPOLICY_LCD:       return "lcd";
+    case CCNL_CACHEPOLICY_PROBCACHE: return "probcache";
+    case CCNL_CACHEPOLICY_TINYLFU:   return "tinylfu";
+    case CCNL_CACHEPOLICY_PROB:
+        sprintf(buf, "prob=%d", cp->prob);
+        return buf;
+    default:
+        break;
+    }
+    return "lce";
+}
+
+// the policy with the longest prefix of name, NULL for the default
+struct ccnl_cachepolicy_s*
+ccnl_cs_policy_find(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *name)
+{
+    struct ccnl_cachepolicy_s *cp, *best = NULL;
+
+    for (cp = ccnl->cachepolicies; cp; cp = cp->next) {
+        if (cp->prefix->suite != name->suite)
+            continue;
+        if (best && cp->prefix->compcnt <= best->prefix->compcnt)
+            continue;
+        if (ccnl_prefix_cmp(cp->prefix, NULL, name, CMP_LONGEST) <
+                                                        cp->prefix->compcnt)
+            continue;
+        best = cp;
+    }
+    return best;
+}
+
+// sets the policy of prefix (which is taken over), returns <0 for a bad spec
+int
+ccnl_cs_setpolicy(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                  char *spec)
+{
+    struct ccnl_cachepolicy_s **pp;
+    int policy, prob = 100;
+
+    policy = ccnl_cs_str2policy(spec, &prob);
+    if (policy < 0) {
+        free_prefix(prefix);
+        return -1;
+    }
+    for (pp = &ccnl->cachepolicies; *pp; pp = &(*pp)->next)
+        if ((*pp)->prefix->suite == prefix->suite &&
+            !ccnl_prefix_cmp((*pp)->prefix, NULL, prefix, CMP_EXACT))
+            break;
+    if (*pp) {
+        free_prefix(prefix);
+    } else {
+        *pp = (struct ccnl_cachepolicy_s *)
+            ccnl_calloc(1, sizeof(struct ccnl_cachepolicy_s));
+        if (!*pp) {
+            free_prefix(prefix);
+            return -1;
+        }
+        (*pp)->prefix = prefix;
+    }
+    (*pp)->policy = policy;
+    (*pp)->prob = prob;
+    if (policy == CCNL_CACHEPOLICY_TINYLFU && !ccnl->cs_sketch)
+        ccnl->cs_sketch = ccnl_calloc(4, CCNL_CS_SKETCH_WIDTH);
+    DEBUGMSG(INFO, "cache policy of <%s> is %s\n",
+             ccnl_prefix_to_path((*pp)->prefix), ccnl_cs_policy2str(*pp));
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+// TinyLFU: how often names were asked for lately, a count-min sketch of
+// four rows of saturating counters which are halved every SAMPLE counts
+
+static unsigned char*
+ccnl_cs_sketch_counter(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                       int row)
+{
+    unsigned int h = 2166136261u + row * 0x9e3779b9u; // FNV-1a, per row
+    unsigned char *cp;
+    int k;
+
+    for (k = 0; k < p->compcnt; k++) {
+        for (cp = p->comp[k]; cp < p->comp[k] + p->complen[k]; cp++)
+            h = (h ^ *cp) * 16777619u;
+        h = (h ^ '/') * 16777619u;
+    }
+    if (p->chunknum)
+        h = (h ^ *p->chunknum) * 16777619u;
+    h ^= h >> 15;
+    return ccnl->cs_sketch + row * CCNL_CS_SKETCH_WIDTH +
+                                                h % CCNL_CS_SKETCH_WIDTH;
+}
+
+int
+ccnl_cs_frequency(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p)
+{
+    int row, f = 255;
+
+    if (!ccnl->cs_sketch)
+        return 0;
+    for (row = 0; row < 4; row++)
+        if (*ccnl_cs_sketch_counter(ccnl, p, row) < f)
+            f = *ccnl_cs_sketch_counter(ccnl, p, row);
+    return f;
+}
+
+// an interest for p was looked up in the content store, hit or not
+void
+ccnl_cs_count(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+              struct ccnl_content_s *hit)
+{
+    unsigned char *cnt;
+    int row;
+
+    ccnl->cs_lookups++;
+    if (hit)
+        ccnl->cs_hits++;
+    if (!ccnl->cs_sketch)
+        return;
+    for (row = 0; row < 4; row++) {
+        cnt = ccnl_cs_sketch_counter(ccnl, p, row);
+        if (*cnt < 255)
+            (*cnt)++;
+    }
+    if (++ccnl->cs_sketchcnt >= CCNL_CS_SKETCH_SAMPLE) {
+        for (row = 0; row < 4 * CCNL_CS_SKETCH_WIDTH; row++)
+            ccnl->cs_sketch[row] >>= 1;
+        ccnl->cs_sketchcnt = 0;
+    }
+}
+
+// ----------------------------------------------------------------------
+
+static unsigned int
+ccnl_cs_rand(void)
+{
+    static unsigned int seed = 1;
+
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+// hops from here to the farthest requester of c, by the hop limit of the
+// pending CCNx interests (sent with 64, or 255); 0 if unknown
+static int
+ccnl_cs_downhops(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_interest_s *i;
+    int rcvd, d, max = 0;
+
+    for (i = ccnl->pit; i; i = i->next) {
+        if (i->suite != CCNL_SUITE_CCNTLV || i->hoppos < 0 ||
+                                                !ccnl_i_matches_c(i, c))
+            continue;
+        rcvd = i->hopval + 1;
+        d = (rcvd <= 64 ? 64 : 255) - rcvd + 1;
+        if (d > max)
+            max = d;
+    }
+    return max;
+}
+
+// whether content c, about to serve pending interests, goes into the
+// content store
+int
+ccnl_cs_admit(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_cachepolicy_s *cp = ccnl_cs_policy_find(ccnl, c->name);
+    struct ccnl_content_s *victim;
+    int ok = 1, down;
+
+    switch (cp ? cp->policy : CCNL_CACHEPOLICY_LCE) {
+    case CCNL_CACHEPOLICY_LCD:
+        ok = c->hops <= 1;
+        break;
+    case CCNL_CACHEPOLICY_PROB:
+        ok = (int)(ccnl_cs_rand() % 100) < cp->prob;
+        break;
+    case CCNL_CACHEPOLICY_PROBCACHE:
+        // hops from the copy, out of the whole path: the nearer to the
+        // requesters, the likelier
+        down = ccnl_cs_downhops(ccnl, c);
+        if (c->hops && down)
+            ok = (int)(ccnl_cs_rand() % (c->hops + down)) < c->hops;
+        break;
+    case CCNL_CACHEPOLICY_TINYLFU:
+        if (ccnl->max_cache_entries < 0 ||
+                                ccnl->contentcnt < ccnl->max_cache_entries)
+            break;
+        victim = ccnl_content_victim(ccnl);
+        ok = !victim || ccnl_cs_frequency(ccnl, c->name) >
+                                    ccnl_cs_frequency(ccnl, victim->name);
+        break;
+    default:
+        break;
+    }
+    if (ok)
+        ccnl->cs_admitted++;
+    else
+        ccnl->cs_rejected++;
+    DEBUGMSG(DEBUG, "  cache admission (%s, %d hops): %s\n",
+             ccnl_cs_policy2str(cp), c->hops, ok ? "admitted" : "rejected");
+    return ok;
+}
+
+void
+ccnl_cs_cleanup(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_cachepolicy_s *cp;
+
+    while (ccnl->cachepolicies) {
+        cp = ccnl->cachepolicies->next;
+        free_prefix(ccnl->cachepolicies->prefix);
+        ccnl_free(ccnl->cachepolicies);
+        ccnl->cachepolicies = cp;
+    }
+    ccnl_free(ccnl->cs_sketch);
+    ccnl->cs_sketch = NULL;
+}
+
+#endif // USE_CACHEPOLICY
+
+// eof
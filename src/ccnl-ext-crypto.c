@@ -440,6 +440,8 @@ ccnl_mgmt_crypto(struct ccnl_relay_s *ccnl, char *type, unsigned char *buf, int
       }
       
       retbuf = ccnl_buf_new((char *)out, len1);
+      if (retbuf)
+          retbuf->tclass = CCNL_TCLASS_CRYPTO;
       if(seqnum >= 0){
           ccnl_face_enqueue(ccnl, from, retbuf); 
       }else{
@@ -166,6 +166,10 @@ ccnl_dump(int lev, int typ, void *p)
 #endif
             if (top->ifs[k].reflect)
                 fprintf(stderr, " reflect=%d", top->ifs[k].reflect);
+#ifdef USE_SCHEDULER
+            if (top->ifs[k].sched)
+                ccnl_sched_dump(top->ifs[k].sched);
+#endif
             fprintf(stderr, "\n");
         }
         if (top->faces) {
@@ -180,6 +184,56 @@ ccnl_dump(int lev, int typ, void *p)
         if (top->contents) {
             INDENT(lev); fprintf(stderr, "contents:\n"); ccnl_dump(lev+1, CCNL_CONTENT, top->contents);
         }
+#ifdef USE_CACHEPOLICY
+        INDENT(lev);
+        fprintf(stderr, "cache: lookups=%ld hits=%ld admitted=%ld rejected=%ld\n",
+                top->cs_lookups, top->cs_hits, top->cs_admitted,
+                top->cs_rejected);
+        {
+            struct ccnl_cachepolicy_s *cp;
+            for (cp = top->cachepolicies; cp; cp = cp->next) {
+                INDENT(lev+1);
+                fprintf(stderr, "%p CACHEPOLICY prefix=%s suite=%s policy=%s\n",
+                        (void *) cp, cp->prefix->compcnt ?
+                        ccnl_prefix_to_path(cp->prefix) : "/",
+                        ccnl_suite2str(cp->prefix->suite),
+                        ccnl_cs_policy2str(cp));
+            }
+        }
+#endif
+#ifdef USE_PREFETCH
+        INDENT(lev);
+        fprintf(stderr, "prefetch: issued=%ld hits=%ld\n",
+                top->pf_issued, top->pf_hits);
+        {
+            struct ccnl_prefetch_s *pf;
+            struct ccnl_prefetch_stream_s *s;
+            for (pf = top->prefetchers; pf; pf = pf->next) {
+                INDENT(lev+1);
+                fprintf(stderr, "%p PREFETCH prefix=%s suite=%s window=%d\n",
+                        (void *) pf, pf->prefix->compcnt ?
+                        ccnl_prefix_to_path(pf->prefix) : "/",
+                        ccnl_suite2str(pf->prefix->suite), pf->window);
+            }
+            for (s = top->prefetchstreams; s; s = s->next) {
+                INDENT(lev+1);
+                fprintf(stderr, "%p STREAM name=%s next=%u ahead=%u "
+                        "window=%d issued=%d hits=%d\n", (void *) s,
+                        ccnl_prefix_to_path(s->name), s->expected, s->ahead,
+                        s->window, s->issued, s->hits);
+            }
+        }
+#endif
+#ifdef USE_DISKCACHE
+        if (top->disk) {
+            INDENT(lev);
+            fprintf(stderr, "disk: dir=%s objects=%d bytes=%ld hits=%ld "
+                    "misses=%ld demoted=%ld promoted=%ld collected=%ld\n",
+                    top->disk->dir, top->disk->entcnt, top->disk->bytes,
+                    top->disk->hits, top->disk->misses, top->disk->demoted,
+                    top->disk->promoted, top->disk->collected);
+        }
+#endif
         break;
     case CCNL_FACE:
         while (fac) {
@@ -197,6 +251,13 @@ ccnl_dump(int lev, int typ, void *p)
                 fprintf(stderr, " ux=%s", ccnl_addr2ascii(&fac->peer));
             else
                 fprintf(stderr, " peer=?");
+            if (fac->flags & CCNL_FACE_FLAGS_COALESCE)
+                fprintf(stderr, " dgrams=%d pkts=%d", fac->txdgrams,
+                        fac->txpkts);
+#ifdef USE_SCHEDULER
+            if (fac->sched)
+                ccnl_sched_dump(fac->sched);
+#endif
             if (fac->frag)
                 ccnl_dump(lev+2, CCNL_FRAG, fac->frag);
             fprintf(stderr, "\n");
@@ -211,14 +272,35 @@ ccnl_dump(int lev, int typ, void *p)
     case CCNL_FRAG:
         fprintf(stderr, " fragproto=%s mtu=%d",
                 frag_protocol(frg->protocol), frg->mtu);
+        if (frg->flags & CCNL_FRAG_FLAGS_ARQ)
+            fprintf(stderr, " arq rto=%d unacked=%u retx=%u lost=%u",
+                    frg->rto, frg->sendseq - frg->txbase,
+                    frg->retransmits, frg->losscount);
+        if (frg->flags & CCNL_FRAG_FLAGS_FEC)
+            fprintf(stderr, " fec=%d/%d repairs=%u recovered=%u",
+                    frg->fecn, frg->feck, frg->fecsent, frg->fecrecovered);
+        if (frg->flags & CCNL_FRAG_FLAGS_PMTU)
+            fprintf(stderr, " pmtu=auto acked=%d max=%d probing=%d",
+                    frg->pmtulo, frg->pmtumax, frg->pmtuprobe);
         break;
 #endif
     case CCNL_FWD:
         while (fwd) {
             INDENT(lev);
-            fprintf(stderr, "%p FWD next=%p face=%p (id=%d suite=%s)\n",
+            fprintf(stderr, "%p FWD next=%p face=%p (id=%d suite=%s)"
+                    " strategy=%s srtt=%ld rttvar=%ld sent=%d ok=%d\n",
                     (void *) fwd, (void *) fwd->next, (void *) fwd->face,
-                    fwd->face->faceid, ccnl_suite2str(fwd->suite));
+                    fwd->face->faceid, ccnl_suite2str(fwd->suite),
+                    fwd->strategy == CCNL_STRATEGY_MULTICAST ? "multicast" :
+                    fwd->strategy == CCNL_STRATEGY_WEIGHTED ? "weighted" :
+                    "best", fwd->srtt, fwd->rttvar, fwd->sent, fwd->ok);
+            if (fwd->strategy == CCNL_STRATEGY_WEIGHTED) {
+                INDENT(lev+1);
+                if (fwd->weight)
+                    fprintf(stderr, "weight=%d\n", fwd->weight);
+                else
+                    fprintf(stderr, "weight=measured\n");
+            }
             ccnl_dump(lev+1, CCNL_PREFIX, fwd->prefix);
             fwd = fwd->next;
         }
@@ -244,9 +326,10 @@ ccnl_dump(int lev, int typ, void *p)
                 break;
             }
             INDENT(lev);
-            fprintf(stderr, "%p INTEREST next=%p prev=%p last=%d min=%d max=%d retries=%d\n",
+            fprintf(stderr, "%p INTEREST next=%p prev=%p last=%d min=%d max=%d retries=%d expires=%ld\n",
                    (void *) itr, (void *) itr->next, (void *) itr->prev,
-                    itr->last_used, mi, ma, itr->retries);
+                    itr->last_used, mi, ma, itr->retries,
+                    (long) itr->expires.tv_sec);
             ccnl_dump(lev+1, CCNL_BUF, itr->pkt);
             ccnl_dump(lev+1, CCNL_PREFIX, itr->prefix);
             if (ppk) {
@@ -275,9 +358,9 @@ ccnl_dump(int lev, int typ, void *p)
     case CCNL_CONTENT:
         while (con) {
             INDENT(lev);
-            fprintf(stderr, "%p CONTENT  next=%p prev=%p last_used=%d served_cnt=%d\n",
+            fprintf(stderr, "%p CONTENT  next=%p prev=%p last_used=%d served_cnt=%d stale=%d\n",
                    (void *) con, (void *) con->next, (void *) con->prev,
-                   con->last_used, con->served_cnt);
+                   con->last_used, con->served_cnt, (con->flags & CCNL_CONTENT_FLAGS_STALE) != 0);
             ccnl_dump(lev+1, CCNL_PREFIX, con->name);
             ccnl_dump(lev+1, CCNL_BUF, con->pkt);
             con = con->next;
@@ -696,6 +779,7 @@ debug_buf_new(void *data, int len, const char *fn, int lno, char *tstamp)
         return NULL;
     b->next = NULL;
     b->datalen = len;
+    b->tclass = 0;
     if (data)
         memcpy(b->data, data, len);
     return b;
@@ -721,6 +805,7 @@ ccnl_buf_new(void *data, int len)
         return NULL;
     b->next = NULL;
     b->datalen = len;
+    b->tclass = 0;
     if (data)
         memcpy(b->data, data, len);
     return b;
@@ -735,7 +820,7 @@ ccnl_buf_new(void *data, int len)
 #define free_5ptr_list(a,b,c,d,e) ccnl_free(a), ccnl_free(b), ccnl_free(c), ccnl_free(d), ccnl_free(e);
 
 #define free_prefix(p)  do{ if(p) \
-                free_4ptr_list(p->bytes,p->comp,p->complen,p); } while(0)
+                free_5ptr_list(p->bytes,p->comp,p->complen,p->chunknum,p); } while(0)
 #define free_content(c) do{ free_prefix(c->name); \
                         free_2ptr_list(c->pkt, c); } while(0)
 
@@ -0,0 +1,546 @@
+/*
+ * @f ccnl-ext-diskcache.c
+ * @b CCN lite extension: second tier of the content store on disk
+ *
+ * Copyright (C) 2026, Christian Tschudin, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2026-10-19 created
+ */
+
+#if defined(USE_DISKCACHE) && defined(USE_PRELOAD) && defined(CCNL_UNIX)
+
+#include <sys/mman.h>
+
+// Content evicted from the content store in RAM is appended to a log on
+// disk ("ccn-lite-relay -D DIR"), in segments NNNNNNNN.seg of up to
+// CCNL_DISK_SEGMENT bytes: a record header, then the packet as it was
+// received. An interest which finds nothing in RAM is looked up by the
+// hash of its name in an index in RAM (20 bytes per object), and what it
+// finds is read through a mapping of its segment, decoded with
+// ccnl_preload_content() and brought back into the content store. Names
+// must match exactly, selectors on them are left to the upstream.
+//
+// A full segment gets an index file NNNNNNNN.idx (hash, offset, length
+// of each record), from which the relay restarts; segments without one
+// are scanned. The oldest segment is deleted when all of them take more
+// than the configured bytes (FIFO, as for a cache log).
+// NON-CONFORM: the files are in host byte order.
+
+#define CCNL_DISK_MAGIC         0x63436c45 // "cClE", "cClD" had no freshness
+#define CCNL_DISK_IDXMAGIC      0x63436c49 // "cClI"
+
+struct ccnl_disk_rec_s {        // precedes each packet in a segment
+    unsigned int magic;
+    unsigned int hash;          // of the name, see ccnl_prefix_hash()
+    unsigned int len;           // of the packet
+    unsigned int fresh;         // end of its FreshnessPeriod (sec), 0: none
+    unsigned char suite, stale, pad[2];
+};
+
+struct ccnl_disk_idx_s {        // index file: a header, then the entries
+    unsigned int magic;
+    unsigned int segsize;       // of the segment when it was written
+    unsigned int cnt;
+};
+
+struct ccnl_disk_seg_s {
+    struct ccnl_disk_seg_s *next;
+    unsigned int id;
+    long size;
+    unsigned char *map;         // of maplen bytes, for the reads
+    long maplen;
+};
+
+struct ccnl_disk_ent_s {        // index entry, in ccnl_disk_s.ents
+    unsigned int hash, seg, off, len; // off: of the record header
+    int next;                   // in its bucket's chain, -1: end
+};
+
+static char*
+ccnl_disk_fname(struct ccnl_disk_s *d, unsigned int id, char *ext)
+{
+    static char fname[1000];
+
+    snprintf(fname, sizeof(fname), "%s/%08u.%s", d->dir, id, ext);
+    return fname;
+}
+
+// ----------------------------------------------------------------------
+// the index in RAM: entries chained per bucket, the newest first
+
+static void
+ccnl_disk_index_rehash(struct ccnl_disk_s *d, int nbuckets)
+{
+    int k, *b = (int*) ccnl_malloc(nbuckets * sizeof(int));
+
+    if (!b)
+        return;
+    ccnl_free(d->buckets);
+    d->buckets = b;
+    d->nbuckets = nbuckets;
+    for (k = 0; k < nbuckets; k++)
+        b[k] = -1;
+    for (k = 0; k < d->entcnt; k++) { // in the order they were added
+        d->ents[k].next = b[d->ents[k].hash % nbuckets];
+        b[d->ents[k].hash % nbuckets] = k;
+    }
+}
+
+static int
+ccnl_disk_index_add(struct ccnl_disk_s *d, unsigned int hash,
+                    unsigned int seg, unsigned int off, unsigned int len)
+{
+    struct ccnl_disk_ent_s *e;
+
+    if (d->entcnt == d->entmax) {
+        int max = d->entmax ? 2 * d->entmax : 1024;
+
+        e = (struct ccnl_disk_ent_s*) ccnl_malloc(max * sizeof(*e));
+        if (!e)
+            return -1;
+        if (d->entcnt)
+            memcpy(e, d->ents, d->entcnt * sizeof(*e));
+        ccnl_free(d->ents);
+        d->ents = e;
+        d->entmax = max;
+    }
+    e = d->ents + d->entcnt;
+    e->hash = hash;
+    e->seg = seg;
+    e->off = off;
+    e->len = len;
+    d->entcnt++;
+    if (d->entcnt > 2 * d->nbuckets) {
+        ccnl_disk_index_rehash(d, d->nbuckets ? 4 * d->nbuckets : 1024);
+    } else {
+        e->next = d->buckets[hash % d->nbuckets];
+        d->buckets[hash % d->nbuckets] = d->entcnt - 1;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+// writes the index file of segment s
+static void
+ccnl_disk_seg_writeidx(struct ccnl_disk_s *d, struct ccnl_disk_seg_s *s)
+{
+    struct ccnl_disk_idx_s hdr;
+    unsigned int rec[3];
+    FILE *f = fopen(ccnl_disk_fname(d, s->id, "idx"), "w");
+    int k;
+
+    if (!f)
+        return;
+    hdr.magic = CCNL_DISK_IDXMAGIC;
+    hdr.segsize = s->size;
+    for (hdr.cnt = 0, k = 0; k < d->entcnt; k++)
+        hdr.cnt += d->ents[k].seg == s->id;
+    fwrite(&hdr, sizeof(hdr), 1, f);
+    for (k = 0; k < d->entcnt; k++) {
+        if (d->ents[k].seg != s->id)
+            continue;
+        rec[0] = d->ents[k].hash;
+        rec[1] = d->ents[k].off;
+        rec[2] = d->ents[k].len;
+        fwrite(rec, sizeof(rec), 1, f);
+    }
+    fclose(f);
+}
+
+// indexes segment s, from its index file if that is up to date, else by
+// reading its records; a torn last record (a crash) is cut off
+static void
+ccnl_disk_seg_load(struct ccnl_disk_s *d, struct ccnl_disk_seg_s *s)
+{
+    struct ccnl_disk_idx_s hdr;
+    struct ccnl_disk_rec_s rec;
+    unsigned int ent[3];
+    unsigned int k;
+    long off;
+    FILE *f = fopen(ccnl_disk_fname(d, s->id, "idx"), "r");
+
+    if (f) {
+        if (fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+                hdr.magic == CCNL_DISK_IDXMAGIC && hdr.segsize == s->size) {
+            for (k = 0; k < hdr.cnt && fread(ent, sizeof(ent), 1, f) == 1; k++)
+                ccnl_disk_index_add(d, ent[0], s->id, ent[1], ent[2]);
+            fclose(f);
+            return;
+        }
+        fclose(f);
+    }
+    f = fopen(ccnl_disk_fname(d, s->id, "seg"), "r");
+    if (!f)
+        return;
+    for (off = 0; off + (long) sizeof(rec) <= s->size; ) {
+        if (fseek(f, off, SEEK_SET) || fread(&rec, sizeof(rec), 1, f) != 1 ||
+                rec.magic != CCNL_DISK_MAGIC || !rec.len ||
+                rec.len > CCNL_MAX_PACKET_SIZE ||
+                off + (long) sizeof(rec) + rec.len > s->size)
+            break;
+        ccnl_disk_index_add(d, rec.hash, s->id, off, rec.len);
+        off += sizeof(rec) + rec.len;
+    }
+    fclose(f);
+    if (off < s->size) {
+        DEBUGMSG(WARNING, "disk: segment %u cut at %ld of %ld bytes\n",
+                 s->id, off, s->size);
+        if (truncate(ccnl_disk_fname(d, s->id, "seg"), off) == 0)
+            s->size = off;
+    }
+}
+
+static void
+ccnl_disk_seg_unmap(struct ccnl_disk_seg_s *s)
+{
+    if (s->map)
+        munmap(s->map, s->maplen);
+    s->map = NULL;
+    s->maplen = 0;
+}
+
+// the newest segment, to be appended to
+static struct ccnl_disk_seg_s*
+ccnl_disk_seg_last(struct ccnl_disk_s *d)
+{
+    struct ccnl_disk_seg_s *s = d->segs;
+
+    while (s && s->next)
+        s = s->next;
+    return s;
+}
+
+static struct ccnl_disk_seg_s*
+ccnl_disk_seg_new(struct ccnl_disk_s *d, unsigned int id)
+{
+    struct ccnl_disk_seg_s *s, *last = ccnl_disk_seg_last(d);
+
+    s = (struct ccnl_disk_seg_s*) ccnl_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    s->id = id;
+    if (last)
+        last->next = s;
+    else
+        d->segs = s;
+    return s;
+}
+
+// deletes the oldest segment and what the index has of it
+static void
+ccnl_disk_collect(struct ccnl_disk_s *d)
+{
+    struct ccnl_disk_seg_s *s = d->segs;
+    int k, n;
+
+    d->segs = s->next;
+    for (k = n = 0; k < d->entcnt; k++)
+        if (d->ents[k].seg != s->id)
+            d->ents[n++] = d->ents[k];
+    d->collected += d->entcnt - n;
+    d->entcnt = n;
+    ccnl_disk_index_rehash(d, d->nbuckets);
+    DEBUGMSG(INFO, "disk: segment %u collected, %ld bytes\n", s->id, s->size);
+    d->bytes -= s->size;
+    ccnl_disk_seg_unmap(s);
+    unlink(ccnl_disk_fname(d, s->id, "seg"));
+    unlink(ccnl_disk_fname(d, s->id, "idx"));
+    ccnl_free(s);
+}
+
+// ----------------------------------------------------------------------
+
+static int
+ccnl_disk_cmpid(const void *a, const void *b)
+{
+    unsigned int x = *(unsigned int*) a, y = *(unsigned int*) b;
+
+    return x < y ? -1 : x > y;
+}
+
+// opens (or creates) the disk tier in directory dir, of at most maxbytes
+int
+ccnl_disk_open(struct ccnl_relay_s *ccnl, char *dir, long maxbytes)
+{
+    struct ccnl_disk_s *d;
+    struct ccnl_disk_seg_s *s;
+    struct dirent *de;
+    struct stat st;
+    unsigned int *ids = NULL, id;
+    int cnt = 0, max = 0, k;
+    char ext[8];
+    DIR *dp;
+
+    if (ccnl->disk)
+        return -1;
+    mkdir(dir, 0755);
+    dp = opendir(dir);
+    if (!dp) {
+        DEBUGMSG(ERROR, "disk: could not open directory %s\n", dir);
+        return -1;
+    }
+    d = (struct ccnl_disk_s*) ccnl_calloc(1, sizeof(*d));
+    if (!d) {
+        closedir(dp);
+        return -1;
+    }
+    d->dir = ccnl_strdup(dir);
+    d->maxbytes = maxbytes;
+    // at least four segments, so that collecting one frees a quarter
+    d->segsize = maxbytes / 4 < CCNL_DISK_SEGMENT ? maxbytes / 4 :
+                                                    CCNL_DISK_SEGMENT;
+    d->fd = -1;
+    ccnl_disk_index_rehash(d, 1024);
+    ccnl->disk = d;
+
+    while ((de = readdir(dp))) {
+        if (sscanf(de->d_name, "%u.%7s", &id, ext) != 2 || strcmp(ext, "seg"))
+            continue;
+        if (cnt == max) {
+            unsigned int *ids2;
+
+            max = max ? 2 * max : 64;
+            ids2 = (unsigned int*) ccnl_malloc(max * sizeof(*ids));
+            if (!ids2)
+                break;
+            if (cnt)
+                memcpy(ids2, ids, cnt * sizeof(*ids));
+            ccnl_free(ids);
+            ids = ids2;
+        }
+        ids[cnt++] = id;
+    }
+    closedir(dp);
+    if (cnt)
+        qsort(ids, cnt, sizeof(*ids), ccnl_disk_cmpid);
+    for (k = 0; k < cnt; k++) {
+        s = ccnl_disk_seg_new(d, ids[k]);
+        if (!s)
+            break;
+        if (!stat(ccnl_disk_fname(d, ids[k], "seg"), &st))
+            s->size = st.st_size;
+        ccnl_disk_seg_load(d, s);
+        d->bytes += s->size;
+    }
+    ccnl_free(ids);
+
+    s = ccnl_disk_seg_last(d);
+    if (!s)
+        s = ccnl_disk_seg_new(d, 0);
+    if (s)
+        d->fd = open(ccnl_disk_fname(d, s->id, "seg"),
+                     O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (d->fd < 0) {
+        DEBUGMSG(ERROR, "disk: could not open a segment in %s\n", dir);
+        ccnl_disk_close(ccnl);
+        return -1;
+    }
+    while (d->bytes > d->maxbytes && d->segs->next)
+        ccnl_disk_collect(d);
+    DEBUGMSG(INFO, "disk: %d objects, %ld bytes in %d segments in %s\n",
+             d->entcnt, d->bytes, cnt, dir);
+    return 0;
+}
+
+// content c leaves the content store in RAM: it is appended to the log,
+// unless it is there already
+void
+ccnl_disk_demote(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_disk_s *d = ccnl->disk;
+    struct ccnl_disk_seg_s *s;
+    struct ccnl_disk_rec_s rec;
+
+    if (!d || d->fd < 0 || !c->pkt || !c->name ||
+                                (c->flags & CCNL_CONTENT_FLAGS_ONDISK))
+        return;
+    s = ccnl_disk_seg_last(d);
+    if (s->size && s->size + (long) sizeof(rec) + c->pkt->datalen >
+                                                                d->segsize) {
+        // full: indexed, and the next one is started
+        ccnl_disk_seg_writeidx(d, s);
+        close(d->fd);
+        s = ccnl_disk_seg_new(d, s->id + 1);
+        d->fd = s ? open(ccnl_disk_fname(d, s->id, "seg"),
+                         O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644) : -1;
+        if (d->fd < 0) {
+            DEBUGMSG(ERROR, "disk: could not start a segment\n");
+            return;
+        }
+        while (d->bytes > d->maxbytes - d->segsize && d->segs != s)
+            ccnl_disk_collect(d);
+    }
+
+    memset(&rec, 0, sizeof(rec));
+    rec.magic = CCNL_DISK_MAGIC;
+    rec.hash = ccnl_prefix_hash(c->name);
+    rec.len = c->pkt->datalen;
+    rec.suite = c->suite;
+    rec.stale = ccnl_content_isStale(c);
+    if (!rec.stale)
+        rec.fresh = c->fresh.tv_sec;
+    if (write(d->fd, &rec, sizeof(rec)) != sizeof(rec) ||
+            write(d->fd, c->pkt->data, rec.len) != (int) rec.len) {
+        DEBUGMSG(ERROR, "disk: write failed (%s)\n", strerror(errno));
+        // the next record must start at s->size, or the index is off
+        if (ftruncate(d->fd, s->size) < 0) {
+            DEBUGMSG(ERROR, "disk: truncate failed (%s), no more demotes\n",
+                     strerror(errno));
+            close(d->fd);
+            d->fd = -1;
+        }
+        return;
+    }
+    ccnl_disk_index_add(d, rec.hash, s->id, s->size, rec.len);
+    s->size += sizeof(rec) + rec.len;
+    d->bytes += sizeof(rec) + rec.len;
+    d->demoted++;
+    c->flags |= CCNL_CONTENT_FLAGS_ONDISK;
+    DEBUGMSG(DEBUG, "disk: <%s> demoted\n", ccnl_prefix_to_path(c->name));
+}
+
+// the content named p (exactly) from the disk, back in the content store
+struct ccnl_content_s*
+ccnl_disk_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p)
+{
+    struct ccnl_disk_s *d = ccnl->disk;
+    struct ccnl_disk_seg_s *s;
+    struct ccnl_disk_ent_s *e;
+    struct ccnl_disk_rec_s *rec;
+    struct ccnl_content_s *c;
+    struct timeval now;
+    struct stat st;
+    unsigned int hash;
+    int k, fd;
+
+    if (!d || !d->entcnt)
+        return NULL;
+    hash = ccnl_prefix_hash(p);
+    for (k = d->buckets[hash % d->nbuckets]; k >= 0; k = e->next) {
+        e = d->ents + k;
+        if (e->hash != hash)
+            continue;
+        for (s = d->segs; s && s->id != e->seg; s = s->next);
+        if (!s)
+            continue;
+        if (e->off + sizeof(*rec) + e->len > (unsigned long) s->maplen) {
+            // (re)mapped as far as it is written
+            ccnl_disk_seg_unmap(s);
+            fd = open(ccnl_disk_fname(d, s->id, "seg"), O_RDONLY);
+            if (fd < 0)
+                continue;
+            if (!fstat(fd, &st) && st.st_size > 0) {
+                s->map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE, fd, 0);
+                if (s->map == MAP_FAILED)
+                    s->map = NULL;
+                else
+                    s->maplen = st.st_size;
+            }
+            close(fd);
+            if (e->off + sizeof(*rec) + e->len > (unsigned long) s->maplen)
+                continue;
+        }
+        rec = (struct ccnl_disk_rec_s*) (s->map + e->off);
+        if (rec->magic != CCNL_DISK_MAGIC || rec->suite != p->suite)
+            continue;
+        c = ccnl_preload_content(ccnl, rec->suite, 0, (unsigned char*)(rec + 1),
+                                 e->len, "disk");
+        if (!c)
+            continue;
+        if (c->suite != p->suite ||
+                ccnl_prefix_cmp(c->name, NULL, p, CMP_EXACT)) {
+            free_content(c);
+            continue;
+        }
+        // what is left of its freshness, as when it was demoted
+        ccnl_get_timeval(&now);
+        if (rec->stale || (rec->fresh && rec->fresh <= now.tv_sec))
+            ccnl_content_freshness(c, 0);
+        else if (rec->fresh) {
+            c->fresh.tv_sec = rec->fresh;
+            c->fresh.tv_usec = 0;
+        }
+        c->flags |= CCNL_CONTENT_FLAGS_ONDISK;
+        if (!ccnl_content_add2cache(ccnl, c)) {
+            free_content(c);
+            return NULL;
+        }
+        d->promoted++;
+        DEBUGMSG(DEBUG, "disk: <%s> promoted\n", ccnl_prefix_to_path(c->name));
+        return c;
+    }
+    return NULL;
+}
+
+// an interest for p found nothing in RAM: answered from the disk, if it can
+int
+ccnl_disk_RX(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
+             struct ccnl_prefix_s *p)
+{
+    struct ccnl_content_s *c;
+
+    if (!ccnl->disk)
+        return 0;
+    c = ccnl_disk_lookup(ccnl, p);
+    if (!c) {
+        ccnl->disk->misses++;
+        return 0;
+    }
+    ccnl->disk->hits++;
+    if (from->ifndx >= 0)
+        ccnl_face_send_shared(ccnl, from, c->pkt, c->hoppos, 255);
+    else
+        ccnl_app_RX(ccnl, c);
+    return 1;
+}
+
+// demotes what is only in RAM, so that a restart finds it, and closes
+void
+ccnl_disk_close(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_disk_s *d = ccnl->disk;
+    struct ccnl_disk_seg_s *s;
+    struct ccnl_content_s *c;
+
+    if (!d)
+        return;
+    for (c = ccnl->contents; c && d->fd >= 0; c = c->next)
+        if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC))
+            ccnl_disk_demote(ccnl, c);
+    if (d->fd >= 0) {
+        close(d->fd);
+        s = ccnl_disk_seg_last(d);
+        if (s && s->size)
+            ccnl_disk_seg_writeidx(d, s);
+    }
+    while (d->segs) {
+        s = d->segs->next;
+        ccnl_disk_seg_unmap(d->segs);
+        ccnl_free(d->segs);
+        d->segs = s;
+    }
+    ccnl_free(d->ents);
+    ccnl_free(d->buckets);
+    ccnl_free(d->dir);
+    ccnl_free(d);
+    ccnl->disk = NULL;
+}
+
+#endif // USE_DISKCACHE && USE_PRELOAD && CCNL_UNIX
+
+// eof
@@ -19,6 +19,11 @@
  * File history:
  * 2011-10-05 created
  * 2013-05-02 prototyped a new fragment format CCNL_FRAG_TYPE_CCNx2013
+ * 2026-10-19 closed-form fragment count, gather send without payload copies
+ * 2026-10-19 out-of-order reassembly with a bounded window and timeout
+ * 2026-10-19 hop-by-hop selective repeat ARQ (acks, RTT based timeout)
+ * 2026-10-19 forward error correction (Reed-Solomon repair fragments)
+ * 2026-10-19 path MTU discovery with DF probes (MTU "auto")
  */
 
 // ----------------------------------------------------------------------
@@ -41,6 +46,18 @@
  *    including carrying fragments of bigger CCNX objects
  *  - all attributes from SEQUENCED2012 are retained
  *
+ * Both can be combined with options (see ccnl_frag_setopts()):
+ *
+ * arq
+ *  - lost fragments are retransmitted hop-by-hop, see below
+ *
+ * fec=N/K
+ *  - K repair fragments follow each block of (up to) N data fragments,
+ *    the receiver rebuilds up to K lost ones without a round trip
+ *
+ * An MTU of 0 ("auto" for the setfrag command) sizes the fragments by
+ * path MTU discovery instead, see ccnl_frag_pmtu_start().
+ *
  */
 
 // ----------------------------------------------------------------------
@@ -59,10 +76,15 @@ ccnl_frag_new(int protocol, int mtu)
         if (e) {
             e->protocol = protocol;
             e->mtu = mtu;
+            if (mtu <= 0) {
+                e->flags |= CCNL_FRAG_FLAGS_PMTU;
+                e->mtu = CCNL_PMTU_BASE;
+            }
             e->flagwidth = 1;
             e->sendseqwidth =   4;
             e->losscountwidth = 2;
             e->recvseqwidth =   4;
+            e->rto = CCNL_FRAG_RTOINIT;
         }
         break;
     case CCNL_FRAG_NONE:
@@ -72,6 +94,56 @@ ccnl_frag_new(int protocol, int mtu)
     return e;
 }
 
+// FRAG is "none", "seqd2012" or "ccnx2013", possibly followed by
+// options, e.g. "ccnx2013,arq" or "ccnx2013,fec=8/2"
+int
+ccnl_frag_str2proto(char *spec)
+{
+    int len = strcspn(spec, ",");
+
+    if (len == 4 && !strncmp(spec, "none", len))
+        return CCNL_FRAG_NONE;
+    if (len == 8 && !strncmp(spec, "seqd2012", len))
+        return CCNL_FRAG_SEQUENCED2012;
+    if (len == 8 && !strncmp(spec, "ccnx2013", len))
+        return CCNL_FRAG_CCNx2013;
+    return -1;
+}
+
+// apply the options of a FRAG string (only check them if e is NULL),
+// -1 for an unknown one
+int
+ccnl_frag_setopts(struct ccnl_frag_s *e, char *spec)
+{
+    char *cp = strchr(spec, ','), *end;
+    int len, n, k;
+
+    while (cp) {
+        cp++;
+        len = strcspn(cp, ",");
+        if (len == 3 && !strncmp(cp, "arq", len)) {
+            if (e)
+                e->flags |= CCNL_FRAG_FLAGS_ARQ;
+        } else if (len > 4 && !strncmp(cp, "fec=", 4)) {
+            n = strtol(cp + 4, &end, 10);
+            if (*end != '/')
+                return -1;
+            k = strtol(end + 1, &end, 10);
+            if (end != cp + len || n < 1 || n > CCNL_FRAG_FECMAXN ||
+                                   k < 1 || k > CCNL_FRAG_FECMAXK)
+                return -1;
+            if (e) {
+                e->flags |= CCNL_FRAG_FLAGS_FEC;
+                e->fecn = n;
+                e->feck = k;
+            }
+        } else
+            return -1;
+        cp = strchr(cp, ',');
+    }
+    return 0;
+}
+
 void
 ccnl_frag_reset(struct ccnl_frag_s *e, struct ccnl_buf_s *buf,
                   int ifndx, sockunion *dst)
@@ -86,62 +158,119 @@ ccnl_frag_reset(struct ccnl_frag_s *e, struct ccnl_buf_s *buf,
     e->sendoffs = 0;
 }
 
+int
+ccnl_frag_nomorefragments(struct ccnl_frag_s *e)
+{
+    if (!e || !e->bigpkt)
+        return 1;
+    return e->bigpkt->datalen <= e->sendoffs;
+}
+
+// ----------------------------------------------------------------------
+// fragment sizes, computed from the ccnb encoding rules instead of
+// encoding trial headers
+
+// length of a ccnb header (tag or blob length) for value num
+static int
+ccnl_frag_hdrsize(unsigned int num)
+{
+    int len = 1;
+
+    for (num >>= 4; num > 0; num >>= 7)
+        len++;
+    return len;
+}
+
+// length of a ccnl_ccnb_mkBinaryInt() field with fixed width
+#define ccnl_frag_intsize(dtag, width) \
+    (ccnl_frag_hdrsize(dtag) + ccnl_frag_hdrsize(width) + (width) + 1)
+
+// header bytes up to and including the content tag, i.e. all but the
+// blob header which depends on the payload length
+static int
+ccnl_frag_fixedsize(struct ccnl_frag_s *e)
+{
+    switch (e->protocol) {
+    case CCNL_FRAG_SEQUENCED2012:
+        return ccnl_frag_hdrsize(CCNL_DTAG_FRAGMENT2012) +
+            ccnl_frag_intsize(CCNL_DTAG_FRAG2012_FLAGS, e->flagwidth) +
+            ccnl_frag_intsize(CCNL_DTAG_FRAG2012_YSEQN, e->recvseqwidth) +
+            ccnl_frag_intsize(CCNL_DTAG_FRAG2012_OLOSS, e->losscountwidth) +
+            ccnl_frag_intsize(CCNL_DTAG_FRAG2012_SEQNR, e->sendseqwidth) +
+            ccnl_frag_hdrsize(CCN_DTAG_CONTENT);
+    case CCNL_FRAG_CCNx2013:
+        return ccnl_frag_hdrsize(CCNL_DTAG_FRAGMENT2013) +
+            ccnl_frag_hdrsize(CCNL_DTAG_FRAG2013_TYPE) + 5 + // 3 byte blob
+            ccnl_frag_intsize(CCNL_DTAG_FRAG2013_SEQNR, e->sendseqwidth) +
+            ccnl_frag_intsize(CCNL_DTAG_FRAG2013_FLAGS, e->flagwidth) +
+            ccnl_frag_hdrsize(CCN_DTAG_CONTENT);
+    default:
+        break;
+    }
+    return -1;
+}
+
+// the same for a FEC repair fragment
+static int
+ccnl_frag_fecfixedsize(struct ccnl_frag_s *e)
+{
+    int len = ccnl_frag_intsize(CCNL_DTAG_FRAG2012_FECSEQ, e->sendseqwidth) +
+        ccnl_frag_intsize(CCNL_DTAG_FRAG2012_FECINFO, 2) +
+        ccnl_frag_hdrsize(CCN_DTAG_CONTENT);
+
+    switch (e->protocol) {
+    case CCNL_FRAG_SEQUENCED2012:
+        return len + ccnl_frag_hdrsize(CCNL_DTAG_FRAGMENT2012);
+    case CCNL_FRAG_CCNx2013:
+        return len + ccnl_frag_hdrsize(CCNL_DTAG_FRAGMENT2013) +
+            ccnl_frag_hdrsize(CCNL_DTAG_FRAG2013_TYPE) + 5;
+    default:
+        break;
+    }
+    return -1;
+}
+
+// content bytes which fit into the MTU after hdrlen header bytes (two
+// end-of-element bytes follow the content)
+static int
+ccnl_frag_payload(int mtu, int hdrlen)
+{
+    if (hdrlen < 0 || mtu - hdrlen - 2 <= 0)
+        return -1;
+    return mtu - hdrlen - ccnl_frag_hdrsize(mtu - hdrlen - 2) - 2;
+}
+
+// payload bytes carried by a full fragment. With FEC, a repair fragment
+// must fit, too: it carries the longest payload plus 3 bytes
+static int
+ccnl_frag_maxpayload(struct ccnl_frag_s *e)
+{
+    int len = ccnl_frag_payload(e->mtu, ccnl_frag_fixedsize(e)), fec;
+
+    if (e->flags & CCNL_FRAG_FLAGS_FEC) {
+        fec = ccnl_frag_payload(e->mtu, ccnl_frag_fecfixedsize(e)) - 3;
+        if (fec < len)
+            len = fec;
+    }
+    return len > 0 ? len : -1;
+}
+
 int
 ccnl_frag_getfragcount(struct ccnl_frag_s *e, int origlen, int *totallen)
 {
-    int cnt = 0, len = 0;
-    unsigned char dummy[256];
-    int hdrlen, blobtaglen, datalen;
-    int offs = 0;
+    int cnt = 1, len = origlen, maxlen;
 
-    if (!e)
-      cnt = 1;
-    else if (e && e->protocol == CCNL_FRAG_SEQUENCED2012) {
-      while (offs < origlen) { // we could do better than to simulate this:
-        hdrlen = ccnl_ccnb_mkHeader(dummy, CCNL_DTAG_FRAGMENT2012, CCN_TT_DTAG);
-        hdrlen += ccnl_ccnb_mkBinaryInt(dummy, CCNL_DTAG_FRAG2012_FLAGS, CCN_TT_DTAG,
-                              0, e->flagwidth);
-        hdrlen += ccnl_ccnb_mkBinaryInt(dummy, CCNL_DTAG_FRAG2012_SEQNR, CCN_TT_DTAG,
-                              0, e->sendseqwidth);
-        hdrlen += ccnl_ccnb_mkBinaryInt(dummy, CCNL_DTAG_FRAG2012_OLOSS, CCN_TT_DTAG,
-                              0, e->losscountwidth);
-        hdrlen += ccnl_ccnb_mkBinaryInt(dummy, CCNL_DTAG_FRAG2012_YSEQN, CCN_TT_DTAG,
-                              0, e->recvseqwidth);
-
-        hdrlen += ccnl_ccnb_mkHeader(dummy, CCN_DTAG_CONTENT, CCN_TT_DTAG);
-        blobtaglen = ccnl_ccnb_mkHeader(dummy, e->mtu - hdrlen - 1, CCN_TT_BLOB);
-        datalen = e->mtu - hdrlen - blobtaglen - 1;
-        if (datalen > (origlen - offs))
-            datalen = origlen - offs;
-        hdrlen += ccnl_ccnb_mkHeader(dummy, datalen, CCN_TT_BLOB);
-        len += hdrlen + datalen + 1;
-        offs += datalen;
-        cnt++;
-      }
-    } else if (e && e->protocol == CCNL_FRAG_CCNx2013) {
-      while (offs < origlen) { // we could do better than to simulate this:
-        hdrlen = ccnl_ccnb_mkHeader(dummy, CCNL_DTAG_FRAGMENT2013, CCN_TT_DTAG);
-        hdrlen += ccnl_ccnb_mkHeader(dummy, CCNL_DTAG_FRAG2013_TYPE, CCN_TT_DTAG);
-        hdrlen += 4; // three BLOB bytes plus end-of-entry
-        hdrlen += ccnl_ccnb_mkBinaryInt(dummy, CCNL_DTAG_FRAG2013_SEQNR, CCN_TT_DTAG,
-                              0, e->sendseqwidth);
-        hdrlen += ccnl_ccnb_mkBinaryInt(dummy, CCNL_DTAG_FRAG2013_FLAGS, CCN_TT_DTAG,
-                              0, e->flagwidth);
-        hdrlen += ccnl_ccnb_mkBinaryInt(dummy, CCNL_DTAG_FRAG2013_OLOSS, CCN_TT_DTAG,
-                              0, e->losscountwidth);
-        hdrlen += ccnl_ccnb_mkBinaryInt(dummy, CCNL_DTAG_FRAG2013_YSEQN, CCN_TT_DTAG,
-                              0, e->recvseqwidth);
-
-        hdrlen += ccnl_ccnb_mkHeader(dummy, CCN_DTAG_CONTENT, CCN_TT_DTAG);
-        blobtaglen = ccnl_ccnb_mkHeader(dummy, e->mtu - hdrlen - 1, CCN_TT_BLOB);
-        datalen = e->mtu - hdrlen - blobtaglen - 1;
-        if (datalen > (origlen - offs))
-            datalen = origlen - offs;
-        hdrlen += ccnl_ccnb_mkHeader(dummy, datalen, CCN_TT_BLOB);
-        len += hdrlen + datalen + 1;
-        offs += datalen;
-        cnt++;
-      }
+    if (e && (e->protocol == CCNL_FRAG_SEQUENCED2012 ||
+              e->protocol == CCNL_FRAG_CCNx2013)) {
+        maxlen = ccnl_frag_maxpayload(e);
+        if (maxlen <= 0) {
+            cnt = len = 0;
+        } else {
+            cnt = origlen > maxlen ? (origlen + maxlen - 1) / maxlen : 1;
+            len += cnt * (ccnl_frag_fixedsize(e) + 2) +
+                (cnt - 1) * ccnl_frag_hdrsize(maxlen) +
+                ccnl_frag_hdrsize(origlen - (cnt - 1) * maxlen);
+        }
     }
 
     if (totallen)
@@ -149,130 +278,284 @@ ccnl_frag_getfragcount(struct ccnl_frag_s *e, int origlen, int *totallen)
     return cnt;
 }
 
-struct ccnl_buf_s*
-ccnl_frag_getnextSEQD2012(struct ccnl_frag_s *e, int *ifndx, sockunion *su)
-{
-    struct ccnl_buf_s *buf = 0;
-    unsigned char header[256];
-    int hdrlen = 0, blobtaglen, flagoffs;
-    unsigned int datalen;
-
-    DEBUGMSG(TRACE, "ccnl_frag_getnextSEQD2012 e=%p, mtu=%d\n", (void*)e, e->mtu);
-    DEBUGMSG(TRACE, "  %d bytes to fragment, offset=%d\n",
-             e->bigpkt->datalen, e->sendoffs);
-
-    hdrlen = ccnl_ccnb_mkHeader(header, CCNL_DTAG_FRAGMENT2012, CCN_TT_DTAG);
-    hdrlen += ccnl_ccnb_mkBinaryInt(header + hdrlen, CCNL_DTAG_FRAG2012_FLAGS,
-                          CCN_TT_DTAG, 0, e->flagwidth);
-    flagoffs = hdrlen - 2;
-    hdrlen += ccnl_ccnb_mkBinaryInt(header + hdrlen, CCNL_DTAG_FRAG2012_YSEQN,
-                          CCN_TT_DTAG, e->recvseq, e->recvseqwidth);
-    hdrlen += ccnl_ccnb_mkBinaryInt(header+hdrlen, CCNL_DTAG_FRAG2012_OLOSS, CCN_TT_DTAG,
-                          e->losscount, e->losscountwidth);
-
-    hdrlen += ccnl_ccnb_mkBinaryInt(header + hdrlen, CCNL_DTAG_FRAG2012_SEQNR,
-                          CCN_TT_DTAG, e->sendseq, e->sendseqwidth);
-    hdrlen += ccnl_ccnb_mkHeader(header+hdrlen, CCN_DTAG_CONTENT, CCN_TT_DTAG);
-    blobtaglen = ccnl_ccnb_mkHeader(header+hdrlen, e->mtu - hdrlen - 2, CCN_TT_BLOB);
-
-    datalen = e->mtu - hdrlen - blobtaglen - 2;
-    if (datalen > (e->bigpkt->datalen - e->sendoffs))
-        datalen = e->bigpkt->datalen - e->sendoffs;
-    hdrlen += ccnl_ccnb_mkHeader(header + hdrlen, datalen, CCN_TT_BLOB);
+// the "FHBH" pdu type field of CCNx2013
+static int
+ccnl_frag_mktype2013(unsigned char *out)
+{
+    int len;
 
-    buf = ccnl_buf_new(NULL, hdrlen + datalen + 2);
-    if (!buf)
-        return NULL;
-    memcpy(buf->data, header, hdrlen);
-    memcpy(buf->data + hdrlen, e->bigpkt->data + e->sendoffs, datalen);
-    buf->data[hdrlen + datalen] = '\0'; // end of content/any field
-    buf->data[hdrlen + datalen + 1] = '\0'; // end of fragment/pdu
-
-    if (datalen >= e->bigpkt->datalen) { // fits in a single fragment
-        buf->data[flagoffs + e->flagwidth - 1] =
-            CCNL_DTAG_FRAG_FLAG_FIRST | CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(e->bigpkt);
-        e->bigpkt = NULL;
-    } else if (e->sendoffs == 0) // this is the start fragment
-        buf->data[flagoffs + e->flagwidth - 1] = CCNL_DTAG_FRAG_FLAG_FIRST;
-    else if(datalen >= (e->bigpkt->datalen - e->sendoffs)) { // the end
-        buf->data[flagoffs + e->flagwidth - 1] = CCNL_DTAG_FRAG_FLAG_LAST;
-        ccnl_free(e->bigpkt);
-        e->bigpkt = NULL;
-    } else // in the middle
-        buf->data[flagoffs + e->flagwidth - 1] = 0x00;
+    len = ccnl_ccnb_mkHeader(out, CCNL_DTAG_FRAG2013_TYPE, CCN_TT_DTAG);
+    len += ccnl_ccnb_mkHeader(out + len, 3, CCN_TT_BLOB);
+    memcpy(out + len, CCNL_FRAG_TYPE_CCNx2013_VAL, 3);
+    out[len + 3] = '\0';
+    return len + 4;
+}
 
-    e->sendoffs += datalen;
-    e->sendseq++;
+// the start of a fragment PDU (tag, and type for CCNx2013), -1 for
+// an unknown protocol
+static int
+ccnl_frag_mkcontainer(int protocol, unsigned char *out)
+{
+    int len;
 
-    DEBUGMSG(DEBUG, "  e->offset now %d\n", e->sendoffs);
+    switch (protocol) {
+    case CCNL_FRAG_SEQUENCED2012:
+        return ccnl_ccnb_mkHeader(out, CCNL_DTAG_FRAGMENT2012, CCN_TT_DTAG);
+    case CCNL_FRAG_CCNx2013:
+        len = ccnl_ccnb_mkHeader(out, CCNL_DTAG_FRAGMENT2013, CCN_TT_DTAG);
+        return len + ccnl_frag_mktype2013(out + len);
+    default:
+        break;
+    }
+    return -1;
+}
 
-    if (ifndx)
-        *ifndx = e->ifndx;
-    if (su)
-        memcpy(su, &e->dest, sizeof(*su));
-    return buf;
+// ----------------------------------------------------------------------
+// forward error correction: a systematic Reed-Solomon code over GF(2^8).
+// The symbol of data fragment j of a block is (flags, length, payload),
+// zero padded to the longest one, repair r is the sum of c(r,j) * symbol
+// over the block. The coefficients form a Cauchy matrix: any m repairs
+// give m independent equations for m lost fragments.
+
+static unsigned char gf_exp[512], gf_log[256];
+
+static void
+ccnl_frag_gf_init(void)
+{
+    int i, x = 1;
+
+    if (gf_exp[0])
+        return;
+    for (i = 0; i < 255; i++) {
+        gf_exp[i] = gf_exp[i + 255] = x;
+        gf_log[x] = i;
+        x <<= 1;
+        if (x & 0x100)
+            x ^= 0x11d;
+    }
+}
+
+static unsigned char
+ccnl_frag_gf_mul(unsigned char a, unsigned char b)
+{
+    return a && b ? gf_exp[gf_log[a] + gf_log[b]] : 0;
+}
+
+static unsigned char
+ccnl_frag_gf_inv(unsigned char a)
+{
+    return gf_exp[255 - gf_log[a]];
 }
 
+// dst += c * src
+static void
+ccnl_frag_gf_addmul(unsigned char *dst, unsigned char *src,
+                    unsigned char c, int len)
+{
+    int i, lc;
+
+    if (!c)
+        return;
+    lc = gf_log[c];
+    for (i = 0; i < len; i++)
+        if (src[i])
+            dst[i] ^= gf_exp[lc + gf_log[src[i]]];
+}
+
+// coefficient of data fragment j (< 128) in repair r
+#define FEC_COEF(r,j)   ccnl_frag_gf_inv((128 + (r)) ^ (j))
+
+// the block is closed: encode its repair fragments into e->fecout. A
+// partial block gets fewer of them, in proportion (but at least one)
+static void
+ccnl_frag_fec_mkrepair(struct ccnl_frag_s *e)
+{
+    struct ccnl_buf_s *buf, **pp = &e->fecout;
+    unsigned char hdr[64];
+    int r, len, cnt = (e->feck * e->feccnt + e->fecn - 1) / e->fecn;
+
+    while (*pp)
+        pp = &(*pp)->next;
+    for (r = 0; r < cnt && e->fecrep[r]; r++) {
+        len = ccnl_frag_mkcontainer(e->protocol, hdr);
+        len += ccnl_ccnb_mkBinaryInt(hdr + len, CCNL_DTAG_FRAG2012_FECSEQ,
+                              CCN_TT_DTAG, e->fecbase, e->sendseqwidth);
+        len += ccnl_ccnb_mkBinaryInt(hdr + len, CCNL_DTAG_FRAG2012_FECINFO,
+                              CCN_TT_DTAG, e->feccnt << 8 | r, 2);
+        len += ccnl_ccnb_mkHeader(hdr + len, CCN_DTAG_CONTENT, CCN_TT_DTAG);
+        len += ccnl_ccnb_mkHeader(hdr + len, e->feclen, CCN_TT_BLOB);
+        buf = ccnl_buf_new(NULL, len + e->feclen + 2);
+        if (!buf)
+            break;
+        memcpy(buf->data, hdr, len);
+        memcpy(buf->data + len, e->fecrep[r]->data, e->feclen);
+        buf->data[len + e->feclen] = '\0'; // end of content field
+        buf->data[len + e->feclen + 1] = '\0'; // end of fragment
+        *pp = buf;
+        pp = &buf->next;
+        e->fecsent++;
+    }
+    e->feccnt = 0;
+}
+
+// add data fragment seq to the sums of the current block
+static void
+ccnl_frag_fec_add(struct ccnl_frag_s *e, unsigned int seq,
+                  unsigned char flags, unsigned char *data, int len)
+{
+    unsigned char sym[3], c;
+    int r, size;
+
+    if (!e->feccnt) {
+        ccnl_frag_gf_init();
+        size = ccnl_frag_maxpayload(e) + 3;
+        for (r = 0; r < e->feck; r++) {
+            if (e->fecrep[r] && e->fecrep[r]->datalen < size) {
+                ccnl_free(e->fecrep[r]);
+                e->fecrep[r] = NULL;
+            }
+            if (!e->fecrep[r])
+                e->fecrep[r] = ccnl_buf_new(NULL, size);
+            if (!e->fecrep[r])
+                return;
+            memset(e->fecrep[r]->data, 0, size);
+        }
+        e->fecbase = seq;
+        e->feclen = 0;
+    }
+    sym[0] = flags;
+    sym[1] = len >> 8;
+    sym[2] = len;
+    for (r = 0; r < e->feck; r++) {
+        c = FEC_COEF(r, seq - e->fecbase);
+        ccnl_frag_gf_addmul(e->fecrep[r]->data, sym, c, 3);
+        ccnl_frag_gf_addmul(e->fecrep[r]->data + 3, data, c, len);
+    }
+    if (len + 3 > e->feclen)
+        e->feclen = len + 3;
+    if (++e->feccnt >= e->fecn)
+        ccnl_frag_fec_mkrepair(e);
+}
+
+// the next repair fragment to send. With flush (nothing more to send
+// for now), a partial block is closed first
 struct ccnl_buf_s*
-ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
+ccnl_frag_fec_getnext(struct ccnl_frag_s *e, int flush)
 {
-    struct ccnl_buf_s *buf = 0;
-    unsigned char header[256];
-    int hdrlen, blobtaglen, flagoffs;
-    unsigned int datalen;
+    struct ccnl_buf_s *buf;
 
-    // switch among encodings of fragments here (ccnb, TLV, etc)
+    if (!e || !(e->flags & CCNL_FRAG_FLAGS_FEC))
+        return NULL;
+    if (flush && e->feccnt && !e->bigpkt)
+        ccnl_frag_fec_mkrepair(e);
+    buf = e->fecout;
+    if (buf) {
+        e->fecout = buf->next;
+        buf->next = NULL;
+    }
+    return buf;
+}
 
-    hdrlen = ccnl_ccnb_mkHeader(header, CCNL_DTAG_FRAGMENT2013, CCN_TT_DTAG); // fragment
+void
+ccnl_frag_fec_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    struct ccnl_buf_s *buf;
 
-    hdrlen += ccnl_ccnb_mkHeader(header + hdrlen, CCNL_DTAG_FRAG2013_TYPE, CCN_TT_DTAG);
-    hdrlen += ccnl_ccnb_mkHeader(header + hdrlen, 3, CCN_TT_BLOB);
-    memcpy(header + hdrlen, CCNL_FRAG_TYPE_CCNx2013_VAL, 3); // "FHBH"
-    header[hdrlen + 3] = '\0';
-    hdrlen += 4;
+    if (f->ifndx < 0)
+        return;
+    while ((buf = ccnl_frag_fec_getnext(f->frag, !f->outq)) != NULL)
+        ccnl_interface_enqueue(NULL, NULL, ccnl, ccnl->ifs + f->ifndx,
+                               buf, &f->peer);
+}
 
-    hdrlen += ccnl_ccnb_mkBinaryInt(header+hdrlen, CCNL_DTAG_FRAG2013_SEQNR, CCN_TT_DTAG,
-                          fr->sendseq, fr->sendseqwidth);
+// encode the header of the next fragment into hdr and return its length.
+// The fragment's payload is the slice (*data, *datalen) of the big packet,
+// it must be followed by two end-of-element bytes.
+static int
+ccnl_frag_mkhdr(struct ccnl_frag_s *fr, unsigned char *hdr,
+                unsigned char **data, int *datalen)
+{
+    int hdrlen, flagoffs, maxlen, rest = fr->bigpkt->datalen - fr->sendoffs;
 
-    hdrlen += ccnl_ccnb_mkBinaryInt(header+hdrlen, CCNL_DTAG_FRAG2013_FLAGS, CCN_TT_DTAG,
-                          0, fr->flagwidth);
-    flagoffs = hdrlen - 2; // most significant byte of flag element
+    maxlen = ccnl_frag_maxpayload(fr);
+    if (maxlen <= 0)
+        return -1;
 
-    // other optional fields would go here
+    switch (fr->protocol) {
+    case CCNL_FRAG_SEQUENCED2012:
+        hdrlen = ccnl_ccnb_mkHeader(hdr, CCNL_DTAG_FRAGMENT2012, CCN_TT_DTAG);
+        hdrlen += ccnl_ccnb_mkBinaryInt(hdr + hdrlen, CCNL_DTAG_FRAG2012_FLAGS,
+                              CCN_TT_DTAG, 0, fr->flagwidth);
+        flagoffs = hdrlen - 2; // least significant byte of the flags
+        hdrlen += ccnl_ccnb_mkBinaryInt(hdr + hdrlen, CCNL_DTAG_FRAG2012_YSEQN,
+                              CCN_TT_DTAG, fr->recvseq, fr->recvseqwidth);
+        hdrlen += ccnl_ccnb_mkBinaryInt(hdr + hdrlen, CCNL_DTAG_FRAG2012_OLOSS,
+                              CCN_TT_DTAG, fr->losscount, fr->losscountwidth);
+        hdrlen += ccnl_ccnb_mkBinaryInt(hdr + hdrlen, CCNL_DTAG_FRAG2012_SEQNR,
+                              CCN_TT_DTAG, fr->sendseq, fr->sendseqwidth);
+        break;
+    case CCNL_FRAG_CCNx2013:
+        // switch among encodings of fragments here (ccnb, TLV, etc)
+        hdrlen = ccnl_ccnb_mkHeader(hdr, CCNL_DTAG_FRAGMENT2013, CCN_TT_DTAG);
+        hdrlen += ccnl_frag_mktype2013(hdr + hdrlen);
+        hdrlen += ccnl_ccnb_mkBinaryInt(hdr + hdrlen, CCNL_DTAG_FRAG2013_SEQNR,
+                              CCN_TT_DTAG, fr->sendseq, fr->sendseqwidth);
+        hdrlen += ccnl_ccnb_mkBinaryInt(hdr + hdrlen, CCNL_DTAG_FRAG2013_FLAGS,
+                              CCN_TT_DTAG, 0, fr->flagwidth);
+        flagoffs = hdrlen - 2;
+        // other optional fields would go here
+        break;
+    default:
+        return -1;
+    }
+    hdrlen += ccnl_ccnb_mkHeader(hdr + hdrlen, CCN_DTAG_CONTENT, CCN_TT_DTAG);
+
+    *datalen = rest < maxlen ? rest : maxlen;
+    *data = fr->bigpkt->data + fr->sendoffs;
+    hdrlen += ccnl_ccnb_mkHeader(hdr + hdrlen, *datalen, CCN_TT_BLOB);
+
+    // FIRST|LAST is a single fragment, none of them a middle one
+    hdr[flagoffs] = (fr->sendoffs == 0 ? CCNL_DTAG_FRAG_FLAG_FIRST : 0) |
+                    (*datalen >= rest ? CCNL_DTAG_FRAG_FLAG_LAST : 0) |
+                    (fr->flags & CCNL_FRAG_FLAGS_ARQ ?
+                                        CCNL_DTAG_FRAG_FLAG_ACKREQ : 0) |
+                    (fr->flags & CCNL_FRAG_FLAGS_FEC ?
+                                        CCNL_DTAG_FRAG_FLAG_FEC : 0);
+    if (fr->flags & CCNL_FRAG_FLAGS_FEC)
+        ccnl_frag_fec_add(fr, fr->sendseq, hdr[flagoffs], *data, *datalen);
+
+    fr->sendoffs += *datalen;
+    fr->sendseq++;
 
-    hdrlen += ccnl_ccnb_mkHeader(header+hdrlen, CCN_DTAG_CONTENT, CCN_TT_DTAG);
+    return hdrlen;
+}
 
-    blobtaglen = ccnl_ccnb_mkHeader(header + hdrlen, fr->mtu - hdrlen - 2, CCN_TT_BLOB);
-    datalen = fr->mtu - hdrlen - blobtaglen - 2;
-    if (datalen > (fr->bigpkt->datalen - fr->sendoffs))
-        datalen = fr->bigpkt->datalen - fr->sendoffs;
-    hdrlen += ccnl_ccnb_mkHeader(header + hdrlen, datalen, CCN_TT_BLOB);
+struct ccnl_buf_s*
+ccnl_frag_getnext(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
+{
+    struct ccnl_buf_s *buf;
+    unsigned char header[256], *data;
+    int hdrlen, datalen;
 
-    buf = ccnl_buf_new(NULL, hdrlen + datalen + 2);
-    if (!buf)
+    if (!fr->bigpkt) return NULL;
+
+    DEBUGMSG(TRACE, "fragmenting %d bytes (@ %d)\n",
+                                fr->bigpkt->datalen, fr->sendoffs);
+
+    hdrlen = ccnl_frag_mkhdr(fr, header, &data, &datalen);
+    if (hdrlen < 0)
         return NULL;
-    memcpy(buf->data, header, hdrlen);
-    memcpy(buf->data + hdrlen, fr->bigpkt->data + fr->sendoffs, datalen);
-    buf->data[hdrlen + datalen] = '\0'; // end of content field
-    buf->data[hdrlen + datalen + 1] = '\0'; // end of fragment
-
-    // patch flag field:
-    if (datalen >= fr->bigpkt->datalen) { // single
-        buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_SINGLE;
-        ccnl_free(fr->bigpkt);
-        fr->bigpkt = NULL;
-    } else if (fr->sendoffs == 0) // start
-        buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_FIRST;
-    else if(datalen >= (fr->bigpkt->datalen - fr->sendoffs)) { // end
-        buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_LAST;
+    buf = ccnl_buf_new(NULL, hdrlen + datalen + 2);
+    if (buf) {
+        memcpy(buf->data, header, hdrlen);
+        memcpy(buf->data + hdrlen, data, datalen);
+        buf->data[hdrlen + datalen] = '\0'; // end of content field
+        buf->data[hdrlen + datalen + 1] = '\0'; // end of fragment
+    }
+    if (ccnl_frag_nomorefragments(fr)) {
         ccnl_free(fr->bigpkt);
         fr->bigpkt = NULL;
-    } else
-        buf->data[flagoffs] = CCNL_DTAG_FRAG_FLAG_MID;
-
-    fr->sendoffs += datalen;
-    fr->sendseq++;
+    }
 
     if (ifndx)
         *ifndx = fr->ifndx;
@@ -282,37 +565,532 @@ ccnl_frag_getnextCCNx2013(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
     return buf;
 }
 
+#if defined(CCNL_UNIX) && !defined(USE_SCHEDULER)
+// send all fragments of the big packet right away, each as a gather
+// list (header, payload slice, trailer): the payload is not copied
+int
+ccnl_frag_TXv(struct ccnl_relay_s *ccnl, struct ccnl_frag_s *fr)
+{
+    static unsigned char trailer[2]; // end of content and of fragment
+    unsigned char header[256], *data;
+    struct iovec iov[3];
+    int hdrlen, datalen, cnt = 0;
+
+    while (fr->bigpkt) {
+        hdrlen = ccnl_frag_mkhdr(fr, header, &data, &datalen);
+        if (hdrlen < 0)
+            break;
+        iov[0].iov_base = header;
+        iov[0].iov_len = hdrlen;
+        iov[1].iov_base = data;
+        iov[1].iov_len = datalen;
+        iov[2].iov_base = trailer;
+        iov[2].iov_len = sizeof(trailer);
+        ccnl_ll_TXv(ccnl, ccnl->ifs + fr->ifndx, &fr->dest, iov, 3);
+        cnt++;
+        if (ccnl_frag_nomorefragments(fr)) {
+            ccnl_free(fr->bigpkt);
+            fr->bigpkt = NULL;
+        }
+    }
+    DEBUGMSG(TRACE, "ccnl_frag_TXv: %d fragments\n", cnt);
 
-struct ccnl_buf_s*
-ccnl_frag_getnext(struct ccnl_frag_s *fr, int *ifndx, sockunion *su)
+    return cnt;
+}
+#endif
+
+// ----------------------------------------------------------------------
+// hop-by-hop ARQ (selective repeat): with CCNL_FRAG_FLAGS_ARQ, fragments
+// ask for an ack and are kept until the peer has them. A kept fragment is
+// sent again when one sent after it is acked (it got lost or reordered),
+// or when it is older than the RTO. At most CCNL_FRAG_TXWINDOW fragments
+// are unacked, which the peer's reassembly window can hold.
+
+#define TX_IDX(s)       ((s) % CCNL_FRAG_TXWINDOW)
+
+static void ccnl_frag_arq_timeout(void *ptr, void *aux);
+
+// (re)transmit kept fragment seq, the interface gets a copy
+static void
+ccnl_frag_arq_send(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f,
+                   unsigned int seq, void (*txdone)(void*, int, int))
 {
-    if (!fr->bigpkt) return NULL;
+    struct ccnl_frag_s *e = f->frag;
+    struct ccnl_buf_s *buf = e->txslot[TX_IDX(seq)];
+
+    ccnl_get_timeval(&e->txtime[TX_IDX(seq)]);
+    e->txstamp[TX_IDX(seq)] = ++e->txclock;
+    if (e->txcnt[TX_IDX(seq)]++ > 0) {
+        DEBUGMSG(DEBUG, "  retransmitting fragment %u (%d)\n",
+                 seq, e->txcnt[TX_IDX(seq)]);
+        e->retransmits++;
+    }
+    buf = ccnl_buf_new(buf->data, buf->datalen);
+    if (buf)
+        ccnl_interface_enqueue(txdone, f, ccnl, ccnl->ifs + e->ifndx,
+                               buf, &e->dest);
+}
 
-    DEBUGMSG(TRACE, "fragmenting %d bytes (@ %d)\n",
-                                fr->bigpkt->datalen, fr->sendoffs);
+static void
+ccnl_frag_arq_settimer(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    struct ccnl_frag_s *e = f->frag;
 
-    switch (fr->protocol) {
-    case CCNL_FRAG_SEQUENCED2012:
-        return ccnl_frag_getnextSEQD2012(fr, ifndx, su);
-    case CCNL_FRAG_CCNx2013:
-        return ccnl_frag_getnextCCNx2013(fr, ifndx, su);
-    default:
+    if (e->txtimer) {
+        ccnl_rem_timer(e->txtimer);
+        e->txtimer = NULL;
+    }
+    if (e->txbase != e->sendseq)
+        e->txtimer = ccnl_set_timer(e->rto, ccnl_frag_arq_timeout, ccnl, f);
+}
+
+// move txbase past the fragments which are no longer kept
+static void
+ccnl_frag_arq_advance(struct ccnl_frag_s *e)
+{
+    while (e->txbase != e->sendseq && !e->txslot[TX_IDX(e->txbase)])
+        e->txbase++;
+}
+
+static int
+ccnl_frag_arq_full(struct ccnl_frag_s *e)
+{
+    return (int)(e->sendseq - e->txbase) >= CCNL_FRAG_TXWINDOW;
+}
+
+// send the face's packets as fragments, as far as the window allows
+void
+ccnl_frag_arq_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    struct ccnl_frag_s *e = f->frag;
+    struct ccnl_buf_s *buf;
+
+    while (!ccnl_frag_arq_full(e)) {
+        buf = ccnl_frag_getnext(e, NULL, NULL);
+        if (!buf) {
+            buf = ccnl_face_dequeue(ccnl, f);
+            if (!buf)
+                break;
+            ccnl_frag_reset(e, buf, f->ifndx, &f->peer);
+            buf = ccnl_frag_getnext(e, NULL, NULL);
+            if (!buf)
+                break;
+        }
+        e->txslot[TX_IDX(e->sendseq - 1)] = buf;
+        e->txcnt[TX_IDX(e->sendseq - 1)] = 0;
+        ccnl_frag_arq_send(ccnl, f, e->sendseq - 1, ccnl_face_CTS_done);
+        if (!e->txtimer)
+            ccnl_frag_arq_settimer(ccnl, f);
+#ifdef USE_SCHEDULER
+        break; // one per CTS
+#endif
+    }
+    ccnl_frag_fec_CTS(ccnl, f);
+}
+
+// the peer has fragment seq: drop our copy, and take an RTT sample
+// unless it was sent more than once
+static void
+ccnl_frag_arq_acked(struct ccnl_frag_s *e, unsigned int seq,
+                    struct timeval *now, unsigned int *newest)
+{
+    int i = TX_IDX(seq);
+    long rtt;
+
+    if (!e->txslot[i])
+        return;
+    if (e->txcnt[i] == 1) {
+        rtt = timevaldelta(now, &e->txtime[i]);
+        if (rtt < 1)
+            rtt = 1;
+        if (!e->srtt) {
+            e->srtt = rtt;
+            e->rttvar = rtt / 2;
+        } else {
+            e->rttvar += ((rtt > e->srtt ? rtt - e->srtt : e->srtt - rtt) -
+                          e->rttvar) / 4;
+            e->srtt += (rtt - e->srtt) / 8;
+        }
+        e->rto = e->srtt + 4 * e->rttvar;
+        if (e->rto < CCNL_FRAG_RTOMIN)
+            e->rto = CCNL_FRAG_RTOMIN;
+        if (e->rto > CCNL_FRAG_RTOMAX)
+            e->rto = CCNL_FRAG_RTOMAX;
+    }
+    if (!*newest || (int)(e->txstamp[i] - *newest) > 0)
+        *newest = e->txstamp[i];
+    ccnl_free(e->txslot[i]);
+    e->txslot[i] = NULL;
+}
+
+// an ack: the peer has all fragments before cum, and those flagged in
+// bits (bit i for seq cum+1+i)
+static void
+ccnl_frag_arq_RXack(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f,
+                    unsigned int cum, unsigned char *bits, int bitslen)
+{
+    struct ccnl_frag_s *e = f->frag;
+    struct timeval now;
+    unsigned int q, newest = 0;
+    int i, full;
+
+    if (!e || !(e->flags & CCNL_FRAG_FLAGS_ARQ))
+        return;
+    DEBUGMSG(TRACE, "  frag ack %u (unacked %u-%u)\n",
+             cum, e->txbase, e->sendseq);
+    if ((int)(cum - e->sendseq) > 0) {
+        DEBUGMSG(DEBUG, "  >> ack beyond our seq %u, ignored\n", e->sendseq);
+        return;
+    }
+
+    ccnl_get_timeval(&now);
+    full = ccnl_frag_arq_full(e);
+    for (q = e->txbase; (int)(q - cum) < 0; q++)
+        ccnl_frag_arq_acked(e, q, &now, &newest);
+    for (i = 0; i < 8 * bitslen && i < CCNL_FRAG_TXWINDOW - 1; i++) {
+        q = cum + 1 + i;
+        if ((int)(q - e->sendseq) >= 0)
+            break;
+        if ((int)(q - e->txbase) >= 0 && (bits[i / 8] & (1 << (i % 8))))
+            ccnl_frag_arq_acked(e, q, &now, &newest);
+    }
+    ccnl_frag_arq_advance(e);
+
+    // missing, but sent before one which arrived
+    for (q = e->txbase; newest && q != e->sendseq; q++) {
+        i = TX_IDX(q);
+        if (e->txslot[i] && (int)(newest - e->txstamp[i]) > 0)
+            ccnl_frag_arq_send(ccnl, f, q, NULL);
+    }
+    ccnl_frag_arq_settimer(ccnl, f);
+    if (full && !ccnl_frag_arq_full(e))
+        ccnl_face_CTS(ccnl, f);
+}
+
+// no ack for an RTO: send again what is older than that, and back off.
+// A fragment sent CCNL_FRAG_MAXTX times is given up.
+static void
+ccnl_frag_arq_timeout(void *ptr, void *aux)
+{
+    struct ccnl_relay_s *ccnl = (struct ccnl_relay_s*) ptr;
+    struct ccnl_face_s *f = (struct ccnl_face_s*) aux;
+    struct ccnl_frag_s *e = f->frag;
+    struct timeval now;
+    unsigned int q;
+    int i, cnt = 0, full = ccnl_frag_arq_full(e);
+
+    e->txtimer = NULL;
+    ccnl_get_timeval(&now);
+    for (q = e->txbase; q != e->sendseq; q++) {
+        i = TX_IDX(q);
+        if (!e->txslot[i] || timevaldelta(&now, &e->txtime[i]) < e->rto)
+            continue;
+        if (e->txcnt[i] >= CCNL_FRAG_MAXTX) {
+            DEBUGMSG(DEBUG, "  >> fragment %u given up\n", q);
+            ccnl_free(e->txslot[i]);
+            e->txslot[i] = NULL;
+            e->losscount++;
+            continue;
+        }
+        ccnl_frag_arq_send(ccnl, f, q, NULL);
+        cnt++;
+    }
+    DEBUGMSG(DEBUG, "frag ARQ timeout face=%p rto=%d: %d resent\n",
+             (void*) f, e->rto, cnt);
+    if (cnt) {
+        e->rto *= 2;
+        if (e->rto > CCNL_FRAG_RTOMAX)
+            e->rto = CCNL_FRAG_RTOMAX;
+    }
+    ccnl_frag_arq_advance(e);
+    ccnl_frag_arq_settimer(ccnl, f);
+    if (full && !ccnl_frag_arq_full(e))
+        ccnl_face_CTS(ccnl, f);
+}
+
+// ----------------------------------------------------------------------
+// path MTU discovery (CCNL_FRAG_FLAGS_PMTU), as datagram PLPMTUD: probes
+// padded to the size in question go out with the DF bit set, and the
+// peer acks the ones which arrive. The kernel's view of the path (the
+// link MTU, less after an ICMP "fragmentation needed") bounds the search.
+// A probe unacked CCNL_PMTU_MAXPROBES times is too big: so the MTU never
+// depends on IP fragmentation, nor on ICMP getting through. After
+// CCNL_PMTU_RAISETIMEOUT the search starts again, the path may have changed.
+
+static void ccnl_frag_pmtu_timeout(void *ptr, void *aux);
+
+#if defined(CCNL_UNIX) && defined(IP_MTU_DISCOVER) && defined(IP_MTU)
+
+#ifndef IP_PMTUDISC_PROBE
+# define IP_PMTUDISC_PROBE      IP_PMTUDISC_DO
+#endif
+
+// UDP payload bytes the kernel would send to an IPv4 peer, -1 if unknown
+static int
+ccnl_frag_pmtu_kernel(sockunion *peer)
+{
+    int s, mtu = -1;
+    socklen_t len = sizeof(mtu);
+
+    if (peer->sa.sa_family != AF_INET)
+        return -1;
+    s = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0)
+        return -1;
+    if (connect(s, &peer->sa, sizeof(peer->ip4)) ||
+                getsockopt(s, IPPROTO_IP, IP_MTU, &mtu, &len))
+        mtu = -1;
+    else
+        mtu -= 28; // IPv4 and UDP header
+    close(s);
+    return mtu;
+}
+
+// send with DF, ignoring the kernel's PMTU estimate, then restore the
+// socket's setting
+static void
+ccnl_frag_pmtu_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+                  sockunion *peer, struct ccnl_buf_s *buf)
+{
+    int old, probe = IP_PMTUDISC_PROBE, dfset = 0;
+    socklen_t len = sizeof(old);
+
+    if (peer->sa.sa_family == AF_INET &&
+        !getsockopt(ifc->sock, IPPROTO_IP, IP_MTU_DISCOVER, &old, &len))
+        dfset = !setsockopt(ifc->sock, IPPROTO_IP, IP_MTU_DISCOVER,
+                            &probe, sizeof(probe));
+    ccnl_ll_TX(ccnl, ifc, peer, buf);
+    if (dfset)
+        setsockopt(ifc->sock, IPPROTO_IP, IP_MTU_DISCOVER, &old, sizeof(old));
+}
+
+#else
+# define ccnl_frag_pmtu_kernel(peer)            -1
+# define ccnl_frag_pmtu_TX(ccnl, ifc, peer, buf) ccnl_ll_TX(ccnl, ifc, peer, buf)
+#endif
+
+// a probe of (about) size bytes, its PMTUPROBE field holds the exact length
+static struct ccnl_buf_s*
+ccnl_frag_pmtu_mkprobe(int protocol, int size)
+{
+    unsigned char hdr[32];
+    struct ccnl_buf_s *buf;
+    int len, typelen, pad;
+
+    typelen = ccnl_frag_mkcontainer(protocol, hdr);
+    if (typelen < 0)
+        return NULL;
+    len = typelen + ccnl_ccnb_mkBinaryInt(hdr + typelen,
+                 CCNL_DTAG_FRAG2012_PMTUPROBE, CCN_TT_DTAG, 0, 2);
+    len += ccnl_ccnb_mkHeader(hdr + len, CCNL_DTAG_FRAG2012_PAD, CCN_TT_DTAG);
+    pad = size - len - 2; // end of the padding, and of the fragment
+    pad -= ccnl_frag_hdrsize(pad);
+    if (pad < 0)
         return NULL;
+    size = len + ccnl_frag_hdrsize(pad) + pad + 2;
+    buf = ccnl_buf_new(NULL, size);
+    if (!buf)
+        return NULL;
+    memset(buf->data, 0, size);
+    memcpy(buf->data, hdr, len);
+    ccnl_ccnb_mkBinaryInt(buf->data + typelen, CCNL_DTAG_FRAG2012_PMTUPROBE,
+                          CCN_TT_DTAG, size, 2);
+    ccnl_ccnb_mkHeader(buf->data + len, pad, CCN_TT_BLOB);
+    return buf;
+}
+
+// new fragment size. A FEC block in progress is closed: its repairs
+// have the size of the largest fragment in it
+static void
+ccnl_frag_pmtu_setmtu(struct ccnl_frag_s *e, int mtu)
+{
+    if (mtu == e->mtu)
+        return;
+    DEBUGMSG(INFO, "frag path MTU %d -> %d\n", e->mtu, mtu);
+    if (e->feccnt)
+        ccnl_frag_fec_mkrepair(e);
+    e->mtu = mtu;
+}
+
+// the next size to probe, 0 when the search is over: first the bound,
+// else CCNL_PMTU_BASE and CCNL_PMTU_MIN, then bisect above what was acked
+static int
+ccnl_frag_pmtu_nextsize(struct ccnl_frag_s *e)
+{
+    int top = e->pmtuhi - 1;
+
+    if (e->pmtulo)
+        return e->pmtuhi - e->pmtulo > CCNL_PMTU_STEP ?
+                                       (e->pmtulo + e->pmtuhi) / 2 : 0;
+    if (!e->pmtuprobe)
+        return top;
+    if (top > CCNL_PMTU_BASE)
+        return CCNL_PMTU_BASE;
+    if (top > CCNL_PMTU_MIN)
+        return CCNL_PMTU_MIN;
+    return 0;
+}
+
+static void
+ccnl_frag_pmtu_send(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    struct ccnl_frag_s *e = f->frag;
+    struct ccnl_buf_s *buf = ccnl_frag_pmtu_mkprobe(e->protocol, e->pmtuprobe);
+
+    e->pmtutries++;
+    if (buf) {
+        e->pmtuprobe = buf->datalen;
+        DEBUGMSG(DEBUG, "  frag path MTU probe %d (%d)\n",
+                 e->pmtuprobe, e->pmtutries);
+        ccnl_frag_pmtu_TX(ccnl, ccnl->ifs + f->ifndx, &f->peer, buf);
+        ccnl_free(buf);
     }
+    e->pmtutimer = ccnl_set_timer(CCNL_PMTU_PROBETIMEOUT,
+                                  ccnl_frag_pmtu_timeout, ccnl, f);
 }
 
-int
-ccnl_frag_nomorefragments(struct ccnl_frag_s *e)
+// probe the next size, or end the search
+static void
+ccnl_frag_pmtu_next(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 {
-    if (!e || !e->bigpkt)
-        return 1;
-    return e->bigpkt->datalen <= e->sendoffs;
+    struct ccnl_frag_s *e = f->frag;
+    int size = ccnl_frag_pmtu_nextsize(e);
+
+    if (size) {
+        e->pmtuprobe = size;
+        e->pmtutries = 0;
+        ccnl_frag_pmtu_send(ccnl, f);
+        return;
+    }
+    // nothing acked: the peer may not answer probes at all, so do not
+    // go below the base size unless the kernel says so
+    if (e->pmtulo)
+        ccnl_frag_pmtu_setmtu(e, e->pmtulo);
+    else
+        ccnl_frag_pmtu_setmtu(e, e->pmtumax < CCNL_PMTU_BASE ?
+                                 e->pmtumax : CCNL_PMTU_BASE);
+    DEBUGMSG(DEBUG, "  frag path MTU search done, mtu=%d\n", e->mtu);
+    e->pmtuprobe = 0;
+    e->pmtutimer = ccnl_set_timer(CCNL_PMTU_RAISETIMEOUT * 1000000,
+                                  ccnl_frag_pmtu_timeout, ccnl, f);
+}
+
+// (re)start the search on a face whose frag has CCNL_FRAG_FLAGS_PMTU
+void
+ccnl_frag_pmtu_start(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    struct ccnl_frag_s *e = f->frag;
+    int max;
+
+    if (!e || !(e->flags & CCNL_FRAG_FLAGS_PMTU) || f->ifndx < 0)
+        return;
+    if (e->pmtutimer) {
+        ccnl_rem_timer(e->pmtutimer);
+        e->pmtutimer = NULL;
+    }
+    max = ccnl_frag_pmtu_kernel(&f->peer);
+    if (max <= 0 || max > CCNL_MAX_PACKET_SIZE)
+        max = CCNL_MAX_PACKET_SIZE;
+    if (max < CCNL_PMTU_MIN)
+        max = CCNL_PMTU_MIN;
+    e->pmtumax = max;
+    if (e->mtu > max)
+        ccnl_frag_pmtu_setmtu(e, max);
+    e->pmtulo = e->pmtuprobe = 0;
+    e->pmtuhi = max + 1;
+    ccnl_frag_pmtu_next(ccnl, f);
+}
+
+// the peer got our probe of size bytes
+static void
+ccnl_frag_pmtu_RXack(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f,
+                     int size)
+{
+    struct ccnl_frag_s *e = f->frag;
+
+    if (!e || !(e->flags & CCNL_FRAG_FLAGS_PMTU) || !e->pmtuprobe ||
+                                                   size != e->pmtuprobe)
+        return; // not in a search, or a late ack
+    DEBUGMSG(DEBUG, "  frag path MTU probe %d acked\n", size);
+    if (e->pmtutimer) {
+        ccnl_rem_timer(e->pmtutimer);
+        e->pmtutimer = NULL;
+    }
+    e->pmtulo = size;
+    if (size > e->mtu)
+        ccnl_frag_pmtu_setmtu(e, size);
+    ccnl_frag_pmtu_next(ccnl, f);
+}
+
+// a probe from the peer: ack it (whether we fragment or not)
+static void
+ccnl_frag_pmtu_RXprobe(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
+                       int protocol, int size)
+{
+    unsigned char ack[32];
+    int len;
+
+    if (!ccnl || !from || from->ifndx < 0)
+        return;
+    len = ccnl_frag_mkcontainer(protocol, ack);
+    len += ccnl_ccnb_mkBinaryInt(ack + len, CCNL_DTAG_FRAG2012_PMTUACK,
+                                 CCN_TT_DTAG, size, 2);
+    ack[len++] = 0; // end of fragment
+    ccnl_interface_enqueue(NULL, NULL, ccnl, ccnl->ifs + from->ifndx,
+                           ccnl_buf_new(ack, len), &from->peer);
+}
+
+static void
+ccnl_frag_pmtu_timeout(void *ptr, void *aux)
+{
+    struct ccnl_relay_s *ccnl = (struct ccnl_relay_s*) ptr;
+    struct ccnl_face_s *f = (struct ccnl_face_s*) aux;
+    struct ccnl_frag_s *e = f->frag;
+
+    e->pmtutimer = NULL;
+    if (!e->pmtuprobe) { // time to look for a larger MTU
+        ccnl_frag_pmtu_start(ccnl, f);
+        return;
+    }
+    if (e->pmtutries < CCNL_PMTU_MAXPROBES) {
+        ccnl_frag_pmtu_send(ccnl, f);
+        return;
+    }
+    DEBUGMSG(DEBUG, "  frag path MTU probe %d lost\n", e->pmtuprobe);
+    e->pmtuhi = e->pmtuprobe;
+    if (e->mtu >= e->pmtuhi) // the path got smaller
+        ccnl_frag_pmtu_setmtu(e, e->pmtuhi - 1 >= CCNL_PMTU_MIN ?
+                                 e->pmtuhi - 1 : CCNL_PMTU_MIN);
+    ccnl_frag_pmtu_next(ccnl, f);
 }
 
 void
 ccnl_frag_destroy(struct ccnl_frag_s *e)
 {
+    int i;
+
     if (e) {
+        if (e->rxtimer)
+            ccnl_rem_timer(e->rxtimer);
+        if (e->txtimer)
+            ccnl_rem_timer(e->txtimer);
+        if (e->pmtutimer)
+            ccnl_rem_timer(e->pmtutimer);
+        for (i = 0; i < CCNL_FRAG_RXWINDOW; i++)
+            ccnl_free(e->rxslot[i]);
+        for (i = 0; i < CCNL_FRAG_TXWINDOW; i++)
+            ccnl_free(e->txslot[i]);
+        for (i = 0; i < CCNL_FRAG_FECMAXK; i++) {
+            ccnl_free(e->fecrep[i]);
+            ccnl_free(e->fecrxrep[i]);
+        }
+        for (i = 0; i < CCNL_FRAG_RXWINDOW; i++)
+            ccnl_free(e->fecsym[i]);
+        while (e->fecout) {
+            struct ccnl_buf_s *buf = e->fecout;
+            e->fecout = buf->next;
+            ccnl_free(buf);
+        }
         ccnl_free(e->bigpkt);
         ccnl_free(e->defrag);
         ccnl_free(e);
@@ -321,11 +1099,48 @@ ccnl_frag_destroy(struct ccnl_frag_s *e)
 
 // ----------------------------------------------------------------------
 
+// whether a datagram starts with a (ccnb encoded) fragment
+int
+ccnl_is_fragment(unsigned char *data, int datalen)
+{
+    int num, typ;
+
+    if (ccnl_ccnb_dehead(&data, &datalen, &num, &typ) || typ != CCN_TT_DTAG)
+        return 0;
+    return num == CCNL_DTAG_FRAGMENT2012 || num == CCNL_DTAG_FRAGMENT2013;
+}
+
+// hand a reassembled packet to the forwarder of its suite
+int
+ccnl_frag_deliver(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+                  unsigned char **data, int *datalen)
+{
+    int suite, skip;
+
+    while (*datalen > 0) {
+        suite = ccnl_pkt2suite(*data, *datalen, &skip);
+        if (suite < 0 || suite >= CCNL_SUITE_LAST ||
+                                        !ccnl_core_RX_dispatch[suite]) {
+            DEBUGMSG(WARNING, "  unknown packet format in fragment\n");
+            return -1;
+        }
+        if (ccnl_core_RX_dispatch[suite](relay, from, data, datalen) < 0)
+            return -1;
+    }
+    return 0;
+}
+
 struct serialFragPDU_s { // collect all fields of a numbered HBH fragment
     int contlen;
     unsigned char *content;
     unsigned int flags, ourseq, ourloss, yourseq, HAS;
     unsigned char flagwidth, ourseqwidth, ourlosswidth, yourseqwidth;
+    unsigned char *ybits; // an ack
+    int ybitslen;
+    unsigned int fecseq, fecinfo; // a FEC repair
+    unsigned char fecseqwidth, fecinfowidth;
+    unsigned int pmtuprobe, pmtuack; // path MTU discovery
+    unsigned char pmtuwidth;
 };
 
 void
@@ -335,87 +1150,511 @@ serialFragPDU_init(struct serialFragPDU_s *s)
     s->contlen = -1;
     s->flagwidth = 1;
     s->ourseqwidth = s->ourlosswidth = s->yourseqwidth = sizeof(int);
+    s->fecseqwidth = s->fecinfowidth = sizeof(int);
+    s->pmtuwidth = sizeof(int);
 }
 
-void
-ccnl_frag_RX_serialfragment(RX_datagram callback,
-                              struct ccnl_relay_s *relay,
-                              struct ccnl_face_s *from,
-                              struct serialFragPDU_s *s)
+// ----------------------------------------------------------------------
+// reassembly: fragments are numbered per face, a packet is the run of
+// sequence numbers from a FIRST to a LAST fragment. In-order fragments
+// are appended to e->defrag, the ones which arrive ahead of a gap wait
+// in the window until their packet is complete.
+
+#define RX_IDX(s)       ((s) % CCNL_FRAG_RXWINDOW)
+#define RX_HAS(e,s)     ((e)->rxmap[RX_IDX(s) / 32] & (1U << (RX_IDX(s) % 32)))
+#define RX_SET(e,s)     ((e)->rxmap[RX_IDX(s) / 32] |= 1U << (RX_IDX(s) % 32))
+#define RX_CLR(e,s)     ((e)->rxmap[RX_IDX(s) / 32] &= ~(1U << (RX_IDX(s) % 32)))
+
+static int
+ccnl_frag_rxpending(struct ccnl_frag_s *e)
 {
-    struct ccnl_buf_s *buf = NULL;
-    struct ccnl_frag_s *e = from->frag;
-    DEBUGMSG(TRACE, "  frag %p protocol=%d, flags=%04x, seq=%d (%d)\n",
-             (void*)e, e->protocol, s->flags, s->ourseq, e->recvseq);
+    int i;
 
-    if (e->recvseq != s->ourseq) {
-        // should increase error counter here
-        if (e->defrag) {
-            DEBUGMSG(WARNING, "  >> seqnum mismatch (%d/%d), dropped defrag buf\n",
-                     s->ourseq, e->recvseq);
-            ccnl_free(e->defrag);
-            e->defrag = NULL;
+    if (e->defrag)
+        return 1;
+    for (i = 0; i < CCNL_FRAG_RXWINDOW / 32; i++)
+        if (e->rxmap[i])
+            return 1;
+    return 0;
+}
+
+// drop the partially reassembled packet
+static void
+ccnl_frag_rxdrop(struct ccnl_frag_s *e)
+{
+    if (!e->defrag)
+        return;
+    DEBUGMSG(DEBUG, "  >> dropped %d bytes of a partial packet\n",
+             e->defraglen);
+    e->rxbytes -= e->defraglen;
+    ccnl_free(e->defrag);
+    e->defrag = NULL;
+    e->losscount++;
+}
+
+static int
+ccnl_frag_rxappend(struct ccnl_frag_s *e, unsigned char *data, int len)
+{
+    struct ccnl_buf_s *buf;
+    int size;
+
+    if (e->rxbytes + len > CCNL_FRAG_RXMAXBYTES) {
+        ccnl_frag_rxdrop(e);
+        return -1;
+    }
+    if (!e->defrag || e->defraglen + len > e->defrag->datalen) {
+        size = e->defrag ? 2 * e->defrag->datalen : CCNL_MAX_PACKET_SIZE;
+        if (size < e->defraglen + len)
+            size = e->defraglen + len;
+        buf = ccnl_buf_new(NULL, size);
+        if (!buf) {
+            ccnl_frag_rxdrop(e);
+            return -1;
         }
+        if (e->defrag)
+            memcpy(buf->data, e->defrag->data, e->defraglen);
+        else
+            e->defraglen = 0;
+        ccnl_free(e->defrag);
+        e->defrag = buf;
     }
-    switch(s->flags & (CCNL_DTAG_FRAG_FLAG_FIRST|CCNL_DTAG_FRAG_FLAG_LAST)) {
-    case CCNL_DTAG_FRAG_FLAG_SINGLE: // single packet
-        DEBUGMSG(DEBUG, "  >> single fragment\n");
+    memcpy(e->defrag->data + e->defraglen, data, len);
+    e->defraglen += len;
+    e->rxbytes += len;
+
+    return 0;
+}
+
+// consume the fragment with sequence number rxbase
+static void
+ccnl_frag_rxnext(RX_datagram callback, struct ccnl_relay_s *relay,
+                 struct ccnl_face_s *from, struct ccnl_frag_s *e,
+                 unsigned int flags, unsigned char *data, int len)
+{
+    struct ccnl_buf_s *buf;
+
+    e->rxbase++;
+    if (flags & CCNL_DTAG_FRAG_FLAG_FIRST) {
         if (e->defrag) {
             DEBUGMSG(WARNING, "    had to drop defrag buf\n");
-            ccnl_free(e->defrag);
-            e->defrag = NULL;
+            ccnl_frag_rxdrop(e);
         }
-        // no need to copy the buffer:
-        callback(relay, from, &s->content, &s->contlen);
-        return;
-    case CCNL_DTAG_FRAG_FLAG_FIRST: // start of fragment sequence
-        DEBUGMSG(DEBUG, "  >> start of fragment series\n");
-        if (e->defrag) {
-            DEBUGMSG(WARNING, "    had to drop defrag buf\n");
-            ccnl_free(e->defrag);
+        if ((flags & CCNL_DTAG_FRAG_FLAG_LAST) && callback) {
+            DEBUGMSG(DEBUG, "  >> single fragment\n");
+            // no need to copy the buffer:
+            callback(relay, from, &data, &len);
+            return;
         }
-        e->defrag = ccnl_buf_new(s->content, s->contlen);
-        break;
-    case CCNL_DTAG_FRAG_FLAG_LAST: // end of fragment sequence
-        DEBUGMSG(DEBUG, "  >> last fragment of a series\n");
-        if (!e->defrag) break;
-        buf = ccnl_buf_new(NULL, e->defrag->datalen + s->contlen);
-        if (buf) {
-            memcpy(buf->data, e->defrag->data, e->defrag->datalen);
-            memcpy(buf->data + e->defrag->datalen, s->content, s->contlen);
+    } else if (!e->defrag) {
+        DEBUGMSG(DEBUG, "  >> fragment without a start, dropped\n");
+        return;
+    }
+    if (ccnl_frag_rxappend(e, data, len) < 0 ||
+                                        !(flags & CCNL_DTAG_FRAG_FLAG_LAST))
+        return;
+
+    buf = e->defrag;
+    len = e->defraglen;
+    e->defrag = NULL;
+    e->rxbytes -= len;
+    DEBUGMSG(DEBUG, "  >> reassembled fragment is %d bytes\n", len);
+    data = buf->data;
+    if (callback)
+        callback(relay, from, &data, &len);
+    ccnl_free(buf);
+}
+
+// consume the window from rxbase on, as far as it is filled
+static void
+ccnl_frag_rxdrain(RX_datagram callback, struct ccnl_relay_s *relay,
+                  struct ccnl_face_s *from, struct ccnl_frag_s *e)
+{
+    struct ccnl_buf_s *buf;
+    int i;
+
+    while (RX_HAS(e, e->rxbase)) {
+        i = RX_IDX(e->rxbase);
+        RX_CLR(e, e->rxbase);
+        buf = e->rxslot[i];
+        e->rxslot[i] = NULL;
+        if (!buf) { // its packet was delivered already
+            ccnl_frag_rxdrop(e);
+            e->rxbase++;
+            continue;
         }
-        ccnl_free(e->defrag);
-        e->defrag = NULL;
-        break;
-    case CCNL_DTAG_FRAG_FLAG_MID:  // fragment in the middle of a squence
-    default:
-        DEBUGMSG(DEBUG, "  >> fragment in the middle of a series\n");
-        if (!e->defrag) break;
-        buf = ccnl_buf_new(NULL, e->defrag->datalen + s->contlen);
-        if (buf) {
-            memcpy(buf->data, e->defrag->data, e->defrag->datalen);
-            memcpy(buf->data + e->defrag->datalen, s->content, s->contlen);
-            ccnl_free(e->defrag);
-            e->defrag = buf;
-            buf = NULL;
-        } else {
-            ccnl_free(e->defrag);
-            e->defrag = NULL;
+        e->rxbytes -= buf->datalen;
+        ccnl_frag_rxnext(callback, relay, from, e, e->rxflags[i],
+                         buf->data, buf->datalen);
+        ccnl_free(buf);
+    }
+}
+
+// give up on all fragments before sequence number base
+static void
+ccnl_frag_rxskip(struct ccnl_frag_s *e, unsigned int base)
+{
+    int i, cnt = base - e->rxbase;
+
+    DEBUGMSG(DEBUG, "  >> reassembly window moves from %u to %u\n",
+             e->rxbase, base);
+    ccnl_frag_rxdrop(e);
+    if (cnt < 0 || cnt > CCNL_FRAG_RXWINDOW)
+        cnt = CCNL_FRAG_RXWINDOW;
+    for (i = 0; i < cnt; i++, e->rxbase++) {
+        if (!RX_HAS(e, e->rxbase))
+            continue;
+        RX_CLR(e, e->rxbase);
+        if (e->rxslot[RX_IDX(e->rxbase)]) {
+            e->rxbytes -= e->rxslot[RX_IDX(e->rxbase)]->datalen;
+            ccnl_free(e->rxslot[RX_IDX(e->rxbase)]);
+            e->rxslot[RX_IDX(e->rxbase)] = NULL;
         }
-        break;
     }
-    // FIXME: we should only bump recvseq if s->ourseq is ahead, or 0
-    e->recvseq = s->ourseq + 1;
-    DEBUGMSG(DEBUG, ">>> seq from %d to %d (w=%d)\n", s->ourseq, e->recvseq,
-        s->ourseqwidth);
+    e->rxbase = base;
+}
+
+// deliver the packet of the (waiting) fragment with sequence number seq
+// if all of its fragments are in the window
+static void
+ccnl_frag_rxcomplete(RX_datagram callback, struct ccnl_relay_s *relay,
+                     struct ccnl_face_s *from, struct ccnl_frag_s *e,
+                     unsigned int seq)
+{
+    struct ccnl_buf_s *buf;
+    unsigned int lo = seq, hi = seq, q;
+    unsigned char *data;
+    int len = 0;
+
+    while (!(e->rxflags[RX_IDX(lo)] & CCNL_DTAG_FRAG_FLAG_FIRST)) {
+        lo--;
+        if ((int)(lo - e->rxbase) <= 0 || !RX_HAS(e, lo) ||
+                                                !e->rxslot[RX_IDX(lo)])
+            return;
+    }
+    while (!(e->rxflags[RX_IDX(hi)] & CCNL_DTAG_FRAG_FLAG_LAST)) {
+        hi++;
+        if ((int)(hi - e->rxbase) >= CCNL_FRAG_RXWINDOW || !RX_HAS(e, hi) ||
+                                                !e->rxslot[RX_IDX(hi)])
+            return;
+    }
+    for (q = lo; q != hi + 1; q++)
+        len += e->rxslot[RX_IDX(q)]->datalen;
+    buf = ccnl_buf_new(NULL, len);
+    for (q = lo, len = 0; q != hi + 1; q++) {
+        if (buf)
+            memcpy(buf->data + len, e->rxslot[RX_IDX(q)]->data,
+                   e->rxslot[RX_IDX(q)]->datalen);
+        len += e->rxslot[RX_IDX(q)]->datalen;
+        ccnl_free(e->rxslot[RX_IDX(q)]);
+        e->rxslot[RX_IDX(q)] = NULL; // the bit stays: delivered
+    }
+    e->rxbytes -= len;
+    if (!buf)
+        return;
+    DEBUGMSG(DEBUG, "  >> reassembled fragment is %d bytes (seq %u-%u, "
+             "out of order)\n", len, lo, hi);
+    data = buf->data;
+    callback(relay, from, &data, &len);
+    ccnl_free(buf);
+}
 
-    if (buf) {
-        unsigned char *frag = buf->data;
-        int fraglen = buf->datalen;
-        DEBUGMSG(DEBUG, "  >> reassembled fragment is %d bytes\n", buf->datalen);
-        callback(relay, from, &frag, &fraglen);
+// nothing arrived to fill the gap at rxbase: skip to the next fragment
+// we have, what is before it is lost
+static void
+ccnl_frag_rxtimeout(void *ptr, void *aux)
+{
+    struct ccnl_frag_s *e = (struct ccnl_frag_s*) ptr;
+    unsigned int q;
+
+    e->rxtimer = NULL;
+    if (e->rxbase == e->rxtimerbase) {
+        for (q = e->rxbase + 1; (int)(q - e->rxbase) < CCNL_FRAG_RXWINDOW; q++)
+            if (RX_HAS(e, q))
+                break;
+        if ((int)(q - e->rxbase) >= CCNL_FRAG_RXWINDOW)
+            q = e->rxbase; // nothing after the gap: drop the partial packet
+        DEBUGMSG(DEBUG, "reassembly timeout frag=%p seq=%u\n", ptr, e->rxbase);
+        ccnl_frag_rxskip(e, q);
+        // packets which are complete in the window have been delivered
+        ccnl_frag_rxdrain(NULL, NULL, NULL, e);
+    }
+    if (ccnl_frag_rxpending(e)) {
+        e->rxtimerbase = e->rxbase;
+        e->rxtimer = ccnl_set_timer(CCNL_FRAG_RXTIMEOUT,
+                                    ccnl_frag_rxtimeout, e, NULL);
+    }
+}
+
+// the ack for what we have from the peer
+static struct ccnl_buf_s*
+ccnl_frag_mkack(struct ccnl_frag_s *e)
+{
+    unsigned char ack[64], bits[CCNL_FRAG_RXWINDOW / 8];
+    int i, len;
+
+    memset(bits, 0, sizeof(bits));
+    for (i = 0; i < CCNL_FRAG_RXWINDOW - 1; i++)
+        if (RX_HAS(e, e->rxbase + 1 + i))
+            bits[i / 8] |= 1 << (i % 8);
+
+    len = ccnl_frag_mkcontainer(e->protocol, ack);
+    if (len < 0)
+        return NULL;
+    len += ccnl_ccnb_mkBinaryInt(ack + len, CCNL_DTAG_FRAG2012_YSEQN,
+                                 CCN_TT_DTAG, e->rxbase, e->recvseqwidth);
+    len += ccnl_ccnb_mkBlob(ack + len, CCNL_DTAG_FRAG2012_YBITS, CCN_TT_DTAG,
+                            (char*) bits, sizeof(bits));
+    ack[len++] = 0; // end of fragment
+    return ccnl_buf_new(ack, len);
+}
+
+// the sender keeps the fragment until we ack it: ack at the end of each
+// packet, on anything out of order and every CCNL_FRAG_ACKEVERY fragments
+static void
+ccnl_frag_ackreq(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+                 struct serialFragPDU_s *s, int now)
+{
+    struct ccnl_frag_s *e = from->frag;
+    struct ccnl_buf_s *buf;
+
+    if (!(s->flags & CCNL_DTAG_FRAG_FLAG_ACKREQ) || !relay || from->ifndx < 0)
+        return;
+    if (!now && ++e->rxunacked < CCNL_FRAG_ACKEVERY)
+        return;
+    e->rxunacked = 0;
+    buf = ccnl_frag_mkack(e);
+    if (buf)
+        ccnl_interface_enqueue(NULL, NULL, relay, relay->ifs + from->ifndx,
+                               buf, &from->peer);
+}
+
+// ----------------------------------------------------------------------
+// FEC reception: the symbols of the data fragments are kept in the
+// window, lost ones are computed when a block has enough repairs
+
+void ccnl_frag_RX_serialfragment(RX_datagram callback,
+            struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+            struct serialFragPDU_s *s);
+
+#define FEC_HAS(e,s)    ((e)->fecsym[RX_IDX(s)] && (e)->fecsymseq[RX_IDX(s)] == (s))
+
+static void
+ccnl_frag_fec_keep(struct ccnl_frag_s *e, struct serialFragPDU_s *s)
+{
+    struct ccnl_buf_s *buf = e->fecsym[RX_IDX(s->ourseq)];
+
+    if (!buf || buf->datalen < s->contlen + 3) {
         ccnl_free(buf);
+        buf = e->fecsym[RX_IDX(s->ourseq)] = ccnl_buf_new(NULL, s->contlen + 3);
+        if (!buf)
+            return;
+    }
+    buf->data[0] = s->flags;
+    buf->data[1] = s->contlen >> 8;
+    buf->data[2] = s->contlen;
+    memcpy(buf->data + 3, s->content, s->contlen);
+    e->fecsymseq[RX_IDX(s->ourseq)] = s->ourseq;
+}
+
+// solve for the missing symbols of the current block if there are as
+// many repairs, and feed them to reassembly
+static void
+ccnl_frag_fec_recover(RX_datagram callback, struct ccnl_relay_s *relay,
+                      struct ccnl_face_s *from)
+{
+    struct ccnl_frag_s *e = from->frag;
+    struct serialFragPDU_s s;
+    unsigned char a[CCNL_FRAG_FECMAXK][CCNL_FRAG_FECMAXK];
+    unsigned char *sym[CCNL_FRAG_FECMAXK], *known, *tmp, c;
+    int miss[CCNL_FRAG_FECMAXK], rows[CCNL_FRAG_FECMAXK];
+    int i, j, k, m = 0, cnt = 0, len = 0, klen;
+
+    if (e->fecrxdone || !e->fecrxcnt)
+        return;
+    for (j = 0; j < e->fecrxcnt; j++) {
+        if (FEC_HAS(e, e->fecrxbase + j))
+            continue;
+        if (m == CCNL_FRAG_FECMAXK)
+            return;
+        miss[m++] = j;
+    }
+    for (i = 0; i < CCNL_FRAG_FECMAXK && cnt < m; i++) {
+        if (!e->fecrxrep[i])
+            continue;
+        if (!cnt || e->fecrxrep[i]->datalen < len)
+            len = e->fecrxrep[i]->datalen;
+        rows[cnt++] = i;
+    }
+    if (cnt < m)
+        return;
+    e->fecrxdone = 1;
+    if (!m)
+        return;
+    ccnl_frag_gf_init();
+
+    // the repairs minus the fragments we have, as m equations
+    for (i = 0; i < m; i++) {
+        sym[i] = e->fecrxrep[rows[i]]->data;
+        for (j = 0; j < e->fecrxcnt; j++) {
+            if (!FEC_HAS(e, e->fecrxbase + j))
+                continue;
+            known = e->fecsym[RX_IDX(e->fecrxbase + j)]->data;
+            klen = 3 + (known[1] << 8 | known[2]);
+            ccnl_frag_gf_addmul(sym[i], known, FEC_COEF(rows[i], j),
+                                klen < len ? klen : len);
+        }
+        for (k = 0; k < m; k++)
+            a[i][k] = FEC_COEF(rows[i], miss[k]);
+    }
+    // Gauss-Jordan elimination
+    for (k = 0; k < m; k++) {
+        for (i = k; i < m && !a[i][k]; i++);
+        if (i == m)
+            return;
+        if (i != k) {
+            for (j = 0; j < m; j++) {
+                c = a[i][j];
+                a[i][j] = a[k][j];
+                a[k][j] = c;
+            }
+            tmp = sym[i];
+            sym[i] = sym[k];
+            sym[k] = tmp;
+        }
+        c = ccnl_frag_gf_inv(a[k][k]);
+        for (j = 0; j < m; j++)
+            a[k][j] = ccnl_frag_gf_mul(a[k][j], c);
+        for (j = 0; j < len; j++)
+            sym[k][j] = ccnl_frag_gf_mul(sym[k][j], c);
+        for (i = 0; i < m; i++) {
+            c = a[i][k];
+            if (i == k || !c)
+                continue;
+            for (j = 0; j < m; j++)
+                a[i][j] ^= ccnl_frag_gf_mul(c, a[k][j]);
+            ccnl_frag_gf_addmul(sym[i], sym[k], c, len);
+        }
+    }
+
+    for (k = 0; k < m; k++) {
+        serialFragPDU_init(&s);
+        s.flags = sym[k][0];
+        s.ourseq = e->fecrxbase + miss[k];
+        s.contlen = sym[k][1] << 8 | sym[k][2];
+        s.content = sym[k] + 3;
+        s.HAS = 0x03; // flags, seq
+        if (s.contlen > len - 3 || !(s.flags & CCNL_DTAG_FRAG_FLAG_FEC)) {
+            DEBUGMSG(WARNING, "  >> bad FEC symbol for fragment %u\n",
+                     s.ourseq);
+            continue;
+        }
+        DEBUGMSG(DEBUG, "  >> fragment %u recovered by FEC\n", s.ourseq);
+        e->fecrecovered++;
+        ccnl_frag_RX_serialfragment(callback, relay, from, &s);
+    }
+}
+
+static void
+ccnl_frag_fec_RXrepair(RX_datagram callback, struct ccnl_relay_s *relay,
+                       struct ccnl_face_s *from, struct serialFragPDU_s *s)
+{
+    struct ccnl_frag_s *e = from->frag;
+    int i, n = s->fecinfo >> 8, r = s->fecinfo & 0xff;
+
+    DEBUGMSG(TRACE, "  FEC repair %d for seq %u-%u\n",
+             r, s->fecseq, s->fecseq + n - 1);
+    if (n < 1 || n > CCNL_FRAG_FECMAXN || r >= CCNL_FRAG_FECMAXK ||
+                                                        s->contlen < 3) {
+        DEBUGMSG(WARNING, "  >> bad FEC repair dropped\n");
+        return;
+    }
+    if (s->fecseq != e->fecrxbase || n != e->fecrxcnt) {
+        // a new block: the previous one is done, or lost for good
+        for (i = 0; i < CCNL_FRAG_FECMAXK; i++) {
+            ccnl_free(e->fecrxrep[i]);
+            e->fecrxrep[i] = NULL;
+        }
+        e->fecrxbase = s->fecseq;
+        e->fecrxcnt = n;
+        e->fecrxdone = 0;
+    }
+    if (e->fecrxdone || e->fecrxrep[r])
+        return;
+    e->fecrxrep[r] = ccnl_buf_new(s->content, s->contlen);
+    ccnl_frag_fec_recover(callback, relay, from);
+}
+
+void
+ccnl_frag_RX_serialfragment(RX_datagram callback,
+                              struct ccnl_relay_s *relay,
+                              struct ccnl_face_s *from,
+                              struct serialFragPDU_s *s)
+{
+    struct ccnl_frag_s *e = from->frag;
+    unsigned int flags = s->flags & CCNL_DTAG_FRAG_FLAG_MASK;
+    struct ccnl_buf_s *buf;
+    int d = s->ourseq - e->rxbase;
+
+    DEBUGMSG(TRACE, "  frag %p protocol=%d, flags=%04x, seq=%d (%d)\n",
+             (void*)e, e->protocol, s->flags, s->ourseq, e->rxbase);
+
+    if ((int)(s->ourseq - e->recvseq) >= 0)
+        e->recvseq = s->ourseq + 1;
+    if (s->flags & CCNL_DTAG_FRAG_FLAG_FEC)
+        ccnl_frag_fec_keep(e, s);
+    if (d < 0 || d >= CCNL_FRAG_RXWINDOW) {
+        if (d < 0 && d >= -CCNL_FRAG_RXWINDOW) {
+            DEBUGMSG(DEBUG, "  >> late fragment %d dropped\n", s->ourseq);
+            ccnl_frag_ackreq(relay, from, s, 1);
+            return;
+        }
+        // ahead of the window, or the peer restarted its numbering
+        ccnl_frag_rxskip(e, ccnl_frag_rxpending(e) ?
+                         s->ourseq - CCNL_FRAG_RXWINDOW + 1 : s->ourseq);
+        ccnl_frag_rxdrain(callback, relay, from, e);
+        d = s->ourseq - e->rxbase;
+    }
+
+    if (d == 0) {
+        ccnl_frag_rxnext(callback, relay, from, e, flags,
+                         s->content, s->contlen);
+        ccnl_frag_rxdrain(callback, relay, from, e);
+    } else if (RX_HAS(e, s->ourseq)) {
+        DEBUGMSG(DEBUG, "  >> duplicate fragment %d dropped\n", s->ourseq);
+    } else if (flags == CCNL_DTAG_FRAG_FLAG_SINGLE) {
+        DEBUGMSG(DEBUG, "  >> single fragment, out of order\n");
+        RX_SET(e, s->ourseq);
+        callback(relay, from, &s->content, &s->contlen);
+    } else if (e->rxbytes + s->contlen > CCNL_FRAG_RXMAXBYTES ||
+               !(buf = ccnl_buf_new(s->content, s->contlen))) {
+        DEBUGMSG(WARNING, "  >> no room for fragment %d, dropped\n",
+                 s->ourseq);
+    } else {
+        DEBUGMSG(DEBUG, "  >> fragment %d waits for %d\n",
+                 s->ourseq, e->rxbase);
+        e->rxslot[RX_IDX(s->ourseq)] = buf;
+        e->rxflags[RX_IDX(s->ourseq)] = flags;
+        e->rxbytes += s->contlen;
+        RX_SET(e, s->ourseq);
+        ccnl_frag_rxcomplete(callback, relay, from, e, s->ourseq);
+    }
+
+    if (!ccnl_frag_rxpending(e)) {
+        if (e->rxtimer) {
+            ccnl_rem_timer(e->rxtimer);
+            e->rxtimer = NULL;
+        }
+    } else if (!e->rxtimer) {
+        e->rxtimerbase = e->rxbase;
+        e->rxtimer = ccnl_set_timer(CCNL_FRAG_RXTIMEOUT,
+                                    ccnl_frag_rxtimeout, e, NULL);
     }
+    ccnl_frag_ackreq(relay, from, s,
+                     d != 0 || (flags & CCNL_DTAG_FRAG_FLAG_LAST));
+    // it may complete a block whose repairs came first
+    if ((s->flags & CCNL_DTAG_FRAG_FLAG_FEC) &&
+                        s->ourseq - e->fecrxbase < (unsigned int) e->fecrxcnt)
+        ccnl_frag_fec_recover(callback, relay, from);
 }
 
 // ----------------------------------------------------------------------
@@ -429,6 +1668,10 @@ ccnl_frag_RX_serialfragment(RX_datagram callback,
 #define HAS_OSEQ   0x02
 #define HAS_OLOS   0x04
 #define HAS_YSEQ   0x08
+#define HAS_FSEQ   0x10
+#define HAS_FINF   0x20
+#define HAS_PPRB   0x40
+#define HAS_PACK   0x80
 
 int
 ccnl_frag_RX_frag2012(RX_datagram callback,
@@ -463,6 +1706,22 @@ ccnl_frag_RX_frag2012(RX_datagram callback,
             case CCNL_DTAG_FRAG2012_YSEQN:
                 getNumField(s.yourseq, s.yourseqwidth, HAS_YSEQ, "yourseq");
                 continue;
+            case CCNL_DTAG_FRAG2012_YBITS:
+                if (ccnl_ccnb_consume(typ, num, data, datalen, &s.ybits, &s.ybitslen) < 0)
+                    goto Bail;
+                continue;
+            case CCNL_DTAG_FRAG2012_FECSEQ:
+                getNumField(s.fecseq, s.fecseqwidth, HAS_FSEQ, "fecseq");
+                continue;
+            case CCNL_DTAG_FRAG2012_FECINFO:
+                getNumField(s.fecinfo, s.fecinfowidth, HAS_FINF, "fecinfo");
+                continue;
+            case CCNL_DTAG_FRAG2012_PMTUPROBE:
+                getNumField(s.pmtuprobe, s.pmtuwidth, HAS_PPRB, "pmtuprobe");
+                continue;
+            case CCNL_DTAG_FRAG2012_PMTUACK:
+                getNumField(s.pmtuack, s.pmtuwidth, HAS_PACK, "pmtuack");
+                continue;
             default:
                 break;
             }
@@ -470,6 +1729,27 @@ ccnl_frag_RX_frag2012(RX_datagram callback,
         if (ccnl_ccnb_consume(typ, num, data, datalen, 0, 0) < 0)
             goto Bail;
     }
+    if (s.HAS & HAS_PPRB) {
+        ccnl_frag_pmtu_RXprobe(relay, from, CCNL_FRAG_SEQUENCED2012, s.pmtuprobe);
+        return 0;
+    }
+    if (s.HAS & HAS_PACK) {
+        if (from)
+            ccnl_frag_pmtu_RXack(relay, from, s.pmtuack);
+        return 0;
+    }
+    if (s.ybits && (s.HAS & HAS_YSEQ)) {
+        if (from)
+            ccnl_frag_arq_RXack(relay, from, s.yourseq, s.ybits, s.ybitslen);
+        if (!s.content)
+            return 0; // just an ack
+    }
+    if ((s.HAS & (HAS_FSEQ|HAS_FINF)) == (HAS_FSEQ|HAS_FINF)) {
+        if (s.content && from && from->frag &&
+                            from->frag->protocol == CCNL_FRAG_SEQUENCED2012)
+            ccnl_frag_fec_RXrepair(callback, relay, from, &s);
+        return 0;
+    }
     if (!s.content || s.HAS != 15) {
         DEBUGMSG(WARNING, "* incomplete frag\n");
         return 0;
@@ -537,6 +1817,22 @@ ccnl_frag_RX_CCNx2013(RX_datagram callback,
             case CCNL_DTAG_FRAG2013_YSEQN:
                 getNumField(s.yourseq, s.yourseqwidth, HAS_YSEQ, "yourseq");
                 continue;
+            case CCNL_DTAG_FRAG2013_YBITS:
+                if (ccnl_ccnb_consume(typ, num, data, datalen, &s.ybits, &s.ybitslen) < 0)
+                    goto Bail;
+                continue;
+            case CCNL_DTAG_FRAG2013_FECSEQ:
+                getNumField(s.fecseq, s.fecseqwidth, HAS_FSEQ, "fecseq");
+                continue;
+            case CCNL_DTAG_FRAG2013_FECINFO:
+                getNumField(s.fecinfo, s.fecinfowidth, HAS_FINF, "fecinfo");
+                continue;
+            case CCNL_DTAG_FRAG2013_PMTUPROBE:
+                getNumField(s.pmtuprobe, s.pmtuwidth, HAS_PPRB, "pmtuprobe");
+                continue;
+            case CCNL_DTAG_FRAG2013_PMTUACK:
+                getNumField(s.pmtuack, s.pmtuwidth, HAS_PACK, "pmtuack");
+                continue;
             default:
                 break;
             }
@@ -544,6 +1840,27 @@ ccnl_frag_RX_CCNx2013(RX_datagram callback,
         if (ccnl_ccnb_consume(typ, num, data, datalen, 0, 0) < 0)
             goto Bail;
     }
+    if (s.HAS & HAS_PPRB) {
+        ccnl_frag_pmtu_RXprobe(relay, from, CCNL_FRAG_CCNx2013, s.pmtuprobe);
+        return 0;
+    }
+    if (s.HAS & HAS_PACK) {
+        if (from)
+            ccnl_frag_pmtu_RXack(relay, from, s.pmtuack);
+        return 0;
+    }
+    if (s.ybits && (s.HAS & HAS_YSEQ)) {
+        if (from)
+            ccnl_frag_arq_RXack(relay, from, s.yourseq, s.ybits, s.ybitslen);
+        if (!s.content)
+            return 0; // just an ack
+    }
+    if ((s.HAS & (HAS_FSEQ|HAS_FINF)) == (HAS_FSEQ|HAS_FINF)) {
+        if (s.content && from && from->frag &&
+                            from->frag->protocol == CCNL_FRAG_CCNx2013)
+            ccnl_frag_fec_RXrepair(callback, relay, from, &s);
+        return 0;
+    }
     if (!pdutype || !s.content ) {
 /* ||
                     (s.HAS&(HAS_FLAGS|HAS_OSEQ)) != (HAS_FLAGS|HAS_OSEQ) ) {
@@ -552,7 +1869,9 @@ ccnl_frag_RX_CCNx2013(RX_datagram callback,
         return 0;
     }
 
-    if (memcmp(pdutype, CCNL_FRAG_TYPE_CCNx2013_VAL, 3) == 0) { // hop-by-hop
+    // hop-by-hop, and mid-to-end fragments which end here
+    if (memcmp(pdutype, CCNL_FRAG_TYPE_CCNx2013_VAL, 3) == 0 ||
+                memcmp(pdutype, CCNL_FRAG_TYPE_MIDTOEND_VAL, 3) == 0) {
         if (from) {
             if (!from->frag)
                 from->frag = ccnl_frag_new(CCNL_FRAG_CCNx2013,
@@ -565,13 +1884,6 @@ ccnl_frag_RX_CCNx2013(RX_datagram callback,
             ccnl_frag_RX_serialfragment(callback, relay, from, &s);
     }
 
-    /*
-     * echo "FMTE" | base64 -d | hexdump -v -e '/1 "@x%02x"'| tr @ '\\'; echo
-     */
-    if (memcmp(pdutype, "\x14\xc4\xc4", 3) == 0) { // mid-to-end fragment
-        // not implemented yet
-    }
-
     return 0;
 Bail:
     DEBUGMSG(WARNING, "* frag bailing\n");
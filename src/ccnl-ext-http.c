@@ -18,6 +18,7 @@
  *
  * File history:
  * 2013-04-11 created
+ * 2026-10-19 content store hit ratio and admission counters
  */
 
 #ifdef USE_HTTP_STATUS
@@ -285,6 +286,13 @@ ccnl_http_status(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http)
     len += sprintf(txt+len, "<li>Pending interests: %d\n", cnt);
     len += sprintf(txt+len, "<li>Content chunks: %d (max=%d)\n",
                    ccnl->contentcnt, ccnl->max_cache_entries);
+#ifdef USE_CACHEPOLICY
+    len += sprintf(txt+len, "<li>Content store hits: %ld of %ld (%ld%%),"
+                   " admitted %ld, rejected %ld\n", ccnl->cs_hits,
+                   ccnl->cs_lookups, ccnl->cs_lookups ?
+                   100 * ccnl->cs_hits / ccnl->cs_lookups : 0,
+                   ccnl->cs_admitted, ccnl->cs_rejected);
+#endif
     len += sprintf(txt+len, "</ul>\n");
 
     len += sprintf(txt+len, "\n<p><table borders=0 width=100%% bgcolor=#e0e0ff>"
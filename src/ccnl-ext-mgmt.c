@@ -19,6 +19,12 @@
  * File history:
  * 2012-05-06 created 
  * 2013-10-21 extended for crypto <christopher.scherb@unibas.ch>
+ * 2026-10-19 setsched command (face and interface scheduler options)
+ * 2026-10-19 prefixreg: optional forwarding strategy of the prefix
+ * 2026-10-19 setcache command (cache admission policy of a prefix)
+ * 2026-10-19 setcache prefetch=W (sequential chunk prefetching)
+ * 2026-10-19 setweight command, prefixreg strategy weighted
+ * 2026-10-19 debug snapshot (content store to the -S file)
  */
 
 
@@ -90,6 +96,8 @@ ccnl_mgmt_send_return_split(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
             if(it == 0){
                 struct ccnl_buf_s *retbuf;
                 retbuf = ccnl_buf_new((char *)buf2, len5);
+                if (retbuf)
+                    retbuf->tclass = CCNL_TCLASS_CTRL;
                 ccnl_face_enqueue(ccnl, from, retbuf); 
             }
             else
@@ -573,6 +581,16 @@ ccnl_mgmt_debug(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         else if (!strcmp((char*) debugaction, "halt")){
             ccnl->halt_flag = 1;
         }
+        else if (!strcmp((char*) debugaction, "snapshot")) {
+#ifdef USE_SNAPSHOT
+            if (!ccnl->snapshot)
+                cp = "no snapshot file (-S), ignored";
+            else if (ccnl_snapshot_save(ccnl, ccnl->snapshot) < 0)
+                cp = "debug snapshot failed";
+#else
+            cp = "no snapshot support";
+#endif
+        }
         else if (!strcmp((char*) debugaction, "dump+halt")) {
             ccnl_dump(0, CCNL_RELAY, ccnl);
             
@@ -811,7 +829,8 @@ ccnl_mgmt_newface(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         //      printf("  flags=%s %d\n", flags, flagval);
         DEBUGMSG(TRACE, "  adding a new face (id=%d) worked!\n", f->faceid);
         f->flags = flagval &
-            (CCNL_FACE_FLAGS_STATIC|CCNL_FACE_FLAGS_REFLECT);
+            (CCNL_FACE_FLAGS_STATIC|CCNL_FACE_FLAGS_REFLECT|
+             CCNL_FACE_FLAGS_COALESCE|CCNL_FACE_FLAGS_CTRL);
 
 #ifdef USE_FRAG
         if (frag) {
@@ -949,16 +968,17 @@ ccnl_mgmt_setfrag(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
             ccnl_frag_destroy(f->frag);
             f->frag = 0;
         }
-        if (!strcmp((const char*)frag, "none"))
-            e = CCNL_FRAG_NONE;
-        else if (!strcmp((const char*)frag, "seqd2012")) {
-            e = CCNL_FRAG_SEQUENCED2012;
-        } else if (!strcmp((const char*)frag, "ccnx2013")) {
-            e = CCNL_FRAG_CCNx2013;
-        }
+        e = ccnl_frag_str2proto((char*) frag);
         if (e < 0)
             goto Error;
+        // an MTU of "auto" (or 0) is found by path MTU discovery
         f->frag = ccnl_frag_new(e, strtol((const char*)mtu, NULL, 0));
+        if (ccnl_frag_setopts(f->frag, (char*) frag) < 0) {
+            ccnl_frag_destroy(f->frag);
+            f->frag = 0;
+            goto Error;
+        }
+        ccnl_frag_pmtu_start(ccnl, f);
         cp = "setfrag cmd worked";
 #else
         cp = "no fragmentation support"; 
@@ -1000,6 +1020,317 @@ Bail:
     return rc;
 }
 
+int
+ccnl_mgmt_setsched(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
+                   struct ccnl_prefix_s *prefix, struct ccnl_face_s *from)
+{
+    unsigned char *buf;
+    int buflen, num, typ;
+    unsigned char *action, *faceid, *ifndx, *sched;
+    char *cp = "setsched cmd failed";
+    int rc = -1;
+    int len = 0, len3;
+
+    DEBUGMSG(TRACE, "ccnl_mgmt_setsched from=%p, ifndx=%d\n",
+             (void*) from, from->ifndx);
+    action = faceid = ifndx = sched = NULL;
+
+    buf = prefix->comp[3];
+    buflen = prefix->complen[3];
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) < 0) goto Bail;
+    if (typ != CCN_TT_DTAG || num != CCN_DTAG_CONTENTOBJ) goto Bail;
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+
+    if (typ != CCN_TT_DTAG || num != CCN_DTAG_CONTENT) goto Bail;
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+    if (typ != CCN_TT_BLOB) goto Bail;
+    buflen = num;
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+    if (typ != CCN_TT_DTAG || num != CCN_DTAG_FACEINSTANCE) goto Bail;
+
+    while (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) == 0) {
+        if (num==0 && typ==0)
+            break; // end
+        extractStr(action, CCN_DTAG_ACTION);
+        extractStr(faceid, CCN_DTAG_FACEID);
+        extractStr(ifndx, CCNL_DTAG_IFNDX);
+        extractStr(sched, CCNL_DTAG_SCHED);
+
+        if (ccnl_ccnb_consume(typ, num, &buf, &buflen, 0, 0) < 0) goto Bail;
+    }
+
+    // the scheduler of a face (FACEID) or of an interface (IFNDX)
+    if ((faceid || ifndx) && sched) {
+#ifdef USE_SCHEDULER
+        struct ccnl_sched_s **sp;
+        struct ccnl_face_s *f;
+        int i;
+
+        if (ccnl_sched_setopts(NULL, (char*) sched) < 0)
+            goto Error;
+        if (faceid) {
+            i = strtol((const char*)faceid, NULL, 0);
+            for (f = ccnl->faces; f && f->faceid != i; f = f->next);
+            if (!f || f->ifndx < 0)
+                goto Error;
+            sp = &f->sched;
+            if (!*sp)
+                *sp = ccnl_sched_pktrate_new(
+                    (void(*)(void*,void*))ccnl_face_CTS, ccnl, 0);
+        } else {
+            i = strtol((const char*)ifndx, NULL, 0);
+            if (i < 0 || i >= ccnl->ifcount)
+                goto Error;
+            sp = &ccnl->ifs[i].sched;
+            if (!*sp)
+                *sp = ccnl_sched_pktrate_new(ccnl_interface_CTS, ccnl, 0);
+        }
+        if (!*sp || ccnl_sched_setopts(*sp, (char*) sched) < 0)
+            goto Error;
+        cp = "setsched cmd worked";
+#else
+        cp = "no scheduler support";
+#endif
+    } else {
+#ifdef USE_SCHEDULER
+Error:
+#endif
+        DEBUGMSG(TRACE, "  setsched request for (faceid=%s ifndx=%s sched=%s) failed or was ignored\n",
+                 faceid, ifndx, sched);
+    }
+    rc = 0;
+
+Bail:
+    ccnl_free(action);
+
+    len += ccnl_ccnb_mkHeader(out_buf+len, CCN_DTAG_NAME, CCN_TT_DTAG);  // name
+    len += ccnl_ccnb_mkStrBlob(out_buf+len, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "ccnx");
+    len += ccnl_ccnb_mkStrBlob(out_buf+len, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "");
+    len += ccnl_ccnb_mkStrBlob(out_buf+len, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "setsched");
+    out_buf[len++] = 0; // end-of-name
+
+    // prepare FACEINSTANCE
+    len3 = ccnl_ccnb_mkHeader(faceinst_buf, CCN_DTAG_FACEINSTANCE, CCN_TT_DTAG);
+    len3 += ccnl_ccnb_mkStrBlob(faceinst_buf+len3, CCN_DTAG_ACTION, CCN_TT_DTAG, cp);
+    if (faceid)
+        len3 += ccnl_ccnb_mkStrBlob(faceinst_buf+len3, CCN_DTAG_FACEID, CCN_TT_DTAG, (char*) faceid);
+    if (ifndx)
+        len3 += ccnl_ccnb_mkStrBlob(faceinst_buf+len3, CCNL_DTAG_IFNDX, CCN_TT_DTAG, (char*) ifndx);
+    if (sched)
+        len3 += ccnl_ccnb_mkStrBlob(faceinst_buf+len3, CCNL_DTAG_SCHED, CCN_TT_DTAG, (char*) sched);
+    faceinst_buf[len3++] = 0; // end-of-faceinst
+
+    len += ccnl_ccnb_mkBlob(out_buf+len, CCN_DTAG_CONTENT, CCN_TT_DTAG,  // content
+                   (char*) faceinst_buf, len3);
+
+    ccnl_mgmt_send_return_split(ccnl, orig, prefix, from, len, (unsigned char*)out_buf);
+
+    ccnl_free(faceid);
+    ccnl_free(ifndx);
+    ccnl_free(sched);
+
+    return rc;
+}
+
+int
+ccnl_mgmt_setcache(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
+                   struct ccnl_prefix_s *prefix, struct ccnl_face_s *from)
+{
+    unsigned char *buf;
+    int buflen, num, typ;
+    struct ccnl_prefix_s *p = NULL;
+    unsigned char *suite = 0, *policy = 0;
+    char *cp = "setcache cmd failed";
+
+    DEBUGMSG(TRACE, "ccnl_mgmt_setcache\n");
+
+    buf = prefix->comp[3];
+    buflen = prefix->complen[3];
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) < 0) goto Bail;
+    if (typ != CCN_TT_DTAG || num != CCN_DTAG_CONTENTOBJ) goto Bail;
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+
+    if (typ != CCN_TT_DTAG || num != CCN_DTAG_CONTENT) goto Bail;
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+    if (typ != CCN_TT_BLOB) goto Bail;
+    buflen = num;
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+    if (typ != CCN_TT_DTAG || num != CCNL_DTAG_PREFIX) goto Bail;
+
+    p = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s));
+    if (!p) goto Bail;
+    p->comp = (unsigned char**) ccnl_malloc(CCNL_MAX_NAME_COMP *
+                                           sizeof(unsigned char*));
+    p->complen = (int*) ccnl_malloc(CCNL_MAX_NAME_COMP * sizeof(int));
+    if (!p->comp || !p->complen) goto Bail;
+
+    while (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) == 0) {
+        if (num==0 && typ==0)
+            break; // end
+
+        if (typ == CCN_TT_DTAG && num == CCN_DTAG_NAME) {
+            for (;;) {
+                if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+                if (num==0 && typ==0)
+                    break;
+                if (typ == CCN_TT_DTAG && num == CCN_DTAG_COMPONENT &&
+                    p->compcnt < CCNL_MAX_NAME_COMP) {
+                    if (ccnl_ccnb_consume(typ, num, &buf, &buflen,
+                                p->comp + p->compcnt,
+                                p->complen + p->compcnt) < 0) goto Bail;
+                    p->compcnt++;
+                } else {
+                    if (ccnl_ccnb_consume(typ, num, &buf, &buflen, 0, 0) < 0) goto Bail;
+                }
+            }
+            continue;
+        }
+
+        extractStr(suite, CCNL_DTAG_SUITE);
+        extractStr(policy, CCNL_DTAG_CACHEPOLICY);
+
+        if (ccnl_ccnb_consume(typ, num, &buf, &buflen, 0, 0) < 0) goto Bail;
+    }
+
+    // the admission policy of the prefix (no components: the whole suite),
+    // or how many of its chunks are prefetched
+    if (suite && policy && !strncmp((char*) policy, "prefetch=", 9)) {
+#ifdef USE_PREFETCH
+        struct ccnl_prefix_s *p2 = ccnl_prefix_clone(p);
+
+        DEBUGMSG(TRACE, "mgmt: %s for prefix %s, suite=%s\n",
+                 policy, ccnl_prefix_to_path(p), ccnl_suite2str(suite[0]));
+        if (p2) {
+            p2->suite = suite[0];
+            if (ccnl_prefetch_set(ccnl, p2, atoi((char*) policy + 9)) >= 0)
+                cp = "setcache cmd worked";
+        }
+#else
+        cp = "no prefetch support";
+#endif
+    } else if (suite && policy) {
+#ifdef USE_CACHEPOLICY
+        struct ccnl_prefix_s *p2 = ccnl_prefix_clone(p);
+
+        DEBUGMSG(TRACE, "mgmt: cache policy %s for prefix %s, suite=%s\n",
+                 policy, ccnl_prefix_to_path(p), ccnl_suite2str(suite[0]));
+        if (p2) {
+            p2->suite = suite[0];
+            if (ccnl_cs_setpolicy(ccnl, p2, (char*) policy) >= 0)
+                cp = "setcache cmd worked";
+        }
+#else
+        cp = "no cache policy support";
+#endif
+    } else {
+        DEBUGMSG(TRACE, "mgmt: ignored setcache policy=%s\n", policy);
+    }
+
+Bail:
+    ccnl_mgmt_return_ccn_msg(ccnl, orig, prefix, from, "setcache", cp);
+
+    ccnl_free(suite);
+    ccnl_free(policy);
+    free_prefix(p);
+
+    return 0;
+}
+
+// the share of a next hop of a prefix with the weighted strategy
+int
+ccnl_mgmt_setweight(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
+                    struct ccnl_prefix_s *prefix, struct ccnl_face_s *from)
+{
+    unsigned char *buf;
+    int buflen, num, typ;
+    struct ccnl_prefix_s *p = NULL;
+    unsigned char *faceid = 0, *suite = 0, *weight = 0;
+    char *cp = "setweight cmd failed";
+
+    DEBUGMSG(TRACE, "ccnl_mgmt_setweight\n");
+
+    buf = prefix->comp[3];
+    buflen = prefix->complen[3];
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) < 0) goto Bail;
+    if (typ != CCN_TT_DTAG || num != CCN_DTAG_CONTENTOBJ) goto Bail;
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+
+    if (typ != CCN_TT_DTAG || num != CCN_DTAG_CONTENT) goto Bail;
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+    if (typ != CCN_TT_BLOB) goto Bail;
+    buflen = num;
+    if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+    if (typ != CCN_TT_DTAG || num != CCN_DTAG_FWDINGENTRY) goto Bail;
+
+    p = (struct ccnl_prefix_s *) ccnl_calloc(1, sizeof(struct ccnl_prefix_s));
+    if (!p) goto Bail;
+    p->comp = (unsigned char**) ccnl_malloc(CCNL_MAX_NAME_COMP *
+                                           sizeof(unsigned char*));
+    p->complen = (int*) ccnl_malloc(CCNL_MAX_NAME_COMP * sizeof(int));
+    if (!p->comp || !p->complen) goto Bail;
+
+    while (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) == 0) {
+        if (num==0 && typ==0)
+            break; // end
+
+        if (typ == CCN_TT_DTAG && num == CCN_DTAG_NAME) {
+            for (;;) {
+                if (ccnl_ccnb_dehead(&buf, &buflen, &num, &typ) != 0) goto Bail;
+                if (num==0 && typ==0)
+                    break;
+                if (typ == CCN_TT_DTAG && num == CCN_DTAG_COMPONENT &&
+                    p->compcnt < CCNL_MAX_NAME_COMP) {
+                    if (ccnl_ccnb_consume(typ, num, &buf, &buflen,
+                                p->comp + p->compcnt,
+                                p->complen + p->compcnt) < 0) goto Bail;
+                    p->compcnt++;
+                } else {
+                    if (ccnl_ccnb_consume(typ, num, &buf, &buflen, 0, 0) < 0) goto Bail;
+                }
+            }
+            continue;
+        }
+
+        extractStr(faceid, CCN_DTAG_FACEID);
+        extractStr(suite, CCNL_DTAG_SUITE);
+        extractStr(weight, CCNL_DTAG_WEIGHT);
+
+        if (ccnl_ccnb_consume(typ, num, &buf, &buflen, 0, 0) < 0) goto Bail;
+    }
+
+    // all entries of the prefix to that face, 0 goes back to the measured
+    if (faceid && suite && weight) {
+        struct ccnl_forward_s *fwd;
+        int fi = strtol((const char*)faceid, NULL, 0), w = atoi((char*) weight);
+
+        p->suite = suite[0];
+        DEBUGMSG(TRACE, "mgmt: weight %d for prefix %s, faceid=%d, suite=%s\n",
+                 w, ccnl_prefix_to_path(p), fi, ccnl_suite2str(suite[0]));
+        if (w < 0 || w > CCNL_STRATEGY_MAX_WEIGHT)
+            goto Bail;
+        for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
+            if (fwd->suite != p->suite || !fwd->face ||
+                fwd->face->faceid != fi ||
+                ccnl_prefix_cmp(fwd->prefix, NULL, p, CMP_EXACT))
+                continue;
+            fwd->weight = w;
+            cp = "setweight cmd worked";
+        }
+    } else {
+        DEBUGMSG(TRACE, "mgmt: ignored setweight faceid=%s\n", faceid);
+    }
+
+Bail:
+    ccnl_mgmt_return_ccn_msg(ccnl, orig, prefix, from, "setweight", cp);
+
+    ccnl_free(faceid);
+    ccnl_free(suite);
+    ccnl_free(weight);
+    free_prefix(p);
+
+    return 0;
+}
+
 int
 ccnl_mgmt_destroyface(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
                       struct ccnl_prefix_s *prefix, struct ccnl_face_s *from)
@@ -1333,7 +1664,7 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     unsigned char *buf;
     int buflen, num, typ;
     struct ccnl_prefix_s *p = NULL;
-    unsigned char *action, *faceid, *suite=0, h[10];
+    unsigned char *action, *faceid, *suite=0, *strategy=0, h[10];
     char *cp = "prefixreg cmd failed";
     int rc = -1;
 
@@ -1390,6 +1721,7 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         extractStr(action, CCN_DTAG_ACTION);
         extractStr(faceid, CCN_DTAG_FACEID);
         extractStr(suite, CCNL_DTAG_SUITE);
+        extractStr(strategy, CCNL_DTAG_STRATEGY);
 
         if (ccnl_ccnb_consume(typ, num, &buf, &buflen, 0, 0) < 0) goto Bail;
     }
@@ -1416,9 +1748,22 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         if (suite)
             fwd->suite = suite[0];
 
-        fwd2 = &ccnl->fib;
-        while (*fwd2)
-            fwd2 = &((*fwd2)->next);
+        // the strategy is one per prefix: a new one applies to all its
+        // entries, else the entry gets that of the others
+        if (strategy)
+            fwd->strategy = !strcmp((char*) strategy, "multicast") ?
+                CCNL_STRATEGY_MULTICAST :
+                !strcmp((char*) strategy, "weighted") ?
+                CCNL_STRATEGY_WEIGHTED : CCNL_STRATEGY_BEST;
+        for (fwd2 = &ccnl->fib; *fwd2; fwd2 = &((*fwd2)->next)) {
+            if ((*fwd2)->suite != fwd->suite ||
+                ccnl_prefix_cmp((*fwd2)->prefix, NULL, fwd->prefix, CMP_EXACT))
+                continue;
+            if (strategy)
+                (*fwd2)->strategy = fwd->strategy;
+            else
+                fwd->strategy = (*fwd2)->strategy;
+        }
         *fwd2 = fwd;
         cp = "prefixreg cmd worked";
     } else {
@@ -1460,6 +1805,7 @@ Bail:
 
     ccnl_free(faceid);
     ccnl_free(action);
+    ccnl_free(strategy);
     free_prefix(p);
 
     //ccnl_mgmt_return_msg(ccnl, orig, from, cp);
@@ -1705,6 +2051,12 @@ int ccnl_mgmt_handle(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         ccnl_mgmt_newdev(ccnl, orig, prefix, from);
     else if (!strcmp(cmd, "setfrag"))
         ccnl_mgmt_setfrag(ccnl, orig, prefix, from);
+    else if (!strcmp(cmd, "setsched"))
+        ccnl_mgmt_setsched(ccnl, orig, prefix, from);
+    else if (!strcmp(cmd, "setcache"))
+        ccnl_mgmt_setcache(ccnl, orig, prefix, from);
+    else if (!strcmp(cmd, "setweight"))
+        ccnl_mgmt_setweight(ccnl, orig, prefix, from);
     else if (!strcmp(cmd, "destroydev"))
         ccnl_mgmt_destroydev(ccnl, orig, prefix, from);
     else if (!strcmp(cmd, "newface"))
@@ -187,7 +187,8 @@ ccnl_nfn(struct ccnl_relay_s *ccnl, // struct ccnl_buf_s *orig,
         ccnl_nfnprefix_clear(copy, CCNL_PREFIX_NFN | CCNL_PREFIX_THUNK); 
         if (!ccnl_nfn_local_content_search(ccnl, NULL, copy)) {
             free_prefix(copy);
-            ccnl_interest_propagate(ccnl, interest);
+            if (!ccnl_interest_propagate(ccnl, interest))
+                DEBUGMSG(DEBUG, "   answered with a NACK\n");
             return 0;
         }
         free_prefix(copy);
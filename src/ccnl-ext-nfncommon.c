@@ -495,7 +495,8 @@ ccnl_nfn_resolve_thunk(struct ccnl_relay_s *ccnl, struct configuration_s *config
             interest = ccnl_interest_remove(ccnl, interest);
             return c;
         }
-        ccnl_interest_propagate(ccnl, interest);
+        if (!ccnl_interest_propagate(ccnl, interest))
+            DEBUGMSG(DEBUG, "  thunk answered with a NACK\n");
     }
     return NULL;
 }
@@ -509,14 +510,23 @@ ccnl_nack_reply(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
 {
     struct ccnl_content_s *nack;
     DEBUGMSG(TRACE, "ccnl_nack_reply()\n");
-    if (from->faceid <= 0) {
+    if (!from || from->faceid <= 0) {
         return;
     }
+    prefix = ccnl_prefix_dup(prefix); // the content takes it
+    if (!prefix)
+        return;
     nack = ccnl_nfn_result2content(ccnl, &prefix,
                                     (unsigned char*)":NACK", 5);
+    if (!nack) {
+        free_prefix(prefix);
+        return;
+    }
     ccnl_nfn_monitor(ccnl, from, nack->name, nack->content, nack->contentlen);
     DEBUGMSG(WARNING, "+++ nack->pkt is %p\n", (void*) nack->pkt);
     ccnl_face_enqueue(ccnl, from, nack->pkt);
+    nack->pkt = NULL;
+    free_content(nack);
 }
 #endif // USE_NACK
 
@@ -416,10 +416,8 @@ recontinue: //loop by reentering after timeout of the interest...
     // Result not in cache, search over the network
     pref2 = ccnl_prefix_dup(pref);
     interest = ccnl_nfn_query2interest(ccnl, &pref2, config);
-    if (interest) {
-        ccnl_interest_propagate(ccnl, interest);
+    if (interest && ccnl_interest_propagate(ccnl, interest)) // else NACKed
         DEBUGMSG(DEBUG, "  new interest's face is %d\n", interest->from->faceid);
-    }
     // wait for content, return current program to continue later
     *halt = -1; //set halt to -1 for async computations
     return ccnl_strdup(prog);
@@ -433,8 +431,8 @@ local_compute:
     DEBUGMSG(DEBUG, "Prefix local computation: %s\n",
              ccnl_prefix_to_path(pref));
     interest = ccnl_nfn_query2interest(ccnl, &pref, config);
-    if (interest)
-        ccnl_interest_propagate(ccnl, interest);
+    if (interest && !ccnl_interest_propagate(ccnl, interest))
+        DEBUGMSG(DEBUG, "  local computation answered with a NACK\n");
 
 handlecontent: //if result was found ---> handle it
     if (c) {
@@ -123,10 +123,9 @@ op_builtin_find(struct ccnl_relay_s *ccnl, struct configuration_s *config,
         //        struct ccnl_interest_s *interest = mkInterestObject(ccnl, config, prefix);
         copy = ccnl_prefix_dup(prefix);
         interest = ccnl_nfn_query2interest(ccnl, &copy, config);
-        DEBUGMSG(DEBUG, "FIND: sending new interest from Face ID: %d\n",
-                 interest->from->faceid);
-        if (interest)
-            ccnl_interest_propagate(ccnl, interest);
+        if (interest && ccnl_interest_propagate(ccnl, interest)) // else NACKed
+            DEBUGMSG(DEBUG, "FIND: sending new interest from Face ID: %d\n",
+                     interest->from->faceid);
         //wait for content, return current program to continue later
         *halt = -1; //set halt to -1 for async computations
         return ccnl_strdup(prog);
@@ -215,9 +214,8 @@ op_builtin_raw(struct ccnl_relay_s *ccnl, struct configuration_s *config,
         //        struct ccnl_interest_s *interest = mkInterestObject(ccnl, config, prefix);
         struct ccnl_prefix_s *copy = ccnl_prefix_dup(prefix);
         struct ccnl_interest_s *interest = ccnl_nfn_query2interest(ccnl, &copy, config);
-        DEBUGMSG(DEBUG, "RAW: sending new interest from Face ID: %d\n", interest->from->faceid);
-        if (interest)
-            ccnl_interest_propagate(ccnl, interest);
+        if (interest && ccnl_interest_propagate(ccnl, interest)) // else NACKed
+            DEBUGMSG(DEBUG, "RAW: sending new interest from Face ID: %d\n", interest->from->faceid);
         //wait for content, return current program to continue later
         *halt = -1; //set halt to -1 for async computations
         return prog ? ccnl_strdup(prog) : NULL;
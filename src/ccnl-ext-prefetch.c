@@ -0,0 +1,304 @@
+/*
+ * @f ccnl-ext-prefetch.c
+ * @b CCN lite extension: sequential chunk prefetching
+ *
+ * Copyright (C) 2026, Christian Tschudin, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2026-10-19 created
+ */
+
+#if defined(USE_PREFETCH) && defined(NEEDS_PACKET_CRAFTING)
+
+// Under a prefix with a prefetch window (see "setcache PREFIX prefetch=W"),
+// an interest for chunk N of a name makes the relay ask for the chunks up
+// to N+W itself. These PIT entries (CCNL_PIT_PREFETCH) have no pending
+// face, their content goes to the content store only, where the consumer's
+// next interests find it; an interest which arrives before the content
+// joins the entry. Chunks asked for which were prefetched are hits: each
+// widens the window by one, up to W, and a jump to another chunk than the
+// next one halves it. Only NDN and CCNx 2015 names carry chunk numbers.
+
+// the prefetch window of the longest prefix of name, NULL for none
+static struct ccnl_prefetch_s*
+ccnl_prefetch_find(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *name)
+{
+    struct ccnl_prefetch_s *pf, *best = NULL;
+
+    for (pf = ccnl->prefetchers; pf; pf = pf->next) {
+        if (pf->prefix->suite != name->suite)
+            continue;
+        if (best && pf->prefix->compcnt <= best->prefix->compcnt)
+            continue;
+        if (ccnl_prefix_cmp(pf->prefix, NULL, name, CMP_LONGEST) <
+                                                        pf->prefix->compcnt)
+            continue;
+        best = pf;
+    }
+    return best;
+}
+
+// sets the prefetch window of prefix (which is taken over), 0 turns it off
+int
+ccnl_prefetch_set(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                  int window)
+{
+    struct ccnl_prefetch_s **pp;
+
+    if (window < 0 || window > CCNL_PREFETCH_MAX_WINDOW) {
+        free_prefix(prefix);
+        return -1;
+    }
+    for (pp = &ccnl->prefetchers; *pp; pp = &(*pp)->next)
+        if ((*pp)->prefix->suite == prefix->suite &&
+            !ccnl_prefix_cmp((*pp)->prefix, NULL, prefix, CMP_EXACT))
+            break;
+    if (*pp) {
+        free_prefix(prefix);
+    } else {
+        *pp = (struct ccnl_prefetch_s *)
+            ccnl_calloc(1, sizeof(struct ccnl_prefetch_s));
+        if (!*pp) {
+            free_prefix(prefix);
+            return -1;
+        }
+        (*pp)->prefix = prefix;
+    }
+    (*pp)->window = window;
+    DEBUGMSG(INFO, "prefetch window of <%s> is %d\n",
+             ccnl_prefix_to_path((*pp)->prefix), window);
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+static void
+ccnl_prefetch_stream_free(struct ccnl_prefetch_stream_s *s)
+{
+    free_prefix(s->name);
+    if (s->tmpl)
+        ccnl_pkt_tmpl_free(s->tmpl);
+    ccnl_free(s);
+}
+
+// the stream of p's name (p without its chunk), a new one replaces the
+// least recently used when there are too many
+static struct ccnl_prefetch_stream_s*
+ccnl_prefetch_stream(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p)
+{
+    struct ccnl_prefetch_stream_s *s, **pp, **oldest = NULL;
+    int cnt = 0;
+
+    for (pp = &ccnl->prefetchstreams; *pp; pp = &(*pp)->next, cnt++) {
+        s = *pp;
+        if (s->name->suite == p->suite &&
+            s->name->compcnt == p->compcnt - 1 &&
+            ccnl_prefix_cmp(s->name, NULL, p, CMP_LONGEST) == s->name->compcnt)
+            return s;
+        if (!oldest || s->last_used <= (*oldest)->last_used)
+            oldest = pp;
+    }
+    if (cnt >= CCNL_PREFETCH_MAX_STREAMS) {
+        s = *oldest;
+        *oldest = s->next;
+        ccnl_prefetch_stream_free(s);
+    }
+
+    s = (struct ccnl_prefetch_stream_s *)
+        ccnl_calloc(1, sizeof(struct ccnl_prefetch_stream_s));
+    if (!s)
+        return NULL;
+    s->name = ccnl_prefix_dup(p);
+    if (!s->name) {
+        ccnl_free(s);
+        return NULL;
+    }
+    s->name->compcnt--; // the chunk is the last component
+    ccnl_free(s->name->chunknum);
+    s->name->chunknum = NULL;
+    s->tmpl = ccnl_pkt_tmpl_new(s->name);
+    if (!s->tmpl) {
+        ccnl_prefetch_stream_free(s);
+        return NULL;
+    }
+    s->expected = s->ahead = *p->chunknum;
+    s->window = 1;
+    s->next = ccnl->prefetchstreams;
+    ccnl->prefetchstreams = s;
+    DEBUGMSG(DEBUG, "  new prefetch stream <%s>\n",
+             ccnl_prefix_to_path(s->name));
+    return s;
+}
+
+// asks for chunk of the stream's name, unless it is cached or pending
+static void
+ccnl_prefetch_issue(struct ccnl_relay_s *ccnl,
+                    struct ccnl_prefetch_stream_s *s, unsigned int chunk)
+{
+    struct ccnl_prefix_s *p = NULL;
+    struct ccnl_buf_s *buf = NULL;
+    struct ccnl_interest_s *i;
+    struct ccnl_content_s *c;
+    unsigned char *pkt, *data;
+    int len, datalen, nonce = rand();
+
+    len = ccnl_pkt_tmpl_interest(s->tmpl, &chunk,
+               s->tmpl->suite == CCNL_SUITE_NDNTLV ? &nonce : NULL, &pkt);
+    if (len <= 0)
+        return;
+    // parsed as if it came in, for the same prefix and packet buffer
+    data = pkt;
+    datalen = len;
+    switch (s->tmpl->suite) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV: {
+        int hdrlen = ((struct ccnx_tlvhdr_ccnx201412_s*) pkt)->hdrlen;
+        int keyidlen, contlen;
+        unsigned int lastchunknum;
+        unsigned char *keyid = NULL, *content = NULL;
+
+        data += hdrlen;
+        datalen -= hdrlen;
+        buf = ccnl_ccntlv_extract(hdrlen, &data, &datalen, &p, &keyid,
+                                  &keyidlen, &lastchunknum, &content, &contlen);
+        break;
+    }
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV: {
+        struct ccnl_ndntlv_view_s v;
+        int typ;
+
+        if (ccnl_ndntlv_dehead(&data, &datalen, &typ, &len) ||
+                            ccnl_ndntlv_scan(data - pkt, &data, &len, &v))
+            break;
+        if (v.nonce) // a copy coming back is dropped
+            ccnl_nonce_find_or_append(ccnl, v.nonce, v.noncelen);
+        buf = ccnl_ndntlv_view2pkt(&v, &p, NULL);
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+    if (!buf || !p)
+        goto Done;
+
+    for (c = ccnl->contents; c; c = c->next)
+        if (c->suite == p->suite &&
+                            !ccnl_prefix_cmp(c->name, NULL, p, CMP_EXACT))
+            goto Done;
+    for (i = ccnl->pit; i; i = i->next)
+        if (i->suite == p->suite &&
+                            !ccnl_prefix_cmp(i->prefix, NULL, p, CMP_EXACT))
+            goto Done;
+    i = ccnl_interest_new(ccnl, NULL, p->suite, &buf, &p,
+                          0, CCNL_MAX_NAME_COMP);
+    if (!i)
+        goto Done;
+    i->flags |= CCNL_PIT_PREFETCH;
+    s->issued++;
+    ccnl->pf_issued++;
+    DEBUGMSG(DEBUG, "  prefetching <%s>\n", ccnl_prefix_to_path(i->prefix));
+    if (!ccnl_interest_propagate(ccnl, i)) // i is gone
+        DEBUGMSG(DEBUG, "  prefetch answered with a NACK\n");
+Done:
+    free_prefix(p);
+    ccnl_free(buf);
+}
+
+// a consumer asked for p, answered from the content store with c, or
+// pending in PIT entry i
+void
+ccnl_prefetch_RX(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                 struct ccnl_content_s *c, struct ccnl_interest_s *i)
+{
+    struct ccnl_prefetch_s *pf;
+    struct ccnl_prefetch_stream_s *s;
+    unsigned int chunk;
+    int hit;
+
+    hit = (c && (c->flags & CCNL_CONTENT_FLAGS_PREFETCHED)) ||
+          (i && (i->flags & CCNL_PIT_PREFETCH));
+    if (c)
+        c->flags &= ~CCNL_CONTENT_FLAGS_PREFETCHED;
+    if (i)
+        i->flags &= ~CCNL_PIT_PREFETCH;
+    if (!p->chunknum || p->compcnt < 1 || !ccnl->max_cache_entries)
+        return;
+    pf = ccnl_prefetch_find(ccnl, p);
+    if (!pf || !pf->window)
+        return;
+    s = ccnl_prefetch_stream(ccnl, p);
+    if (!s)
+        return;
+
+    chunk = *p->chunknum;
+    s->last_used = CCNL_NOW();
+    if (hit) {
+        s->hits++;
+        ccnl->pf_hits++;
+        if (s->window < pf->window)
+            s->window++;
+    } else if (chunk != s->expected || chunk <= s->ahead) {
+        // elsewhere, or lost on the way: what was prefetched is wasted
+        s->window = s->window > 1 ? s->window / 2 : 1;
+        s->ahead = chunk;
+    }
+    if (s->window > pf->window)
+        s->window = pf->window;
+    s->expected = chunk + 1;
+    if (s->ahead < chunk)
+        s->ahead = chunk;
+    while (s->ahead < chunk + s->window) {
+        s->ahead++;
+        ccnl_prefetch_issue(ccnl, s, s->ahead);
+    }
+}
+
+// whether content c answers a prefetch, which goes to the content store
+int
+ccnl_prefetch_wanted(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    struct ccnl_interest_s *i;
+
+    for (i = ccnl->pit; i; i = i->next)
+        if ((i->flags & CCNL_PIT_PREFETCH) && ccnl_i_matches_c(i, c))
+            return 1;
+    return 0;
+}
+
+void
+ccnl_prefetch_cleanup(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_prefetch_s *pf;
+    struct ccnl_prefetch_stream_s *s;
+
+    while (ccnl->prefetchers) {
+        pf = ccnl->prefetchers->next;
+        free_prefix(ccnl->prefetchers->prefix);
+        ccnl_free(ccnl->prefetchers);
+        ccnl->prefetchers = pf;
+    }
+    while (ccnl->prefetchstreams) {
+        s = ccnl->prefetchstreams->next;
+        ccnl_prefetch_stream_free(ccnl->prefetchstreams);
+        ccnl->prefetchstreams = s;
+    }
+}
+
+#endif // USE_PREFETCH && NEEDS_PACKET_CRAFTING
+
+// eof
@@ -0,0 +1,478 @@
+/*
+ * @f ccnl-ext-preload.c
+ * @b CCN lite extension: loading the content store from files at startup
+ *
+ * Copyright (C) 2026, Christian Tschudin, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2026-10-19 created (was ccnl_populate_cache() of ccn-lite-relay.c)
+ * 2026-10-19 packed repository files
+ */
+
+#if defined(USE_PRELOAD) && defined(CCNL_UNIX)
+
+#include <pthread.h>
+#include <sys/mman.h>
+
+// The files of a directory (one packet each, see "ccn-lite-relay -d") are
+// opened, mapped and read in by CCNL_PRELOAD_THREADS threads, while the
+// relay already serves: between its rounds of select() it decodes up to
+// CCNL_PRELOAD_BATCH of them into the content store. The decoders and the
+// content store belong to the relay's thread, the others only touch the
+// file system; at most CCNL_PRELOAD_QUEUE files wait mapped.
+//
+// A packed repository file (see struct ccnl_repo_hdr_s, written by
+// "ccn-lite-produce -r") is mapped as a whole instead, and one thread reads
+// its packets in, in the order of its index, that is sequentially.
+
+struct ccnl_preload_file_s {
+    struct ccnl_preload_file_s *next;
+    unsigned char *data;        // mapped, NULL if it could not be
+    long len;
+    int err;                    // errno of open/fstat/mmap
+    int suite, skip;
+    char inrepo;                // data is in the repository's mapping
+    unsigned int hash;          // of the name, from the repository's index
+    char name[256];
+};
+
+struct ccnl_preload_s {
+    pthread_mutex_t lock;
+    pthread_cond_t room;        // the queue has room again, or stop
+    pthread_t threads[CCNL_PRELOAD_THREADS];
+    int nthreads, running;      // started, and not yet done
+    DIR *dir;                   // read by the threads, under lock
+    unsigned char *repo;        // or the mapped repository file
+    long repolen, idxoff;
+    long entcnt, nextent;       // index entries, the next is under lock
+    char *path;
+    struct ccnl_preload_file_s *ready, **readytail;
+    int readycnt;
+    char stop;
+    void *timer;
+    struct timeval started;
+    long files, loaded, bytes;
+};
+
+static void*
+ccnl_preload_thread(void *arg)
+{
+    struct ccnl_preload_s *pl = (struct ccnl_preload_s*) arg;
+    struct ccnl_preload_file_s *f;
+    struct dirent *de;
+    struct stat s;
+    char fname[1000];
+    volatile unsigned char sum = 0;
+    long k;
+    int fd;
+
+    pthread_mutex_lock(&pl->lock);
+    while (!pl->stop) {
+        if (pl->readycnt >= CCNL_PRELOAD_QUEUE) {
+            pthread_cond_wait(&pl->room, &pl->lock);
+            continue;
+        }
+        de = readdir(pl->dir);
+        if (!de)
+            break;
+        if (de->d_name[0] == '.')
+            continue;
+        f = (struct ccnl_preload_file_s*) calloc(1, sizeof(*f));
+        if (!f)
+            break;
+        strncpy(f->name, de->d_name, sizeof(f->name) - 1);
+        snprintf(fname, sizeof(fname), "%s/%s", pl->path, de->d_name);
+        pthread_mutex_unlock(&pl->lock);
+
+        fd = open(fname, O_RDONLY);
+        if (fd < 0 || fstat(fd, &s)) {
+            f->err = errno;
+        } else if (S_ISREG(s.st_mode) && s.st_size >= 2) {
+            // private: the decoders may write to what they parse
+            f->data = mmap(NULL, s.st_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE, fd, 0);
+            if (f->data == MAP_FAILED) {
+                f->err = errno;
+                f->data = NULL;
+            } else {
+                f->len = s.st_size;
+                for (k = 0; k < f->len; k += 4096) // read in here
+                    sum += f->data[k];
+                f->suite = ccnl_pkt2suite(f->data, f->len, &f->skip);
+            }
+        } else
+            f->len = s.st_size;
+        if (fd >= 0)
+            close(fd);
+
+        pthread_mutex_lock(&pl->lock);
+        *pl->readytail = f;
+        pl->readytail = &f->next;
+        pl->readycnt++;
+    }
+    pl->running--;
+    pthread_mutex_unlock(&pl->lock);
+    return NULL;
+}
+
+// the packets of the repository file, as its index lists them
+static void*
+ccnl_preload_repo_thread(void *arg)
+{
+    struct ccnl_preload_s *pl = (struct ccnl_preload_s*) arg;
+    struct ccnl_preload_file_s *f;
+    struct ccnl_repo_ent_s e;
+    volatile unsigned char sum = 0;
+    unsigned long long off;
+    long k, n;
+
+    pthread_mutex_lock(&pl->lock);
+    while (!pl->stop && pl->nextent < pl->entcnt) {
+        if (pl->readycnt >= CCNL_PRELOAD_QUEUE) {
+            pthread_cond_wait(&pl->room, &pl->lock);
+            continue;
+        }
+        n = pl->nextent++;
+        pthread_mutex_unlock(&pl->lock);
+
+        f = (struct ccnl_preload_file_s*) calloc(1, sizeof(*f));
+        if (!f) {
+            pthread_mutex_lock(&pl->lock);
+            break;
+        }
+        memcpy(&e, pl->repo + pl->idxoff + n * sizeof(e), sizeof(e));
+        off = ((unsigned long long) ntohl(e.offhi) << 32) | ntohl(e.offlo);
+        f->len = ntohl(e.len);
+        f->hash = ntohl(e.hash);
+        f->inrepo = 1;
+        snprintf(f->name, sizeof(f->name), "packet %ld", n);
+        if (off >= sizeof(struct ccnl_repo_hdr_s) && f->len >= 2 &&
+                off <= (unsigned long long) pl->idxoff &&
+                f->len <= (unsigned long long) pl->idxoff - off) {
+            f->data = pl->repo + off;
+            for (k = 0; k < f->len; k += 4096) // read in here
+                sum += f->data[k];
+            f->suite = ccnl_pkt2suite(f->data, f->len, &f->skip);
+        } else
+            f->err = EINVAL;
+
+        pthread_mutex_lock(&pl->lock);
+        *pl->readytail = f;
+        pl->readytail = &f->next;
+        pl->readycnt++;
+    }
+    pl->running--;
+    pthread_mutex_unlock(&pl->lock);
+    return NULL;
+}
+
+// maps the packed repository file path, -1 if it is none
+static int
+ccnl_preload_repo(struct ccnl_preload_s *pl, char *path)
+{
+    struct ccnl_repo_hdr_s h;
+    struct stat s;
+    unsigned long long idx;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &s) || s.st_size < (long) sizeof(h)) {
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    pl->repo = mmap(NULL, s.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                    fd, 0);
+    close(fd);
+    if (pl->repo == MAP_FAILED) {
+        pl->repo = NULL;
+        return -1;
+    }
+    pl->repolen = s.st_size;
+    memcpy(&h, pl->repo, sizeof(h));
+    idx = ((unsigned long long) ntohl(h.idxhi) << 32) | ntohl(h.idxlo);
+    // the index must fit in the file, without idx + ... wrapping around
+    if (memcmp(h.magic, CCNL_REPO_MAGIC, sizeof(h.magic)) ||
+            ntohl(h.version) != CCNL_REPO_VERSION || idx < sizeof(h) ||
+            idx > (unsigned long long) s.st_size ||
+            ntohl(h.cnt) > ((unsigned long long) s.st_size - idx) /
+                                        sizeof(struct ccnl_repo_ent_s)) {
+        munmap(pl->repo, pl->repolen);
+        pl->repo = NULL;
+        return -1;
+    }
+    pl->idxoff = idx;
+    pl->entcnt = ntohl(h.cnt);
+    return 0;
+}
+
+// ----------------------------------------------------------------------
+
+// the content object in data (suite, after skip bytes of switch header),
+// NULL if there is none
+struct ccnl_content_s*
+ccnl_preload_content(struct ccnl_relay_s *ccnl, int suite, int skip,
+                     unsigned char *data, int datalen, char *what)
+{
+    struct ccnl_buf_s *nonce=0, *ppkd=0, *pkt = 0;
+    struct ccnl_prefix_s *prefix = 0;
+    struct ccnl_content_s *c = 0;
+    unsigned char *start = data, *content;
+    int contlen, typ, len;
+
+    switch (suite) {
+#ifdef USE_SUITE_CCNB
+    case CCNL_SUITE_CCNB:
+        if (data[0+skip] != 0x04 || data[1+skip] != 0x82)
+            goto notacontent;
+        data += 2 + skip;
+        datalen -= 2 + skip;
+        pkt = ccnl_ccnb_extract(&data, &datalen, 0, 0, 0, 0,
+                                &prefix, &nonce, &ppkd, &content, &contlen);
+        break;
+#endif
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        // ccntlv_extract expects the data pointer
+        // at the start of the message. Move past the fixed header.
+        data += skip;
+        datalen -= 8 + skip;
+        data += 8;
+        pkt = ccnl_ccntlv_extract(8, // hdrlen
+                                  &data, &datalen, &prefix, 0, 0, 0,
+                                  &content, &contlen);
+        break;
+#endif
+#ifdef USE_SUITE_IOTTLV
+    case CCNL_SUITE_IOTTLV:
+        data += skip;
+        datalen -= skip;
+        if (ccnl_iottlv_dehead(&data, &datalen, &typ, &len) ||
+                                                   typ != IOT_TLV_Reply)
+            goto notacontent;
+        pkt = ccnl_iottlv_extract(start + skip, &data, &datalen,
+                                  &prefix, NULL, &content, &contlen);
+        break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        data += skip;
+        datalen -= skip;
+        if (ccnl_ndntlv_dehead(&data, &datalen, &typ, &len) ||
+                                                   typ != NDN_TLV_Data)
+            goto notacontent;
+        pkt = ccnl_ndntlv_extract(data - start, &data, &datalen,
+                                  0, 0, 0, 0, 0, 0, NULL, &prefix, NULL,
+                                  &nonce, &ppkd, &content, &contlen);
+        break;
+#endif
+    default:
+        DEBUGMSG(WARNING, "unknown packet format (%s)\n", what);
+        goto Done;
+    }
+    if (!pkt) {
+        DEBUGMSG(WARNING, "parsing error (%s)\n", what);
+        goto Done;
+    }
+    if (!prefix) {
+        DEBUGMSG(WARNING, "missing prefix (%s)\n", what);
+        goto Done;
+    }
+
+    c = ccnl_content_new(ccnl, suite, &pkt, &prefix,
+                         &ppkd, content, contlen);
+    if (!c)
+        DEBUGMSG(WARNING, "could not create content (%s)\n", what);
+Done:
+    free_prefix(prefix);
+    ccnl_free(pkt);
+    ccnl_free(nonce);
+    ccnl_free(ppkd);
+    return c;
+notacontent:
+    DEBUGMSG(WARNING, "not a content object (%s)\n", what);
+    return NULL;
+}
+
+static void
+ccnl_preload_free(struct ccnl_preload_file_s *f)
+{
+    if (f->data && !f->inrepo)
+        munmap(f->data, f->len);
+    free(f);
+}
+
+// stops the threads and drops what is not loaded yet
+void
+ccnl_preload_cleanup(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_preload_s *pl = ccnl->preload;
+    struct ccnl_preload_file_s *f;
+    int k;
+
+    if (!pl)
+        return;
+    pthread_mutex_lock(&pl->lock);
+    pl->stop = 1;
+    pthread_cond_broadcast(&pl->room);
+    pthread_mutex_unlock(&pl->lock);
+    for (k = 0; k < pl->nthreads; k++)
+        pthread_join(pl->threads[k], NULL);
+    while (pl->ready) {
+        f = pl->ready->next;
+        ccnl_preload_free(pl->ready);
+        pl->ready = f;
+    }
+    if (pl->timer)
+        ccnl_rem_timer(pl->timer);
+    if (pl->dir)
+        closedir(pl->dir);
+    if (pl->repo)
+        munmap(pl->repo, pl->repolen);
+    pthread_cond_destroy(&pl->room);
+    pthread_mutex_destroy(&pl->lock);
+    ccnl_free(pl->path);
+    ccnl_free(pl);
+    ccnl->preload = NULL;
+}
+
+// timer: the next batch of files into the content store
+void
+ccnl_preload_work(void *relay, void *dummy)
+{
+    struct ccnl_relay_s *ccnl = (struct ccnl_relay_s*) relay;
+    struct ccnl_preload_s *pl = ccnl->preload;
+    struct ccnl_preload_file_s *f, *batch, **tail;
+    struct ccnl_content_s *c;
+    struct timeval now;
+    double secs;
+    int cnt, done;
+
+    if (!pl)
+        return;
+    pl->timer = NULL;
+    pthread_mutex_lock(&pl->lock);
+    for (cnt = 0, tail = &batch; pl->ready && cnt < CCNL_PRELOAD_BATCH; cnt++) {
+        *tail = pl->ready;
+        tail = &pl->ready->next;
+        pl->ready = pl->ready->next;
+    }
+    *tail = NULL;
+    if (!pl->ready)
+        pl->readytail = &pl->ready;
+    pl->readycnt -= cnt;
+    pthread_cond_broadcast(&pl->room);
+    done = !pl->running && !pl->ready;
+    pthread_mutex_unlock(&pl->lock);
+
+    while (batch) {
+        f = batch->next;
+        pl->files++;
+        if (!batch->data) {
+            DEBUGMSG(WARNING, "could not load file %s, %ld bytes (%s)\n",
+                     batch->name, batch->len,
+                     batch->err ? strerror(batch->err) : "too short");
+        } else {
+            DEBUGMSG(DEBUG, "loading file %s, %ld bytes\n",
+                     batch->name, batch->len);
+            c = ccnl_preload_content(ccnl, batch->suite, batch->skip,
+                                     batch->data, batch->len, batch->name);
+            if (c && batch->inrepo && ccnl_prefix_hash(c->name) != batch->hash)
+                DEBUGMSG(WARNING, "name of %s does not match the index\n",
+                         batch->name);
+            if (c) {
+                ccnl_content_add2cache(ccnl, c);
+                c->flags |= CCNL_CONTENT_FLAGS_STATIC;
+                pl->loaded++;
+                pl->bytes += batch->len;
+            }
+        }
+        ccnl_preload_free(batch);
+        batch = f;
+    }
+
+    if (!done) { // right after the next select(), or once more are mapped
+        pl->timer = ccnl_set_timer(cnt ? 0 : 1000, ccnl_preload_work,
+                                   ccnl, NULL);
+        return;
+    }
+    ccnl_get_timeval(&now);
+    secs = timevaldelta(&now, &pl->started) / 1e6;
+    if (secs <= 0)
+        secs = 1e-6;
+    DEBUGMSG(INFO, "loaded %ld of %ld %s from %s in %.2f s "
+             "(%.0f objects/s, %.1f MB/s)\n", pl->loaded, pl->files,
+             pl->repo ? "packets" : "files", pl->path, secs,
+             pl->loaded / secs, pl->bytes / secs / 1e6);
+    ccnl_preload_cleanup(ccnl);
+}
+
+// starts loading the packets in the files of directory path, or in the
+// packed repository file path
+void
+ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
+{
+    struct ccnl_preload_s *pl;
+    struct stat s;
+    int k, nthreads = CCNL_PRELOAD_THREADS;
+
+    if (ccnl->preload) {
+        DEBUGMSG(ERROR, "still loading %s\n", ccnl->preload->path);
+        return;
+    }
+    pl = (struct ccnl_preload_s*) ccnl_calloc(1, sizeof(*pl));
+    if (!pl)
+        return;
+    if (!stat(path, &s) && S_ISREG(s.st_mode)) {
+        if (ccnl_preload_repo(pl, path)) {
+            DEBUGMSG(ERROR, "%s is not a packed repository file\n", path);
+            ccnl_free(pl);
+            return;
+        }
+        nthreads = 1;
+    } else if (!(pl->dir = opendir(path))) {
+        DEBUGMSG(ERROR, "could not open directory %s\n", path);
+        ccnl_free(pl);
+        return;
+    }
+    pl->path = ccnl_strdup(path);
+    pl->readytail = &pl->ready;
+    pthread_mutex_init(&pl->lock, NULL);
+    pthread_cond_init(&pl->room, NULL);
+    ccnl_get_timeval(&pl->started);
+    ccnl->preload = pl;
+
+    DEBUGMSG(INFO, "populating cache from %s %s\n",
+             pl->repo ? "repository file" : "directory", path);
+
+    pthread_mutex_lock(&pl->lock);
+    for (k = 0; k < nthreads; k++) {
+        if (pthread_create(pl->threads + pl->nthreads, NULL, pl->repo ?
+                           ccnl_preload_repo_thread : ccnl_preload_thread, pl))
+            break;
+        pl->nthreads++;
+        pl->running++;
+    }
+    pthread_mutex_unlock(&pl->lock);
+    if (!pl->nthreads) {
+        DEBUGMSG(ERROR, "could not start the loader threads\n");
+        ccnl_preload_cleanup(ccnl);
+        return;
+    }
+    pl->timer = ccnl_set_timer(0, ccnl_preload_work, ccnl, NULL);
+}
+
+#endif // USE_PRELOAD && CCNL_UNIX
+
+// eof
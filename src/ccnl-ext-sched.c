@@ -18,6 +18,10 @@
  *
  * File history:
  * 2011-04-09 created
+ * 2026-10-19 token bucket rate limiter (bytes/s with burst), setsched options
+ * 2026-10-19 deficit round robin fair queueing of the faces of an interface
+ * 2026-10-19 interest shaping by the expected size of the returning content
+ * 2026-10-19 control and crypto packets bypass the fair queueing deficits
  */
 
 #ifdef USE_CHEMFLOW
@@ -28,8 +32,9 @@
 
 #ifdef USE_SCHEDULER
 
-// currently, this file mostly has stubs,
-// and for now a simple rate controller (dec 2011)
+// currently, this file mostly has stubs, a simple rate controller
+// (dec 2011), a token bucket, fair queueing and interest shaping, see
+// ccnl_sched_setopts()
 
 /* scheduler protocol:
 
@@ -66,13 +71,38 @@ interface)            |
 
 
 struct ccnl_sched_s {
-    char mode; // 0=dummy, 1=pktrate
+    char mode; // 0=dummy, 1=pktrate, 2=tokenbucket
     void (*rts)(struct ccnl_sched_s* s, int cnt, int len, void *aux1, void *aux2);
     // private:
     void (*cts)(void *aux1, void *aux2);
     struct ccnl_relay_s *ccnl;
     void *aux1, *aux2;
     int cnt;
+    // fair queueing (deficit round robin). Interface side: the faces
+    // with a backlog, each may send quantum*weight bytes per round
+    int quantum;
+    struct ccnl_face_s *fqhead, *fqtail;
+    char fqbusy; // in fq_pull()
+    // face side (quantum, if set, overrides the one of the interface),
+    // fqpending counts the CTS_done still to come for what fq_pull() sent
+    int weight, fqpending;
+    char fqsending; // in its CTS from fq_pull()
+    long deficit;
+    struct ccnl_face_s *fqnext;
+    char fqactive, fqnewround;
+    struct timeval fqsince;
+    unsigned long fqbytes, fqpkts;
+    long fqlatavg, fqlatmax; // usec a face waited for its turn
+    // interest shaping (face side): each interest sent upstream costs the
+    // average size of the content coming back (shapeavg), tokens come
+    // at shape bytes/s, the capacity of the way back
+    int shape, shapeqmax, shapeqlen;
+    char shapenack;
+    long shapeavg, shapetokens;
+    struct timeval shapefilled;
+    struct ccnl_buf_s *shapeq, *shapeqend;
+    void *shapeTimer;
+    unsigned long shapedcnt, shapedropcnt;
 #ifdef USE_CHEMFLOW
     struct cf_rnet *rn;
     struct cf_queue *q;
@@ -81,6 +111,12 @@ struct ccnl_sched_s {
     struct timeval nextTX;
     // simple packet rate limiter:
     int ipi; // inter_packet_interval, minimum time between send() in usec
+    // token bucket: rate bytes/s, at most burst bytes at once. Tokens
+    // go negative by the last packet's size, pendingTimer then waits
+    // until they are back
+    int rate, burst;
+    long tokens;
+    struct timeval filled;
 #endif
 };
 
@@ -351,6 +387,525 @@ ccnl_sched_pktrate_new(void (cts)(void *aux1, void *aux2),
     return s;
 }
 
+// ----------------------------------------------------------------------
+// token bucket: while there are tokens, RTS and CTS_done give CTS right
+// away, so a face under its rate costs no timer. Only when they run out
+// one timer waits for the debt to be paid.
+
+#ifndef USE_CHEMFLOW
+
+static void ccnl_sched_tb_kick(struct ccnl_sched_s *s);
+
+// add the tokens earned since the last fill, up to the burst size
+static void
+ccnl_sched_tb_fill(struct ccnl_sched_s *s)
+{
+    struct timeval now;
+    long usec, earned;
+
+    ccnl_get_timeval(&now);
+    usec = timevaldelta(&now, &s->filled);
+    if (usec > 10000000) // idle for long: full (and no overflow below)
+        earned = s->burst - s->tokens;
+    else
+        earned = (long long) s->rate * usec / 1000000;
+    if (earned <= 0)
+        return; // keep the fraction for the next fill
+    s->tokens += earned;
+    if (s->tokens > s->burst)
+        s->tokens = s->burst;
+    s->filled = now;
+}
+
+static void
+ccnl_sched_tb_wakeup(void *aux1, void *aux2)
+{
+    struct ccnl_sched_s *s = (struct ccnl_sched_s*) aux1;
+
+    s->pendingTimer = NULL;
+    ccnl_sched_tb_kick(s);
+}
+
+static void
+ccnl_sched_tb_kick(struct ccnl_sched_s *s)
+{
+    long usec;
+
+    if (s->pendingTimer || s->cnt <= 0)
+        return;
+    ccnl_sched_tb_fill(s);
+    if (s->tokens > 0) {
+        s->cts(s->aux1, s->aux2);
+        return;
+    }
+    usec = (1 - s->tokens) * 1000000LL / s->rate + 1;
+    DEBUGMSG(VERBOSE, "  token bucket empty (%ld), waiting %ld usec\n",
+             s->tokens, usec);
+    s->pendingTimer = ccnl_set_timer(usec, ccnl_sched_tb_wakeup, s, NULL);
+}
+
+#endif // !USE_CHEMFLOW
+
+// ----------------------------------------------------------------------
+// fair queueing: on an interface with a quantum, the face queues are not
+// cleared by their own schedulers but by a deficit round robin over the
+// faces with a backlog. It keeps at most CCNL_SCHED_FQ_IFQLEN packets in
+// the interface queue and refills it after each transmission, so a face
+// with a long queue cannot crowd out the others.
+
+// a face's next transmission unit: a packet, or a fragment of it
+static int
+ccnl_sched_fq_headlen(struct ccnl_face_s *f)
+{
+    if (f->frag && f->frag->protocol != CCNL_FRAG_NONE) {
+        if (f->frag->bigpkt || f->outq)
+            return f->frag->mtu;
+        return 0;
+    }
+    return f->outq ? f->outq->datalen : 0;
+}
+
+static void
+ccnl_sched_fq_unlink(struct ccnl_sched_s *is, struct ccnl_face_s *f)
+{
+    struct ccnl_face_s **pp, *prev = NULL;
+
+    for (pp = &is->fqhead; *pp; prev = *pp, pp = &(*pp)->sched->fqnext)
+        if (*pp == f) {
+            *pp = f->sched->fqnext;
+            if (is->fqtail == f)
+                is->fqtail = prev;
+            break;
+        }
+    f->sched->fqnext = NULL;
+    f->sched->fqactive = 0;
+    f->sched->deficit = 0;
+}
+
+static void
+ccnl_sched_fq_append(struct ccnl_sched_s *is, struct ccnl_face_s *f)
+{
+    f->sched->fqnext = NULL;
+    f->sched->fqnewround = 1;
+    if (is->fqtail)
+        is->fqtail->sched->fqnext = f;
+    else
+        is->fqhead = f;
+    is->fqtail = f;
+}
+
+// called by ccnl_face_enqueue() with the number of packets already queued
+// at f: 0 if the interface does no fair queueing, -1 if f has too many
+// packets queued (drop), 1 if the packet joins the round
+int
+ccnl_sched_fq_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f,
+                      int qlen)
+{
+    struct ccnl_sched_s *is;
+
+    if (f->ifndx < 0 || f->ifndx >= ccnl->ifcount)
+        return 0;
+    is = ccnl->ifs[f->ifndx].sched;
+    if (!is || is->quantum <= 0)
+        return 0;
+    if (qlen >= CCNL_MAX_IF_QLEN)
+        return -1;
+    if (!f->sched) {
+        f->sched = ccnl_sched_dummy_new(
+                        (void(*)(void*,void*))ccnl_face_CTS, ccnl);
+        if (!f->sched)
+            return 0;
+    }
+    if (!f->sched->fqactive) {
+        f->sched->fqactive = 1;
+        f->sched->deficit = 0;
+        ccnl_get_timeval(&f->sched->fqsince);
+        ccnl_sched_fq_append(is, f);
+    }
+    return 1;
+}
+
+// the face with the highest traffic class above data at its head, if any
+static struct ccnl_face_s*
+ccnl_sched_fq_urgent(struct ccnl_sched_s *is)
+{
+    struct ccnl_face_s *f, *best = NULL;
+    int c = CCNL_TCLASS_DATA;
+
+    for (f = is->fqhead; f; f = f->sched->fqnext)
+        if (f->outq && f->outq->tclass > c) {
+            best = f;
+            c = f->outq->tclass;
+        }
+    return best;
+}
+
+// fill the interface queue from the faces in the round
+void
+ccnl_sched_fq_pull(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc)
+{
+    struct ccnl_sched_s *is = ifc->sched, *fs;
+    struct ccnl_face_s *f, *uf;
+    struct timeval now;
+    unsigned int bytes, pkts;
+    long len;
+    int urgent;
+
+    if (!is || is->fqbusy)
+        return;
+    is->fqbusy = 1; // interface_enqueue() may get us back here
+    while ((f = is->fqhead) != NULL && ifc->qlen < CCNL_SCHED_FQ_IFQLEN) {
+        // control and crypto packets go first, outside of the deficits
+        uf = ccnl_sched_fq_urgent(is);
+        urgent = uf != NULL;
+        if (urgent)
+            f = uf;
+        fs = f->sched;
+        len = ccnl_sched_fq_headlen(f);
+        if (!len) { // nothing left, out of the round
+            ccnl_sched_fq_unlink(is, f);
+            continue;
+        }
+        if (!urgent && fs->fqnewround) {
+            fs->fqnewround = 0;
+            fs->deficit += (long) (fs->quantum > 0 ? fs->quantum :
+                            is->quantum > 0 ? is->quantum : 1500) *
+                           (fs->weight > 0 ? fs->weight : 1);
+        }
+        if (!urgent && len > fs->deficit) { // next round
+            is->fqhead = fs->fqnext;
+            if (!is->fqhead)
+                is->fqtail = NULL;
+            ccnl_sched_fq_append(is, f);
+            continue;
+        }
+        bytes = ifc->qbytes;
+        pkts = ifc->qpkts;
+        fs->fqsending = 1;
+        ccnl_face_CTS(ccnl, f);
+        fs->fqsending = 0;
+        bytes = ifc->qbytes - bytes;
+        pkts = ifc->qpkts - pkts;
+        fs->fqpending += pkts;
+        if (!pkts) { // e.g. an ARQ window is full, the face comes back
+            ccnl_sched_fq_unlink(is, f); // with its next packet
+            continue;
+        }
+        if (!urgent)
+            fs->deficit -= bytes;
+        fs->fqbytes += bytes;
+        fs->fqpkts += pkts;
+        ccnl_get_timeval(&now);
+        len = timevaldelta(&now, &fs->fqsince);
+        fs->fqlatavg += (len - fs->fqlatavg) / 8;
+        if (len > fs->fqlatmax)
+            fs->fqlatmax = len;
+        fs->fqsince = now;
+    }
+    is->fqbusy = 0;
+}
+
+// take f out of the round of its interface, before it goes away
+void
+ccnl_sched_fq_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    if (!f->sched || !f->sched->fqactive)
+        return;
+    if (f->ifndx >= 0 && f->ifndx < ccnl->ifcount && ccnl->ifs[f->ifndx].sched)
+        ccnl_sched_fq_unlink(ccnl->ifs[f->ifndx].sched, f);
+}
+
+// fair queueing ends: the faces' own schedulers get their backlog
+void
+ccnl_sched_fq_release(struct ccnl_sched_s *is)
+{
+    struct ccnl_face_s *f;
+    struct ccnl_buf_s *buf;
+    int cnt;
+
+    while ((f = is->fqhead) != NULL) {
+        ccnl_sched_fq_unlink(is, f);
+        for (cnt = 0, buf = f->outq; buf; buf = buf->next)
+            cnt++;
+        if (cnt)
+            ccnl_sched_RTS(f->sched, cnt, 0, is->ccnl, f);
+    }
+}
+
+// ----------------------------------------------------------------------
+// interest shaping: a relay forwarding interests as they come can ask
+// for more content than the link back from the upstream face carries.
+// The shaper of that face lets interests pass while there are tokens,
+// queues at most shapeqmax of them when not, and drops (or, with
+// shapenack, asks for a NACK) beyond that.
+
+// what an interest costs: the expected size of the content it brings
+static long
+ccnl_sched_shape_cost(struct ccnl_sched_s *s)
+{
+    return s->shapeavg ? s->shapeavg : CCNL_SCHED_SHAPE_SIZE;
+}
+
+static void
+ccnl_sched_shape_fill(struct ccnl_sched_s *s)
+{
+    struct timeval now;
+    long usec, burst, earned;
+
+    ccnl_get_timeval(&now);
+    usec = timevaldelta(&now, &s->shapefilled);
+    // a tenth of a second's worth, but at least one interest
+    burst = ccnl_sched_shape_cost(s);
+    if (s->shape / 10 > burst)
+        burst = s->shape / 10;
+    if (usec > 10000000)
+        earned = burst - s->shapetokens;
+    else
+        earned = (long long) s->shape * usec / 1000000;
+    if (earned <= 0)
+        return;
+    s->shapetokens += earned;
+    if (s->shapetokens > burst)
+        s->shapetokens = burst;
+    s->shapefilled = now;
+}
+
+static void ccnl_sched_shape_kick(struct ccnl_relay_s *ccnl,
+                                  struct ccnl_face_s *f);
+
+static void
+ccnl_sched_shape_wakeup(void *aux1, void *aux2)
+{
+    struct ccnl_face_s *f = (struct ccnl_face_s*) aux2;
+
+    f->sched->shapeTimer = NULL;
+    ccnl_sched_shape_kick((struct ccnl_relay_s*) aux1, f);
+}
+
+// send the queued interests the tokens pay for, wait for the others
+static void
+ccnl_sched_shape_kick(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
+{
+    struct ccnl_sched_s *s = f->sched;
+    struct ccnl_buf_s *buf;
+    long usec;
+
+    if (s->shape > 0)
+        ccnl_sched_shape_fill(s);
+    while (s->shapeq && (s->shape <= 0 || s->shapetokens > 0)) {
+        buf = s->shapeq;
+        s->shapeq = buf->next;
+        if (!s->shapeq)
+            s->shapeqend = NULL;
+        buf->next = NULL;
+        s->shapeqlen--;
+        s->shapetokens -= ccnl_sched_shape_cost(s);
+        ccnl_face_enqueue(ccnl, f, buf);
+    }
+    if (!s->shapeq || s->shapeTimer)
+        return;
+    usec = (1 - s->shapetokens) * 1000000LL / s->shape + 1;
+    DEBUGMSG(VERBOSE, "  interest shaping face=%d: %d queued, waiting %ld usec\n",
+             f->faceid, s->shapeqlen, usec);
+    s->shapeTimer = ccnl_set_timer(usec, ccnl_sched_shape_wakeup, ccnl, f);
+}
+
+// called before interest i goes to face f: 0 if it may go now, 1 if a
+// copy was queued, -1 if the queue is full (-2: and a NACK is wanted)
+int
+ccnl_sched_shape_interest(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f,
+                          struct ccnl_interest_s *i)
+{
+    struct ccnl_sched_s *s = f->sched;
+    struct ccnl_buf_s *buf, *q;
+
+    if (!s || (s->shape <= 0 && !s->shapeq))
+        return 0;
+    if (!s->shapeq) {
+        ccnl_sched_shape_fill(s);
+        if (s->shapetokens > 0) {
+            s->shapetokens -= ccnl_sched_shape_cost(s);
+            return 0;
+        }
+    }
+    if (s->shapeqlen >= (s->shapeqmax > 0 ? s->shapeqmax :
+                                            CCNL_SCHED_SHAPE_QLEN)) {
+        DEBUGMSG(DEBUG, "  interest shaping face=%d: queue full\n",
+                 f->faceid);
+        s->shapedropcnt++;
+        return s->shapenack ? -2 : -1;
+    }
+    buf = buf_dup(i->pkt);
+    if (!buf)
+        return -1;
+    if (i->hoppos >= 0 && i->hoppos < (int) buf->datalen)
+        buf->data[i->hoppos] = i->hopval;
+    for (q = s->shapeq; q; q = q->next)
+        if (buf_equal(q, buf)) { // a retransmission, still waiting
+            ccnl_free(buf);
+            return 1;
+        }
+    if (s->shapeqend)
+        s->shapeqend->next = buf;
+    else
+        s->shapeq = buf;
+    s->shapeqend = buf;
+    s->shapeqlen++;
+    s->shapedcnt++;
+    ccnl_sched_shape_kick(ccnl, f);
+    return 1;
+}
+
+// content of len bytes came back from face f (the first one replaces
+// the initial guess)
+void
+ccnl_sched_shape_RX(struct ccnl_face_s *f, int len)
+{
+    struct ccnl_sched_s *s = f->sched;
+
+    if (s)
+        s->shapeavg = s->shapeavg ? s->shapeavg + (len - s->shapeavg) / 8
+                                  : len;
+}
+
+// ----------------------------------------------------------------------
+
+// scheduler counters for the debug dump. Fair queueing: quantum and
+// Jain's fairness index (in thousandths, 1000: equal shares) over the
+// weighted kBytes of the faces of an interface, bytes and waiting times
+// of a face. Interest shaping: rate, expected content size, queue.
+void
+ccnl_sched_dump(struct ccnl_sched_s *s)
+{
+    struct ccnl_face_s *f;
+    struct ccnl_sched_s *fs;
+    unsigned long long x, sum = 0, sumsq = 0;
+    int n = 0;
+
+    if (s->quantum > 0 && s->ccnl) {
+        for (f = s->ccnl->faces; f; f = f->next) {
+            fs = f->sched;
+            if (!fs || !fs->fqpkts || f->ifndx < 0 ||
+                                        s->ccnl->ifs[f->ifndx].sched != s)
+                continue;
+            x = fs->fqbytes / (fs->weight > 0 ? fs->weight : 1) / 1024 + 1;
+            sum += x;
+            sumsq += x * x;
+            n++;
+        }
+        fprintf(stderr, " fq: quantum=%d faces=%d", s->quantum, n);
+        if (n)
+            fprintf(stderr, " fairness=%d",
+                    (int) (sum * sum * 1000 / (n * sumsq)));
+    }
+    if (s->fqpkts || s->weight > 0)
+        fprintf(stderr, " fq: weight=%d bytes=%lu pkts=%lu"
+                " wait=%ld/%ldus(avg/max)", s->weight > 0 ? s->weight : 1,
+                s->fqbytes, s->fqpkts, s->fqlatavg, s->fqlatmax);
+    if (s->shape > 0 || s->shapedcnt)
+        fprintf(stderr, " shape: rate=%d avg=%ld queued=%d shaped=%lu"
+                " dropped=%lu%s", s->shape, ccnl_sched_shape_cost(s),
+                s->shapeqlen,
+                s->shapedcnt, s->shapedropcnt, s->shapenack ? " (nack)" : "");
+}
+
+// limit to rate bytes/s with bursts of up to burst bytes (0: a tenth
+// of a second), or back to the packet rate limiter for rate 0
+int
+ccnl_sched_setrate(struct ccnl_sched_s *s, int rate, int burst)
+{
+#ifdef USE_CHEMFLOW
+    return rate ? -1 : 0;
+#else
+    if (!s || rate < 0 || burst < 0)
+        return -1;
+    if (s->pendingTimer && s->mode == 2) {
+        ccnl_rem_timer(s->pendingTimer);
+        s->pendingTimer = NULL;
+    }
+    if (!rate) {
+        s->mode = 1;
+        ccnl_get_timeval(&s->nextTX);
+        if (s->cnt > 0)
+            s->cts(s->aux1, s->aux2);
+        return 0;
+    }
+    s->mode = 2;
+    s->rate = rate;
+    s->burst = burst ? burst : (rate + 9) / 10;
+    s->tokens = s->burst;
+    ccnl_get_timeval(&s->filled);
+    ccnl_sched_tb_kick(s);
+    return 0;
+#endif
+}
+
+// apply a SCHED string like "rate=125000,burst=3000" (rate in bytes/s,
+// 0 for no limit, burst in bytes), "quantum=1500" (interface: bytes per
+// face and round, 0 turns fair queueing off; face: its own quantum) or
+// "weight=2" (face: share), "shape=125000" (face: interest shaping for
+// content at bytes/s coming back, 0: off), "shapeq=N" (face: interests
+// queued at most) or "shapenack=1" (face: NACK instead of dropping
+// interests once the queue is full); only check it if s is NULL. -1 for
+// an unknown or bad option
+int
+ccnl_sched_setopts(struct ccnl_sched_s *s, char *spec)
+{
+    char *cp = spec, *end;
+    int len, val, rate = -1, burst = 0, quantum = -1, weight = -1;
+    int shape = -1, shapeq = -1, shapenack = -1;
+
+    while (cp && *cp) {
+        len = strcspn(cp, ",");
+        if (len > 5 && !strncmp(cp, "rate=", 5)) {
+            rate = val = strtol(cp + 5, &end, 10);
+        } else if (len > 6 && !strncmp(cp, "burst=", 6)) {
+            burst = val = strtol(cp + 6, &end, 10);
+        } else if (len > 8 && !strncmp(cp, "quantum=", 8)) {
+            quantum = val = strtol(cp + 8, &end, 10);
+        } else if (len > 7 && !strncmp(cp, "weight=", 7)) {
+            weight = val = strtol(cp + 7, &end, 10);
+        } else if (len > 6 && !strncmp(cp, "shape=", 6)) {
+            shape = val = strtol(cp + 6, &end, 10);
+        } else if (len > 7 && !strncmp(cp, "shapeq=", 7)) {
+            shapeq = val = strtol(cp + 7, &end, 10);
+        } else if (len > 10 && !strncmp(cp, "shapenack=", 10)) {
+            shapenack = val = strtol(cp + 10, &end, 10);
+        } else
+            return -1;
+        if (end != cp + len || val < 0)
+            return -1;
+        cp = strchr(cp, ',');
+        if (cp)
+            cp++;
+    }
+    if (rate < 0 && burst)
+        return -1; // a burst needs a rate
+    if (!s)
+        return 0;
+    if (weight >= 0)
+        s->weight = weight;
+    if (shape >= 0) {
+        if (shape && !s->shape) {
+            s->shapetokens = 0;
+            ccnl_get_timeval(&s->shapefilled);
+        }
+        s->shape = shape; // a queue left drains with the pending timer
+    }
+    if (shapeq >= 0)
+        s->shapeqmax = shapeq;
+    if (shapenack >= 0)
+        s->shapenack = shapenack != 0;
+    if (quantum >= 0) {
+        s->quantum = quantum;
+        if (!quantum)
+            ccnl_sched_fq_release(s);
+    }
+    if (rate >= 0)
+        return ccnl_sched_setrate(s, rate, burst);
+    return 0;
+}
+
 void
 ccnl_sched_destroy(struct ccnl_sched_s *s)
 {
@@ -365,7 +920,20 @@ ccnl_sched_destroy(struct ccnl_sched_s *s)
             s->rn->obj.destroylock = 0;
             cf_rnet_destroy(s->rn);
         }
+#else
+        // the packet rate limiter does not keep track of its timers
+        if (s->mode == 2 && s->pendingTimer)
+            ccnl_rem_timer(s->pendingTimer);
 #endif
+        while (s->fqhead)
+            ccnl_sched_fq_unlink(s, s->fqhead);
+        if (s->shapeTimer)
+            ccnl_rem_timer(s->shapeTimer);
+        while (s->shapeq) {
+            struct ccnl_buf_s *buf = s->shapeq->next;
+            ccnl_free(s->shapeq);
+            s->shapeq = buf;
+        }
         ccnl_free(s);
     }
 }
@@ -408,6 +976,10 @@ ccnl_sched_RTS(struct ccnl_sched_s *s, int cnt, int len,
         }
     }
 #else
+    if (s->mode == 2) {
+        ccnl_sched_tb_kick(s);
+        return;
+    }
     ccnl_get_timeval(&now);
     since = timevaldelta(&(s->nextTX), &now);
     if (since <= 0) {
@@ -443,7 +1015,18 @@ ccnl_sched_CTS_done(struct ccnl_sched_s *s, int cnt, int len)
     DEBUGMSG(VERBOSE, "ccnl_sched_CTS_done sched=%p/%d cnt=%d len=%d (mycnt=%d)\n",
              (void*)s, s->mode, cnt, len, s->cnt);
 
+    if (s->fqsending || s->fqpending > 0) { // sent by fair queueing
+        s->fqpending -= cnt;
+        return;
+    }
     s->cnt -= cnt;
+#ifndef USE_CHEMFLOW
+    if (s->mode == 2) {
+        s->tokens -= len;
+        ccnl_sched_tb_kick(s);
+        return;
+    }
+#endif
     if (s->cnt <= 0)
         return;
 
@@ -0,0 +1,172 @@
+/*
+ * @f ccnl-ext-snapshot.c
+ * @b CCN lite extension: content store snapshot, saved and restored
+ *
+ * Copyright (C) 2026, Christian Tschudin, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2026-10-19 created
+ */
+
+#if defined(USE_SNAPSHOT) && defined(USE_PRELOAD) && defined(CCNL_UNIX)
+
+// "ccn-lite-relay -S FILE" restores the content store from FILE at startup
+// and saves it there when the relay stops (SIGTERM, SIGINT, "debug halt")
+// or is told so ("ccn-lite-ctrl debug snapshot"). A snapshot is a header
+// and, per object, a record with its usage (seconds since it was last
+// used, times served, what is left of its freshness) and the packet.
+// Objects are saved from the oldest in the list to the newest, so that
+// adding them again gives the same list; with the ages, the least
+// recently used are also the first to go when the content store is now
+// smaller. Objects loaded with -d are not saved, they are loaded again.
+// Integers are in network byte order.
+
+#define CCNL_SNAPSHOT_MAGIC     "ccnlsnap"
+#define CCNL_SNAPSHOT_VERSION   1
+
+struct ccnl_snapshot_hdr_s {
+    char magic[8];
+    unsigned int version;
+    unsigned int cnt;           // of records
+};
+
+struct ccnl_snapshot_rec_s {    // precedes each packet
+    unsigned int len;           // of the packet
+    unsigned int age;           // seconds since it was last used
+    unsigned int served;        // served_cnt
+    int fresh;                  // msec of freshness left, -1: none
+    unsigned char suite, flags, hops, pad;
+};
+
+// writes the content store to path (via path.tmp), returns the objects
+// written or -1
+int
+ccnl_snapshot_save(struct ccnl_relay_s *ccnl, char *path)
+{
+    struct ccnl_snapshot_hdr_s h;
+    struct ccnl_snapshot_rec_s r;
+    struct ccnl_content_s *c;
+    struct timeval now;
+    char tmp[1000];
+    int cnt = 0, t = CCNL_NOW(), ok;
+    FILE *f;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    f = fopen(tmp, "w");
+    if (!f) {
+        DEBUGMSG(ERROR, "snapshot: could not create %s (%s)\n", tmp,
+                 strerror(errno));
+        return -1;
+    }
+    setvbuf(f, NULL, _IOFBF, 1024*1024);
+    memset(&h, 0, sizeof(h));
+    ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    ccnl_get_timeval(&now);
+    for (c = ccnl->contents; c && c->next; c = c->next);
+    for (; ok && c; c = c->prev) {
+        if ((c->flags & CCNL_CONTENT_FLAGS_STATIC) || !c->pkt)
+            continue;
+        memset(&r, 0, sizeof(r));
+        r.len = htonl(c->pkt->datalen);
+        r.age = htonl(t > c->last_used ? t - c->last_used : 0);
+        r.served = htonl(c->served_cnt);
+        if (!c->fresh.tv_sec)
+            r.fresh = htonl(-1);
+        else if (timevaldelta(&c->fresh, &now) > 0)
+            r.fresh = htonl(timevaldelta(&c->fresh, &now) / 1000);
+        r.suite = c->suite;
+        r.flags = c->flags & (CCNL_CONTENT_FLAGS_STALE |
+                              CCNL_CONTENT_FLAGS_PREFETCHED);
+        r.hops = c->hops;
+        ok = fwrite(&r, sizeof(r), 1, f) == 1 &&
+             fwrite(c->pkt->data, c->pkt->datalen, 1, f) == 1;
+        cnt++;
+    }
+    memcpy(h.magic, CCNL_SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = htonl(CCNL_SNAPSHOT_VERSION);
+    h.cnt = htonl(cnt);
+    ok = ok && !fseek(f, 0, SEEK_SET) && fwrite(&h, sizeof(h), 1, f) == 1;
+    if (fclose(f) || !ok || rename(tmp, path)) {
+        DEBUGMSG(ERROR, "snapshot: could not write %s (%s)\n", path,
+                 strerror(errno));
+        unlink(tmp);
+        return -1;
+    }
+    DEBUGMSG(INFO, "snapshot: %d objects saved to %s\n", cnt, path);
+    return cnt;
+}
+
+// adds the objects of the snapshot in path to the content store, returns
+// how many or -1
+int
+ccnl_snapshot_load(struct ccnl_relay_s *ccnl, char *path)
+{
+    struct ccnl_snapshot_hdr_s h;
+    struct ccnl_snapshot_rec_s r;
+    struct ccnl_content_s *c;
+    unsigned char *data = NULL;
+    unsigned int k, len;
+    int cnt = 0, t = CCNL_NOW(), suite, skip;
+    FILE *f = fopen(path, "r");
+
+    if (!f)
+        return -1;
+    if (fread(&h, sizeof(h), 1, f) != 1 ||
+            memcmp(h.magic, CCNL_SNAPSHOT_MAGIC, sizeof(h.magic)) ||
+            ntohl(h.version) != CCNL_SNAPSHOT_VERSION) {
+        DEBUGMSG(ERROR, "snapshot: %s is not a snapshot\n", path);
+        fclose(f);
+        return -1;
+    }
+    data = (unsigned char*) ccnl_malloc(CCNL_MAX_PACKET_SIZE);
+    for (k = 0; data && k < ntohl(h.cnt); k++) {
+        if (fread(&r, sizeof(r), 1, f) != 1)
+            break;
+        len = ntohl(r.len);
+        if (len < 2 || len > CCNL_MAX_PACKET_SIZE ||
+                                        fread(data, len, 1, f) != 1)
+            break;
+        suite = ccnl_pkt2suite(data, len, &skip);
+        if (suite != r.suite)
+            continue;
+        c = ccnl_preload_content(ccnl, suite, skip, data, len, path);
+        if (!c)
+            continue;
+        c->last_used = t - (int) ntohl(r.age);
+        c->served_cnt = ntohl(r.served);
+        c->hops = r.hops;
+        c->flags = r.flags & (CCNL_CONTENT_FLAGS_STALE |
+                              CCNL_CONTENT_FLAGS_PREFETCHED);
+        memset(&c->fresh, 0, sizeof(c->fresh));
+        if ((int) ntohl(r.fresh) >= 0)
+            ccnl_content_freshness(c, ntohl(r.fresh));
+        if (!ccnl_content_add2cache(ccnl, c)) {
+            free_content(c);
+            continue;
+        }
+        cnt++;
+    }
+    if (k < ntohl(h.cnt))
+        DEBUGMSG(WARNING, "snapshot: %s ends after %u of %u objects\n",
+                 path, k, ntohl(h.cnt));
+    ccnl_free(data);
+    fclose(f);
+    DEBUGMSG(INFO, "snapshot: %d objects restored from %s\n", cnt, path);
+    return cnt;
+}
+
+#endif // USE_SNAPSHOT && USE_PRELOAD && CCNL_UNIX
+
+// eof
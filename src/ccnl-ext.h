@@ -51,6 +51,10 @@ int ccnl_str2suite(char *str);
 
 struct ccnl_frag_s* ccnl_frag_new(int protocol, int mtu);
 
+int ccnl_frag_str2proto(char *spec);
+
+int ccnl_frag_setopts(struct ccnl_frag_s *e, char *spec);
+
 void ccnl_frag_reset(struct ccnl_frag_s *e, struct ccnl_buf_s *buf,
                      int ifndx, sockunion *su);
 
@@ -60,6 +64,18 @@ int ccnl_frag_getfragcount(struct ccnl_frag_s *e, int origlen,
 struct ccnl_buf_s* ccnl_frag_getnext(struct ccnl_frag_s *e,
                                      int *ifndx, sockunion *su);
 
+void ccnl_frag_arq_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
+
+struct ccnl_buf_s* ccnl_frag_fec_getnext(struct ccnl_frag_s *e, int flush);
+
+void ccnl_frag_fec_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
+
+void ccnl_frag_pmtu_start(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
+
+#if defined(CCNL_UNIX) && !defined(USE_SCHEDULER)
+int ccnl_frag_TXv(struct ccnl_relay_s *ccnl, struct ccnl_frag_s *fr);
+#endif
+
 /*
 struct ccnl_buf_s* ccnl_frag_handle_fragment(struct ccnl_relay_s *r,
                 struct ccnl_face_s *f, unsigned char *data, int datalen);
@@ -84,6 +100,9 @@ int ccnl_frag_RX_CCNx2013(RX_datagram callback, struct ccnl_relay_s *relay,
                           struct ccnl_face_s *from,
                           unsigned char **data, int *datalen);
 
+int ccnl_frag_deliver(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+                      unsigned char **data, int *datalen);
+
 int ccnl_is_fragment(unsigned char *data, int datalen);
 #else
 # define ccnl_frag_new(e,u)   NULL
@@ -181,6 +200,19 @@ void ccnl_sched_RTS(struct ccnl_sched_s *s, int cnt, int len,
                     void *aux1, void *aux2);
 void ccnl_sched_CTS_done(struct ccnl_sched_s *s, int cnt, int len);
 void ccnl_sched_destroy(struct ccnl_sched_s *s);
+struct ccnl_sched_s* ccnl_sched_pktrate_new(void (cts)(void *aux1, void *aux2),
+                             struct ccnl_relay_s *ccnl, int inter_packet_interval);
+int ccnl_sched_setrate(struct ccnl_sched_s *s, int rate, int burst);
+int ccnl_sched_setopts(struct ccnl_sched_s *s, char *spec);
+int ccnl_sched_fq_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f,
+                          int qlen);
+void ccnl_sched_fq_pull(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc);
+void ccnl_sched_fq_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
+void ccnl_sched_fq_release(struct ccnl_sched_s *is);
+int ccnl_sched_shape_interest(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f,
+                              struct ccnl_interest_s *i);
+void ccnl_sched_shape_RX(struct ccnl_face_s *f, int len);
+void ccnl_sched_dump(struct ccnl_sched_s *s);
 
 #else
 # define ccnl_sched_CTS_done(S,C,L)     do{}while(0)
@@ -189,6 +221,79 @@ void ccnl_sched_destroy(struct ccnl_sched_s *s);
 
 // ----------------------------------------------------------------------
 
+#ifdef USE_CACHEPOLICY
+
+int ccnl_cs_setpolicy(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                      char *spec);
+char* ccnl_cs_policy2str(struct ccnl_cachepolicy_s *cp);
+void ccnl_cs_count(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                   struct ccnl_content_s *hit);
+int ccnl_cs_admit(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+void ccnl_cs_cleanup(struct ccnl_relay_s *ccnl);
+
+#else
+# define ccnl_cs_count(R,P,C)           do{}while(0)
+# define ccnl_cs_admit(R,C)             1
+# define ccnl_cs_cleanup(R)             do{}while(0)
+#endif
+
+#if defined(USE_PREFETCH) && defined(NEEDS_PACKET_CRAFTING)
+
+int ccnl_prefetch_set(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix,
+                      int window);
+void ccnl_prefetch_RX(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p,
+                      struct ccnl_content_s *c, struct ccnl_interest_s *i);
+int ccnl_prefetch_wanted(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+void ccnl_prefetch_cleanup(struct ccnl_relay_s *ccnl);
+
+#else
+# undef USE_PREFETCH
+# define ccnl_prefetch_RX(R,P,C,I)      do{}while(0)
+# define ccnl_prefetch_wanted(R,C)      0
+# define ccnl_prefetch_cleanup(R)       do{}while(0)
+#endif
+
+#if defined(USE_PRELOAD) && defined(CCNL_UNIX)
+
+void ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path);
+struct ccnl_content_s* ccnl_preload_content(struct ccnl_relay_s *ccnl,
+                  int suite, int skip, unsigned char *data, int datalen,
+                  char *what);
+void ccnl_preload_work(void *relay, void *dummy);
+void ccnl_preload_cleanup(struct ccnl_relay_s *ccnl);
+
+#else
+# define ccnl_preload_cleanup(R)        do{}while(0)
+#endif
+
+#if defined(USE_DISKCACHE) && defined(USE_PRELOAD) && defined(CCNL_UNIX)
+
+int ccnl_disk_open(struct ccnl_relay_s *ccnl, char *dir, long maxbytes);
+void ccnl_disk_demote(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+struct ccnl_content_s* ccnl_disk_lookup(struct ccnl_relay_s *ccnl,
+                                        struct ccnl_prefix_s *p);
+int ccnl_disk_RX(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
+                 struct ccnl_prefix_s *p);
+void ccnl_disk_close(struct ccnl_relay_s *ccnl);
+
+#else
+# undef USE_DISKCACHE
+# define ccnl_disk_demote(R,C)          do{}while(0)
+# define ccnl_disk_RX(R,F,P)            0
+# define ccnl_disk_close(R)             do{}while(0)
+#endif
+
+#if defined(USE_SNAPSHOT) && defined(USE_PRELOAD) && defined(CCNL_UNIX)
+
+int ccnl_snapshot_save(struct ccnl_relay_s *ccnl, char *path);
+int ccnl_snapshot_load(struct ccnl_relay_s *ccnl, char *path);
+
+#else
+# undef USE_SNAPSHOT
+#endif
+
+// ----------------------------------------------------------------------
+
 #ifdef USE_UNIXSOCKET
 
 #if defined (CCNL_UNIX)
@@ -215,6 +320,11 @@ int ccnl_is_local_addr(sockunion *su);
 void ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
                 sockunion *dest, struct ccnl_buf_s *buf);
 
+#if defined(USE_FRAG) && defined(CCNL_UNIX)
+void ccnl_ll_TXv(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
+                 sockunion *dest, struct iovec *iov, int iovcnt);
+#endif
+
 #ifndef CCNL_LINUXKERNEL
 void ccnl_close_socket(int s);
 #endif
@@ -28,17 +28,44 @@ struct ccnl_buf_s *ccnl_face_dequeue(struct ccnl_relay_s *ccnl, struct ccnl_face
 void ccnl_face_CTS_done(void *ptr, int cnt, int len);
 void ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
 int ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to, struct ccnl_buf_s *buf);
+int ccnl_face_send_shared(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to, struct ccnl_buf_s *pkt, int pos, unsigned char val);
+int ccnl_prefix_tclass(struct ccnl_prefix_s *p);
 struct ccnl_interest_s *ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from, char suite, struct ccnl_buf_s **pkt, struct ccnl_prefix_s **prefix, int minsuffix, int maxsuffix);
 int ccnl_interest_append_pending(struct ccnl_interest_s *i, struct ccnl_face_s *from);
-void ccnl_interest_propagate(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i);
+int ccnl_fwd_matches(struct ccnl_forward_s *fwd, struct ccnl_interest_s *i);
+long ccnl_fwd_cost(struct ccnl_forward_s *fwd);
+long ccnl_fwd_rto(struct ccnl_forward_s *fwd);
+struct ccnl_forward_s *ccnl_fwd_lookup(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f, struct ccnl_interest_s *i);
+int ccnl_fwd_send(struct ccnl_relay_s *ccnl, struct ccnl_forward_s *fwd, struct ccnl_interest_s *i);
+int ccnl_fwd_weight(struct ccnl_forward_s *fwd);
+unsigned int ccnl_fwd_namehash(struct ccnl_prefix_s *p);
+struct ccnl_forward_s *ccnl_fwd_pick(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i, int len, struct ccnl_face_s *avoid, struct ccnl_face_s *avoid2);
+int ccnl_fwd_strategy(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i, struct ccnl_face_s *avoid, int strict);
+int ccnl_interest_propagate(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i);
+void ccnl_interest_retx(void *relay, void *ptr);
+void ccnl_interest_retx_start(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i);
+void ccnl_interest_lifetime(struct ccnl_interest_s *i, int msec);
+long ccnl_interest_lifeleft(struct ccnl_interest_s *i);
+int ccnl_interest_overdue(struct ccnl_interest_s *i);
 struct ccnl_interest_s *ccnl_interest_remove(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i);
 int ccnl_i_prefixof_c(struct ccnl_prefix_s *prefix, int minsuffix, int maxsuffix, struct ccnl_content_s *c);
 struct ccnl_content_s *ccnl_content_new(struct ccnl_relay_s *ccnl, char suite, struct ccnl_buf_s **pkt, struct ccnl_prefix_s **prefix, struct ccnl_buf_s **ppk, unsigned char *content, int contlen);
+void ccnl_content_freshness(struct ccnl_content_s *c, int msec);
+int ccnl_content_isStale(struct ccnl_content_s *c);
 struct ccnl_content_s *ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 struct ccnl_content_s *ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+void ccnl_content_used(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+struct ccnl_content_s *ccnl_content_victim(struct ccnl_relay_s *ccnl);
+int ccnl_i_matches_c(struct ccnl_interest_s *i, struct ccnl_content_s *c);
 int ccnl_content_serve_pending(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+void ccnl_fwd_RX(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f, struct ccnl_content_s *c);
+int ccnl_fwd_NACK(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f, struct ccnl_content_s *c);
+struct ccnl_nack_s *ccnl_nack_find(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix);
+void ccnl_nack_cache(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix);
+void ccnl_nack_forget(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix);
+void ccnl_interest_nack(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i);
 void ccnl_do_ageing(void *ptr, void *dummy);
-int ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *nonce);
+int ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl, unsigned char *nonce, int len);
 void ccnl_core_RX(struct ccnl_relay_s *relay, int ifndx, unsigned char *data, int datalen, struct sockaddr *sa, int addrlen);
 void ccnl_core_init(void);
 void ccnl_core_addToCleanup(struct ccnl_buf_s *buf);
@@ -211,6 +238,15 @@ void ccnl_sched_cleanup(void);
 struct ccnl_sched_s *ccnl_sched_dummy_new(void (cts)(void *aux1, void *aux2), struct ccnl_relay_s *ccnl);
 struct ccnl_sched_s *ccnl_sched_pktrate_new(void (cts)(void *aux1, void *aux2), struct ccnl_relay_s *ccnl, int inter_packet_interval);
 void ccnl_sched_destroy(struct ccnl_sched_s *s);
+int ccnl_sched_setrate(struct ccnl_sched_s *s, int rate, int burst);
+int ccnl_sched_setopts(struct ccnl_sched_s *s, char *spec);
+int ccnl_sched_fq_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f, int qlen);
+void ccnl_sched_fq_pull(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc);
+void ccnl_sched_fq_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
+void ccnl_sched_fq_release(struct ccnl_sched_s *is);
+int ccnl_sched_shape_interest(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f, struct ccnl_interest_s *i);
+void ccnl_sched_shape_RX(struct ccnl_face_s *f, int len);
+void ccnl_sched_dump(struct ccnl_sched_s *s);
 void ccnl_sched_RTS(struct ccnl_sched_s *s, int cnt, int len, void *aux1, void *aux2);
 void ccnl_sched_CTS_done(struct ccnl_sched_s *s, int cnt, int len);
 void ccnl_sched_RX_ok(struct ccnl_relay_s *ccnl, int ifndx, int cnt);
@@ -218,6 +254,57 @@ void ccnl_sched_RX_loss(struct ccnl_relay_s *ccnl, int ifndx, int cnt);
 struct ccnl_sched_s *ccnl_sched_packetratelimiter_new(int inter_packet_interval, void (*cts)(void *aux1, void *aux2), void *aux1, void *aux2);
 #endif
 
+
+//---------------------------------------------------------------------------------------------------------------------------------------
+/* ccnl-ext-cache.c */
+#ifdef USE_CACHEPOLICY
+int ccnl_cs_str2policy(char *spec, int *prob);
+char *ccnl_cs_policy2str(struct ccnl_cachepolicy_s *cp);
+struct ccnl_cachepolicy_s *ccnl_cs_policy_find(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *name);
+int ccnl_cs_setpolicy(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix, char *spec);
+int ccnl_cs_frequency(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p);
+void ccnl_cs_count(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p, struct ccnl_content_s *hit);
+int ccnl_cs_admit(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+void ccnl_cs_cleanup(struct ccnl_relay_s *ccnl);
+#endif
+
+
+//---------------------------------------------------------------------------------------------------------------------------------------
+/* ccnl-ext-prefetch.c */
+#if defined(USE_PREFETCH) && defined(NEEDS_PACKET_CRAFTING)
+int ccnl_prefetch_set(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *prefix, int window);
+void ccnl_prefetch_RX(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p, struct ccnl_content_s *c, struct ccnl_interest_s *i);
+int ccnl_prefetch_wanted(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+void ccnl_prefetch_cleanup(struct ccnl_relay_s *ccnl);
+#endif
+
+
+//---------------------------------------------------------------------------------------------------------------------------------------
+/* ccnl-ext-preload.c */
+#if defined(USE_PRELOAD) && defined(CCNL_UNIX)
+struct ccnl_content_s *ccnl_preload_content(struct ccnl_relay_s *ccnl, int suite, int skip, unsigned char *data, int datalen, char *what);
+void ccnl_preload_cleanup(struct ccnl_relay_s *ccnl);
+void ccnl_preload_work(void *relay, void *dummy);
+void ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path);
+#endif
+
+//---------------------------------------------------------------------------------------------------------------------------------------
+/* ccnl-ext-diskcache.c */
+#if defined(USE_DISKCACHE) && defined(USE_PRELOAD) && defined(CCNL_UNIX)
+int ccnl_disk_open(struct ccnl_relay_s *ccnl, char *dir, long maxbytes);
+void ccnl_disk_demote(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+struct ccnl_content_s *ccnl_disk_lookup(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *p);
+int ccnl_disk_RX(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from, struct ccnl_prefix_s *p);
+void ccnl_disk_close(struct ccnl_relay_s *ccnl);
+#endif
+
+//---------------------------------------------------------------------------------------------------------------------------------------
+/* ccnl-ext-snapshot.c */
+#if defined(USE_SNAPSHOT) && defined(USE_PRELOAD) && defined(CCNL_UNIX)
+int ccnl_snapshot_save(struct ccnl_relay_s *ccnl, char *path);
+int ccnl_snapshot_load(struct ccnl_relay_s *ccnl, char *path);
+#endif
+
 //---------------------------------------------------------------------------------------------------------------------------------------
 /* ccnl-core-util.c */
 char* ccnl_suite2str(int suite);
@@ -227,6 +314,7 @@ int ccnl_URItoComponents(char **compVector, unsigned int *compLens, char *uri);
 struct ccnl_prefix_s *ccnl_URItoPrefix(char *uri, int suite, char *nfnexpr, unsigned int *chunknum);
 int ccnl_pkt_mkComponent(int suite, unsigned char *dst, char *src, int srclen);
 struct ccnl_prefix_s *ccnl_prefix_dup(struct ccnl_prefix_s *prefix);
+unsigned int ccnl_prefix_hash(struct ccnl_prefix_s *p);
 int ccnl_pkt2suite(unsigned char *data, int len, int *skip);
 char *ccnl_prefix_to_path(struct ccnl_prefix_s *pr);
 char* ccnl_prefix_to_path_detailed(struct ccnl_prefix_s *pr, int ccntlv_skip, int escape_components, int call_slash);
@@ -237,6 +325,10 @@ void ccnl_lambdaFreeTerm(struct ccnl_lambdaTerm_s *t);
 int ccnl_lambdaStrToComponents(char **compVector, char *str);
 struct ccnl_buf_s *ccnl_mkSimpleInterest(struct ccnl_prefix_s *name, int *nonce);
 struct ccnl_buf_s *ccnl_mkSimpleContent(struct ccnl_prefix_s *name, unsigned char *payload, int paylen, int *payoffset);
+struct ccnl_pkt_tmpl_s *ccnl_pkt_tmpl_new(struct ccnl_prefix_s *name);
+void ccnl_pkt_tmpl_free(struct ccnl_pkt_tmpl_s *t);
+int ccnl_pkt_tmpl_interest(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum, int *nonce, unsigned char **pkt);
+int ccnl_pkt_tmpl_content(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum, unsigned char *payload, int paylen, unsigned int *lastchunknum, int *contentpos, unsigned char **pkt);
 int ccnl_str2suite(char *cp);
 
 
@@ -309,7 +401,10 @@ int ccnl_ndntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 const char *compile_string(void);
 unsigned long int ccnl_ndntlv_nonNegInt(unsigned char *cp, int len);
 int ccnl_ndntlv_dehead(unsigned char **buf, int *len, int *typ, int *vallen);
-struct ccnl_buf_s *ccnl_ndntlv_extract(int hdrlen, unsigned char **data, int *datalen, int *scope, int *mbf, int *min, int *max, unsigned int *final_block_id, struct ccnl_prefix_s **prefix, struct ccnl_prefix_s **tracing, struct ccnl_buf_s **nonce, struct ccnl_buf_s **ppkl, unsigned char **content, int *contlen);
+int ccnl_ndntlv_scan(int hdrlen, unsigned char **data, int *datalen, struct ccnl_ndntlv_view_s *v);
+void ccnl_ndntlv_view2shadow(struct ccnl_ndntlv_view_s *v, struct ccnl_prefix_s *p);
+struct ccnl_buf_s *ccnl_ndntlv_view2pkt(struct ccnl_ndntlv_view_s *v, struct ccnl_prefix_s **prefix, unsigned char **content);
+struct ccnl_buf_s *ccnl_ndntlv_extract(int hdrlen, unsigned char **data, int *datalen, int *scope, int *mbf, int *min, int *max, int *lifetime, int *freshness, unsigned int *final_block_id, struct ccnl_prefix_s **prefix, struct ccnl_prefix_s **tracing, struct ccnl_buf_s **nonce, struct ccnl_buf_s **ppkl, unsigned char **content, int *contlen);
 int ccnl_ndntlv_prependTLval(unsigned long val, int *offset, unsigned char *buf);
 int ccnl_ndntlv_prependTL(int type, unsigned int len, int *offset, unsigned char *buf);
 int ccnl_ndntlv_prependNonNegInt(int type, unsigned int val, int *offset, unsigned char *buf);
@@ -83,6 +83,8 @@ ccnl_ccnb_consume(int typ, int num, unsigned char **buf, int *len,
                   unsigned char **valptr, int *vallen)
 {
     if (typ == CCN_TT_BLOB || typ == CCN_TT_UDATA) {
+        if (num < 0 || num > *len)
+            return -1;
         if (valptr)  *valptr = *buf;
         if (vallen)  *vallen = num;
         *buf += num, *len -= num;
@@ -122,6 +124,8 @@ ccnl_ccnb_extract(unsigned char **data, int *datalen,
     struct ccnl_buf_s *buf, *n = 0, *pub = 0;
     DEBUGMSG(TRACE, "ccnl_ccnb_extract\n");
 
+    if (content)
+        *content = NULL;
     p = ccnl_prefix_new(CCNL_SUITE_CCNB, CCNL_MAX_NAME_COMP);
     p->compcnt = 0;
     if (!p)
@@ -203,7 +207,7 @@ ccnl_ccnb_extract(unsigned char **data, int *datalen,
 
     buf = ccnl_buf_new(start, *data - start);
     // carefully rebase ptrs to new buf because of 64bit pointers:
-    if (content)
+    if (content && *content)
         *content = buf->data + (*content - start);
     for (num = 0; num < p->compcnt; num++)
             p->comp[num] = buf->data + (p->comp[num] - start);
@@ -19,6 +19,7 @@
  * File history:
  * 2014-03-05 created
  * 2014-11-05 merged from pkt-ccntlv-enc.c pkt-ccntlv-dec.c
+ * 2026-10-19 template builders
  */
 
 #ifndef PKT_CCNTLV_C
@@ -43,7 +44,7 @@ int
 ccnl_ccnltv_extractNetworkVarInt(unsigned char *buf, int len,
                                  unsigned int *intval)
 {
-    int val = 0;
+    unsigned int val = 0;
     
     while (len-- > 0) {
         val = (val << 8) | *buf;
@@ -111,22 +112,27 @@ ccnl_ccntlv_extract(int hdrlen,
         int len2 = len;
         unsigned int len3;
 
+        if (len > (unsigned int) *datalen)
+            goto Bail;
+
         switch (typ) {
         case CCNX_TLV_M_Name:
             p->nameptr = start + oldpos;
             while (len2 > 0) {
                 cp2 = cp;
-                if (ccnl_ccntlv_dehead(&cp, &len2, &typ, &len3))
+                if (ccnl_ccntlv_dehead(&cp, &len2, &typ, &len3) ||
+                                                len3 > (unsigned int) len2)
                     goto Bail;
 
                 if (typ == CCNX_TLV_N_Chunk) {
                     // We extract the chunknum to the prefix but keep it in the name component for now
                     // In the future we possibly want to remove the chunk segment from the name components 
                     // and rely on the chunknum field in the prefix.
-                    p->chunknum = ccnl_malloc(sizeof(int));
+                    if (!p->chunknum)
+                        p->chunknum = ccnl_malloc(sizeof(int));
 
                     if (ccnl_ccnltv_extractNetworkVarInt(cp,
-                                                         len2, p->chunknum) < 0) {
+                                                         len3, p->chunknum) < 0) {
                         DEBUGMSG(WARNING, "Error in NetworkVarInt for chunk\n");
                         goto Bail;
                     }
@@ -160,7 +166,8 @@ ccnl_ccntlv_extract(int hdrlen,
 #endif
             break;
         case CCNX_TLV_M_MetaData:
-            if (ccnl_ccntlv_dehead(&cp, &len2, &typ, &len3)) {
+            if (ccnl_ccntlv_dehead(&cp, &len2, &typ, &len3) ||
+                                                len3 > (unsigned int) len2) {
                 DEBUGMSG(WARNING, "error when extracting CCNX_TLV_M_MetaData\n");
                 goto Bail;
             }
@@ -448,6 +455,103 @@ ccnl_ccntlv_prependContentWithHdr(struct ccnl_prefix_s *name,
     return oldoffset - *offset;
 }
 
+// ----------------------------------------------------------------------
+// pre-encoded packets, see ccnl_pkt_tmpl_new()
+
+// write the template's name plus an optional chunk component *before*
+// buf[offs], remember where the chunk component went
+int
+ccnl_ccntlv_prependTmplName(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum,
+                            int *offset, unsigned char *buf)
+{
+    int oldoffset = *offset;
+
+    t->chunkpos = -1;
+    if (chunknum) {
+        if (ccnl_ccntlv_prependNetworkVarInt(CCNX_TLV_N_Chunk, *chunknum,
+                                             offset, buf) < 0)
+            return -1;
+        t->chunkpos = *offset;
+        t->chunklen = oldoffset - *offset;
+    }
+    if (*offset < t->namelen)
+        return -1;
+    *offset -= t->namelen;
+    memcpy(buf + *offset, t->name, t->namelen);
+    if (ccnl_ccntlv_prependTL(CCNX_TLV_M_Name, oldoffset - *offset,
+                              offset, buf) < 0)
+        return -1;
+
+    return 0;
+}
+
+// same packet as ccnl_ccntlv_prependChunkInterestWithHdr()
+int
+ccnl_ccntlv_tmplInterest(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum)
+{
+    int offs = t->size, len;
+
+    t->kind = 0;
+    if (ccnl_ccntlv_prependTmplName(t, chunknum, &offs, t->buf) ||
+        ccnl_ccntlv_prependTL(CCNX_TLV_TL_Interest, t->size - offs,
+                              &offs, t->buf) < 0)
+        return -1;
+    len = t->size - offs;
+    if (len >= ((1 << 16)-8))
+        return -1;
+    if (ccnl_ccntlv_prependFixedHdr(CCNX_TLV_V0, CCNX_TLV_TL_Interest,
+                                    len, 64, &offs, t->buf) < 0)
+        return -1;
+
+    t->kind = 'i';
+    t->final = 0;
+    t->noncepos = t->paypos = -1;
+    t->offs = offs;
+    t->len = t->size - offs;
+    return t->len;
+}
+
+// same packet as ccnl_ccntlv_prependContentWithHdr()
+int
+ccnl_ccntlv_tmplContent(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum,
+                        unsigned char *payload, int paylen,
+                        unsigned int *lastchunknum)
+{
+    int offs = t->size, len;
+
+    t->kind = 0;
+    t->paypos = offs - paylen;
+    t->paylen = paylen;
+    if (ccnl_ccntlv_prependBlob(CCNX_TLV_M_Payload, payload, paylen,
+                                &offs, t->buf) < 0)
+        return -1;
+    if (lastchunknum) {
+        int oldoffset = offs;
+        if (ccnl_ccntlv_prependNetworkVarInt(CCNX_TLV_M_ENDChunk,
+                                             *lastchunknum, &offs, t->buf) < 0 ||
+            ccnl_ccntlv_prependTL(CCNX_TLV_M_MetaData, oldoffset - offs,
+                                  &offs, t->buf) < 0)
+            return -1;
+    }
+    if (ccnl_ccntlv_prependTmplName(t, chunknum, &offs, t->buf) ||
+        ccnl_ccntlv_prependTL(CCNX_TLV_TL_Object, t->size - offs,
+                              &offs, t->buf) < 0)
+        return -1;
+    len = t->size - offs;
+    if (len >= ((1 << 16) - 4))
+        return -1;
+    if (ccnl_ccntlv_prependFixedHdr(CCNX_TLV_V0, CCNX_TLV_TL_Object,
+                                    len, 255, &offs, t->buf) < 0)
+        return -1;
+
+    t->kind = 'c';
+    t->final = lastchunknum != NULL;
+    t->noncepos = -1;
+    t->offs = offs;
+    t->len = t->size - offs;
+    return t->len;
+}
+
 #endif // NEEDS_PACKET_CRAFTING
 
 #endif // PKT_CCNTLV_C
@@ -33,7 +33,9 @@
 static int
 ccnl_iottlv_varlenint(unsigned char **buf, int *len, int *val)
 {
-    if (**buf < 253 && *len >= 1) {
+    if (*len < 1)
+        return -1;
+    if (**buf < 253) {
         *val = **buf;
         *buf += 1;
         *len -= 1;
@@ -43,6 +45,8 @@ ccnl_iottlv_varlenint(unsigned char **buf, int *len, int *val)
         *len -= 3;
     } else if (**buf == 254 && *len >= 5) { // 4 bytes
         *val = ntohl(*(uint32_t*)(*buf + 1));
+        if (*val < 0) // does not fit
+            return -1;
         *buf += 5;
         *len -= 5;
     } else {
@@ -108,7 +112,7 @@ ccnl_iottlv_parseHierarchicalName(unsigned char *data, int datalen)
     p->nameptr = data;
     p->namelen = len;
     while (len > 0) {
-        if (ccnl_iottlv_dehead(&data, &len, &typ, &len2))
+        if (ccnl_iottlv_dehead(&data, &len, &typ, &len2) || len2 > len)
             goto Bail;
         if (typ == IOT_TLV_PN_Component &&
                                p->compcnt < CCNL_MAX_NAME_COMP) {
@@ -156,14 +160,15 @@ ccnl_iottlv_extract(unsigned char *start, unsigned char **data, int *datalen,
         *content = NULL;
 
     while (*datalen) {
-        if (ccnl_iottlv_dehead(data, datalen, &typ, &len))
+        if (ccnl_iottlv_dehead(data, datalen, &typ, &len) || len > *datalen)
             goto Bail;
         switch (typ) {
         case IOT_TLV_R_OptHeader:
         {
             cp = *data;
             cplen = len;
-            while (cplen > 0 && !ccnl_iottlv_dehead(&cp, &cplen, &typ, &len2)) {
+            while (cplen > 0 && !ccnl_iottlv_dehead(&cp, &cplen, &typ, &len2)
+                                                        && len2 <= cplen) {
                 if (typ == IOT_TLV_H_HopLim && len2 == 1 && ttl)
                     *ttl = *cp;
                 cp += len2;
@@ -174,7 +179,8 @@ ccnl_iottlv_extract(unsigned char *start, unsigned char **data, int *datalen,
         case IOT_TLV_R_Name:
             cp = *data;
             cplen = len;
-            while (cplen > 0 && !ccnl_iottlv_dehead(&cp, &cplen, &typ, &len2)) {
+            while (cplen > 0 && !ccnl_iottlv_dehead(&cp, &cplen, &typ, &len2)
+                                                        && len2 <= cplen) {
                 if (typ == IOT_TLV_N_PathName) {
                     if (n)
                         free_prefix(n);
@@ -189,7 +195,8 @@ ccnl_iottlv_extract(unsigned char *start, unsigned char **data, int *datalen,
         case IOT_TLV_R_Payload:
             cp = *data;
             cplen = len;
-            if (!ccnl_iottlv_dehead(&cp, &cplen, &typ, &len2)) {
+            if (!ccnl_iottlv_dehead(&cp, &cplen, &typ, &len2) &&
+                                                            len2 <= cplen) {
                 if (content && typ == IOT_TLV_PL_Data) {
                     *content = cp;
                     *contlen = len2;
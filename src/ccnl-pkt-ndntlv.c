@@ -19,6 +19,9 @@
  * File history:
  * 2014-03-05 created
  * 2014-11-05 merged from pkt-ndntlv-enc.c pkt-ndntlv-dec.c
+ * 2026-10-19 zero-copy scan, extract() builds on it
+ * 2026-10-19 template builders
+ * 2026-10-19 InterestLifetime and FreshnessPeriod
  */
 
 #ifndef PKT_NDNTLV_C
@@ -32,8 +35,9 @@
 static int
 ccnl_ndntlv_varlenint(unsigned char **buf, int *len, int *val)
 {
-
-    if (**buf < 253 && *len >= 1) {
+    if (*len < 1)
+        return -1;
+    if (**buf < 253) {
         *val = **buf;
         *buf += 1;
         *len -= 1;
@@ -43,6 +47,8 @@ ccnl_ndntlv_varlenint(unsigned char **buf, int *len, int *val)
         *len -= 3;
     } else if (**buf == 254 && *len >= 5) { // 4 bytes
         *val = ntohl(*(uint32_t*)(*buf + 1));
+        if (*val < 0) // does not fit
+            return -1;
         *buf += 5;
         *len -= 5;
     } else {
@@ -77,84 +83,80 @@ ccnl_ndntlv_dehead(unsigned char **buf, int *len,
     return 0;
 }
 
-// we use one extraction routine for both interest and data pkts
-struct ccnl_buf_s*
-ccnl_ndntlv_extract(int hdrlen,
-                    unsigned char **data, int *datalen,
-                    int *scope, int *mbf, int *min, int *max,
-                    unsigned int *final_block_id,
-                    struct ccnl_prefix_s **prefix,
-                    struct ccnl_prefix_s **tracing,
-                    struct ccnl_buf_s **nonce,
-                    struct ccnl_buf_s **ppkl,
-                    unsigned char **content, int *contlen)
+// we use one scan routine for both interest and data pkts: fills the
+// view with pointers into the packet, no allocation takes place
+int
+ccnl_ndntlv_scan(int hdrlen, unsigned char **data, int *datalen,
+                 struct ccnl_ndntlv_view_s *v)
 {
-    unsigned char *start = *data - hdrlen;
     int i, len, typ, oldpos;
-    struct ccnl_prefix_s *p;
-    struct ccnl_buf_s *buf, *n = 0, *pub = 0;
 
-    DEBUGMSG(DEBUG, "extracting NDNTLV packet\n");
+    DEBUGMSG(DEBUG, "scanning NDNTLV packet\n");
 
-    if (content)
-        *content = NULL;
-
-    p = ccnl_prefix_new(CCNL_SUITE_NDNTLV, CCNL_MAX_NAME_COMP);
-    p->compcnt = 0;
-    if (!p)
-        return NULL;
+    v->start = *data - hdrlen;
+    v->len = v->namelen = v->compcnt = 0;
+    v->nameptr = v->nonce = v->content = NULL;
+    v->noncelen = v->contlen = v->mbf = 0;
+    v->haschunknum = v->hasfinalblockid = 0;
+    v->scope = v->minsuffix = v->maxsuffix = v->scopepos = -1;
+    v->lifetime = v->freshness = -1;
+#ifdef USE_NFN
+    v->nfnflags = 0;
+#endif
 
-    oldpos = *data - start;
+    oldpos = *data - v->start;
     while (ccnl_ndntlv_dehead(data, datalen, &typ, &len) == 0) {
         unsigned char *cp = *data;
         int len2 = len;
 
+        if (len > *datalen)
+            return -1;
         switch (typ) {
         case NDN_TLV_Name:
-            p->nameptr = start + oldpos;
+            v->nameptr = v->start + oldpos;
             while (len2 > 0) {
-                if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i))
-                    goto Bail;
+                if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i) || i > len2)
+                    return -1;
                 if (typ == NDN_TLV_NameComponent &&
-                            p->compcnt < CCNL_MAX_NAME_COMP) {
-                    if(cp[0] == NDN_Marker_SegmentNumber) {
-                        p->chunknum = ccnl_malloc(sizeof(int));
+                            v->compcnt < CCNL_MAX_NAME_COMP) {
+                    if (i > 0 && cp[0] == NDN_Marker_SegmentNumber) {
                         // TODO: requires ccnl_ndntlv_includedNonNegInt which includes the length of the marker
                         // it is implemented for encode, the decode is not yet implemented
-                        *p->chunknum = ccnl_ndntlv_nonNegInt(cp + 1, i - 1);
+                        v->chunknum = ccnl_ndntlv_nonNegInt(cp + 1, i - 1);
+                        v->haschunknum = 1;
                     }
-                    p->comp[p->compcnt] = cp;
-                    p->complen[p->compcnt] = i;
-                    p->compcnt++;
+                    v->comp[v->compcnt] = cp;
+                    v->complen[v->compcnt] = i;
+                    v->compcnt++;
                 }  // else unknown type: skip
                 cp += i;
                 len2 -= i;
             }
-            p->namelen = *data - p->nameptr;
+            v->namelen = *data + len - v->nameptr;
     #ifdef USE_NFN
-            if (p->compcnt > 0 && p->complen[p->compcnt-1] == 3 &&
-                    !memcmp(p->comp[p->compcnt-1], "NFN", 3)) {
-                p->nfnflags |= CCNL_PREFIX_NFN;
-                p->compcnt--;
-                if (p->compcnt > 0 && p->complen[p->compcnt-1] == 5 &&
-                        !memcmp(p->comp[p->compcnt-1], "THUNK", 5)) {
-                    p->nfnflags |= CCNL_PREFIX_THUNK;
-                    p->compcnt--;
+            if (v->compcnt > 0 && v->complen[v->compcnt-1] == 3 &&
+                    !memcmp(v->comp[v->compcnt-1], "NFN", 3)) {
+                v->nfnflags |= CCNL_PREFIX_NFN;
+                v->compcnt--;
+                if (v->compcnt > 0 && v->complen[v->compcnt-1] == 5 &&
+                        !memcmp(v->comp[v->compcnt-1], "THUNK", 5)) {
+                    v->nfnflags |= CCNL_PREFIX_THUNK;
+                    v->compcnt--;
                 }
             }
     #endif
             break;
         case NDN_TLV_Selectors:
             while (len2 > 0) {
-                if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i))
-                    goto Bail;
-
-                if (typ == NDN_TLV_MinSuffixComponents && min)
-                    *min = ccnl_ndntlv_nonNegInt(cp, i);
-                if (typ == NDN_TLV_MinSuffixComponents && max)
-                    *max = ccnl_ndntlv_nonNegInt(cp, i);
-                if (typ == NDN_TLV_MustBeFresh && mbf)
-                    *mbf = 1;
+                if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i) || i > len2)
+                    return -1;
+
+                if (typ == NDN_TLV_MinSuffixComponents)
+                    v->minsuffix = ccnl_ndntlv_nonNegInt(cp, i);
+                if (typ == NDN_TLV_MaxSuffixComponents)
+                    v->maxsuffix = ccnl_ndntlv_nonNegInt(cp, i);
+                if (typ == NDN_TLV_MustBeFresh)
+                    v->mbf = 1;
                 if (typ == NDN_TLV_Exclude) {
                     DEBUGMSG(WARNING, "'Exclude' field ignored\n");
                 }
@@ -163,39 +165,45 @@ ccnl_ndntlv_extract(int hdrlen,
             }
             break;
         case NDN_TLV_Nonce:
-            if (!n)
-                n = ccnl_buf_new(*data, len);
+            if (!v->nonce) {
+                v->nonce = *data;
+                v->noncelen = len;
+            }
             break;
         case NDN_TLV_Scope:
-            if (scope)
-                *scope = ccnl_ndntlv_nonNegInt(*data, len);
+            v->scope = ccnl_ndntlv_nonNegInt(*data, len);
+            v->scopepos = len == 1 ? *data - v->start : -1;
+            break;
+        case NDN_TLV_InterestLifetime:
+            v->lifetime = ccnl_ndntlv_nonNegInt(*data, len);
             break;
         case NDN_TLV_Content:
-            if (content) {
-                *content = *data;
-                *contlen = len;
-            }
+            v->content = *data;
+            v->contlen = len;
             break;
         case NDN_TLV_MetaInfo:
             while (len2 > 0) {
-                if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i))
-                    goto Bail;
+                if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i) || i > len2)
+                    return -1;
                 if (typ == NDN_TLV_ContentType) {
                     // Not used
                     // = ccnl_ndntlv_nonNegInt(cp, i);
                     DEBUGMSG(WARNING, "'ContentType' field ignored\n");
                 }
                 if (typ == NDN_TLV_FreshnessPeriod)
-                    // Not used
-                    // = ccnl_ndntlv_nonNegInt(cp, i);
-                    DEBUGMSG(WARNING, "'FreshnessPeriod' field ignored\n");
+                    v->freshness = ccnl_ndntlv_nonNegInt(cp, i);
                 if (typ == NDN_TLV_FinalBlockId) {
-                    if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i))
-                        goto Bail;
-                    if (typ == NDN_TLV_NameComponent && final_block_id) {
+                    unsigned char *cp2 = cp;
+                    int len3 = i, typ2, i2;
+                    if (ccnl_ndntlv_dehead(&cp2, &len3, &typ2, &i2) ||
+                                                                i2 > len3)
+                        return -1;
+                    if (typ2 == NDN_TLV_NameComponent && i2 > 0) {
                         // TODO: again, includedNonNeg not yet implemented
-                        *final_block_id = ccnl_ndntlv_nonNegInt(cp + 1, i - 1);
-                    } 
+                        v->final_block_id = ccnl_ndntlv_nonNegInt(cp2 + 1,
+                                                                  i2 - 1);
+                        v->hasfinalblockid = 1;
+                    }
                 }
                 cp += i;
                 len2 -= i;
@@ -206,29 +214,124 @@ ccnl_ndntlv_extract(int hdrlen,
         }
         *data += len;
         *datalen -= len;
-        oldpos = *data - start;
+        oldpos = *data - v->start;
     }
     if (*datalen > 0)
-        goto Bail;
+        return -1;
+    v->len = *data - v->start;
+
+    return 0;
+}
 
-    if (prefix)    *prefix = p;    else free_prefix(p);
-    if (nonce)     *nonce = n;     else ccnl_free(n);
-    if (ppkl)      *ppkl = pub;    else ccnl_free(pub);
+// fill a prefix struct which borrows the view's component arrays: good
+// for PIT and CS lookups, must neither be freed nor be kept
+void
+ccnl_ndntlv_view2shadow(struct ccnl_ndntlv_view_s *v,
+                        struct ccnl_prefix_s *p)
+{
+    memset(p, 0, sizeof(*p));
+    p->suite = CCNL_SUITE_NDNTLV;
+    p->comp = v->comp;
+    p->complen = v->complen;
+    p->compcnt = v->compcnt;
+    p->nameptr = v->nameptr;
+    p->namelen = v->namelen;
+    if (v->haschunknum)
+        p->chunknum = &v->chunknum;
+#ifdef USE_NFN
+    p->nfnflags = v->nfnflags;
+#endif
+}
+
+// copy the viewed packet into its own buffer and return it, together
+// with a prefix (and content ptr) pointing into that new buffer
+struct ccnl_buf_s*
+ccnl_ndntlv_view2pkt(struct ccnl_ndntlv_view_s *v,
+                     struct ccnl_prefix_s **prefix, unsigned char **content)
+{
+    struct ccnl_buf_s *buf;
+    struct ccnl_prefix_s *p;
+    int i;
 
-    buf = ccnl_buf_new(start, *data - start);
+    buf = ccnl_buf_new(v->start, v->len);
+    if (!buf)
+        return NULL;
+    if (content)
+        *content = v->content ? buf->data + (v->content - v->start) : NULL;
+    if (!prefix)
+        return buf;
+
+    p = ccnl_prefix_new(CCNL_SUITE_NDNTLV, CCNL_MAX_NAME_COMP);
+    if (!p) {
+        ccnl_free(buf);
+        return NULL;
+    }
     // carefully rebase ptrs to new buf because of 64bit pointers:
-    if (content && *content)
-        *content = buf->data + (*content - start);
-    for (i = 0; i < p->compcnt; i++)
-        p->comp[i] = buf->data + (p->comp[i] - start);
-    if (p->nameptr)
-        p->nameptr = buf->data + (p->nameptr - start);
+    for (i = 0; i < v->compcnt; i++) {
+        p->comp[i] = buf->data + (v->comp[i] - v->start);
+        p->complen[i] = v->complen[i];
+    }
+    p->compcnt = v->compcnt;
+    if (v->nameptr) {
+        p->nameptr = buf->data + (v->nameptr - v->start);
+        p->namelen = v->namelen;
+    }
+    if (v->haschunknum) {
+        p->chunknum = ccnl_malloc(sizeof(int));
+        *p->chunknum = v->chunknum;
+    }
+#ifdef USE_NFN
+    p->nfnflags = v->nfnflags;
+#endif
+    *prefix = p;
+
+    return buf;
+}
+
+// allocating variant of ccnl_ndntlv_scan(), for callers which want to own
+// the packet and its name right away
+struct ccnl_buf_s*
+ccnl_ndntlv_extract(int hdrlen,
+                    unsigned char **data, int *datalen,
+                    int *scope, int *mbf, int *min, int *max,
+                    int *lifetime, int *freshness,
+                    unsigned int *final_block_id,
+                    struct ccnl_prefix_s **prefix,
+                    struct ccnl_prefix_s **tracing,
+                    struct ccnl_buf_s **nonce,
+                    struct ccnl_buf_s **ppkl,
+                    unsigned char **content, int *contlen)
+{
+    struct ccnl_ndntlv_view_s v;
+    struct ccnl_buf_s *buf;
+
+    DEBUGMSG(DEBUG, "extracting NDNTLV packet\n");
+
+    if (content)
+        *content = NULL;
+    if (ccnl_ndntlv_scan(hdrlen, data, datalen, &v))
+        return NULL;
+
+    if (scope && v.scope >= 0)          *scope = v.scope;
+    if (mbf && v.mbf)                   *mbf = 1;
+    if (min && v.minsuffix >= 0)        *min = v.minsuffix;
+    if (max && v.maxsuffix >= 0)        *max = v.maxsuffix;
+    if (lifetime && v.lifetime >= 0)    *lifetime = v.lifetime;
+    if (freshness && v.freshness >= 0)  *freshness = v.freshness;
+    if (final_block_id && v.hasfinalblockid)
+        *final_block_id = v.final_block_id;
+    if (content && v.content)
+        *contlen = v.contlen;
+
+    buf = ccnl_ndntlv_view2pkt(&v, prefix, content);
+    if (!buf)
+        return NULL;
+    if (nonce)
+        *nonce = v.nonce ? ccnl_buf_new(v.nonce, v.noncelen) : NULL;
+    if (ppkl)
+        *ppkl = NULL;
 
     return buf;
-Bail:
-    free_prefix(p);
-    free_2ptr_list(n, pub);
-    return NULL;
 }
 
 // ----------------------------------------------------------------------
@@ -428,9 +531,6 @@ ccnl_ndntlv_prependContent(struct ccnl_prefix_s *name,
     int oldoffset = *offset, oldoffset2;
     unsigned char signatureType[1] = { NDN_SigTypeVal_SignatureSha256WithRsa };
 
-    if (contentpos)
-        *contentpos = *offset - paylen;
-
     // fill in backwards
 
     // mandatory (empty for now)
@@ -453,7 +553,9 @@ ccnl_ndntlv_prependContent(struct ccnl_prefix_s *name,
     if (ccnl_ndntlv_prependTL(NDN_TLV_SignatureInfo, oldoffset2 - *offset, offset, buf) < 0)
         return -1;
 
-    // mandatory
+    // mandatory, the signature fields come after the content
+    if (contentpos)
+        *contentpos = *offset - paylen;
     if (ccnl_ndntlv_prependBlob(NDN_TLV_Content, payload, paylen,
                                 offset, buf) < 0)
         return -1;
@@ -491,6 +593,120 @@ ccnl_ndntlv_prependContent(struct ccnl_prefix_s *name,
     return oldoffset - *offset;
 }
 
+// ----------------------------------------------------------------------
+// pre-encoded packets, see ccnl_pkt_tmpl_new()
+
+// write the template's name plus an optional chunk component *before*
+// buf[offs], remember where the chunk component went
+int
+ccnl_ndntlv_prependTmplName(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum,
+                            int *offset, unsigned char *buf)
+{
+    int oldoffset = *offset;
+
+    t->chunkpos = -1;
+    if (chunknum) {
+        if (ccnl_ndntlv_prependIncludedNonNegInt(NDN_TLV_NameComponent,
+                                                 *chunknum,
+                                                 NDN_Marker_SegmentNumber,
+                                                 offset, buf) < 0)
+            return -1;
+        t->chunkpos = *offset;
+        t->chunklen = oldoffset - *offset;
+    }
+    if (*offset < t->namelen)
+        return -1;
+    *offset -= t->namelen;
+    memcpy(buf + *offset, t->name, t->namelen);
+    if (ccnl_ndntlv_prependTL(NDN_TLV_Name, oldoffset - *offset,
+                              offset, buf) < 0)
+        return -1;
+
+    return 0;
+}
+
+// same packet as ccnl_ndntlv_prependInterest(name, -1, nonce, ..)
+int
+ccnl_ndntlv_tmplInterest(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum,
+                         int *nonce)
+{
+    int offs = t->size;
+    unsigned char lifetime[2] = { 0x0f, 0xa0 };
+
+    t->kind = 0;
+    if (ccnl_ndntlv_prependBlob(NDN_TLV_InterestLifetime, lifetime, 2,
+                                &offs, t->buf) < 0)
+        return -1;
+    t->noncepos = -1;
+    if (nonce) {
+        if (ccnl_ndntlv_prependBlob(NDN_TLV_Nonce, (unsigned char*) nonce, 4,
+                                    &offs, t->buf) < 0)
+            return -1;
+        t->noncepos = offs + 2;
+    }
+    if (ccnl_ndntlv_prependTmplName(t, chunknum, &offs, t->buf))
+        return -1;
+    if (ccnl_ndntlv_prependTL(NDN_TLV_Interest, t->size - offs,
+                              &offs, t->buf) < 0)
+        return -1;
+
+    t->kind = 'i';
+    t->final = 0;
+    t->paypos = -1;
+    t->offs = offs;
+    t->len = t->size - offs;
+    return t->len;
+}
+
+// same packet as ccnl_ndntlv_prependContent()
+int
+ccnl_ndntlv_tmplContent(struct ccnl_pkt_tmpl_s *t, unsigned int *chunknum,
+                        unsigned char *payload, int paylen,
+                        unsigned int *final_block_id)
+{
+    int offs = t->size, oldoffset2;
+    unsigned char sig[5] = { NDN_TLV_SignatureType, 1,
+                             NDN_SigTypeVal_SignatureSha256WithRsa,
+                             NDN_TLV_KeyLocator, 0 };
+
+    t->kind = 0;
+    if (ccnl_ndntlv_prependTL(NDN_TLV_SignatureValue, 0, &offs, t->buf) < 0 ||
+        ccnl_ndntlv_prependBlob(NDN_TLV_SignatureInfo, sig, sizeof(sig),
+                                &offs, t->buf) < 0)
+        return -1;
+    t->paypos = offs - paylen;
+    t->paylen = paylen;
+    if (ccnl_ndntlv_prependBlob(NDN_TLV_Content, payload, paylen,
+                                &offs, t->buf) < 0)
+        return -1;
+
+    oldoffset2 = offs;
+    if (final_block_id) {
+        if (ccnl_ndntlv_prependIncludedNonNegInt(NDN_TLV_NameComponent,
+                                                 *final_block_id,
+                                                 NDN_Marker_SegmentNumber,
+                                                 &offs, t->buf) < 0 ||
+            ccnl_ndntlv_prependTL(NDN_TLV_FinalBlockId, oldoffset2 - offs,
+                                  &offs, t->buf) < 0)
+            return -1;
+    }
+    if (ccnl_ndntlv_prependTL(NDN_TLV_MetaInfo, oldoffset2 - offs,
+                              &offs, t->buf) < 0)
+        return -1;
+    if (ccnl_ndntlv_prependTmplName(t, chunknum, &offs, t->buf))
+        return -1;
+    if (ccnl_ndntlv_prependTL(NDN_TLV_Data, t->size - offs,
+                              &offs, t->buf) < 0)
+        return -1;
+
+    t->kind = 'c';
+    t->final = final_block_id != NULL;
+    t->noncepos = -1;
+    t->offs = offs;
+    t->len = t->size - offs;
+    return t->len;
+}
+
 #endif // NEEDS_PACKET_CRAFTING
 
 #endif // PKT_NDNTLV_C
@@ -18,6 +18,7 @@
  *
  * File history:
  * 2014-03-05 created
+ * 2026-10-19 zero-copy packet view
  */
 
 #define NDN_UDP_PORT                    6363
@@ -92,4 +93,32 @@ Values          Designation
 #define NDN_Marker_Timestamp			0xFC
 #define NDN_Marker_SequenceNumber		0xFE
 
+// Zero-copy view of a NDNTLV packet, filled by ccnl_ndntlv_scan().
+// All pointers refer into the receive buffer, nothing is allocated:
+// the forwarder only copies the packet once it decides to keep it
+// (PIT entry, CS entry), see ccnl_ndntlv_view2pkt()
+struct ccnl_ndntlv_view_s {
+    unsigned char *start;       // first byte of the packet (outer TL)
+    int len;                    // full length of the packet
+    unsigned char *nameptr;     // Name TLV, including its TL
+    int namelen;
+    int compcnt;
+    unsigned char *comp[CCNL_MAX_NAME_COMP];
+    int complen[CCNL_MAX_NAME_COMP];
+    int haschunknum;
+    unsigned int chunknum;
+#ifdef USE_NFN
+    unsigned int nfnflags;
+#endif
+    int scope, mbf, minsuffix, maxsuffix;       // -1 if absent (mbf: 0)
+    int lifetime, freshness;    // msec, -1 if absent
+    int scopepos;               // offset of the 1-byte Scope value, or -1
+    unsigned char *nonce;
+    int noncelen;
+    unsigned char *content;
+    int contlen;
+    int hasfinalblockid;
+    unsigned int final_block_id;
+};
+
 // eof
@@ -22,6 +22,7 @@
  * 2013-03-19 updated (ms): replacement code after renaming the field
  *              ccnl_relay_s.client to ccnl_relay_s.aux
  * 2014-12-18 removed log generation (cft)
+ * 2026-10-19 goodput of each task (content bytes over elapsed time)
  */
 
 
@@ -38,9 +39,12 @@ struct ccnl_client_s {
     int threadcnt;
     int last_received;
     int retries, outofseq;
+    int bytes;            // content received, for the goodput
+    struct timeval start;
 };
 
-int pending_client_tasks;
+int pending_client_tasks; // counted when scheduled, a phase ends with
+                          // its last task (not with the first started one)
 int phaseOne;
 
 void
@@ -61,6 +65,21 @@ ccnl_simu_client_timeout(void *ptr, void *aux)
     ccnl_client_TX(node, cl->name, cl->onthefly[ndx], cl->nonces[ndx]);
 }
 
+void
+ccnl_simu_client_goodput(struct ccnl_relay_s *relay)
+{
+    struct ccnl_client_s *cl = relay->aux;
+    struct timeval now;
+    long usec;
+
+    ccnl_get_timeval(&now);
+    usec = timevaldelta(&now, &cl->start);
+    if (usec < 1)
+        usec = 1;
+    DEBUGMSG(INFO, "goodput of node %c: %d bytes in %.3f s, %.1f kB/s\n",
+             relay2char(relay), cl->bytes, usec / 1e6, cl->bytes * 1e3 / usec);
+}
+
 void
 ccnl_simu_client_RX(struct ccnl_relay_s *relay, char *name,
                    int seqn, char *data, int len) // receiving side
@@ -91,6 +110,7 @@ ccnl_simu_client_RX(struct ccnl_relay_s *relay, char *name,
         cl->outofseq++;
     }
     cl->last_received = seqn;
+    cl->bytes += len;
 
     if (cl->to_handlers[i]) {
         ccnl_rem_timer(cl->to_handlers[i]);
@@ -106,6 +126,7 @@ ccnl_simu_client_RX(struct ccnl_relay_s *relay, char *name,
             pending_client_tasks--;
             DEBUGMSG(INFO, "task for node %c ended, %d retransmit(s), %d outofseq /%d\n",
                      node, cl->retries, cl->outofseq, pending_client_tasks);
+            ccnl_simu_client_goodput(relay);
             if (pending_client_tasks <= 0) {
                 if (phaseOne == 1){
                     DEBUGMSG(INFO, "Enter Phase-TWO (by node %c)\n\n", node);
@@ -163,15 +184,16 @@ void
 ccnl_simu_client_start(void *ptr, void *dummy)
 {
     struct ccnl_relay_s *relay = (struct ccnl_relay_s*) ptr;
+    struct ccnl_client_s *cl = relay->aux;
     char node = relay2char(relay);
     int i;
 
     if (phaseOne != 1) {
-        struct ccnl_client_s *cl = relay->aux;
         cl->nextseq = 0;
         cl->name = node == 'A' ? "/ccnl/simu/movie2" : "/ccnl/simu/movie3";
     }
-    pending_client_tasks++;
+    cl->bytes = 0;
+    ccnl_get_timeval(&cl->start);
 
     // kick the client by installing MAX_PIPELINE threads
     for (i = 0; i < MAX_PIPELINE; i++)
@@ -20,6 +20,12 @@
  * 2012-06-01  created
  * 2013-07     <christopher.scherb@unibas.ch> heavy reworking and parsing
  *             of return message
+ * 2026-10-19  setsched command
+ * 2026-10-19  prefixreg with a forwarding strategy
+ * 2026-10-19  setcache command
+ * 2026-10-19  setcache prefetch=CHUNKS
+ * 2026-10-19  setweight command, prefixreg STRATEGY weighted
+ * 2026-10-19  debug snapshot
  */
 #define CCNL_UNIX
 #define USE_SUITE_CCNB
@@ -433,11 +439,129 @@ mkSetfragRequest(unsigned char *out, char *faceid, char *frag, char *mtu, char *
     return len;
 }
 
+// TARGET is "face" or "dev", ID a face id or an interface index
+int
+mkSetschedRequest(unsigned char *out, char *target, char *id, char *sched,
+                  char *private_key_path)
+{
+    int len = 0, len1 = 0, len2 = 0, len3 = 0;
+    unsigned char out1[CCNL_MAX_PACKET_SIZE];
+    unsigned char contentobj[2000];
+    unsigned char faceinst[2000];
+
+    len = ccnl_ccnb_mkHeader(out, CCN_DTAG_INTEREST, CCN_TT_DTAG);   // interest
+    len += ccnl_ccnb_mkHeader(out+len, CCN_DTAG_NAME, CCN_TT_DTAG);  // name
+
+    len1 += ccnl_ccnb_mkStrBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "ccnx");
+    len1 += ccnl_ccnb_mkStrBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "");
+    len1 += ccnl_ccnb_mkStrBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "setsched");
+
+    // prepare FACEINSTANCE
+    len3 = ccnl_ccnb_mkHeader(faceinst, CCN_DTAG_FACEINSTANCE, CCN_TT_DTAG);
+    len3 += ccnl_ccnb_mkStrBlob(faceinst+len3, CCN_DTAG_ACTION, CCN_TT_DTAG, "setsched");
+    len3 += ccnl_ccnb_mkStrBlob(faceinst+len3, strcmp(target, "dev") ?
+                          CCN_DTAG_FACEID : CCNL_DTAG_IFNDX, CCN_TT_DTAG, id);
+    len3 += ccnl_ccnb_mkStrBlob(faceinst+len3, CCNL_DTAG_SCHED, CCN_TT_DTAG, sched);
+    faceinst[len3++] = 0; // end-of-faceinst
+
+    // prepare CONTENTOBJ with CONTENT
+    len2 = ccnl_ccnb_mkHeader(contentobj, CCN_DTAG_CONTENTOBJ, CCN_TT_DTAG);   // contentobj
+    len2 += ccnl_ccnb_mkBlob(contentobj+len2, CCN_DTAG_CONTENT, CCN_TT_DTAG,  // content
+                             (char*) faceinst, len3);
+    contentobj[len2++] = 0; // end-of-contentobj
+
+    // add CONTENTOBJ as the final name component
+    len1 += ccnl_ccnb_mkBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG,  // comp
+                             (char*) contentobj, len2);
+
+#ifdef USE_SIGNATURES
+    if(private_key_path) len += add_signature(out+len, private_key_path, out1, len1);
+#endif /*USE_SIGNATURES*/
+    memcpy(out+len, out1, len1);
+    len += len1;
+    out[len++] = 0; // end-of-name
+    out[len++] = 0; // end-of-interest
+
+    return len;
+}
+
 
 // ----------------------------------------------------------------------
 
+// POLICY is lce, lcd, prob=PERCENT, probcache or tinylfu
+int
+mkSetcacheRequest(unsigned char *out, char *path, char *policy, int suite,
+                  char *private_key_path)
+{
+    int len = 0, len1 = 0, len2 = 0, len3 = 0;
+    unsigned char out1[CCNL_MAX_PACKET_SIZE];
+    unsigned char contentobj[2000];
+    unsigned char entry[2000];
+    char suite_s[1];
+    char *cp;
+
+    len = ccnl_ccnb_mkHeader(out, CCN_DTAG_INTEREST, CCN_TT_DTAG);   // interest
+    len += ccnl_ccnb_mkHeader(out+len, CCN_DTAG_NAME, CCN_TT_DTAG);  // name
+
+    len1 += ccnl_ccnb_mkStrBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "ccnx");
+    len1 += ccnl_ccnb_mkStrBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "");
+    len1 += ccnl_ccnb_mkStrBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "setcache");
+
+    // prepare PREFIX
+    len3 = ccnl_ccnb_mkHeader(entry, CCNL_DTAG_PREFIX, CCN_TT_DTAG);
+    len3 += ccnl_ccnb_mkStrBlob(entry+len3, CCN_DTAG_ACTION, CCN_TT_DTAG, "setcache");
+    len3 += ccnl_ccnb_mkHeader(entry+len3, CCN_DTAG_NAME, CCN_TT_DTAG); // prefix
+
+    cp = strtok(path, "/");
+    while (cp) {
+        unsigned short cmplen = strlen(cp);
+        if (suite == CCNL_SUITE_CCNTLV) {
+            char* oldcp = cp;
+            cp = malloc( (cmplen + 4) * (sizeof(char)) );
+            cp[0] = CCNX_TLV_N_NameSegment >> 8;
+            cp[1] = CCNX_TLV_N_NameSegment;
+            cp[2] = cmplen >> 8;
+            cp[3] = cmplen;
+            memcpy(cp + 4, oldcp, cmplen);
+            cmplen += 4;
+        }
+        len3 += ccnl_ccnb_mkBlob(entry+len3, CCN_DTAG_COMPONENT, CCN_TT_DTAG,
+                       cp, cmplen);
+        if (suite == CCNL_SUITE_CCNTLV)
+            free(cp);
+        cp = strtok(NULL, "/");
+    }
+    entry[len3++] = 0; // end-of-prefix
+
+    suite_s[0] = suite;
+    len3 += ccnl_ccnb_mkBlob(entry+len3, CCNL_DTAG_SUITE, CCN_TT_DTAG, suite_s, 1);
+    len3 += ccnl_ccnb_mkStrBlob(entry+len3, CCNL_DTAG_CACHEPOLICY, CCN_TT_DTAG, policy);
+    entry[len3++] = 0; // end-of-entry
+
+    // prepare CONTENTOBJ with CONTENT
+    len2 = ccnl_ccnb_mkHeader(contentobj, CCN_DTAG_CONTENTOBJ, CCN_TT_DTAG);   // contentobj
+    len2 += ccnl_ccnb_mkBlob(contentobj+len2, CCN_DTAG_CONTENT, CCN_TT_DTAG,  // content
+                             (char*) entry, len3);
+    contentobj[len2++] = 0; // end-of-contentobj
+
+    // add CONTENTOBJ as the final name component
+    len1 += ccnl_ccnb_mkBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG,  // comp
+                             (char*) contentobj, len2);
+
+#ifdef USE_SIGNATURES
+    if(private_key_path) len += add_signature(out+len, private_key_path, out1, len1);
+#endif /*USE_SIGNATURES*/
+    memcpy(out+len, out1, len1);
+    len += len1;
+    out[len++] = 0; // end-of-name
+    out[len++] = 0; // end-of-interest
+
+    return len;
+}
+
+// cmd is prefixreg, prefixunreg or setweight (of the FIB entry)
 int
-mkPrefixregRequest(unsigned char *out, char reg, char *path, char *faceid, int suite ,char *private_key_path)
+mkPrefixregRequest(unsigned char *out, char *cmd, char *path, char *faceid, int suite, char *strategy, char *weight, char *private_key_path)
 {
     int len = 0, len1 = 0, len2 = 0, len3 = 0;
     unsigned char out1[CCNL_MAX_PACKET_SIZE];
@@ -451,13 +575,11 @@ mkPrefixregRequest(unsigned char *out, char reg, char *path, char *faceid, int s
 
     len1 += ccnl_ccnb_mkStrBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "ccnx");
     len1 += ccnl_ccnb_mkStrBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG, "");
-    len1 += ccnl_ccnb_mkStrBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG,
-                     reg ? "prefixreg" : "prefixunreg");
+    len1 += ccnl_ccnb_mkStrBlob(out1+len1, CCN_DTAG_COMPONENT, CCN_TT_DTAG, cmd);
 
     // prepare FWDENTRY
     len3 = ccnl_ccnb_mkHeader(fwdentry, CCN_DTAG_FWDINGENTRY, CCN_TT_DTAG);
-    len3 += ccnl_ccnb_mkStrBlob(fwdentry+len3, CCN_DTAG_ACTION, CCN_TT_DTAG,
-                      reg ? "prefixreg" : "prefixunreg");
+    len3 += ccnl_ccnb_mkStrBlob(fwdentry+len3, CCN_DTAG_ACTION, CCN_TT_DTAG, cmd);
     len3 += ccnl_ccnb_mkHeader(fwdentry+len3, CCN_DTAG_NAME, CCN_TT_DTAG); // prefix
 
     cp = strtok(path, "/");
@@ -485,6 +607,10 @@ mkPrefixregRequest(unsigned char *out, char reg, char *path, char *faceid, int s
 
     suite_s[0] = suite;
     len3 += ccnl_ccnb_mkStrBlob(fwdentry+len3, CCNL_DTAG_SUITE, CCN_TT_DTAG, suite_s);
+    if (strategy)
+        len3 += ccnl_ccnb_mkStrBlob(fwdentry+len3, CCNL_DTAG_STRATEGY, CCN_TT_DTAG, strategy);
+    if (weight)
+        len3 += ccnl_ccnb_mkStrBlob(fwdentry+len3, CCNL_DTAG_WEIGHT, CCN_TT_DTAG, weight);
     fwdentry[len3++] = 0; // end-of-fwdentry
 
     // prepare CONTENTOBJ with CONTENT
@@ -586,7 +712,7 @@ getNDNTLVPrefix(unsigned char *data, int datalen){
     
     if(ccnl_ndntlv_extract(data - cp,
                   &data, &datalen,
-                  &scope, &mbf, &minsfx, &maxsfx, &lastchunknum,
+                  &scope, &mbf, &minsfx, &maxsfx, NULL, NULL, &lastchunknum,
                   &prefix, NULL,
                   &nonce, // nonce
                   &ppkl, //ppkl
@@ -1044,6 +1170,18 @@ main(int argc, char *argv[])
     } else if (!strcmp(argv[1], "setfrag")) {
         if (argc < 5)  goto Usage;
         len = mkSetfragRequest(out, argv[2], argv[3], argv[4], private_key_path);
+    } else if (!strcmp(argv[1], "setsched")) {
+        if (argc < 5 || (strcmp(argv[2], "face") && strcmp(argv[2], "dev")))
+            goto Usage;
+        len = mkSetschedRequest(out, argv[2], argv[3], argv[4], private_key_path);
+    } else if (!strcmp(argv[1], "setcache")) {
+        if (argc > 4) {
+            suite = ccnl_str2suite(argv[4]);
+            if (suite < 0 || suite >= CCNL_SUITE_LAST)
+                goto Usage;
+        }
+        if (argc < 4) goto Usage;
+        len = mkSetcacheRequest(out, argv[2], argv[3], suite, private_key_path);
     } else if (!strcmp(argv[1], "destroyface")) {
         if (argc < 3) goto Usage;
     len = mkDestroyFaceRequest(out, argv[2], private_key_path);
@@ -1054,12 +1192,27 @@ main(int argc, char *argv[])
                 goto Usage;
             }
         } 
+        if (argc > 5 && strcmp(argv[5], "best") &&
+            strcmp(argv[5], "multicast") && strcmp(argv[5], "weighted"))
+            goto Usage;
         if (argc < 4) goto Usage;
-        len = mkPrefixregRequest(out, 1, argv[2], argv[3], suite, private_key_path);
+        len = mkPrefixregRequest(out, "prefixreg", argv[2], argv[3], suite,
+                                 argc > 5 ? argv[5] : NULL, NULL,
+                                 private_key_path);
     } else if (!strcmp(argv[1], "prefixunreg")) {
         if(argc > 4) suite = atoi(argv[4]);
         if (argc < 4) goto Usage;
-        len = mkPrefixregRequest(out, 0, argv[2], argv[3], suite, private_key_path);
+        len = mkPrefixregRequest(out, "prefixunreg", argv[2], argv[3], suite,
+                                 NULL, NULL, private_key_path);
+    } else if (!strcmp(argv[1], "setweight")) {
+        if (argc > 5) {
+            suite = ccnl_str2suite(argv[5]);
+            if (suite < 0 || suite >= CCNL_SUITE_LAST)
+                goto Usage;
+        }
+        if (argc < 5 || atoi(argv[4]) < 0) goto Usage;
+        len = mkPrefixregRequest(out, "setweight", argv[2], argv[3], suite,
+                                 NULL, argv[4], private_key_path);
     } else if (!strcmp(argv[1], "addContentToCache")){
         if(argc < 3) goto Usage;
         file_uri = argv[2];
@@ -1207,15 +1360,38 @@ Usage:
        "  newUDPface    IP4SRC|any IP4DST PORT [FACEFLAGS]\n"
        "  newUNIXface   PATH [FACEFLAGS]\n"
        "  setfrag       FACEID FRAG MTU\n"
+       "  setsched      face FACEID|dev DEVNDX SCHED\n"
        "  destroyface   FACEID\n"
-       "  prefixreg     PREFIX FACEID [SUITE (ccnb, ccnx2014, ndn2013)]\n"
+       "  prefixreg     PREFIX FACEID [SUITE (ccnb, ccnx2014, ndn2013) [STRATEGY]]\n"
        "  prefixunreg   PREFIX FACEID [SUITE (ccnb, ccnx2014, ndn2013)]\n"
+       "  setcache      PREFIX POLICY [SUITE (ccnb, ccnx2014, ndn2013)]\n"
+       "  setweight     PREFIX FACEID WEIGHT [SUITE (ccnb, ccnx2014, ndn2013)]\n"
        "  debug         dump\n"
        "  debug         halt\n"
        "  debug         dump+halt\n"
+       "  debug         snapshot (content store to the relay's -S file)\n"
        "  addContentToCache             ccn-file\n"
        "  removeContentFromCache        ccn-path\n"
-       "where FRAG in none, seqd2012, ccnx2013\n"
+       "where FRAG in none, seqd2012, ccnx2013, optionally followed by\n"
+       "  ,arq (retransmit lost fragments, e.g. ccnx2013,arq)\n"
+       "  ,fec=N/K (K repair fragments per N, e.g. ccnx2013,fec=8/2)\n"
+       "and MTU a number, or auto (path MTU discovery)\n"
+       "SCHED is rate=BYTES_PER_SEC[,burst=BYTES] (rate=0: no limit),\n"
+       "  quantum=BYTES (dev: fair queueing of its faces, 0: off;\n"
+       "  face: its own quantum), weight=N (face: its share), shape=BYTES_PER_SEC\n"
+       "  (face: pace interests to the content rate back, 0: off), shapeq=N\n"
+       "  (face: interests queued) or shapenack=1 (face: NACK when full),\n"
+       "  e.g. quantum=1500 or shape=125000,shapeq=16\n"
+       "STRATEGY is best (one next hop by RTT and success ratio, the default)\n"
+       "  or multicast (all next hops) for the prefix, or weighted (one next\n"
+       "  hop per name, by the WEIGHT of each, 0: by its RTT and success ratio)\n"
+       "POLICY admits content to the cache: lce (always, the default), lcd (one\n"
+       "  hop below a copy), prob=PERCENT, probcache (likelier near the\n"
+       "  requesters) or tinylfu (asked for more often than what it evicts),\n"
+       "  or prefetch=CHUNKS (ask for up to that many chunks ahead of the\n"
+       "  consumers, 0: off)\n"
+       "FACEFLAGS is a number, or'ed of 0x01 (static), 0x02 (reflect), 0x10\n"
+       "  (coalesce), 0x20 (control: its packets go before data packets)\n"
        "-m is a special mode which only prints the interest message of the corresponding command",
     progname);
 
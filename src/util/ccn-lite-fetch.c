@@ -18,6 +18,7 @@
  *
  * File history:
  * 2014-10-13  created
+ * 2026-10-19  chunk interests from a packet template
  */
 
 
@@ -32,6 +33,25 @@
 
 // ----------------------------------------------------------------------
 
+// same name components (chunk number aside)?
+int
+ccnl_prefix_sameName(struct ccnl_prefix_s *a, struct ccnl_prefix_s *b)
+{
+    int i;
+
+    if (a->compcnt != b->compcnt)
+        return 0;
+#ifdef USE_NFN
+    if (a->nfnflags != b->nfnflags)
+        return 0;
+#endif
+    for (i = 0; i < a->compcnt; i++)
+        if (a->complen[i] != b->complen[i] ||
+                            memcmp(a->comp[i], b->comp[i], a->complen[i]))
+            return 0;
+    return 1;
+}
+
 int
 ccnl_fetchContentForChunkName(struct ccnl_prefix_s *prefix,
                               char* nfnexpr,
@@ -39,9 +59,11 @@ ccnl_fetchContentForChunkName(struct ccnl_prefix_s *prefix,
                               int suite, 
                               unsigned char *out, int out_len, 
                               int *len, 
-                              float wait, int sock, struct sockaddr sa) {
+                              float wait, int sock, struct sockaddr sa,
+                              struct ccnl_pkt_tmpl_s *tmpl) {
 
     int (*mkInterest)(struct ccnl_prefix_s*, int*, unsigned char*, int);
+    unsigned char *pkt = out;
     switch (suite) {
 #ifdef USE_SUITE_CCNB
     case CCNL_SUITE_CCNB:
@@ -65,9 +87,13 @@ ccnl_fetchContentForChunkName(struct ccnl_prefix_s *prefix,
     }
 
     int nonce = random();
-    *len = mkInterest(prefix, &nonce, out, out_len);
+    if (tmpl && chunknum) // chunk after chunk: only patch the template
+        *len = ccnl_pkt_tmpl_interest(tmpl, chunknum,
+                    suite == CCNL_SUITE_NDNTLV ? &nonce : NULL, &pkt);
+    else
+        *len = mkInterest(prefix, &nonce, out, out_len);
 
-    if (sendto(sock, out, *len, 0, &sa, sizeof(sa)) < 0) {
+    if (sendto(sock, pkt, *len, 0, &sa, sizeof(sa)) < 0) {
         perror("sendto");
         myexit(1);
     }
@@ -129,7 +155,7 @@ ccnl_extractDataAndChunkInfo(unsigned char **data, int *datalen,
         }
 
         buf = ccnl_ndntlv_extract(*data - cp, data, datalen,
-                                  0, 0, 0, 0, 
+                                  0, 0, 0, 0, 0, 0,
                                   lastchunknum,
                                   prefix, 
                                   NULL, 0, 0, 
@@ -303,6 +329,8 @@ usage:
     }
 
     struct ccnl_prefix_s *prefix = ccnl_URItoPrefix(url, suite, nfnexpr, curchunknum);
+    struct ccnl_prefix_s *tmplname = NULL;
+    struct ccnl_pkt_tmpl_s *tmpl = NULL;
 
 
     const int maxretry = 3;
@@ -317,6 +345,11 @@ usage:
             }
             *prefix->chunknum = *curchunknum; 
             DEBUGMSG(INFO, "fetching chunk %d for prefix '%s'\n", *curchunknum, ccnl_prefix_to_path(prefix));
+            if (!tmpl || !ccnl_prefix_sameName(tmplname, prefix)) {
+                ccnl_pkt_tmpl_free(tmpl);
+                tmpl = ccnl_pkt_tmpl_new(prefix);
+                tmplname = prefix;
+            }
         } else {
             DEBUGMSG(DEBUG, "fetching first chunk...\n");
             DEBUGMSG(INFO, "fetching first chunk for prefix '%s'\n", ccnl_prefix_to_path(prefix));
@@ -329,7 +362,7 @@ usage:
                                           suite, 
                                           out, sizeof(out), 
                                           &len, 
-                                          wait, sock, sa) < 0) {
+                                          wait, sock, sa, tmpl) < 0) {
             retry++;
             DEBUGMSG(WARNING, "timeout\n");//, retry number %d of %d\n", retry, maxretry);
         } else {
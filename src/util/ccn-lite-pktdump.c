@@ -1342,7 +1342,7 @@ emit_content_only(unsigned char *data, int len, int suite, int format)
         cp = data + 2;
         len -= 2;
         ccnl_ndntlv_extract(2, &cp, &len,
-                            NULL, NULL, NULL, NULL, NULL, 
+                            NULL, NULL, NULL, NULL, NULL, NULL, NULL,
                             &p, NULL, NULL, NULL,
                             &content, &contlen);
         break;
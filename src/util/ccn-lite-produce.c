@@ -18,6 +18,8 @@
  *
  * File history:
  * 2014-09-01 created <basil.kohler@unibas.ch>
+ * 2026-10-19 encode the name once (packet template)
+ * 2026-10-19 packed repository file (-r)
  */
 
 #define USE_SUITE_CCNB
@@ -31,20 +33,103 @@
 #include "ccnl-common.c"
 #include "ccnl-crypto.c"
 
+// index of the packed repository file (-r), written after the packets
+struct ccnl_repo_ent_s *repo_index;
+unsigned int repo_cnt, repo_max;
+unsigned long long repo_off = sizeof(struct ccnl_repo_hdr_s);
+
+// hash of the name of the packet, as the relay decodes it
+unsigned int
+packet_namehash(int suite, unsigned char *pkt, int len)
+{
+    unsigned char buf[CCNL_MAX_PACKET_SIZE], *data = buf, *content;
+    struct ccnl_prefix_s *prefix = NULL;
+    struct ccnl_buf_s *b = NULL;
+    unsigned int h = 0;
+    int contlen, typ, len2;
+
+    if (len > (int) sizeof(buf))
+        return 0;
+    memcpy(buf, pkt, len); // the decoders may write to it
+    switch (suite) {
+    case CCNL_SUITE_CCNTLV:
+        data += 8;
+        len -= 8;
+        b = ccnl_ccntlv_extract(8, &data, &len, &prefix, 0, 0, 0,
+                                &content, &contlen);
+        break;
+    case CCNL_SUITE_NDNTLV:
+        if (ccnl_ndntlv_dehead(&data, &len, &typ, &len2))
+            break;
+        b = ccnl_ndntlv_extract(data - buf, &data, &len, 0, 0, 0, 0, 0, 0,
+                                NULL, &prefix, NULL, 0, 0, &content, &contlen);
+        break;
+    default:
+        break;
+    }
+    if (prefix)
+        h = ccnl_prefix_hash(prefix);
+    free_prefix(prefix);
+    ccnl_free(b);
+    return h;
+}
+
+int
+repo_append(FILE *repo, int suite, unsigned char *pkt, int len)
+{
+    struct ccnl_repo_ent_s *e;
+
+    if (repo_cnt == repo_max) {
+        repo_max = repo_max ? 2 * repo_max : 1024;
+        e = ccnl_realloc(repo_index, repo_max * sizeof(*e));
+        if (!e)
+            return -1;
+        repo_index = e;
+    }
+    e = repo_index + repo_cnt++;
+    e->hash = htonl(packet_namehash(suite, pkt, len));
+    e->len = htonl(len);
+    e->offhi = htonl(repo_off >> 32);
+    e->offlo = htonl(repo_off & 0xffffffff);
+    repo_off += len;
+    return fwrite(pkt, len, 1, repo) == 1 ? 0 : -1;
+}
+
+// writes the index, and the header which points to it
+int
+repo_finish(FILE *repo)
+{
+    struct ccnl_repo_hdr_s h;
+
+    memcpy(h.magic, CCNL_REPO_MAGIC, sizeof(h.magic));
+    h.version = htonl(CCNL_REPO_VERSION);
+    h.cnt = htonl(repo_cnt);
+    h.idxhi = htonl(repo_off >> 32);
+    h.idxlo = htonl(repo_off & 0xffffffff);
+    if (fwrite(repo_index, sizeof(*repo_index), repo_cnt, repo) != repo_cnt ||
+            fseek(repo, 0, SEEK_SET) || fwrite(&h, sizeof(h), 1, repo) != 1) {
+        fclose(repo);
+        return -1;
+    }
+    return fclose(repo) ? -1 : 0;
+}
+
 int
 main(int argc, char *argv[])
 {
     // char *private_key_path = 0;
     //    char *witness = 0;
-    unsigned char out[65*1024];
+    unsigned char *out;
     char *publisher = 0;
-    char *infname = 0, *outdirname = 0, *outfname;
+    char *infname = 0, *outdirname = 0, *outfname = 0, *reponame = 0;
     int f, fout, contentlen = 0, opt, plen;
     int suite = CCNL_SUITE_DEFAULT;
     int chunk_size = CCNL_MAX_CHUNK_SIZE;
     struct ccnl_prefix_s *name;
+    struct ccnl_pkt_tmpl_s *tmpl = NULL;
+    FILE *repo = NULL;
 
-    while ((opt = getopt(argc, argv, "hc:f:i:o:p:k:w:s:v:")) != -1) {
+    while ((opt = getopt(argc, argv, "hc:f:i:o:p:k:r:w:s:v:")) != -1) {
         switch (opt) {
         case 'c':
             chunk_size = atoi(optarg);
@@ -80,6 +165,9 @@ main(int argc, char *argv[])
             exit(-1);
             }
             break;
+        case 'r':
+            reponame = optarg;
+            break;
         case 's':
             suite = ccnl_str2suite(optarg);
             break;
@@ -102,6 +190,7 @@ Usage:
         "  -i FNAME         input file (instead of stdin)\n"
         "  -o DIR           output dir (instead of stdout), filename default is cN, otherwise specify -f\n"
         "  -p DIGEST        publisher fingerprint\n"
+        "  -r FNAME         packed repository file (instead of stdout or -o)\n"
         "  -s SUITE         (ccnb, ccnx2014, iot2014, ndn2013)\n"
 #ifdef USE_LOGGING
         "  -v DEBUG_LEVEL (fatal, error, warning, info, debug, trace, verbose)\n"
@@ -121,7 +210,7 @@ Usage:
         goto Usage;
 
     char *url_orig = argv[optind];
-    char url[strlen(url_orig)];
+    char url[strlen(url_orig) + 1];
     optind++;
 
     // optional nfn 
@@ -173,7 +262,7 @@ Usage:
 
     char *chunk_buf;
     chunk_buf = ccnl_malloc(chunk_size * sizeof(unsigned char));
-    int chunk_len, is_last = 0, offs = -1;
+    int chunk_len, is_last = 0;
     unsigned int chunknum = 0;
 
     char outpathname[255];
@@ -192,6 +281,29 @@ Usage:
             DEBUGMSG(ERROR, "fileext for suite %d not implemented\n", suite);
     }
 
+    // the name is the same for all chunks: encode it only once
+    strcpy(url, url_orig);
+    name = ccnl_URItoPrefix(url, suite, nfnexpr, NULL);
+    if (name)
+        tmpl = ccnl_pkt_tmpl_new(name);
+    if (!tmpl) {
+        DEBUGMSG(ERROR, "produce for suite %i is not implemented\n", suite);
+        goto Error;
+    }
+    if (reponame) {
+        struct ccnl_repo_hdr_s h;
+
+        // the packets are appended, then the index and the header
+        repo = fopen(reponame, "w");
+        if (!repo) {
+            DEBUGMSG(ERROR, "could not create %s\n", reponame);
+            goto Error;
+        }
+        setvbuf(repo, NULL, _IOFBF, 1024*1024);
+        memset(&h, 0, sizeof(h));
+        fwrite(&h, sizeof(h), 1, repo);
+    }
+
     chunk_len = 1;
     chunk_len = read(f, chunk_buf, chunk_size);
     while (!is_last && chunk_len > 0) {
@@ -200,42 +312,34 @@ Usage:
             is_last = 1;
         } 
 
-        strcpy(url, url_orig);
-        offs = CCNL_MAX_PACKET_SIZE;
-        name = ccnl_URItoPrefix(url, suite, nfnexpr, &chunknum);
-        switch (suite) {
-        case CCNL_SUITE_CCNTLV: 
-            contentlen = ccnl_ccntlv_prependContentWithHdr(name, 
-                                                           (unsigned char *)chunk_buf, chunk_len, 
-                                                           is_last ? &chunknum : NULL, 
-                                                           &offs, 
-                                                           NULL, // int *contentpos
-                                                           out);
-            break;
-        case CCNL_SUITE_NDNTLV:
-            contentlen = ccnl_ndntlv_prependContent(name, 
-                                                    (unsigned char *) chunk_buf, chunk_len, 
-                                                    &offs, NULL,
-                                                    is_last ? &chunknum : NULL, 
-                                                    out);
-            break;
-        default:
-            DEBUGMSG(ERROR, "produce for suite %i is not implemented\n", suite);
+        contentlen = ccnl_pkt_tmpl_content(tmpl, &chunknum,
+                                           (unsigned char *) chunk_buf, chunk_len,
+                                           is_last ? &chunknum : NULL,
+                                           NULL, // int *contentpos
+                                           &out);
+        if (contentlen <= 0) {
+            DEBUGMSG(ERROR, "could not encode chunk %d\n", chunknum);
             goto Error;
-            break;
         }
 
-        if (outdirname) {
-            DEBUGMSG(INFO, "%s/%s%d.%s", outdirname, outfname, chunknum, fileext);
+        if (repo) {
+            DEBUGMSG(INFO, "appending chunk %d to %s\n", chunknum, reponame);
+            if (repo_append(repo, suite, out, contentlen)) {
+                DEBUGMSG(ERROR, "could not write to %s\n", reponame);
+                goto Error;
+            }
+        } else if (outdirname) {
+            snprintf(outpathname, sizeof(outpathname), "%s/%s%d.%s",
+                     outdirname, outfname, chunknum, fileext);
 
             DEBUGMSG(INFO, "writing chunk %d to file %s\n", chunknum, outpathname);
 
             fout = creat(outpathname, 0666);
-            write(fout, out + offs, contentlen);
+            write(fout, out, contentlen);
             close(fout);
         } else {
             DEBUGMSG(INFO, "writing chunk %d\n", chunknum);
-            fwrite(out + offs, sizeof(unsigned char),contentlen, stdout);
+            fwrite(out, sizeof(unsigned char),contentlen, stdout);
         }
 
         chunknum++;
@@ -244,13 +348,23 @@ Usage:
         }
     } 
 
+    if (repo && repo_finish(repo)) {
+        repo = NULL;
+        DEBUGMSG(ERROR, "could not write to %s\n", reponame);
+        goto Error;
+    }
     close(f);
     ccnl_free(chunk_buf);
+    ccnl_free(repo_index);
+    ccnl_pkt_tmpl_free(tmpl);
     return 0;
 
 Error:
+    if (repo)
+        fclose(repo);
     close(f);
     ccnl_free(chunk_buf);
+    ccnl_pkt_tmpl_free(tmpl);
     return -1;
 }
 
@@ -44,6 +44,7 @@
 #include <unistd.h>
 #include <getopt.h>
 #include <limits.h>
+#include <signal.h>
 
 #include <arpa/inet.h>
 #include <sys/types.h>
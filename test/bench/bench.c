@@ -0,0 +1,308 @@
+/*
+ * @f test/bench/bench.c
+ * @b CCN lite - packet parser micro benchmark
+ *
+ * Copyright (C) 2026, Christian Tschudin, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2026-10-19 created
+ */
+
+// usage: bench [-n rounds] [-t TESTDIR]
+// replays the packets of TESTDIR/{ccnb,ccntlv,iottlv,ndntlv} (default ..)
+// plus generated interests and contents with names of increasing depth,
+// and reports ns/pkt and allocs/pkt per decoder. Then compares encoding
+// chunk streams with the prepend functions against packet templates.
+
+#define CCNL_BENCH_COUNT_ALLOCS
+#include "decoders.c"
+
+struct bench_pkt_s {
+    struct bench_pkt_s *next;
+    char *fname;
+    int len;
+    unsigned char data[1];
+};
+
+struct bench_pkt_s*
+bench_pkt_new(char *fname, unsigned char *data, int len)
+{
+    struct bench_pkt_s *p = malloc(sizeof(*p) + len);
+
+    if (!p)
+        return NULL;
+    p->fname = strdup(fname);
+    p->len = len;
+    if (data)
+        memcpy(p->data, data, len);
+    p->next = NULL;
+    return p;
+}
+
+void
+bench_pkt_free(struct bench_pkt_s *list)
+{
+    struct bench_pkt_s *p;
+
+    while (list) {
+        p = list->next;
+        free(list->fname);
+        free(list);
+        list = p;
+    }
+}
+
+struct bench_pkt_s*
+bench_load(char *dir, char *pattern)
+{
+    struct bench_pkt_s *list = NULL, *p;
+    struct dirent *de;
+    DIR *d = opendir(dir);
+    char path[1024];
+    struct stat st;
+    int fd;
+
+    if (!d) {
+        perror(dir);
+        return NULL;
+    }
+    while ((de = readdir(d))) {
+        if (fnmatch(pattern, de->d_name, 0))
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+        if (stat(path, &st) || !S_ISREG(st.st_mode) || st.st_size == 0)
+            continue;
+        fd = open(path, O_RDONLY);
+        if (fd < 0)
+            continue;
+        p = bench_pkt_new(de->d_name, NULL, st.st_size);
+        if (p && read(fd, p->data, st.st_size) == st.st_size) {
+            p->next = list;
+            list = p;
+        } else
+            bench_pkt_free(p);
+        close(fd);
+    }
+    closedir(d);
+    return list;
+}
+
+// one interest and one content object, for a name with depth components
+struct bench_pkt_s*
+bench_generate(int suite, int depth)
+{
+    struct bench_pkt_s *list = NULL, *p;
+    struct ccnl_prefix_s *pfx;
+    struct ccnl_buf_s *buf[2];
+    char uri[CCNL_MAX_NAME_COMP * 8], fname[32];
+    int i, nonce = 0x4711, len = 0;
+
+    for (i = 0; i < depth; i++)
+        len += sprintf(uri + len, "/c%d", i);
+    pfx = ccnl_URItoPrefix(uri, suite, NULL, NULL);
+    if (!pfx)
+        return NULL;
+    buf[0] = ccnl_mkSimpleInterest(pfx, &nonce);
+    buf[1] = ccnl_mkSimpleContent(pfx, (unsigned char*) "payload", 7, NULL);
+    for (i = 0; i < 2; i++) {
+        if (!buf[i])
+            continue;
+        sprintf(fname, "%s-depth%d", i ? "content" : "interest", depth);
+        p = bench_pkt_new(fname, buf[i]->data, buf[i]->datalen);
+        if (p) {
+            p->next = list;
+            list = p;
+        }
+        ccnl_free(buf[i]);
+    }
+    free_prefix(pfx);
+    return list;
+}
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+typedef int (*bench_decoder)(unsigned char *data, int len);
+
+struct bench_decoder_s {
+    char *name;
+    int suite;
+    char *dir, *pattern;
+    bench_decoder fct;
+} decoders[] = {
+    {"ccnb",        CCNL_SUITE_CCNB,   "ccnb",   "*.ccnb",   ccnl_bench_ccnb},
+    {"ccntlv",      CCNL_SUITE_CCNTLV, "ccntlv", "*.ccntlv", ccnl_bench_ccntlv},
+    {"iottlv",      CCNL_SUITE_IOTTLV, "iottlv", "*.iottlv", ccnl_bench_iottlv},
+    {"ndntlv",      CCNL_SUITE_NDNTLV, "ndntlv", "*.ndntlv", ccnl_bench_ndntlv},
+    {"ndntlv-scan", CCNL_SUITE_NDNTLV, "ndntlv", "*.ndntlv",
+                                                     ccnl_bench_ndntlv_scan},
+    {NULL, 0, NULL, NULL, NULL}
+};
+
+// time one decoder over a packet set, skipping packets it rejects
+void
+bench_run(struct bench_decoder_s *dec, char *set,
+          struct bench_pkt_s *pkts, int rounds)
+{
+    struct bench_pkt_s *p, *ok = NULL, *next;
+    int i, cnt = 0;
+    long allocs;
+    double t0, t1;
+
+    for (p = pkts; p; p = next) {
+        next = p->next;
+        if (dec->fct(p->data, p->len) >= 0) {
+            p->next = ok;
+            ok = p;
+            cnt++;
+        } else {
+            fprintf(stderr, "  %s: %s not accepted\n", dec->name, p->fname);
+            p->next = NULL;
+            bench_pkt_free(p);
+        }
+    }
+    if (!cnt) {
+        printf("%-12s %-10s %6d %10s %12s\n", dec->name, set, 0, "-", "-");
+        return;
+    }
+    allocs = bench_allocs;
+    t0 = bench_now();
+    for (i = 0; i < rounds; i++)
+        for (p = ok; p; p = p->next)
+            dec->fct(p->data, p->len);
+    t1 = bench_now();
+    allocs = bench_allocs - allocs;
+    printf("%-12s %-10s %6d %10.1f %12.2f\n", dec->name, set, cnt,
+           (t1 - t0) / ((double) rounds * cnt),
+           (double) allocs / ((double) rounds * cnt));
+    bench_pkt_free(ok);
+}
+
+// ----------------------------------------------------------------------
+
+// encode rounds chunk interests resp. 1KB chunks under one name, either
+// from scratch (prepend) or by stamping a packet template
+void
+bench_encode(int suite, int depth, int rounds)
+{
+    struct ccnl_prefix_s *pfx;
+    struct ccnl_pkt_tmpl_s *tmpl;
+    unsigned char *buf = ccnl_malloc(CCNL_MAX_PACKET_SIZE), *pkt;
+    unsigned char payload[1024];
+    char uri[CCNL_MAX_NAME_COMP * 8];
+    unsigned int chunk;
+    int i, len = 0, offs, nonce = 0x4711;
+    double t[5];
+
+    for (i = 0; i < depth; i++)
+        len += sprintf(uri + len, "/c%d", i);
+    pfx = ccnl_URItoPrefix(uri, suite, NULL, NULL);
+    tmpl = pfx ? ccnl_pkt_tmpl_new(pfx) : NULL;
+    if (!tmpl)
+        goto done;
+    memset(payload, 'x', sizeof(payload));
+    pfx->chunknum = &chunk;
+
+    t[0] = bench_now();
+    for (chunk = 0; chunk < rounds; chunk++) {
+        offs = CCNL_MAX_PACKET_SIZE;
+        if (suite == CCNL_SUITE_NDNTLV)
+            ccnl_ndntlv_prependInterest(pfx, -1, &nonce, &offs, buf);
+        else
+            ccnl_ccntlv_prependChunkInterestWithHdr(pfx, &offs, buf);
+    }
+    t[1] = bench_now();
+    for (chunk = 0; chunk < rounds; chunk++)
+        ccnl_pkt_tmpl_interest(tmpl, &chunk,
+                       suite == CCNL_SUITE_NDNTLV ? &nonce : NULL, &pkt);
+    t[2] = bench_now();
+    for (chunk = 0; chunk < rounds; chunk++) {
+        offs = CCNL_MAX_PACKET_SIZE;
+        if (suite == CCNL_SUITE_NDNTLV)
+            ccnl_ndntlv_prependContent(pfx, payload, sizeof(payload),
+                                       &offs, NULL, NULL, buf);
+        else
+            ccnl_ccntlv_prependContentWithHdr(pfx, payload, sizeof(payload),
+                                              NULL, &offs, NULL, buf);
+    }
+    t[3] = bench_now();
+    for (chunk = 0; chunk < rounds; chunk++)
+        ccnl_pkt_tmpl_content(tmpl, &chunk, payload, sizeof(payload),
+                              NULL, NULL, &pkt);
+    t[4] = bench_now();
+    pfx->chunknum = NULL;
+
+    printf("%-12s depth=%-4d %10.1f %10.1f %10.1f %10.1f\n",
+           ccnl_suite2str(suite), depth,
+           (t[1] - t[0]) / rounds, (t[2] - t[1]) / rounds,
+           (t[3] - t[2]) / rounds, (t[4] - t[3]) / rounds);
+done:
+    ccnl_pkt_tmpl_free(tmpl);
+    free_prefix(pfx);
+    ccnl_free(buf);
+}
+
+// ----------------------------------------------------------------------
+
+int
+main(int argc, char **argv)
+{
+    struct bench_decoder_s *dec;
+    char *testdir = "..", path[1024], set[16];
+    int opt, rounds = 20000, depth;
+
+    while ((opt = getopt(argc, argv, "hn:t:")) != -1) {
+        switch (opt) {
+        case 'n':
+            rounds = atoi(optarg);
+            break;
+        case 't':
+            testdir = optarg;
+            break;
+        case 'h':
+        default:
+            fprintf(stderr, "usage: %s [-n rounds] [-t TESTDIR]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    ccnl_core_init();
+    printf("%-12s %-10s %6s %10s %12s\n",
+           "decoder", "packets", "count", "ns/pkt", "allocs/pkt");
+    for (dec = decoders; dec->name; dec++) {
+        snprintf(path, sizeof(path), "%s/%s", testdir, dec->dir);
+        bench_run(dec, "corpus", bench_load(path, dec->pattern), rounds);
+        for (depth = 1; depth <= 16; depth *= 4) {
+            sprintf(set, "depth=%d", depth);
+            bench_run(dec, set, bench_generate(dec->suite, depth), rounds);
+        }
+    }
+
+    printf("\n%-12s %-10s %10s %10s %10s %10s\n", "encoder", "name",
+           "I prepend", "I tmpl", "C prepend", "C tmpl");
+    for (depth = 1; depth <= 16; depth *= 4) {
+        bench_encode(CCNL_SUITE_CCNTLV, depth, rounds);
+        bench_encode(CCNL_SUITE_NDNTLV, depth, rounds);
+    }
+    return 0;
+}
+
+// eof
@@ -0,0 +1,252 @@
+/*
+ * @f test/bench/cachetrace.c
+ * @b CCN lite - content store hit ratios of the cache admission policies
+ *    on a replayed request trace
+ *
+ * Copyright (C) 2026, Christian Tschudin, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2026-10-19 created
+ */
+
+// usage: cachetrace [-r relays] [-c entries] [-n requests] [-k names]
+//                   [-a alpha] [-s seed] [-f TRACEFILE] [POLICY ...]
+// replays a trace of names (one per line in TRACEFILE, or generated with
+// a Zipf popularity) from clients behind a chain of relays, the producer
+// being at its other end. Each relay runs the content store code of the
+// forwarder: lookup and hit counters, ccnl_cs_admit() and LRU eviction.
+// Reports per policy the share of requests answered by a cache, the hit
+// ratio of each relay (from the clients to the producer), the mean number
+// of hops to the content and the admission counters.
+
+#define USE_CACHEPOLICY
+#include "decoders.c"
+#include <math.h>
+#include "../../src/ccnl-ext-cache.c"
+
+char **trace;
+int tracelen;
+
+struct ccnl_prefix_s*
+trace_prefix(char *name)
+{
+    char uri[CCNL_MAX_PACKET_SIZE];
+
+    strncpy(uri, name, sizeof(uri) - 1);
+    uri[sizeof(uri) - 1] = '\0';
+    return ccnl_URItoPrefix(uri, CCNL_SUITE_CCNTLV, NULL, NULL);
+}
+
+int
+trace_load(char *fname)
+{
+    char line[1024];
+    FILE *f = fopen(fname, "r");
+    int max = 0;
+
+    if (!f)
+        return -1;
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] != '/')
+            continue;
+        if (tracelen == max) {
+            max = max ? 2 * max : 1024;
+            trace = realloc(trace, max * sizeof(char*));
+        }
+        trace[tracelen++] = strdup(line);
+    }
+    fclose(f);
+    return tracelen;
+}
+
+// n requests for k names, name i with a probability proportional to 1/i^alpha
+void
+trace_zipf(int n, int k, double alpha)
+{
+    double *cdf = malloc(k * sizeof(double)), sum = 0, r;
+    char name[64];
+    int i, lo, hi;
+
+    for (i = 0; i < k; i++)
+        cdf[i] = sum += 1 / pow(i + 1, alpha);
+    trace = malloc(n * sizeof(char*));
+    for (tracelen = 0; tracelen < n; tracelen++) {
+        r = sum * random() / ((double) RAND_MAX + 1);
+        for (lo = 0, hi = k - 1; lo < hi;) {
+            i = (lo + hi) / 2;
+            if (cdf[i] < r)
+                lo = i + 1;
+            else
+                hi = i;
+        }
+        sprintf(name, "/trace/name%d", lo);
+        trace[tracelen] = strdup(name);
+    }
+    free(cdf);
+}
+
+// ----------------------------------------------------------------------
+
+// one request from the clients behind relay n-1; returns the hops to the
+// content, which then travels back to the clients
+int
+trace_request(struct ccnl_relay_s *chain, int n, char *name)
+{
+    struct ccnl_prefix_s *p = trace_prefix(name);
+    struct ccnl_content_s *c = NULL;
+    struct ccnl_interest_s *i;
+    int k, at, hops;
+
+    if (!p)
+        return 0;
+    for (at = n - 1; at >= 0; at--) {
+        for (c = chain[at].contents; c; c = c->next)
+            if (!ccnl_prefix_cmp(c->name, NULL, p, CMP_EXACT))
+                break;
+        ccnl_cs_count(chain + at, p, c);
+        if (c) {
+            ccnl_content_used(chain + at, c);
+            break;
+        }
+    }
+    for (k = at + 1, hops = 1; k < n; k++) {
+        // the pending interest, as received with the hop limit of 64
+        i = ccnl_calloc(1, sizeof(struct ccnl_interest_s));
+        i->prefix = ccnl_prefix_dup(p);
+        i->suite = CCNL_SUITE_CCNTLV;
+        i->hoppos = 0;
+        i->hopval = 64 - (n - k);
+        DBL_LINKED_LIST_ADD(chain[k].pit, i);
+
+        c = ccnl_calloc(1, sizeof(struct ccnl_content_s));
+        c->suite = CCNL_SUITE_CCNTLV;
+        c->name = ccnl_prefix_dup(p);
+        c->content = (unsigned char*) "data.";
+        c->contentlen = 5;
+        c->hoppos = -1;
+        c->hops = hops;
+        if (ccnl_cs_admit(chain + k, c))
+            ccnl_content_add2cache(chain + k, c);
+        else
+            free_content(c);
+        ccnl_interest_remove(chain + k, i);
+        hops++;
+    }
+    free_prefix(p);
+    return at >= 0 ? n - at : n + 1;
+}
+
+void
+trace_run(char *policy, int n, int entries)
+{
+    struct ccnl_relay_s *chain = calloc(n, sizeof(struct ccnl_relay_s));
+    long hits = 0, hops = 0, admitted = 0, rejected = 0;
+    char relayhits[256];
+    int k, len = 0;
+
+    for (k = 0; k < n; k++) {
+        chain[k].max_cache_entries = entries;
+        if (ccnl_cs_setpolicy(chain + k, trace_prefix("/"), policy) < 0) {
+            fprintf(stderr, "bad policy %s\n", policy);
+            goto Done;
+        }
+    }
+    for (k = 0; k < tracelen; k++)
+        hops += trace_request(chain, n, trace[k]);
+    for (k = n - 1; k >= 0; k--) {
+        hits += chain[k].cs_hits;
+        admitted += chain[k].cs_admitted;
+        rejected += chain[k].cs_rejected;
+        if (len < (int) sizeof(relayhits) - 8)
+            len += sprintf(relayhits + len, "%s%.1f", k < n - 1 ? "/" : "",
+                           chain[k].cs_lookups ? 100.0 * chain[k].cs_hits /
+                           chain[k].cs_lookups : 0);
+    }
+    printf("%-12s %8.1f  %-28s %6.2f %10ld %10ld\n", policy,
+           100.0 * hits / tracelen, relayhits, (double) hops / tracelen,
+           admitted, rejected);
+Done:
+    for (k = 0; k < n; k++)
+        ccnl_core_cleanup(chain + k);
+    free(chain);
+}
+
+// ----------------------------------------------------------------------
+
+int
+main(int argc, char **argv)
+{
+    char *fname = NULL, *policies[] = {"lce", "lcd", "prob=10", "prob=50",
+                                       "probcache", "tinylfu", NULL};
+    int opt, relays = 4, entries = 100, requests = 100000, names = 10000;
+    double alpha = 0.8;
+
+    while ((opt = getopt(argc, argv, "a:c:f:hk:n:r:s:")) != -1) {
+        switch (opt) {
+        case 'a':
+            alpha = atof(optarg);
+            break;
+        case 'c':
+            entries = atoi(optarg);
+            break;
+        case 'f':
+            fname = optarg;
+            break;
+        case 'k':
+            names = atoi(optarg);
+            break;
+        case 'n':
+            requests = atoi(optarg);
+            break;
+        case 'r':
+            relays = atoi(optarg);
+            break;
+        case 's':
+            srandom(atoi(optarg));
+            break;
+        case 'h':
+        default:
+            fprintf(stderr, "usage: %s [-r relays] [-c entries] [-n requests] "
+                    "[-k names] [-a alpha] [-s seed] [-f TRACEFILE] "
+                    "[POLICY ...]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (relays < 1 || relays > 32 || entries < 1 || names < 1)
+        return -1;
+
+    ccnl_core_init();
+    if (fname) {
+        if (trace_load(fname) <= 0) {
+            fprintf(stderr, "no names in %s\n", fname);
+            return -1;
+        }
+    } else
+        trace_zipf(requests, names, alpha);
+
+    printf("%d requests, %d relays of %d entries\n", tracelen, relays, entries);
+    printf("%-12s %8s  %-28s %6s %10s %10s\n", "policy", "hit%",
+           "relay hit% (clients..)", "hops", "admitted", "rejected");
+    if (optind < argc)
+        for (; optind < argc; optind++)
+            trace_run(argv[optind], relays, entries);
+    else
+        for (opt = 0; policies[opt]; opt++)
+            trace_run(policies[opt], relays, entries);
+    return 0;
+}
+
+// eof
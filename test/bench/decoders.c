@@ -0,0 +1,192 @@
+/*
+ * @f test/bench/decoders.c
+ * @b CCN lite - one entry point per wire format decoder, for the parser
+ *    benchmark and the fuzzing harnesses (test/fuzz)
+ *
+ * Copyright (C) 2026, Christian Tschudin, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2026-10-19 created
+ */
+
+// Each decoder takes one packet as it would be handed to the suite's
+// forwarder, i.e. after the relay's code switching, and releases whatever
+// the decoder allocated. Returns 0 if the packet was accepted, <0 otherwise.
+
+#define CCNL_UNIX
+
+#define NEEDS_PACKET_CRAFTING
+#define USE_SUITE_CCNB
+#define USE_SUITE_CCNTLV
+#define USE_SUITE_IOTTLV
+#define USE_SUITE_NDNTLV
+
+#include "../../src/ccnl-os-includes.h"
+
+#include <dirent.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef CCNL_BENCH_COUNT_ALLOCS
+long bench_allocs;
+
+static void*
+bench_malloc(size_t s)
+{
+    bench_allocs++;
+    return malloc(s);
+}
+
+static void*
+bench_calloc(size_t n, size_t s)
+{
+    bench_allocs++;
+    return calloc(n, s);
+}
+
+#  define malloc(s)     bench_malloc(s)
+#  define calloc(n,s)   bench_calloc(n,s)
+#endif
+
+#include "../../src/ccnl-ext-logging.c"
+
+#include "../../src/ccnl-defs.h"
+#include "../../src/ccnl-core.h"
+
+#include "../../src/ccnl-ext.h"
+#include "../../src/ccnl-ext-debug.c"
+#include "../../src/ccnl-os-time.c"
+
+#define ccnl_app_RX(x,y)                do{}while(0)
+#define ccnl_print_stats(x,y)           do{}while(0)
+#define ccnl_close_socket(a)            do{}while(0)
+#define ccnl_ll_TX(a,b,c,d)             do{a=a;}while(0)
+
+#include "../../src/ccnl-core.c"
+
+// ----------------------------------------------------------------------
+
+int
+ccnl_bench_ccnb(unsigned char *data, int len)
+{
+    int num, typ, scope, aok, min, max, contlen;
+    struct ccnl_prefix_s *p = 0;
+    struct ccnl_buf_s *buf, *nonce = 0, *ppkd = 0;
+    unsigned char *content = 0;
+
+    if (ccnl_ccnb_dehead(&data, &len, &num, &typ) || typ != CCN_TT_DTAG ||
+        (num != CCN_DTAG_INTEREST && num != CCN_DTAG_CONTENTOBJ))
+        return -1;
+    buf = ccnl_ccnb_extract(&data, &len, &scope, &aok, &min, &max,
+                            &p, &nonce, &ppkd, &content, &contlen);
+    if (!buf)
+        return -1;
+    free_prefix(p);
+    free_3ptr_list(buf, nonce, ppkd);
+    return 0;
+}
+
+int
+ccnl_bench_ccntlv(unsigned char *data, int len)
+{
+    struct ccnx_tlvhdr_ccnx201412_s *hp;
+    struct ccnl_prefix_s *p = 0;
+    struct ccnl_buf_s *buf;
+    unsigned char *content = 0, *keyid = 0;
+    int hdrlen, payloadlen, keyidlen, contlen;
+    unsigned int lastchunknum;
+
+    // same header checks as in ccnl_ccntlv_forwarder()
+    if (len < (int) sizeof(*hp) || *data != CCNX_TLV_V0)
+        return -1;
+    hp = (struct ccnx_tlvhdr_ccnx201412_s*) data;
+    hdrlen = hp->hdrlen;
+    if (hdrlen > len)
+        return -1;
+    payloadlen = ntohs(hp->pktlen) - hdrlen;
+    data += hdrlen;
+    len -= hdrlen;
+    if (payloadlen <= 0 || payloadlen > len)
+        return -1;
+
+    buf = ccnl_ccntlv_extract(hdrlen, &data, &len, &p, &keyid, &keyidlen,
+                              &lastchunknum, &content, &contlen);
+    if (!buf)
+        return -1;
+    free_prefix(p);
+    ccnl_free(buf);
+    return 0;
+}
+
+// the relay only passes IOTTLV packets which were announced by a code
+// switch, and the decoder relies on this header being present
+int
+ccnl_bench_iottlv(unsigned char *data, int len)
+{
+    int enc, typ, vallen, contlen;
+    struct ccnl_prefix_s *p = 0;
+    struct ccnl_buf_s *buf;
+    unsigned char *start, *content = 0;
+
+    if (ccnl_switch_dehead(&data, &len, &enc) || enc != CCNL_ENC_IOT2014)
+        return -1;
+    start = data;
+    if (ccnl_iottlv_dehead(&data, &len, &typ, &vallen))
+        return -1;
+    buf = ccnl_iottlv_extract(start, &data, &len, &p, NULL,
+                              &content, &contlen);
+    if (!buf)
+        return -1;
+    free_prefix(p);
+    ccnl_free(buf);
+    return 0;
+}
+
+int
+ccnl_bench_ndntlv(unsigned char *data, int len)
+{
+    unsigned char *cp = data;
+    int typ, vallen, scope, mbf, min, max, contlen;
+    unsigned int final_block_id;
+    struct ccnl_prefix_s *p = 0;
+    struct ccnl_buf_s *buf, *nonce = 0, *ppkl = 0;
+    unsigned char *content = 0;
+
+    if (ccnl_ndntlv_dehead(&data, &len, &typ, &vallen))
+        return -1;
+    buf = ccnl_ndntlv_extract(data - cp, &data, &len, &scope, &mbf, &min,
+                              &max, NULL, NULL, &final_block_id, &p, NULL, &nonce,
+                              &ppkl, &content, &contlen);
+    if (!buf)
+        return -1;
+    free_prefix(p);
+    free_3ptr_list(buf, nonce, ppkl);
+    return 0;
+}
+
+int
+ccnl_bench_ndntlv_scan(unsigned char *data, int len)
+{
+    unsigned char *cp = data;
+    int typ, vallen;
+    struct ccnl_ndntlv_view_s v;
+
+    if (ccnl_ndntlv_dehead(&data, &len, &typ, &vallen))
+        return -1;
+    return ccnl_ndntlv_scan(data - cp, &data, &len, &v);
+}
+
+// eof
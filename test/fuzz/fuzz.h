@@ -0,0 +1,137 @@
+/*
+ * @f test/fuzz/fuzz.h
+ * @b CCN lite - common part of the packet decoder fuzzing harnesses
+ *
+ * Copyright (C) 2026, Christian Tschudin, University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2026-10-19 created
+ */
+
+#ifndef CCNL_FUZZ_H
+#define CCNL_FUZZ_H
+
+#include <stdint.h>
+
+#include "../bench/decoders.c"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+// hand a private, exactly sized copy to the decoder so that the sanitizer
+// catches every read beyond the packet
+int
+ccnl_fuzz_one(int (*decode)(unsigned char*, int),
+              const uint8_t *data, size_t size)
+{
+    unsigned char *buf;
+
+    if (size == 0 || size > CCNL_MAX_PACKET_SIZE)
+        return 0;
+    buf = malloc(size);
+    if (!buf)
+        return 0;
+    memcpy(buf, data, size);
+    decode(buf, size);
+    free(buf);
+    return 0;
+}
+
+#ifndef CCNL_LIBFUZZER
+
+// Standalone driver, used by AFL and for replaying crashes: runs the
+// harness on each file given (or on stdin). With -m N, each input is
+// in addition fed N times to the harness after random mutation, which is
+// a cheap smoke test where no coverage guided fuzzer is installed.
+
+static void
+ccnl_fuzz_mutate(unsigned char *buf, int *len, unsigned int *seed)
+{
+    int i, cnt = 1 + rand_r(seed) % 4;
+
+    while (cnt-- > 0 && *len > 0) {
+        i = rand_r(seed) % *len;
+        switch (rand_r(seed) % 4) {
+        case 0: // flip a bit
+            buf[i] ^= 1 << (rand_r(seed) % 8);
+            break;
+        case 1: // interesting byte values (TLV length escapes)
+            buf[i] = "\x00\x01\x7f\x80\xfd\xfe\xff"[rand_r(seed) % 7];
+            break;
+        case 2: // truncate
+            *len = i;
+            break;
+        default: // random byte
+            buf[i] = rand_r(seed);
+            break;
+        }
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    unsigned char *data = malloc(CCNL_MAX_PACKET_SIZE), *tmp;
+    unsigned int seed = 4711;
+    int opt, fd, len, len2, mutations = 0, i, n;
+
+    tmp = malloc(CCNL_MAX_PACKET_SIZE);
+    while ((opt = getopt(argc, argv, "hm:s:")) != -1) {
+        switch (opt) {
+        case 'm':
+            mutations = atoi(optarg);
+            break;
+        case 's':
+            seed = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr, "usage: %s [-m mutations] [-s seed] [FILE...]\n",
+                    argv[0]);
+            return -1;
+        }
+    }
+
+    for (i = optind; i < argc || i == optind; i++) {
+        if (i < argc) {
+            fd = open(argv[i], O_RDONLY);
+            if (fd < 0) {
+                perror(argv[i]);
+                continue;
+            }
+        } else
+            fd = 0;
+        len = read(fd, data, CCNL_MAX_PACKET_SIZE);
+        if (fd)
+            close(fd);
+        if (len <= 0)
+            continue;
+        LLVMFuzzerTestOneInput(data, len);
+        for (n = 0; n < mutations; n++) {
+            memcpy(tmp, data, len);
+            len2 = len;
+            ccnl_fuzz_mutate(tmp, &len2, &seed);
+            LLVMFuzzerTestOneInput(tmp, len2);
+        }
+    }
+    free(tmp);
+    free(data);
+    return 0;
+}
+
+#endif // CCNL_LIBFUZZER
+
+#endif // CCNL_FUZZ_H
+
+// eof
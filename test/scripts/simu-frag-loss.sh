@@ -0,0 +1,53 @@
+#!/bin/sh
+
+# simu-frag-loss.sh -- goodput of the simulated network for some loss rates
+# and fragmentation modes (plain, ARQ, FEC), one simulation run each
+USAGE="usage: sh simu-frag-loss.sh [\"LOSS_PERCENT ...\" [\"FRAG ...\"]]"
+SET_CCNL_HOME_VAR="set system variable CCNL_HOME to your local CCN-Lite installation (.../ccn-lite) and run 'make clean all' in the src/ directory"
+COMPILE_CCNL="run 'make clean all' in CCNL_HOME/src"
+
+if [ -z "$CCNL_HOME" ]
+then
+    echo $SET_CCNL_HOME_VAR
+    exit 1
+fi
+
+if [ ! -f "$CCNL_HOME/src/ccn-lite-simu" ]
+then
+    echo $COMPILE_CCNL
+    exit 1
+fi
+
+if [ "$#" -gt 2 ]; then
+    echo $USAGE
+    exit 1
+fi
+
+LOSSES=${1:-"0 5 10 20"}
+FRAGS=${2:-"none ccnx2013 ccnx2013,arq ccnx2013,fec=8/2 ccnx2013,fec=4/2"}
+LOG=/tmp/ccn-lite-simu-$$.log
+
+# the simulation waits for ENTER at its start and its end
+printf "%-20s %5s %10s %10s %8s\n" FRAG LOSS% "TIME[s]" "kB/s" RETX
+for FRAG in $FRAGS; do
+    for LOSS in $LOSSES; do
+        (sleep 1; echo; sleep 60; echo) |
+            timeout 70 $CCNL_HOME/src/ccn-lite-simu -v info -f $FRAG -l $LOSS \
+            > $LOG 2>&1
+        # all four tasks (two per phase) must end
+        awk -v frag=$FRAG -v loss=$LOSS '
+            /goodput of node/ { bytes += $(NF-6); secs += $(NF-3); n++ }
+            /task for node .* ended/ { retx += $(NF-4) }
+            END {
+                if (n < 4)
+                    printf "%-20s %5d %10s %10s %8d\n", frag, loss,
+                           "-", "(" n+0 "/4 done)", retx
+                else
+                    printf "%-20s %5d %10.3f %10.1f %8d\n", frag, loss,
+                           secs, bytes / secs / 1000, retx
+            }' $LOG
+    done
+done
+rm -f $LOG
+
+# eof
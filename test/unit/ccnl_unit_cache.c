@@ -0,0 +1,565 @@
+#include "test.h"
+#include "../../src/ccnl-headers.h"
+
+
+// a content store of two entries, policies are set per test
+struct ccnl_relay_s *cache_relay;
+
+struct ccnl_prefix_s *ccnl_test_cache_prefix(char *uri, int suite){
+
+	char *c = ccnl_malloc(100);
+	struct ccnl_prefix_s *p;
+
+	strcpy(c, uri);
+	p = ccnl_URItoPrefix(c, suite, NULL, NULL);
+	ccnl_free(c);
+	return p;
+}
+
+// content which came hops away from its copy (0: unknown)
+struct ccnl_content_s *ccnl_test_cache_content(char *uri, int suite, int hops){
+
+	struct ccnl_content_s *c = ccnl_calloc(1, sizeof(struct ccnl_content_s));
+
+	c->name = ccnl_test_cache_prefix(uri, suite);
+	c->suite = suite;
+	c->content = (unsigned char*) "data.";
+	c->contentlen = 5;
+	c->hoppos = -1;
+	c->hops = hops;
+	return c;
+}
+
+int ccnl_test_cache_admit(char *uri, int hops){
+
+	struct ccnl_content_s *c = ccnl_test_cache_content(uri, CCNL_SUITE_NDNTLV, hops);
+	int ok = ccnl_cs_admit(cache_relay, c);
+
+	free_content(c);
+	return ok;
+}
+
+//---------------------------------------------------------------------------------------------------
+int ccnl_test_prepare_cache(void **relay, void **policies){
+
+	cache_relay = ccnl_calloc(1, sizeof(struct ccnl_relay_s));
+	cache_relay->max_cache_entries = 2;
+	*relay = cache_relay;
+	*policies = NULL;
+
+	return cache_relay != NULL;
+}
+
+int ccnl_test_cleanup_cache(void *relay, void *policies){
+
+	while (cache_relay->pit)
+		ccnl_interest_remove(cache_relay, cache_relay->pit);
+	while (cache_relay->faces)
+		ccnl_face_remove(cache_relay, cache_relay->faces);
+	ccnl_disk_close(cache_relay);
+	while (cache_relay->contents)
+		ccnl_content_remove(cache_relay, cache_relay->contents);
+	ccnl_cs_cleanup(cache_relay);
+	ccnl_prefetch_cleanup(cache_relay);
+	ccnl_free(cache_relay);
+	return 1;
+}
+
+//---------------------------------------------------------------------------------------------------
+// the longest prefix decides; LCD admits next to the copy, fixed
+// probabilities of 0 and 100 percent always decide the same way
+int ccnl_test_run_cache_policies(void *relay, void *policies){
+
+	int res;
+
+	res = ccnl_test_cache_admit("/path/to/data", 3);
+	res = res && !ccnl_cs_setpolicy(cache_relay,
+			ccnl_test_cache_prefix("/path", CCNL_SUITE_NDNTLV), "lcd");
+	res = res && !ccnl_test_cache_admit("/path/to/data", 3) &&
+		ccnl_test_cache_admit("/path/to/data", 1) &&
+		ccnl_test_cache_admit("/path/to/data", 0) &&
+		ccnl_test_cache_admit("/other/data", 3);
+
+	res = res && !ccnl_cs_setpolicy(cache_relay,
+			ccnl_test_cache_prefix("/path/to", CCNL_SUITE_NDNTLV), "prob=0");
+	res = res && !ccnl_test_cache_admit("/path/to/data", 1) &&
+		ccnl_test_cache_admit("/path/data", 1);
+
+	// replaces the policy of the same prefix, a bad spec is refused
+	res = res && !ccnl_cs_setpolicy(cache_relay,
+			ccnl_test_cache_prefix("/path/to", CCNL_SUITE_NDNTLV), "prob=100");
+	res = res && ccnl_test_cache_admit("/path/to/data", 3) &&
+		cache_relay->cachepolicies->next &&
+		!cache_relay->cachepolicies->next->next;
+	res = res && ccnl_cs_setpolicy(cache_relay,
+			ccnl_test_cache_prefix("/path/to", CCNL_SUITE_NDNTLV), "prob=101") < 0;
+
+	// other suites are not affected
+	res = res && !ccnl_cs_setpolicy(cache_relay,
+			ccnl_test_cache_prefix("/", CCNL_SUITE_CCNTLV), "prob=0");
+	res = res && ccnl_test_cache_admit("/path/data", 1);
+
+	return res && C_ASSERT_EQUAL_INT(cache_relay->cs_admitted, 7) &&
+		C_ASSERT_EQUAL_INT(cache_relay->cs_rejected, 2);
+}
+
+//---------------------------------------------------------------------------------------------------
+// ProbCache admits with hops/(hops + the hops down to the requester),
+// TinyLFU if the content is asked for more often than the LRU victim
+int ccnl_test_run_cache_probcache_tinylfu(void *relay, void *policies){
+
+	struct ccnl_interest_s *i = ccnl_calloc(1, sizeof(struct ccnl_interest_s));
+	struct ccnl_content_s *c;
+	struct ccnl_prefix_s *p;
+	int k, cnt, res;
+
+	res = !ccnl_cs_setpolicy(cache_relay,
+			ccnl_test_cache_prefix("/", CCNL_SUITE_CCNTLV), "probcache");
+	i->prefix = ccnl_test_cache_prefix("/path/to/data", CCNL_SUITE_CCNTLV);
+	i->suite = CCNL_SUITE_CCNTLV;
+	i->pkt = ccnl_buf_new("interest", 8);
+	i->hoppos = 0;
+	i->hopval = 61; // sent with 64, received with 62: three hops down
+	DBL_LINKED_LIST_ADD(cache_relay->pit, i);
+	c = ccnl_test_cache_content("/path/to/data", CCNL_SUITE_CCNTLV, 1);
+	for (k = cnt = 0; k < 1000; k++)
+		cnt += ccnl_cs_admit(cache_relay, c);
+	res = res && cnt > 150 && cnt < 350;
+	c->hops = 0; // unknown
+	res = res && ccnl_cs_admit(cache_relay, c);
+	free_content(c);
+
+	res = res && !ccnl_cs_setpolicy(cache_relay,
+			ccnl_test_cache_prefix("/path", CCNL_SUITE_NDNTLV), "tinylfu") &&
+		cache_relay->cs_sketch;
+	ccnl_content_add2cache(cache_relay,
+		ccnl_test_cache_content("/path/a", CCNL_SUITE_NDNTLV, 0));
+	res = res && ccnl_test_cache_admit("/path/b", 0); // not full yet
+	ccnl_content_add2cache(cache_relay,
+		ccnl_test_cache_content("/path/b", CCNL_SUITE_NDNTLV, 0));
+
+	// the victim is /path/a; /path/c is asked for more often, /path/d not
+	p = ccnl_test_cache_prefix("/path/c", CCNL_SUITE_NDNTLV);
+	for (k = 0; k < 3; k++)
+		ccnl_cs_count(cache_relay, p, NULL);
+	free_prefix(p);
+	ccnl_cs_count(cache_relay, cache_relay->contents->next->name,
+		      cache_relay->contents->next);
+	res = res && ccnl_test_cache_admit("/path/c", 0) &&
+		!ccnl_test_cache_admit("/path/d", 0);
+
+	// a hit makes /path/a the most recently used, the full store evicts /path/b
+	ccnl_content_used(cache_relay, cache_relay->contents->next);
+	ccnl_content_add2cache(cache_relay,
+		ccnl_test_cache_content("/path/c", CCNL_SUITE_NDNTLV, 0));
+	p = ccnl_test_cache_prefix("/path/a", CCNL_SUITE_NDNTLV);
+	res = res && C_ASSERT_EQUAL_INT(cache_relay->contentcnt, 2) &&
+		!ccnl_prefix_cmp(cache_relay->contents->next->name, NULL, p, CMP_EXACT);
+	free_prefix(p);
+
+	return res && C_ASSERT_EQUAL_INT(cache_relay->cs_lookups, 4) &&
+		C_ASSERT_EQUAL_INT(cache_relay->cs_hits, 1);
+}
+
+//---------------------------------------------------------------------------------------------------
+// an NDN packet for chunk of /path/file from face f, an interest or data
+void ccnl_test_prefetch_RX(struct ccnl_face_s *f, unsigned int chunk, int data){
+
+	struct ccnl_prefix_s *p = ccnl_test_cache_prefix("/path/file", CCNL_SUITE_NDNTLV);
+	struct ccnl_pkt_tmpl_s *t = ccnl_pkt_tmpl_new(p);
+	static int nonce = 1;
+	unsigned char *pkt;
+	int len;
+
+	if (data)
+		len = ccnl_pkt_tmpl_content(t, &chunk, (unsigned char*) "data.", 5,
+					    NULL, NULL, &pkt);
+	else
+		len = ccnl_pkt_tmpl_interest(t, &chunk, &nonce, &pkt);
+	nonce++;
+	ccnl_ndntlv_forwarder(cache_relay, f, &pkt, &len);
+	ccnl_pkt_tmpl_free(t);
+	free_prefix(p);
+}
+
+// the PIT entry of chunk, NULL if there is none
+struct ccnl_interest_s *ccnl_test_prefetch_pit(unsigned int chunk){
+
+	struct ccnl_interest_s *i;
+
+	for (i = cache_relay->pit; i; i = i->next)
+		if (i->prefix->chunknum && *i->prefix->chunknum == chunk)
+			return i;
+	return NULL;
+}
+
+// chunks ahead of the consumer are asked for upstream and cached; the
+// window grows with each one asked for, a jump shrinks it
+int ccnl_test_run_cache_prefetch(void *relay, void *policies){
+
+	struct ccnl_face_s *f[2];
+	struct ccnl_forward_s *fwd = ccnl_calloc(1, sizeof(struct ccnl_forward_s));
+	struct ccnl_prefetch_stream_s *s;
+	int k, res;
+
+	cache_relay->max_cache_entries = 8;
+	cache_relay->ifcount = 1;
+	cache_relay->ifs[0].sock = -1;
+	for (k = 0; k < 2; k++) { // consumer, upstream
+		f[k] = ccnl_calloc(1, sizeof(struct ccnl_face_s));
+		f[k]->faceid = k + 1;
+		DBL_LINKED_LIST_ADD(cache_relay->faces, f[k]);
+	}
+	fwd->prefix = ccnl_test_cache_prefix("/path", CCNL_SUITE_NDNTLV);
+	fwd->face = f[1];
+	fwd->suite = CCNL_SUITE_NDNTLV;
+	cache_relay->fib = fwd;
+	res = !ccnl_cs_setpolicy(cache_relay,
+			ccnl_test_cache_prefix("/path", CCNL_SUITE_NDNTLV), "prob=0") &&
+		!ccnl_prefetch_set(cache_relay,
+			ccnl_test_cache_prefix("/path", CCNL_SUITE_NDNTLV), 3) &&
+		ccnl_prefetch_set(cache_relay,
+			ccnl_test_cache_prefix("/path", CCNL_SUITE_NDNTLV), 1000) < 0;
+
+	// chunk 0 brings chunk 1, which is cached although the policy is not to
+	ccnl_test_prefetch_RX(f[0], 0, 0);
+	res = res && ccnl_test_prefetch_pit(0) && ccnl_test_prefetch_pit(1) &&
+		ccnl_test_prefetch_pit(1)->flags & CCNL_PIT_PREFETCH &&
+		!ccnl_test_prefetch_pit(1)->pending;
+	ccnl_test_prefetch_RX(f[1], 0, 1);
+	ccnl_test_prefetch_RX(f[1], 1, 1);
+	res = res && !cache_relay->pit && C_ASSERT_EQUAL_INT(cache_relay->contentcnt, 1) &&
+		cache_relay->contents->flags & CCNL_CONTENT_FLAGS_PREFETCHED;
+
+	// a hit from the cache, one from the PIT: two, then three ahead
+	ccnl_test_prefetch_RX(f[0], 1, 0);
+	res = res && ccnl_test_prefetch_pit(2) && ccnl_test_prefetch_pit(3) &&
+		!ccnl_test_prefetch_pit(4);
+	ccnl_test_prefetch_RX(f[0], 2, 0);
+	s = cache_relay->prefetchstreams;
+	res = res && ccnl_test_prefetch_pit(2)->pending &&
+		!(ccnl_test_prefetch_pit(2)->flags & CCNL_PIT_PREFETCH) &&
+		ccnl_test_prefetch_pit(5) && !ccnl_test_prefetch_pit(6) &&
+		s && C_ASSERT_EQUAL_INT(s->window, 3) && C_ASSERT_EQUAL_INT(s->hits, 2);
+
+	// the consumer jumps: back to one ahead
+	ccnl_test_prefetch_RX(f[0], 9, 0);
+	res = res && ccnl_test_prefetch_pit(10) && !ccnl_test_prefetch_pit(11) &&
+		C_ASSERT_EQUAL_INT(s->window, 1) && !s->next;
+
+	return res && C_ASSERT_EQUAL_INT(cache_relay->pf_issued, 6) &&
+		C_ASSERT_EQUAL_INT(cache_relay->pf_hits, 2);
+}
+
+//---------------------------------------------------------------------------------------------------
+// runs the loader's timer until it is done
+int ccnl_test_preload_run(void){
+
+	int k;
+
+	for (k = 0; cache_relay->preload && k < 5000; k++) {
+		ccnl_rem_timer(cache_relay->preload->timer);
+		cache_relay->preload->timer = NULL;
+		ccnl_preload_work(cache_relay, NULL);
+		usleep(1000);
+	}
+	return !cache_relay->preload && !eventqueue;
+}
+
+// the files of a directory go into the content store in the background,
+// what is not a content object is skipped
+int ccnl_test_run_cache_preload(void *relay, void *policies){
+
+	struct ccnl_prefix_s *p = ccnl_test_cache_prefix("/path/to/file", CCNL_SUITE_NDNTLV);
+	struct ccnl_pkt_tmpl_s *t = ccnl_pkt_tmpl_new(p);
+	struct ccnl_content_s *c;
+	char dir[] = "/tmp/ccnl-unit-XXXXXX", fname[100];
+	unsigned char *pkt;
+	unsigned int chunk;
+	int len, fd, res = t && mkdtemp(dir);
+
+	for (chunk = 0; res && chunk < 3; chunk++) {
+		len = ccnl_pkt_tmpl_content(t, &chunk, (unsigned char*) "data.", 5,
+					    NULL, NULL, &pkt);
+		sprintf(fname, "%s/c%u.ndntlv", dir, chunk);
+		fd = open(fname, O_WRONLY | O_CREAT, 0644);
+		res = len > 0 && fd >= 0 && write(fd, pkt, len) == len;
+		close(fd);
+	}
+	sprintf(fname, "%s/junk", dir);
+	fd = open(fname, O_WRONLY | O_CREAT, 0644);
+	res = res && fd >= 0 && write(fd, "junk", 4) == 4;
+	close(fd);
+
+	cache_relay->max_cache_entries = 8;
+	ccnl_populate_cache(cache_relay, dir);
+	res = res && cache_relay->preload && ccnl_test_preload_run() &&
+		C_ASSERT_EQUAL_INT(cache_relay->contentcnt, 3);
+	for (c = cache_relay->contents; res && c; c = c->next)
+		res = c->flags & CCNL_CONTENT_FLAGS_STATIC && c->name->compcnt == 4 &&
+			ccnl_prefix_cmp(p, NULL, c->name, CMP_LONGEST) == p->compcnt;
+
+	for (chunk = 0; chunk < 3; chunk++) {
+		sprintf(fname, "%s/c%u.ndntlv", dir, chunk);
+		unlink(fname);
+	}
+	sprintf(fname, "%s/junk", dir);
+	unlink(fname);
+	rmdir(dir);
+	if (t)
+		ccnl_pkt_tmpl_free(t);
+	free_prefix(p);
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// the packets of a packed repository file go into the content store, an
+// index entry which points outside of the packets (or wraps) is skipped
+int ccnl_test_run_cache_repo(void *relay, void *policies){
+
+	struct ccnl_prefix_s *p = ccnl_test_cache_prefix("/path/to/file", CCNL_SUITE_NDNTLV);
+	struct ccnl_pkt_tmpl_s *t = ccnl_pkt_tmpl_new(p);
+	struct ccnl_repo_hdr_s h;
+	struct ccnl_repo_ent_s e[5];
+	struct ccnl_content_s *c;
+	char fname[] = "/tmp/ccnl-unit-XXXXXX";
+	unsigned char *pkt;
+	unsigned int chunk, off = sizeof(h);
+	int len, fd = mkstemp(fname), res = t && fd >= 0;
+
+	res = res && write(fd, &h, sizeof(h)) == sizeof(h);
+	for (chunk = 0; res && chunk < 3; chunk++) {
+		len = ccnl_pkt_tmpl_content(t, &chunk, (unsigned char*) "data.", 5,
+					    NULL, NULL, &pkt);
+		res = len > 0 && write(fd, pkt, len) == len;
+		c = ccnl_preload_content(cache_relay, CCNL_SUITE_NDNTLV, 0, pkt, len, "test");
+		res = res && c;
+		e[chunk].hash = c ? htonl(ccnl_prefix_hash(c->name)) : 0;
+		e[chunk].len = htonl(len);
+		e[chunk].offhi = 0;
+		e[chunk].offlo = htonl(off);
+		off += len;
+		if (c)
+			free_content(c);
+	}
+	e[3] = e[2];
+	e[3].offlo = htonl(off - 2);
+	e[4] = e[2];
+	e[4].offhi = htonl(0xffffffff);
+	e[4].offlo = htonl(0xfffffff0);
+	memcpy(h.magic, CCNL_REPO_MAGIC, sizeof(h.magic));
+	h.version = htonl(CCNL_REPO_VERSION);
+	h.cnt = htonl(5);
+	h.idxhi = 0;
+	h.idxlo = htonl(off);
+	res = res && write(fd, e, sizeof(e)) == sizeof(e) &&
+		lseek(fd, 0, SEEK_SET) == 0 && write(fd, &h, sizeof(h)) == sizeof(h);
+	if (fd >= 0)
+		close(fd);
+
+	cache_relay->max_cache_entries = 8;
+	ccnl_populate_cache(cache_relay, fname);
+	res = res && cache_relay->preload && cache_relay->preload->repo &&
+		C_ASSERT_EQUAL_INT(cache_relay->preload->entcnt, 5) &&
+		ccnl_test_preload_run() &&
+		C_ASSERT_EQUAL_INT(cache_relay->contentcnt, 3);
+	for (c = cache_relay->contents; res && c; c = c->next)
+		res = c->flags & CCNL_CONTENT_FLAGS_STATIC && c->name->compcnt == 4 &&
+			ccnl_prefix_cmp(p, NULL, c->name, CMP_LONGEST) == p->compcnt;
+
+	unlink(fname);
+	if (t)
+		ccnl_pkt_tmpl_free(t);
+	free_prefix(p);
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// chunk of /path/file, as if it came in, into the content store
+void ccnl_test_disk_add(unsigned int chunk){
+
+	struct ccnl_prefix_s *p = ccnl_test_cache_prefix("/path/file", CCNL_SUITE_NDNTLV);
+	struct ccnl_pkt_tmpl_s *t = ccnl_pkt_tmpl_new(p);
+	struct ccnl_content_s *c;
+	unsigned char *pkt;
+	int len;
+
+	len = ccnl_pkt_tmpl_content(t, &chunk, (unsigned char*) "data.", 5,
+				    NULL, NULL, &pkt);
+	c = ccnl_preload_content(cache_relay, CCNL_SUITE_NDNTLV, 0, pkt, len, "test");
+	if (c && !ccnl_content_add2cache(cache_relay, c))
+		free_content(c);
+	ccnl_pkt_tmpl_free(t);
+	free_prefix(p);
+}
+
+// whether an interest for chunk of /path/file is answered from disk
+int ccnl_test_disk_has(struct ccnl_face_s *f, unsigned int chunk){
+
+	long hits = cache_relay->disk->hits;
+
+	ccnl_test_prefetch_RX(f, chunk, 0);
+	return cache_relay->disk->hits > hits;
+}
+
+// evicted content goes to disk and comes back from there on a miss, also
+// after a restart; the oldest segments are deleted when it is full
+int ccnl_test_run_cache_disk(void *relay, void *policies){
+
+	struct ccnl_face_s *f = ccnl_calloc(1, sizeof(struct ccnl_face_s));
+	char dir[] = "/tmp/ccnl-unit-XXXXXX", fname[300];
+	struct ccnl_disk_s *d;
+	struct dirent *de;
+	unsigned int chunk;
+	DIR *dp;
+	int res = mkdtemp(dir) && !ccnl_disk_open(cache_relay, dir, 1 << 20);
+
+	cache_relay->ifcount = 1;
+	cache_relay->ifs[0].sock = -1;
+	f->faceid = 1;
+	DBL_LINKED_LIST_ADD(cache_relay->faces, f);
+	d = cache_relay->disk;
+
+	for (chunk = 0; res && chunk < 4; chunk++)
+		ccnl_test_disk_add(chunk);
+	res = res && C_ASSERT_EQUAL_INT(cache_relay->contentcnt, 2) &&
+		C_ASSERT_EQUAL_INT(d->demoted, 2) && C_ASSERT_EQUAL_INT(d->entcnt, 2);
+
+	// a miss in RAM is answered from disk, which evicts chunk 2
+	if (res)
+		ccnl_test_prefetch_RX(f, 0, 0);
+	res = res && !cache_relay->pit && C_ASSERT_EQUAL_INT(d->hits, 1) &&
+		cache_relay->contents->flags & CCNL_CONTENT_FLAGS_ONDISK &&
+		C_ASSERT_EQUAL_INT(d->demoted, 3);
+	if (res)
+		ccnl_test_prefetch_RX(f, 7, 0);
+	res = res && C_ASSERT_EQUAL_INT(d->misses, 1);
+
+	// chunk 3 is only in RAM until the relay stops
+	ccnl_disk_close(cache_relay);
+	while (cache_relay->contents)
+		ccnl_content_remove(cache_relay, cache_relay->contents);
+	res = res && !ccnl_disk_open(cache_relay, dir, 1 << 20);
+	res = res && C_ASSERT_EQUAL_INT(cache_relay->disk->entcnt, 4) &&
+		ccnl_test_disk_has(f, 3) && ccnl_test_disk_has(f, 1) &&
+		!ccnl_test_disk_has(f, 7);
+
+	// a quarter of 1000 bytes is one packet per segment
+	ccnl_disk_close(cache_relay);
+	while (cache_relay->contents)
+		ccnl_content_remove(cache_relay, cache_relay->contents);
+	res = res && !ccnl_disk_open(cache_relay, dir, 1000);
+	for (chunk = 10; res && chunk < 30; chunk++)
+		ccnl_test_disk_add(chunk);
+	d = cache_relay->disk;
+	res = res && d->collected > 0 && d->bytes <= 1000 &&
+		!ccnl_test_disk_has(f, 0) && ccnl_test_disk_has(f, 27);
+
+	ccnl_disk_close(cache_relay);
+	dp = opendir(dir);
+	while (dp && (de = readdir(dp))) {
+		sprintf(fname, "%s/%.256s", dir, de->d_name);
+		if (de->d_name[0] != '.')
+			unlink(fname);
+	}
+	if (dp)
+		closedir(dp);
+	rmdir(dir);
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// a snapshot gives back the content store in the same order and with its
+// usage, but without the objects loaded with -d
+int ccnl_test_run_cache_snapshot(void *relay, void *policies){
+
+	char path[] = "/tmp/ccnl-unit-XXXXXX";
+	struct ccnl_content_s *c;
+	unsigned int chunk;
+	int fd = mkstemp(path), t = CCNL_NOW(), res = fd >= 0;
+	int ages[] = {0, 0, 20, 10};
+
+	if (fd >= 0)
+		close(fd);
+	cache_relay->max_cache_entries = 4;
+	for (chunk = 0; res && chunk < 4; chunk++) {
+		ccnl_test_disk_add(chunk);
+		c = cache_relay->contents;
+		c->served_cnt = 10 + chunk;
+		c->last_used = t - ages[chunk];
+	}
+	res = res && C_ASSERT_EQUAL_INT(cache_relay->contentcnt, 4);
+	if (res) {
+		cache_relay->contents->next->flags |= CCNL_CONTENT_FLAGS_STALE;
+		cache_relay->contents->next->next->next->flags |= CCNL_CONTENT_FLAGS_STATIC;
+	}
+	res = res && C_ASSERT_EQUAL_INT(ccnl_snapshot_save(cache_relay, path), 3);
+
+	while (cache_relay->contents)
+		ccnl_content_remove(cache_relay, cache_relay->contents);
+	res = res && C_ASSERT_EQUAL_INT(ccnl_snapshot_load(cache_relay, path), 3) &&
+		C_ASSERT_EQUAL_INT(cache_relay->contentcnt, 3);
+	c = cache_relay->contents;
+	res = res && C_ASSERT_EQUAL_INT(c->served_cnt, 13) &&
+		C_ASSERT_EQUAL_INT(c->next->served_cnt, 12) &&
+		C_ASSERT_EQUAL_INT(c->next->next->served_cnt, 11) &&
+		c->next->flags & CCNL_CONTENT_FLAGS_STALE &&
+		!(c->flags & CCNL_CONTENT_FLAGS_STALE) &&
+		c->next->next->last_used > c->last_used &&
+		c->last_used > c->next->last_used;
+
+	// in a smaller content store, the least recently used one is evicted
+	while (cache_relay->contents)
+		ccnl_content_remove(cache_relay, cache_relay->contents);
+	cache_relay->max_cache_entries = 2;
+	res = res && C_ASSERT_EQUAL_INT(ccnl_snapshot_load(cache_relay, path), 3) &&
+		C_ASSERT_EQUAL_INT(cache_relay->contentcnt, 2);
+	c = cache_relay->contents;
+	res = res && C_ASSERT_EQUAL_INT(c->served_cnt, 13) &&
+		C_ASSERT_EQUAL_INT(c->next->served_cnt, 11);
+
+	unlink(path);
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// content which the ageing drops from RAM goes to disk as well
+int ccnl_test_run_cache_disk_ageing(void *relay, void *policies){
+
+	struct ccnl_face_s *f = ccnl_calloc(1, sizeof(struct ccnl_face_s));
+	char dir[] = "/tmp/ccnl-unit-XXXXXX", fname[300];
+	struct ccnl_content_s *c;
+	unsigned int chunk;
+	int res = mkdtemp(dir) && !ccnl_disk_open(cache_relay, dir, 1 << 20);
+
+	cache_relay->max_cache_entries = -1;
+	cache_relay->ifcount = 1;
+	cache_relay->ifs[0].sock = -1;
+	f->faceid = 1;
+	f->flags = CCNL_FACE_FLAGS_STATIC;
+	DBL_LINKED_LIST_ADD(cache_relay->faces, f);
+
+	for (chunk = 0; res && chunk < 3; chunk++)
+		ccnl_test_disk_add(chunk);
+	for (c = cache_relay->contents; c; c = c->next) {
+		c->last_used -= CCNL_CONTENT_TIMEOUT;
+		if (!c->next) // chunk 0 comes back stale
+			ccnl_content_freshness(c, 0);
+	}
+	if (res)
+		ccnl_do_ageing(cache_relay, NULL);
+	res = res && C_ASSERT_EQUAL_INT(cache_relay->contentcnt, 0) &&
+		C_ASSERT_EQUAL_INT(cache_relay->disk->demoted, 3) &&
+		ccnl_test_disk_has(f, 1) && !ccnl_test_disk_has(f, 7) &&
+		!ccnl_content_isStale(cache_relay->contents) &&
+		ccnl_test_disk_has(f, 0) &&
+		ccnl_content_isStale(cache_relay->contents);
+
+	ccnl_disk_close(cache_relay);
+	for (chunk = 0; chunk < 2; chunk++) {
+		sprintf(fname, "%s/%08u.%s", dir, 0, chunk ? "idx" : "seg");
+		unlink(fname);
+	}
+	rmdir(dir);
+	return res;
+}
@@ -0,0 +1,457 @@
+#include "test.h"
+#include "../../src/ccnl-headers.h"
+
+
+int frag_proto = CCNL_FRAG_CCNx2013;
+
+// single fragments, exact multiples and one byte more, for some MTUs
+int frag_mtus[] = {100, 300, 1200, 1500, 9000};
+int frag_lens[] = {1, 50, 80, 299, 1000, 1199, 1200, 1201, 4000, 20000};
+#define FRAG_MAXLEN 20000
+
+// packets handed up by reassembly; all are prefixes of the test pattern
+unsigned char *frag_pattern;
+int frag_resultlens[32], frag_resultcnt, frag_resultok, frag_resultbytes;
+
+int ccnl_test_frag_collect(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
+			   unsigned char **data, int *datalen){
+
+	if (frag_resultcnt < 32)
+		frag_resultlens[frag_resultcnt] = *datalen;
+	frag_resultcnt++;
+	frag_resultbytes += *datalen;
+	frag_resultok = frag_resultok && !memcmp(*data, frag_pattern, *datalen);
+	*data += *datalen;
+	*datalen = 0;
+	return 0;
+}
+
+void ccnl_test_frag_RXrelay(struct ccnl_relay_s *relay, struct ccnl_face_s *f,
+			    struct ccnl_buf_s *buf){
+
+	unsigned char *data = buf->data;
+	int num, typ, datalen = buf->datalen;
+
+	ccnl_ccnb_dehead(&data, &datalen, &num, &typ);
+	if (frag_proto == CCNL_FRAG_CCNx2013)
+		ccnl_frag_RX_CCNx2013(ccnl_test_frag_collect, relay, f, &data, &datalen);
+	else
+		ccnl_frag_RX_frag2012(ccnl_test_frag_collect, relay, f, &data, &datalen);
+}
+
+void ccnl_test_frag_RX(struct ccnl_face_s *f, struct ccnl_buf_s *buf){
+	ccnl_test_frag_RXrelay(NULL, f, buf);
+}
+
+//---------------------------------------------------------------------------------------------------
+int ccnl_test_prepare_frag(void **pkt, void **face){
+
+	struct ccnl_buf_s *buf = ccnl_buf_new(NULL, FRAG_MAXLEN);
+	int i;
+
+	if (!buf)
+		return 0;
+	for (i = 0; i < FRAG_MAXLEN; i++)
+		buf->data[i] = i * 7 + (i >> 8);
+	*pkt = buf;
+	frag_pattern = buf->data;
+	*face = ccnl_calloc(1, sizeof(struct ccnl_face_s));
+
+	return *face != NULL;
+}
+
+int ccnl_test_cleanup_frag(void *pkt, void *face){
+
+	ccnl_free(pkt);
+	ccnl_free(face);
+	return 1;
+}
+
+//---------------------------------------------------------------------------------------------------
+// the computed fragment count and size must match what getnext produces,
+// and the fragments must reassemble to the original packet
+int ccnl_test_run_frag(void *pkt, void *face){
+
+	struct ccnl_buf_s *orig = pkt, *buf;
+	struct ccnl_face_s *f = face;
+	struct ccnl_frag_s *tx;
+	sockunion su;
+	int i, j, cnt, total, n, sum, res = 1;
+
+	memset(&su, 0, sizeof(su));
+	for (i = 0; res && i < sizeof(frag_mtus) / sizeof(int); i++) {
+		for (j = 0; res && j < sizeof(frag_lens) / sizeof(int); j++) {
+			tx = ccnl_frag_new(frag_proto, frag_mtus[i]);
+			f->frag = ccnl_frag_new(frag_proto, frag_mtus[i]);
+			frag_resultcnt = 0;
+			frag_resultok = 1;
+
+			cnt = ccnl_frag_getfragcount(tx, frag_lens[j], &total);
+			ccnl_frag_reset(tx, ccnl_buf_new(orig->data, frag_lens[j]), 0, &su);
+			for (n = sum = 0; (buf = ccnl_frag_getnext(tx, NULL, NULL)); n++) {
+				sum += buf->datalen;
+				res = res && buf->datalen <= frag_mtus[i];
+				ccnl_test_frag_RX(f, buf);
+				ccnl_free(buf);
+			}
+			res = res && C_ASSERT_EQUAL_INT(n, cnt) &&
+				C_ASSERT_EQUAL_INT(sum, total) &&
+				C_ASSERT_EQUAL_INT(frag_resultcnt, 1) && frag_resultok &&
+				C_ASSERT_EQUAL_INT(frag_resultlens[0], frag_lens[j]);
+			if (!res)
+				fprintf(stderr, "  mtu=%d len=%d: %d/%d fragments, %d/%d bytes\n",
+					frag_mtus[i], frag_lens[j], n, cnt, sum, total);
+
+			ccnl_frag_destroy(tx);
+			ccnl_frag_destroy(f->frag);
+			f->frag = NULL;
+		}
+	}
+
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// fragments of several packets in a changed order, and with one of them
+// lost: each complete packet must come out exactly once
+
+// packet lengths (all differ), for an MTU of 300
+int frag_reorder_lens[] = {1000, 40, 700, 1500, 41, 900, 42};
+#define FRAG_REORDER_CNT (sizeof(frag_reorder_lens) / sizeof(int))
+
+int ccnl_test_frag_reorder(struct ccnl_face_s *f, struct ccnl_buf_s *orig,
+			   int (*order)(int i, int n), int lost){
+
+	struct ccnl_frag_s *tx = ccnl_frag_new(frag_proto, 300);
+	struct ccnl_buf_s *frags[64], *buf;
+	sockunion su;
+	int i, j, n = 0, lostpkt = -1, res;
+
+	memset(&su, 0, sizeof(su));
+	f->frag = ccnl_frag_new(frag_proto, 300);
+	frag_resultcnt = 0;
+	frag_resultok = 1;
+	for (i = 0; i < FRAG_REORDER_CNT; i++) {
+		ccnl_frag_reset(tx, ccnl_buf_new(orig->data, frag_reorder_lens[i]), 0, &su);
+		while (n < 64 && (buf = ccnl_frag_getnext(tx, NULL, NULL))) {
+			if (n == lost)
+				lostpkt = i;
+			frags[n++] = buf;
+		}
+	}
+	for (i = 0; i < n; i++) {
+		j = order(i, n);
+		if (j != lost)
+			ccnl_test_frag_RX(f, frags[j]);
+	}
+	for (i = 0; i < n; i++)
+		ccnl_free(frags[i]);
+
+	res = frag_resultok && C_ASSERT_EQUAL_INT(frag_resultcnt,
+				FRAG_REORDER_CNT - (lostpkt >= 0 ? 1 : 0));
+	for (i = 0; res && i < FRAG_REORDER_CNT; i++) {
+		int found = 0;
+		for (j = 0; j < frag_resultcnt; j++)
+			found += frag_resultlens[j] == frag_reorder_lens[i];
+		res = C_ASSERT_EQUAL_INT(found, i == lostpkt ? 0 : 1);
+	}
+	if (!res)
+		fprintf(stderr, "  lost=%d: %d packets delivered\n", lost, frag_resultcnt);
+	// the timeout gives up on the lost fragment and empties the window
+	for (i = 0; i < 3 && f->frag->rxtimer; i++) {
+		ccnl_rem_timer(f->frag->rxtimer);
+		ccnl_frag_rxtimeout(f->frag, NULL);
+	}
+	res = res && !ccnl_frag_rxpending(f->frag) && f->frag->rxbytes == 0 &&
+		!f->frag->rxtimer;
+
+	ccnl_frag_destroy(tx);
+	ccnl_frag_destroy(f->frag);
+	f->frag = NULL;
+	return res;
+}
+
+int ccnl_test_frag_reversed(int i, int n){
+	return n - 1 - i;
+}
+
+int ccnl_test_frag_swapped(int i, int n){ // 1 0 3 2 5 4 ...
+	return (i ^ 1) < n ? i ^ 1 : i;
+}
+
+int ccnl_test_frag_interleaved(int i, int n){ // odd ones first
+	return i < n / 2 ? 2 * i + 1 : 2 * (i - n / 2);
+}
+
+int ccnl_test_run_frag_reorder(void *pkt, void *face){
+
+	int (*orders[])(int, int) = {ccnl_test_frag_reversed,
+		ccnl_test_frag_swapped, ccnl_test_frag_interleaved};
+	int i, res = 1;
+
+	for (i = 0; res && i < 3; i++) {
+		res = ccnl_test_frag_reorder(face, pkt, orders[i], -1) &&
+			ccnl_test_frag_reorder(face, pkt, orders[i], 5) &&
+			ccnl_test_frag_reorder(face, pkt, orders[i], 0);
+	}
+
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// ARQ between two relays over a link which loses every 5th fragment and
+// every 4th ack: each packet must come out exactly once, without any loss
+
+struct ccnl_relay_s *frag_arq_relay[2]; // sender, receiver
+struct ccnl_buf_s *frag_arq_wire[2];    // datagrams in flight, per direction
+
+void ccnl_test_frag_arq_TX(struct ccnl_relay_s *relay, struct ccnl_buf_s *buf){
+
+	int dir = relay == frag_arq_relay[1];
+	struct ccnl_buf_s **pp = &frag_arq_wire[dir];
+
+	while (*pp)
+		pp = &(*pp)->next;
+	*pp = ccnl_buf_new(buf->data, buf->datalen);
+}
+
+int ccnl_test_frag_arq_deliver(struct ccnl_face_s **faces, int dir, int *cnt, int lossy){
+
+	struct ccnl_buf_s *buf;
+	int n = 0;
+
+	while ((buf = frag_arq_wire[dir]) != NULL) {
+		frag_arq_wire[dir] = buf->next;
+		if (++*cnt % lossy)
+			ccnl_test_frag_RXrelay(frag_arq_relay[!dir], faces[!dir], buf);
+		ccnl_free(buf);
+		n++;
+	}
+	return n;
+}
+
+int ccnl_test_run_frag_arq(void *pkt, void *face){
+
+	struct ccnl_buf_s *orig = pkt;
+	struct ccnl_face_s *faces[2];
+	struct ccnl_frag_s *tx;
+	int i, len, total = 0, cnt[2] = {0, 0}, rounds = 0, res;
+
+	for (i = 0; i < 2; i++) {
+		frag_arq_relay[i] = ccnl_calloc(1, sizeof(struct ccnl_relay_s));
+		frag_arq_relay[i]->ifcount = 1;
+		faces[i] = ccnl_calloc(1, sizeof(struct ccnl_face_s));
+		faces[i]->frag = ccnl_frag_new(frag_proto, 300);
+	}
+	tx = faces[0]->frag;
+	ccnl_frag_setopts(tx, "x,arq");
+	ccnl_test_ll_TX = ccnl_test_frag_arq_TX;
+	frag_resultcnt = frag_resultbytes = 0;
+	frag_resultok = 1;
+
+	// more fragments than the window holds (lengths differ, the face
+	// queue drops duplicates)
+	for (i = 0; i < 6 * FRAG_REORDER_CNT; i++) {
+		len = frag_reorder_lens[i % FRAG_REORDER_CNT] + 1000 * (i / FRAG_REORDER_CNT);
+		total += len;
+		ccnl_face_enqueue(frag_arq_relay[0], faces[0], ccnl_buf_new(orig->data, len));
+	}
+	while (rounds++ < 1000 && (tx->txbase != tx->sendseq || faces[0]->outq)) {
+		if (ccnl_test_frag_arq_deliver(faces, 0, &cnt[0], 5) +
+		    ccnl_test_frag_arq_deliver(faces, 1, &cnt[1], 4) == 0 &&
+		    tx->txtimer) {
+			// the link is idle: let the retransmission timer expire
+			ccnl_rem_timer(tx->txtimer);
+			tx->txtimer = NULL;
+			tx->rto = 0;
+			ccnl_frag_arq_timeout(frag_arq_relay[0], faces[0]);
+		}
+	}
+	ccnl_test_ll_TX = NULL;
+
+	res = C_ASSERT_EQUAL_INT(frag_resultcnt, 6 * FRAG_REORDER_CNT) &&
+		C_ASSERT_EQUAL_INT(frag_resultbytes, total) && frag_resultok &&
+		C_ASSERT_EQUAL_INT(tx->losscount, 0) &&
+		C_ASSERT_EQUAL_INT(faces[1]->frag->losscount, 0) &&
+		tx->retransmits > 0 && !tx->txtimer && !faces[1]->frag->rxtimer &&
+		!ccnl_frag_rxpending(faces[1]->frag);
+	if (!res)
+		fprintf(stderr, "  %d rounds, %d packets, %u retransmissions\n",
+			rounds, frag_resultcnt, tx->retransmits);
+
+	for (i = 0; i < 2; i++) {
+		while (frag_arq_wire[i]) {
+			struct ccnl_buf_s *buf = frag_arq_wire[i];
+			frag_arq_wire[i] = buf->next;
+			ccnl_free(buf);
+		}
+		ccnl_frag_destroy(faces[i]->frag);
+		ccnl_free(faces[i]);
+		ccnl_free(frag_arq_relay[i]);
+	}
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// FEC without retransmissions: 8/2 blocks, two data fragments lost in
+// every other block and one data fragment plus one repair in the others.
+// All packets must come out exactly once, and every datagram must fit
+
+int ccnl_test_run_frag_fec(void *pkt, void *face){
+
+	struct ccnl_buf_s *orig = pkt, *buf, *wire[512];
+	struct ccnl_face_s *f = face;
+	struct ccnl_frag_s *tx = ccnl_frag_new(frag_proto, 300);
+	char isrepair[512];
+	sockunion su;
+	int i, n = 0, r, seq, blk, len, total = 0, res = 1;
+
+	memset(&su, 0, sizeof(su));
+	res = C_ASSERT_EQUAL_INT(ccnl_frag_setopts(NULL, "x,fec=8/0"), -1) &&
+		C_ASSERT_EQUAL_INT(ccnl_frag_setopts(NULL, "x,fec=8"), -1) &&
+		C_ASSERT_EQUAL_INT(ccnl_frag_setopts(tx, "x,fec=8/2,arq"), 0) &&
+		C_ASSERT_EQUAL_INT(tx->fecn, 8) && C_ASSERT_EQUAL_INT(tx->feck, 2);
+	tx->flags &= ~CCNL_FRAG_FLAGS_ARQ;
+	f->frag = ccnl_frag_new(frag_proto, 300);
+	frag_resultcnt = frag_resultbytes = 0;
+	frag_resultok = 1;
+
+	for (i = 0; i < 3 * FRAG_REORDER_CNT; i++) {
+		len = frag_reorder_lens[i % FRAG_REORDER_CNT] + 10 * i;
+		total += len;
+		ccnl_frag_reset(tx, ccnl_buf_new(orig->data, len), 0, &su);
+		// repairs go out right after their block, as in ccnl_face_CTS()
+		while (n < 512 && (buf = ccnl_frag_getnext(tx, NULL, NULL))) {
+			isrepair[n] = 0;
+			wire[n++] = buf;
+			while (n < 512 && (buf = ccnl_frag_fec_getnext(tx,
+						i == 3 * FRAG_REORDER_CNT - 1))) {
+				isrepair[n] = 1;
+				wire[n++] = buf;
+			}
+		}
+	}
+	res = res && tx->fecsent > 0 && !tx->feccnt;
+
+	for (i = 0, seq = 0, r = 0; i < n; i++) {
+		res = res && wire[i]->datalen <= 300;
+		if (wire[i]->datalen > 300)
+			fprintf(stderr, "  datagram %d: %d bytes\n", i, wire[i]->datalen);
+		if (isrepair[i]) {
+			blk = (seq - 1) / 8;
+			if (!(blk % 2 && r++ % 2 == 0))
+				ccnl_test_frag_RX(f, wire[i]);
+		} else {
+			blk = seq / 8;
+			if (!(seq % 8 == 1 || (seq % 8 == 5 && blk % 2 == 0)))
+				ccnl_test_frag_RX(f, wire[i]);
+			seq++;
+			r = 0;
+		}
+		ccnl_free(wire[i]);
+	}
+
+	res = res && C_ASSERT_EQUAL_INT(frag_resultcnt, 3 * FRAG_REORDER_CNT) &&
+		C_ASSERT_EQUAL_INT(frag_resultbytes, total) && frag_resultok &&
+		C_ASSERT_EQUAL_INT(f->frag->losscount, 0) &&
+		f->frag->fecrecovered > 0 && !ccnl_frag_rxpending(f->frag);
+	if (!res)
+		fprintf(stderr, "  %d datagrams, %d packets, %u repairs sent, %u recovered\n",
+			n, frag_resultcnt, tx->fecsent, f->frag->fecrecovered);
+
+	ccnl_frag_destroy(tx);
+	ccnl_frag_destroy(f->frag);
+	f->frag = NULL;
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// path MTU discovery over links which drop larger datagrams: the search
+// must end within CCNL_PMTU_STEP below the path MTU, and no fragment may
+// be larger. A peer which never answers leaves the base size
+
+int frag_pmtu_paths[] = {600, 1000, 1472, 4000, CCNL_MAX_PACKET_SIZE, 0};
+#define FRAG_PMTU_CNT (sizeof(frag_pmtu_paths) / sizeof(int))
+
+int ccnl_test_frag_pmtu_deliver(struct ccnl_face_s **faces, int dir, int path){
+
+	struct ccnl_buf_s *buf;
+	int n = 0;
+
+	while ((buf = frag_arq_wire[dir]) != NULL) {
+		frag_arq_wire[dir] = buf->next;
+		if (buf->datalen <= path)
+			ccnl_test_frag_RXrelay(frag_arq_relay[!dir], faces[!dir], buf);
+		ccnl_free(buf);
+		n++;
+	}
+	return n;
+}
+
+int ccnl_test_run_frag_pmtu(void *pkt, void *face){
+
+	struct ccnl_buf_s *orig = pkt, *buf;
+	struct ccnl_face_s *faces[2];
+	struct ccnl_frag_s *tx;
+	sockunion su;
+	int i, p, path, rounds, big, res = 1;
+
+	memset(&su, 0, sizeof(su));
+	for (i = 0; i < 2; i++) {
+		frag_arq_relay[i] = ccnl_calloc(1, sizeof(struct ccnl_relay_s));
+		frag_arq_relay[i]->ifcount = 1;
+		faces[i] = ccnl_calloc(1, sizeof(struct ccnl_face_s));
+	}
+	ccnl_test_ll_TX = ccnl_test_frag_arq_TX;
+
+	for (p = 0; res && p < FRAG_PMTU_CNT; p++) {
+		path = frag_pmtu_paths[p];
+		tx = faces[0]->frag = ccnl_frag_new(frag_proto, 0);
+		res = tx && (tx->flags & CCNL_FRAG_FLAGS_PMTU);
+		if (!res)
+			break;
+		ccnl_frag_pmtu_start(frag_arq_relay[0], faces[0]);
+		for (rounds = 0; rounds < 200 && tx->pmtuprobe; rounds++) {
+			if (ccnl_test_frag_pmtu_deliver(faces, 0, path) +
+			    ccnl_test_frag_pmtu_deliver(faces, 1, path) == 0 &&
+			    tx->pmtutimer) {
+				// nothing came back: the probe timer expires
+				ccnl_rem_timer(tx->pmtutimer);
+				ccnl_frag_pmtu_timeout(frag_arq_relay[0], faces[0]);
+			}
+		}
+		if (path)
+			res = res && tx->mtu == tx->pmtulo && tx->mtu <= path &&
+				path - tx->mtu < CCNL_PMTU_STEP;
+		else
+			res = res && C_ASSERT_EQUAL_INT(tx->mtu, CCNL_PMTU_BASE);
+		res = res && !tx->pmtuprobe && tx->pmtutimer;
+
+		// fragments use the new MTU
+		big = 0;
+		ccnl_frag_reset(tx, ccnl_buf_new(orig->data, FRAG_MAXLEN), 0, &su);
+		while ((buf = ccnl_frag_getnext(tx, NULL, NULL)) != NULL) {
+			if (buf->datalen > tx->mtu)
+				big++;
+			ccnl_free(buf);
+		}
+		res = res && !big;
+		if (!res)
+			fprintf(stderr, "  path %d: mtu=%d after %d rounds, %d too big\n",
+				path, tx->mtu, rounds, big);
+		ccnl_frag_destroy(tx);
+		faces[0]->frag = NULL;
+	}
+	ccnl_test_ll_TX = NULL;
+
+	for (i = 0; i < 2; i++) {
+		while (frag_arq_wire[i]) {
+			buf = frag_arq_wire[i];
+			frag_arq_wire[i] = buf->next;
+			ccnl_free(buf);
+		}
+		ccnl_free(faces[i]);
+		ccnl_free(frag_arq_relay[i]);
+	}
+	return res;
+}
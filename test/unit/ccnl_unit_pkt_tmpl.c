@@ -0,0 +1,94 @@
+#include "test.h"
+#include "../../src/ccnl-headers.h"
+
+
+int pkt_tmpl_suite = CCNL_SUITE_NDNTLV;
+
+// widths change at 128/256/64K/16M, equal width neighbours take the patch path
+unsigned int pkt_tmpl_chunks[] = {0, 1, 127, 128, 200, 255, 256, 300, 65535,
+                                  65536, 70000, 16777216, 0, 1};
+#define PKT_TMPL_CHUNKCNT (sizeof(pkt_tmpl_chunks) / sizeof(unsigned int))
+
+//---------------------------------------------------------------------------------------------------
+int ccnl_test_prepare_pkt_tmpl(void **prefix, void **tmpl){
+
+	char *c = ccnl_malloc(100);
+	strcpy(c, "/path/to/data");
+	*prefix = ccnl_URItoPrefix(c, pkt_tmpl_suite, NULL, NULL);
+	ccnl_free(c);
+	if (!*prefix)
+		return 0;
+	*tmpl = ccnl_pkt_tmpl_new(*prefix);
+
+	return *tmpl != NULL;
+}
+
+int ccnl_test_cleanup_pkt_tmpl(void *prefix, void *tmpl){
+
+	struct ccnl_prefix_s *p = prefix;
+
+	ccnl_pkt_tmpl_free(tmpl);
+	free_prefix(p);
+	return 1;
+}
+
+//---------------------------------------------------------------------------------------------------
+// interests built from the template must match the prepend functions
+int ccnl_test_run_pkt_tmpl_interest(void *prefix, void *tmpl){
+
+	struct ccnl_prefix_s *p = prefix;
+	unsigned char *buf = ccnl_malloc(CCNL_MAX_PACKET_SIZE), *pkt;
+	int i, len, offs, nonce, res = 1;
+
+	for (i = 0; res && i < PKT_TMPL_CHUNKCNT; i++) {
+		nonce = 0x1000 + i;
+		p->chunknum = &pkt_tmpl_chunks[i];
+		offs = CCNL_MAX_PACKET_SIZE;
+		if (pkt_tmpl_suite == CCNL_SUITE_NDNTLV)
+			len = ccnl_ndntlv_prependInterest(p, -1, &nonce, &offs, buf);
+		else
+			len = ccnl_ccntlv_prependChunkInterestWithHdr(p, &offs, buf);
+		p->chunknum = NULL;
+
+		res = C_ASSERT_EQUAL_INT(ccnl_pkt_tmpl_interest(tmpl, &pkt_tmpl_chunks[i],
+				pkt_tmpl_suite == CCNL_SUITE_NDNTLV ? &nonce : NULL, &pkt), len);
+		res = res && len > 0 && !memcmp(pkt, buf + offs, len);
+	}
+	ccnl_free(buf);
+
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// same for content, with changing payload sizes and a final chunk
+int ccnl_test_run_pkt_tmpl_content(void *prefix, void *tmpl){
+
+	struct ccnl_prefix_s *p = prefix;
+	unsigned char *buf = ccnl_malloc(CCNL_MAX_PACKET_SIZE), *pkt;
+	unsigned char payload[300];
+	unsigned int *last;
+	int i, len, offs, paylen, cpos, res = 1;
+
+	for (i = 0; res && i < PKT_TMPL_CHUNKCNT; i++) {
+		paylen = i < 6 ? 20 : sizeof(payload);
+		last = i == 8 || i == PKT_TMPL_CHUNKCNT - 1 ? &pkt_tmpl_chunks[i] : NULL;
+		memset(payload, 'a' + i, paylen);
+		p->chunknum = &pkt_tmpl_chunks[i];
+		offs = CCNL_MAX_PACKET_SIZE;
+		if (pkt_tmpl_suite == CCNL_SUITE_NDNTLV)
+			len = ccnl_ndntlv_prependContent(p, payload, paylen, &offs, NULL,
+						last, buf);
+		else
+			len = ccnl_ccntlv_prependContentWithHdr(p, payload, paylen,
+						last, &offs, NULL, buf);
+		p->chunknum = NULL;
+
+		res = C_ASSERT_EQUAL_INT(ccnl_pkt_tmpl_content(tmpl, &pkt_tmpl_chunks[i],
+				payload, paylen, last, &cpos, &pkt), len);
+		res = res && len > 0 && !memcmp(pkt, buf + offs, len) &&
+			!memcmp(pkt + cpos, payload, paylen);
+	}
+	ccnl_free(buf);
+
+	return res;
+}
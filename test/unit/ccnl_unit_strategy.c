@@ -0,0 +1,371 @@
+#include "test.h"
+#include "../../src/ccnl-headers.h"
+
+
+// two next hops for /path/to, interests come in on a third face
+struct ccnl_relay_s *strategy_relay;
+struct ccnl_face_s *strategy_faces[3];
+struct ccnl_forward_s *strategy_fwd[2];
+
+struct ccnl_interest_s *ccnl_test_strategy_interest(struct ccnl_face_s *from){
+
+	char *c = ccnl_malloc(100);
+	struct ccnl_interest_s *i = ccnl_calloc(1, sizeof(struct ccnl_interest_s));
+
+	strcpy(c, "/path/to/data");
+	i->prefix = ccnl_URItoPrefix(c, CCNL_SUITE_NDNTLV, NULL, NULL);
+	ccnl_free(c);
+	i->pkt = ccnl_buf_new("interest", 8);
+	i->suite = CCNL_SUITE_NDNTLV;
+	i->details.ndntlv.maxsuffix = CCNL_MAX_NAME_COMP;
+	i->from = from;
+	i->hoppos = -1;
+#ifdef USE_NFN
+	i->flags = CCNL_PIT_COREPROPAGATES;
+#endif
+	DBL_LINKED_LIST_ADD(strategy_relay->pit, i);
+	return i;
+}
+
+// content for the PIT entry i arrives on face f after usec
+void ccnl_test_strategy_answer(struct ccnl_interest_s *i, struct ccnl_face_s *f,
+			       long usec){
+
+	struct ccnl_content_s *c = ccnl_calloc(1, sizeof(struct ccnl_content_s));
+
+	c->name = ccnl_prefix_dup(i->prefix);
+	i->upsent.tv_sec -= usec / 1000000 + 1;
+	i->upsent.tv_usec += 1000000 - usec % 1000000;
+	ccnl_fwd_RX(strategy_relay, f, c);
+	free_prefix(c->name);
+	ccnl_free(c);
+	ccnl_interest_remove(strategy_relay, i);
+}
+
+//---------------------------------------------------------------------------------------------------
+int ccnl_test_prepare_strategy(void **relay, void **fib){
+
+	char *c = ccnl_malloc(100);
+	int k;
+
+	strategy_relay = ccnl_calloc(1, sizeof(struct ccnl_relay_s));
+	strategy_relay->ifcount = 1;
+	strategy_relay->ifs[0].sock = -1;
+	for (k = 0; k < 3; k++) {
+		strategy_faces[k] = ccnl_calloc(1, sizeof(struct ccnl_face_s));
+		strategy_faces[k]->faceid = k + 1;
+	}
+	for (k = 1; k >= 0; k--) {
+		strcpy(c, "/path/to");
+		strategy_fwd[k] = ccnl_calloc(1, sizeof(struct ccnl_forward_s));
+		strategy_fwd[k]->prefix = ccnl_URItoPrefix(c, CCNL_SUITE_NDNTLV, NULL, NULL);
+		strategy_fwd[k]->face = strategy_faces[k];
+		strategy_fwd[k]->suite = CCNL_SUITE_NDNTLV;
+		strategy_fwd[k]->next = strategy_relay->fib;
+		strategy_relay->fib = strategy_fwd[k];
+	}
+	ccnl_free(c);
+	*relay = strategy_relay;
+	*fib = strategy_relay->fib;
+
+	return strategy_fwd[0]->prefix && strategy_fwd[1]->prefix;
+}
+
+int ccnl_test_cleanup_strategy(void *relay, void *fib){
+
+	int k;
+
+	while (strategy_relay->pit)
+		ccnl_interest_remove(strategy_relay, strategy_relay->pit);
+	for (k = 0; k < 2; k++) {
+		free_prefix(strategy_fwd[k]->prefix);
+		ccnl_free(strategy_fwd[k]);
+	}
+	for (k = 0; k < 3; k++)
+		ccnl_free(strategy_faces[k]);
+	ccnl_free(strategy_relay);
+	return 1;
+}
+
+//---------------------------------------------------------------------------------------------------
+// one next hop per interest, fail over on a timeout, then the measured
+// faster one; an alternative is probed every CCNL_STRATEGY_PROBE interests
+int ccnl_test_run_strategy_best(void *relay, void *fib){
+
+	struct ccnl_interest_s *i;
+	int k, res;
+
+	i = ccnl_test_strategy_interest(strategy_faces[2]);
+	ccnl_interest_propagate(strategy_relay, i);
+	res = i->upface == strategy_faces[0] &&
+		C_ASSERT_EQUAL_INT(strategy_fwd[0]->sent, 1) &&
+		C_ASSERT_EQUAL_INT(strategy_fwd[1]->sent, 0);
+
+	// no answer: the retransmission goes to the other one
+	ccnl_interest_propagate(strategy_relay, i);
+	res = res && i->upface == strategy_faces[1] &&
+		C_ASSERT_EQUAL_INT(strategy_fwd[1]->sent, 1);
+	ccnl_test_strategy_answer(i, strategy_faces[1], 20000);
+	res = res && C_ASSERT_EQUAL_INT(strategy_fwd[1]->ok, 1) &&
+		strategy_fwd[1]->srtt >= 20000 && strategy_fwd[1]->srtt < 30000;
+
+	for (k = 0; res && k < CCNL_STRATEGY_PROBE; k++) {
+		i = ccnl_test_strategy_interest(strategy_faces[2]);
+		ccnl_interest_propagate(strategy_relay, i);
+		res = i->upface == strategy_faces[1];
+		ccnl_test_strategy_answer(i, strategy_faces[1], 20000);
+	}
+	res = res && C_ASSERT_EQUAL_INT(strategy_fwd[0]->sent, 2) &&
+		C_ASSERT_EQUAL_INT(strategy_fwd[1]->sent, 1 + CCNL_STRATEGY_PROBE) &&
+		C_ASSERT_EQUAL_INT(strategy_fwd[1]->ok, 1 + CCNL_STRATEGY_PROBE);
+
+	// never back to where the interest came from
+	i = ccnl_test_strategy_interest(strategy_faces[1]);
+	ccnl_interest_propagate(strategy_relay, i);
+	res = res && i->upface == strategy_faces[0];
+
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// all next hops, the RTT samples are taken all the same
+int ccnl_test_run_strategy_multicast(void *relay, void *fib){
+
+	struct ccnl_interest_s *i;
+	int k, res = 1;
+
+	strategy_fwd[0]->strategy = strategy_fwd[1]->strategy = CCNL_STRATEGY_MULTICAST;
+	for (k = 1; res && k <= 3; k++) {
+		i = ccnl_test_strategy_interest(strategy_faces[2]);
+		ccnl_interest_propagate(strategy_relay, i);
+		res = !i->upface && C_ASSERT_EQUAL_INT(strategy_fwd[0]->sent, k) &&
+			C_ASSERT_EQUAL_INT(strategy_fwd[1]->sent, k);
+		ccnl_test_strategy_answer(i, strategy_faces[0], 5000);
+	}
+	return res && C_ASSERT_EQUAL_INT(strategy_fwd[0]->ok, 3) &&
+		C_ASSERT_EQUAL_INT(strategy_fwd[1]->ok, 0) &&
+		strategy_fwd[0]->srtt >= 5000 && strategy_fwd[0]->srtt < 10000;
+}
+
+//---------------------------------------------------------------------------------------------------
+// the retransmission timer follows the RTO of the chosen next hop, with
+// backoff and at most a quarter of jitter, until the entry is given up
+long ccnl_test_strategy_timeout(struct ccnl_interest_s *i){
+
+	struct ccnl_timer_s *t = i->retxTimer;
+	struct timeval now;
+
+	ccnl_get_timeval(&now);
+	return t ? timevaldelta(&t->timeout, &now) : -1;
+}
+
+int ccnl_test_run_strategy_retx(void *relay, void *fib){
+
+	struct ccnl_interest_s *i;
+	long usec;
+	int res;
+
+	strategy_fwd[0]->srtt = 10000;
+	strategy_fwd[0]->rttvar = 2000;
+	strategy_fwd[1]->srtt = 50000;
+	strategy_fwd[1]->rttvar = 10000;
+	i = ccnl_test_strategy_interest(strategy_faces[2]);
+	ccnl_interest_propagate(strategy_relay, i);
+	usec = ccnl_test_strategy_timeout(i);
+	res = i->upface == strategy_faces[0] && C_ASSERT_EQUAL_INT(i->rto, 20000) &&
+		usec > 19000 && usec <= 25000;
+
+	// the timer fires: fail over, twice the RTO of the other one
+	ccnl_rem_timer(i->retxTimer);
+	ccnl_interest_retx(strategy_relay, i);
+	usec = ccnl_test_strategy_timeout(i);
+	res = res && i->upface == strategy_faces[1] &&
+		C_ASSERT_EQUAL_INT(i->retries, 1) && C_ASSERT_EQUAL_INT(i->rto, 90000) &&
+		usec > 179000 && usec <= 225000;
+
+	// then the entry is given up
+	i->retries = CCNL_MAX_INTEREST_RETRANSMIT + 1;
+	ccnl_rem_timer(i->retxTimer);
+	ccnl_interest_retx(strategy_relay, i);
+
+	return res && !strategy_relay->pit;
+}
+
+//---------------------------------------------------------------------------------------------------
+// an InterestLifetime caps the retransmission timer and holds the entry
+// after its last retransmission; content is stale after its FreshnessPeriod
+int ccnl_test_run_strategy_lifetime(void *relay, void *fib){
+
+	struct ccnl_interest_s *i;
+	struct ccnl_content_s *c;
+	long usec;
+	int res;
+
+	strategy_fwd[0]->srtt = 50000;
+	strategy_fwd[0]->rttvar = 10000;
+	i = ccnl_test_strategy_interest(strategy_faces[2]);
+	ccnl_interest_lifetime(i, 30);
+	ccnl_interest_propagate(strategy_relay, i);
+	usec = ccnl_test_strategy_timeout(i);
+	res = i->upface == strategy_faces[0] && usec > 25000 && usec <= 30000;
+
+	// an aggregated interest only extends it
+	ccnl_interest_append_pending(i, strategy_faces[2]);
+	ccnl_interest_lifetime(i, 10);
+	res = res && ccnl_interest_lifeleft(i) > 20000;
+	ccnl_interest_lifetime(i, 100);
+	res = res && ccnl_interest_lifeleft(i) > 90000;
+
+	// the answer is overdue once the RTO has passed
+	res = res && !ccnl_interest_overdue(i);
+	i->upsent.tv_sec -= 1;
+	res = res && ccnl_interest_overdue(i);
+
+	// a longer lifetime does not keep it after its retransmissions
+	i->retries = CCNL_MAX_INTEREST_RETRANSMIT + 1;
+	ccnl_rem_timer(i->retxTimer);
+	ccnl_interest_retx(strategy_relay, i);
+	res = res && !strategy_relay->pit;
+
+	i = ccnl_test_strategy_interest(strategy_faces[2]);
+	ccnl_interest_lifetime(i, 30);
+	ccnl_interest_propagate(strategy_relay, i);
+	ccnl_get_timeval(&i->expires);
+	ccnl_rem_timer(i->retxTimer);
+	ccnl_interest_retx(strategy_relay, i);
+	res = res && !strategy_relay->pit;
+
+	c = ccnl_calloc(1, sizeof(struct ccnl_content_s));
+	ccnl_content_freshness(c, 1000);
+	res = res && !ccnl_content_isStale(c);
+	c->fresh.tv_sec -= 1;
+	res = res && ccnl_content_isStale(c);
+	ccnl_content_freshness(c, -1);
+	res = res && ccnl_content_isStale(c);
+	ccnl_free(c);
+
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// a NACK fails over to the other next hop at once; once all of them NACKed
+// it goes downstream and the name is answered locally for a moment
+void ccnl_test_strategy_nack(struct ccnl_interest_s *i, struct ccnl_face_s *f){
+
+	struct ccnl_prefix_s *p = ccnl_prefix_dup(i->prefix);
+
+	ccnl_fwd_handleContent(strategy_relay, f,
+			ccnl_nfn_result2content(strategy_relay, &p, (unsigned char*) ":NACK", 5));
+}
+
+int ccnl_test_run_strategy_nack(void *relay, void *fib){
+
+	struct ccnl_interest_s *i;
+	int res;
+
+	i = ccnl_test_strategy_interest(strategy_faces[2]);
+	ccnl_interest_append_pending(i, strategy_faces[2]);
+	res = ccnl_interest_propagate(strategy_relay, i) &&
+		i->upface == strategy_faces[0];
+
+	ccnl_test_strategy_nack(i, strategy_faces[0]);
+	res = res && strategy_relay->pit == i && i->upface == strategy_faces[1] &&
+		C_ASSERT_EQUAL_INT(strategy_relay->nackcnt, 0);
+
+	ccnl_test_strategy_nack(i, strategy_faces[1]);
+	res = res && !strategy_relay->pit &&
+		C_ASSERT_EQUAL_INT(strategy_relay->nackcnt, 1);
+
+	i = ccnl_test_strategy_interest(strategy_faces[2]);
+	res = res && !ccnl_interest_propagate(strategy_relay, i) &&
+		!strategy_relay->pit;
+
+	// the entry has expired
+	strategy_relay->nacks->expires.tv_sec = 0;
+	i = ccnl_test_strategy_interest(strategy_faces[2]);
+	res = res && ccnl_interest_propagate(strategy_relay, i) &&
+		strategy_relay->pit == i && C_ASSERT_EQUAL_INT(strategy_relay->nackcnt, 0);
+
+	return res;
+}
+
+//---------------------------------------------------------------------------------------------------
+// one next hop per name, in shares by weight, the same one for the same
+// name; a retransmission goes to another one
+struct ccnl_interest_s *ccnl_test_strategy_named(int n){
+
+	struct ccnl_interest_s *i = ccnl_test_strategy_interest(strategy_faces[2]);
+	char *c = ccnl_malloc(100);
+
+	sprintf(c, "/path/to/data%d", n);
+	free_prefix(i->prefix);
+	i->prefix = ccnl_URItoPrefix(c, CCNL_SUITE_NDNTLV, NULL, NULL);
+	ccnl_free(c);
+	return i;
+}
+
+int ccnl_test_run_strategy_weighted(void *relay, void *fib){
+
+	struct ccnl_interest_s *i;
+	struct ccnl_face_s *first[20];
+	int k, cnt = 0, res = 1;
+
+	strategy_fwd[0]->strategy = strategy_fwd[1]->strategy = CCNL_STRATEGY_WEIGHTED;
+	strategy_fwd[0]->weight = 3;
+	strategy_fwd[1]->weight = 1;
+	for (k = 0; res && k < 400; k++) {
+		i = ccnl_test_strategy_named(k);
+		res = ccnl_interest_propagate(strategy_relay, i) && i->upface;
+		if (res && i->upface == strategy_faces[0])
+			cnt++;
+		if (k < 20)
+			first[k] = i->upface;
+		ccnl_interest_remove(strategy_relay, i);
+	}
+	res = res && cnt > 250 && cnt < 350;
+	for (k = 0; res && k < 20; k++) {
+		i = ccnl_test_strategy_named(k);
+		ccnl_interest_propagate(strategy_relay, i);
+		res = i->upface == first[k];
+		ccnl_interest_remove(strategy_relay, i);
+	}
+
+	i = ccnl_test_strategy_named(0);
+	ccnl_interest_propagate(strategy_relay, i);
+	ccnl_interest_propagate(strategy_relay, i);
+	res = res && i->upface && i->upface != first[0];
+	ccnl_interest_remove(strategy_relay, i);
+
+	// without weights, by the measured cost: the faster one gets more
+	strategy_fwd[0]->weight = strategy_fwd[1]->weight = 0;
+	strategy_fwd[0]->srtt = CCNL_STRATEGY_RTT0 / 8;
+	strategy_fwd[0]->rttvar = 0;
+	for (k = cnt = 0; res && k < 200; k++) {
+		strategy_fwd[0]->sent = strategy_fwd[1]->sent = 0;
+		strategy_fwd[0]->ok = strategy_fwd[1]->ok = 0;
+		res = ccnl_fwd_weight(strategy_fwd[0]) == 8 * ccnl_fwd_weight(strategy_fwd[1]);
+		i = ccnl_test_strategy_named(k);
+		ccnl_interest_propagate(strategy_relay, i);
+		if (i->upface == strategy_faces[0])
+			cnt++;
+		ccnl_interest_remove(strategy_relay, i);
+	}
+
+	// the jitter of the RTT does not move names between the next hops
+	for (k = 0; res && k < 20; k++) {
+		strategy_fwd[0]->sent = strategy_fwd[1]->sent = 0;
+		strategy_fwd[0]->ok = strategy_fwd[1]->ok = 0;
+		strategy_fwd[0]->srtt = CCNL_STRATEGY_RTT0 / 6 + k * 50;
+		i = ccnl_test_strategy_named(k);
+		ccnl_interest_propagate(strategy_relay, i);
+		first[k] = i->upface;
+		ccnl_interest_remove(strategy_relay, i);
+		strategy_fwd[0]->sent = strategy_fwd[1]->sent = 0;
+		strategy_fwd[0]->srtt = CCNL_STRATEGY_RTT0 / 6 - k * 50;
+		i = ccnl_test_strategy_named(k);
+		ccnl_interest_propagate(strategy_relay, i);
+		res = i->upface == first[k];
+		ccnl_interest_remove(strategy_relay, i);
+	}
+	return res && cnt > 150;
+}
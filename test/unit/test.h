@@ -4,6 +4,7 @@
 
 #define USE_DEBUG
 #define USE_DEBUG_MALLOC
+#define USE_DISKCACHE
 #define CCNL_UNIX
 #define USE_NFN
 #define USE_NFN_MONITOR
@@ -13,7 +14,6 @@
 enum {STAT_RCV_I, STAT_RCV_C, STAT_SND_I, STAT_SND_C, STAT_QLEN, STAT_EOP1};
 
 
-#define ccnl_frag_destroy(e)            do{}while(0)
 #define ccnl_print_stats(x,y)           do{}while(0)
 #define ccnl_app_RX(x,y)		do{}while(0)
 
@@ -28,14 +28,19 @@ enum {STAT_RCV_I, STAT_RCV_C, STAT_SND_I, STAT_SND_C, STAT_QLEN, STAT_EOP1};
 
 #define CCNL_UNIX
 
+#define USE_CACHEPOLICY
 #define USE_CCNxDIGEST
 #define USE_DEBUG                      // must select this for USE_MGMT
 #define USE_DEBUG_MALLOC
 #define USE_ETHERNET
+#define USE_FRAG
 #define USE_HTTP_STATUS
 #define USE_NACK
 #define USE_NFN
 #define USE_NFN_NSTRANS
+#define USE_PREFETCH
+#define USE_PRELOAD
+#define USE_SNAPSHOT
 #define USE_SUITE_CCNB                 // must select this for USE_MGMT
 #define USE_SUITE_CCNTLV
 #define USE_SUITE_IOTTLV
@@ -57,7 +62,10 @@ enum {STAT_RCV_I, STAT_RCV_C, STAT_SND_I, STAT_SND_C, STAT_QLEN, STAT_EOP1};
 #define ccnl_app_RX(x,y)                do{}while(0)
 #define ccnl_print_stats(x,y)           do{}while(0)
 #define ccnl_close_socket(a)		do{}while(0)
-#define ccnl_ll_TX(a,b,c,d)		do{a=a;}while(0)
+// datagrams handed to the link layer, for the tests which look at them
+void (*ccnl_test_ll_TX)(struct ccnl_relay_s *relay, struct ccnl_buf_s *buf);
+#define ccnl_ll_TX(a,b,c,d)		do{(void)(b);if(ccnl_test_ll_TX)ccnl_test_ll_TX(a,d);}while(0)
+#define ccnl_ll_TXv(a,b,c,d,e)		do{a=a;(void)(b);(void)(d);}while(0)
 
 #include "../../src/ccnl-core.c"
 
@@ -67,6 +75,11 @@ enum {STAT_RCV_I, STAT_RCV_C, STAT_SND_I, STAT_SND_C, STAT_QLEN, STAT_EOP1};
 #include "../../src/ccnl-ext-nfn.c"
 #include "../../src/ccnl-ext-nfnmonitor.c"
 #include "../../src/ccnl-ext-sched.c"
+#include "../../src/ccnl-ext-cache.c"
+#include "../../src/ccnl-ext-prefetch.c"
+#include "../../src/ccnl-ext-preload.c"
+#include "../../src/ccnl-ext-diskcache.c"
+#include "../../src/ccnl-ext-snapshot.c"
 #include "../../src/ccnl-ext-frag.c"
 #include "../../src/ccnl-ext-crypto.c"
 
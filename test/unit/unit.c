@@ -9,12 +9,17 @@
 #include "ccnl_unit_uri_2_prefix.c"
 #include "ccnl_unit_prefix_comp.c"
 #include "ccnl_unit_stack_type_const.c"
+#include "ccnl_unit_pkt_tmpl.c"
+#include "ccnl_unit_frag.c"
+#include "ccnl_unit_strategy.c"
+#include "ccnl_unit_cache.c"
 
 int main(int argc, char **argv){
 
 	struct ccnl_prefix_s *p1 = NULL, *p2 = NULL;
 	char *str = NULL;
 	struct const_s *con1 = NULL, *con2 = NULL;
+	void *tmpl = NULL;
 
 	fprintf(stderr, "CCN-lite Unit Tests\n");
 
@@ -71,7 +76,6 @@ int main(int argc, char **argv){
 		sprintf(testdescription, "testing prefix cmp with a match components for match with suite %s", ccnl_suite2str(prefix_cmp_suite));
 		RUN_TEST(testnum, testdescription, ccnl_test_prepare_prefix_cmp_match, ccnl_test_run_prefix_cmp_match, ccnl_test_cleanup_prefix_cmp, p1, p2);
 	}
-	ccnl_free(testdescription);
 
 	//Test: prefix type const: str2const
 	++testnum;
@@ -82,6 +86,94 @@ int main(int argc, char **argv){
 	++testnum;
 	RUN_TEST(testnum, "Testing stack type const2str", ccnl_test_prepare_stack_type_const_const2str, ccnl_test_run_stack_type_const_const2str, ccnl_test_cleanup_stack_type_const_const2str, str, con2);
 
+	//Test: packet templates for NDN and CCNx
+	int suites[] = {CCNL_SUITE_CCNTLV, CCNL_SUITE_NDNTLV}, i;
+	for(i = 0; i < 2; ++i){
+		pkt_tmpl_suite = suites[i];
+
+		++testnum;
+		sprintf(testdescription, "testing interest packet templates with suite %s", ccnl_suite2str(pkt_tmpl_suite));
+		RUN_TEST(testnum, testdescription, ccnl_test_prepare_pkt_tmpl, ccnl_test_run_pkt_tmpl_interest, ccnl_test_cleanup_pkt_tmpl, p1, tmpl);
+
+		++testnum;
+		sprintf(testdescription, "testing content packet templates with suite %s", ccnl_suite2str(pkt_tmpl_suite));
+		RUN_TEST(testnum, testdescription, ccnl_test_prepare_pkt_tmpl, ccnl_test_run_pkt_tmpl_content, ccnl_test_cleanup_pkt_tmpl, p1, tmpl);
+	}
+
+	//Test: fragmentation and reassembly for both fragment formats
+	int protos[] = {CCNL_FRAG_SEQUENCED2012, CCNL_FRAG_CCNx2013};
+	void *frag_face = NULL;
+	for(i = 0; i < 2; ++i){
+		frag_proto = protos[i];
+
+		++testnum;
+		sprintf(testdescription, "testing fragment count and reassembly with protocol %s", frag_protocol(frag_proto));
+		RUN_TEST(testnum, testdescription, ccnl_test_prepare_frag, ccnl_test_run_frag, ccnl_test_cleanup_frag, tmpl, frag_face);
+
+		++testnum;
+		sprintf(testdescription, "testing out of order reassembly with protocol %s", frag_protocol(frag_proto));
+		RUN_TEST(testnum, testdescription, ccnl_test_prepare_frag, ccnl_test_run_frag_reorder, ccnl_test_cleanup_frag, tmpl, frag_face);
+
+		++testnum;
+		sprintf(testdescription, "testing fragment retransmission (ARQ) with protocol %s", frag_protocol(frag_proto));
+		RUN_TEST(testnum, testdescription, ccnl_test_prepare_frag, ccnl_test_run_frag_arq, ccnl_test_cleanup_frag, tmpl, frag_face);
+
+		++testnum;
+		sprintf(testdescription, "testing forward error correction (FEC) with protocol %s", frag_protocol(frag_proto));
+		RUN_TEST(testnum, testdescription, ccnl_test_prepare_frag, ccnl_test_run_frag_fec, ccnl_test_cleanup_frag, tmpl, frag_face);
+
+		++testnum;
+		sprintf(testdescription, "testing path MTU discovery with protocol %s", frag_protocol(frag_proto));
+		RUN_TEST(testnum, testdescription, ccnl_test_prepare_frag, ccnl_test_run_frag_pmtu, ccnl_test_cleanup_frag, tmpl, frag_face);
+	}
+
+	//Test: forwarding strategies
+	void *fwd_relay = NULL, *fwd_fib = NULL;
+	++testnum;
+	RUN_TEST(testnum, "testing best next hop strategy with failover and probing", ccnl_test_prepare_strategy, ccnl_test_run_strategy_best, ccnl_test_cleanup_strategy, fwd_relay, fwd_fib);
+
+	++testnum;
+	RUN_TEST(testnum, "testing multicast strategy", ccnl_test_prepare_strategy, ccnl_test_run_strategy_multicast, ccnl_test_cleanup_strategy, fwd_relay, fwd_fib);
+
+	++testnum;
+	RUN_TEST(testnum, "testing interest retransmission timers", ccnl_test_prepare_strategy, ccnl_test_run_strategy_retx, ccnl_test_cleanup_strategy, fwd_relay, fwd_fib);
+
+	++testnum;
+	RUN_TEST(testnum, "testing InterestLifetime and FreshnessPeriod", ccnl_test_prepare_strategy, ccnl_test_run_strategy_lifetime, ccnl_test_cleanup_strategy, fwd_relay, fwd_fib);
+
+	++testnum;
+	RUN_TEST(testnum, "testing NACK failover and negative cache", ccnl_test_prepare_strategy, ccnl_test_run_strategy_nack, ccnl_test_cleanup_strategy, fwd_relay, fwd_fib);
+
+	++testnum;
+	RUN_TEST(testnum, "testing weighted multipath strategy", ccnl_test_prepare_strategy, ccnl_test_run_strategy_weighted, ccnl_test_cleanup_strategy, fwd_relay, fwd_fib);
+
+	//Test: cache admission
+	void *cs_relay = NULL, *cs_policies = NULL;
+	++testnum;
+	RUN_TEST(testnum, "testing cache admission by prefix, LCD and fixed probability", ccnl_test_prepare_cache, ccnl_test_run_cache_policies, ccnl_test_cleanup_cache, cs_relay, cs_policies);
+
+	++testnum;
+	RUN_TEST(testnum, "testing ProbCache and TinyLFU cache admission", ccnl_test_prepare_cache, ccnl_test_run_cache_probcache_tinylfu, ccnl_test_cleanup_cache, cs_relay, cs_policies);
+
+	++testnum;
+	RUN_TEST(testnum, "testing sequential chunk prefetching", ccnl_test_prepare_cache, ccnl_test_run_cache_prefetch, ccnl_test_cleanup_cache, cs_relay, cs_policies);
+
+	++testnum;
+	RUN_TEST(testnum, "testing background loading of the content store", ccnl_test_prepare_cache, ccnl_test_run_cache_preload, ccnl_test_cleanup_cache, cs_relay, cs_policies);
+
+	++testnum;
+	RUN_TEST(testnum, "testing loading of a packed repository file", ccnl_test_prepare_cache, ccnl_test_run_cache_repo, ccnl_test_cleanup_cache, cs_relay, cs_policies);
+
+	++testnum;
+	RUN_TEST(testnum, "testing the content store tier on disk", ccnl_test_prepare_cache, ccnl_test_run_cache_disk, ccnl_test_cleanup_cache, cs_relay, cs_policies);
+
+	++testnum;
+	RUN_TEST(testnum, "testing the disk tier for content dropped by the ageing", ccnl_test_prepare_cache, ccnl_test_run_cache_disk_ageing, ccnl_test_cleanup_cache, cs_relay, cs_policies);
+
+	++testnum;
+	RUN_TEST(testnum, "testing content store snapshot and restore", ccnl_test_prepare_cache, ccnl_test_run_cache_snapshot, ccnl_test_cleanup_cache, cs_relay, cs_policies);
+	ccnl_free(testdescription);
+
 	return 0;
 }
 